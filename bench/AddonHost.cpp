@@ -0,0 +1,617 @@
+#include "AddonHost.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include "AddonUIData.h"
+#include "CDataFile.h"
+#include "Startup.h"
+#include "crc32_hash.hpp"
+
+using namespace Bench;
+using namespace reshade::api;
+using namespace std;
+
+BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID);
+
+// Stands in for the addon's module handle, GetModuleFileName answers for any non-null one
+static char g_module;
+
+void Counters::Reset()
+{
+    techniquesRendered = 0;
+    effectBatches = 0;
+    stateRebinds = 0;
+    copies = 0;
+    clears = 0;
+    bindingUpdates = 0;
+    uniformWrites = 0;
+}
+
+bool PrivateData::Get(const uint8_t guid[16], uint64_t* data) const
+{
+    for (const auto& [key, value] : _entries)
+    {
+        if (key == guid)
+        {
+            *data = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void PrivateData::Set(const uint8_t guid[16], uint64_t data)
+{
+    for (auto& [key, value] : _entries)
+    {
+        if (key == guid)
+        {
+            value = data;
+            return;
+        }
+    }
+
+    _entries.emplace_back(guid, data);
+}
+
+bool StubDevice::create_resource(const resource_desc& desc, const subresource_data* initial_data, resource_usage, resource* out_handle, void**)
+{
+    unique_lock<shared_mutex> lock(_mutex);
+
+    const uint64_t handle = _nextHandle++;
+    Resource& res = _resources[handle];
+    res.desc = desc;
+
+    if (desc.type == resource_type::buffer)
+    {
+        res.data.resize(static_cast<size_t>(desc.buffer.size));
+        if (initial_data != nullptr && initial_data->data != nullptr)
+        {
+            memcpy(res.data.data(), initial_data->data, res.data.size());
+        }
+    }
+
+    *out_handle = resource{ handle };
+    return true;
+}
+
+void StubDevice::destroy_resource(resource handle)
+{
+    unique_lock<shared_mutex> lock(_mutex);
+    _resources.erase(handle.handle);
+}
+
+resource_desc StubDevice::get_resource_desc(resource resource) const
+{
+    shared_lock<shared_mutex> lock(_mutex);
+
+    const auto it = _resources.find(resource.handle);
+    return it != _resources.end() ? it->second.desc : resource_desc();
+}
+
+bool StubDevice::create_resource_view(resource resource, resource_usage, const resource_view_desc& desc, resource_view* out_handle)
+{
+    unique_lock<shared_mutex> lock(_mutex);
+
+    const uint64_t handle = _nextHandle++;
+    _views.emplace(handle, make_pair(resource, desc));
+
+    *out_handle = resource_view{ handle };
+    return true;
+}
+
+void StubDevice::destroy_resource_view(resource_view handle)
+{
+    unique_lock<shared_mutex> lock(_mutex);
+    _views.erase(handle.handle);
+}
+
+resource StubDevice::get_resource_from_view(resource_view view) const
+{
+    shared_lock<shared_mutex> lock(_mutex);
+
+    const auto it = _views.find(view.handle);
+    return it != _views.end() ? it->second.first : resource{ 0 };
+}
+
+resource_view_desc StubDevice::get_resource_view_desc(resource_view view) const
+{
+    shared_lock<shared_mutex> lock(_mutex);
+
+    const auto it = _views.find(view.handle);
+    return it != _views.end() ? it->second.second : resource_view_desc();
+}
+
+bool StubDevice::map_buffer_region(resource resource, uint64_t offset, uint64_t size, map_access, void** out_data)
+{
+    shared_lock<shared_mutex> lock(_mutex);
+
+    const auto it = _resources.find(resource.handle);
+    if (it == _resources.end() || offset >= it->second.data.size())
+    {
+        return false;
+    }
+
+    *out_data = it->second.data.data() + offset;
+    return true;
+}
+
+bool StubDevice::AddResource(resource handle, const resource_desc& desc)
+{
+    unique_lock<shared_mutex> lock(_mutex);
+
+    const auto [it, added] = _resources.try_emplace(handle.handle);
+    if (added)
+    {
+        it->second.desc = desc;
+        if (desc.type == resource_type::buffer)
+        {
+            it->second.data.resize(static_cast<size_t>(desc.buffer.size));
+        }
+    }
+
+    return added;
+}
+
+bool StubDevice::AddView(resource_view handle, resource resource, const resource_view_desc& desc)
+{
+    unique_lock<shared_mutex> lock(_mutex);
+    return _views.try_emplace(handle.handle, resource, desc).second;
+}
+
+void StubDevice::CopyBuffer(resource source, resource dest)
+{
+    unique_lock<shared_mutex> lock(_mutex);
+
+    const auto src = _resources.find(source.handle);
+    const auto dst = _resources.find(dest.handle);
+    if (src != _resources.end() && dst != _resources.end())
+    {
+        memcpy(dst->second.data.data(), src->second.data.data(), min(src->second.data.size(), dst->second.data.size()));
+    }
+}
+
+void StubCommandList::copy_resource(resource source, resource dest)
+{
+    _device.Stats().copies++;
+    _device.CopyBuffer(source, dest);
+}
+
+StubRuntime::StubRuntime(StubDevice& device, StubQueue& queue, uint32_t width, uint32_t height) : _device(device), _queue(queue), _width(width), _height(height)
+{
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        resource backBuffer;
+        device.create_resource(resource_desc(width, height, 1, 1, format::r8g8b8a8_unorm, 1, memory_heap::gpu_only, resource_usage::render_target | resource_usage::copy_source),
+            nullptr, resource_usage::present, &backBuffer);
+        _backBuffers.push_back(backBuffer);
+    }
+}
+
+void StubRuntime::get_screenshot_width_and_height(uint32_t* out_width, uint32_t* out_height) const
+{
+    *out_width = _width;
+    *out_height = _height;
+}
+
+void StubRuntime::enumerate_uniform_variables(const char*, void(*callback)(effect_runtime* runtime, effect_uniform_variable variable, void* user_data), void* user_data)
+{
+    for (size_t i = 0; i < _uniforms.size(); i++)
+    {
+        callback(this, effect_uniform_variable{ i + 1 }, user_data);
+    }
+}
+
+void StubRuntime::get_uniform_variable_type(effect_uniform_variable variable, format* out_base_type, uint32_t* out_rows, uint32_t* out_columns, uint32_t* out_array_length) const
+{
+    const UniformDesc& desc = _uniforms[variable.handle - 1].desc;
+
+    *out_base_type = desc.type;
+    if (out_rows != nullptr)
+        *out_rows = desc.rows;
+    if (out_columns != nullptr)
+        *out_columns = desc.columns;
+    if (out_array_length != nullptr)
+        *out_array_length = desc.arrayLength;
+}
+
+bool StubRuntime::get_annotation_string_from_uniform_variable(effect_uniform_variable variable, const char* name, char* value, size_t* length) const
+{
+    const string& source = _uniforms[variable.handle - 1].desc.source;
+    if (strcmp(name, "source") != 0 || source.empty())
+    {
+        return false;
+    }
+
+    if (value == nullptr)
+    {
+        *length = source.size() + 1;
+        return true;
+    }
+
+    *length = min(*length - 1, source.size());
+    memcpy(value, source.data(), *length);
+    value[*length] = '\0';
+    return true;
+}
+
+template<typename T>
+void StubRuntime::GetUniform(effect_uniform_variable variable, T* values, size_t count, size_t array_index) const
+{
+    const Uniform& uniform = _uniforms[variable.handle - 1];
+    const size_t first = array_index * uniform.desc.rows * uniform.desc.columns;
+
+    count = min(count, uniform.values.size() - min(first, uniform.values.size()));
+    memcpy(values, uniform.values.data() + first, count * sizeof(T));
+}
+
+template<typename T>
+void StubRuntime::SetUniform(effect_uniform_variable variable, const T* values, size_t count, size_t array_index)
+{
+    Uniform& uniform = _uniforms[variable.handle - 1];
+    const size_t first = array_index * uniform.desc.rows * uniform.desc.columns;
+
+    count = min(count, uniform.values.size() - min(first, uniform.values.size()));
+    memcpy(uniform.values.data() + first, values, count * sizeof(T));
+    _device.Stats().uniformWrites++;
+}
+
+void StubRuntime::enumerate_techniques(const char*, void(*callback)(effect_runtime* runtime, effect_technique technique, void* user_data), void* user_data)
+{
+    for (size_t i = 0; i < _techniques.size(); i++)
+    {
+        callback(this, effect_technique{ i + 1 }, user_data);
+    }
+}
+
+void StubRuntime::get_technique_name(effect_technique technique, char* value, size_t* length) const
+{
+    const string& name = _techniques[technique.handle - 1].name;
+
+    if (value == nullptr)
+    {
+        *length = name.size() + 1;
+        return;
+    }
+
+    *length = min(*length - 1, name.size());
+    memcpy(value, name.data(), *length);
+    value[*length] = '\0';
+}
+
+void StubRuntime::SetTechniques(const vector<string>& names)
+{
+    _techniques.clear();
+    for (const auto& name : names)
+    {
+        _techniques.push_back({ name, true });
+    }
+}
+
+void StubRuntime::SetUniforms(const vector<UniformDesc>& uniforms)
+{
+    _uniforms.clear();
+    for (const auto& desc : uniforms)
+    {
+        _uniforms.push_back({ desc, vector<uint32_t>(static_cast<size_t>(max(desc.arrayLength, 1u)) * desc.rows * desc.columns) });
+    }
+}
+
+bool AddonConfig::Write(const filesystem::path& path) const
+{
+    ofstream file(path, ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "[General]\n";
+    file << "AmountGroups=" << groups.size() << "\n";
+    file << "ConstantBufferHookCopyType=" << constantCopy << "\n";
+    file << "ResourceShim=none\n\n";
+
+    const auto writeHashes = [&file](const string& section, const vector<uint32_t>& hashes) {
+        file << "[" << section << "]\n";
+        file << "AmountHashes=" << hashes.size() << "\n";
+        for (size_t i = 0; i < hashes.size(); i++)
+        {
+            file << "ShaderHash" << i << "=" << hashes[i] << "\n";
+        }
+        file << "\n";
+    };
+
+    for (size_t i = 0; i < groups.size(); i++)
+    {
+        const GroupDesc& group = groups[i];
+        const string section = "Group" + to_string(i);
+
+        file << "[" << section << "]\n";
+        file << "Name=" << group.name << "\n";
+        file << "Active=" << (group.active ? 1 : 0) << "\n";
+        file << "InvocationLocation=" << group.invocationLocation << "\n";
+        file << "MatchSwapchainResolutionOnly=0\n";
+        file << "Techniques=";
+        for (size_t t = 0; t < group.techniques.size(); t++)
+        {
+            file << (t > 0 ? "," : "") << group.techniques[t];
+        }
+        file << "\n";
+        file << "ExtractConstants=" << (group.extractConstants ? 1 : 0) << "\n";
+        file << "ConstantPipelineSlot=" << group.constantSlot << "\n";
+        file << "ConstantDescriptorIndex=0\n\n";
+
+        writeHashes(section + "_PixelShaders", group.pixelShaders);
+        writeHashes(section + "_VertexShaders", group.vertexShaders);
+
+        file << "[" << section << "_Constants]\n";
+        file << "AmountConstants=" << group.constants.size() << "\n";
+        for (size_t c = 0; c < group.constants.size(); c++)
+        {
+            file << "Offset" << c << "=" << group.constants[c].second << "\n";
+            file << "Variable" << c << "=" << group.constants[c].first << "\n";
+            file << "UsePreviousValue" << c << "=0\n";
+            file << "Elements" << c << "=1\n";
+        }
+        file << "\n";
+    }
+
+    return static_cast<bool>(file);
+}
+
+AddonHost::~AddonHost()
+{
+    Unload();
+}
+
+bool AddonHost::Load(const AddonConfig& config, device_api api, const vector<string>& techniques, const vector<UniformDesc>& uniforms)
+{
+    _directory = filesystem::temp_directory_path() / ("shadertoggler-bench-" + to_string(GetCurrentProcessId()));
+
+    error_code ec;
+    filesystem::create_directories(_directory, ec);
+    if (ec || !config.Write(_directory / HASH_FILE_NAME))
+    {
+        fprintf(stderr, "Could not write the config to %s\n", _directory.string().c_str());
+        return false;
+    }
+
+    return Start(api, techniques, uniforms);
+}
+
+bool AddonHost::Load(const filesystem::path& configFile, device_api api, const vector<string>& techniques, const vector<UniformDesc>& uniforms)
+{
+    _directory = filesystem::temp_directory_path() / ("shadertoggler-bench-" + to_string(GetCurrentProcessId()));
+
+    error_code ec;
+    filesystem::create_directories(_directory, ec);
+    if (!ec)
+    {
+        filesystem::copy_file(configFile, _directory / HASH_FILE_NAME, filesystem::copy_options::overwrite_existing, ec);
+    }
+    if (ec)
+    {
+        fprintf(stderr, "Could not copy %s: %s\n", configFile.string().c_str(), ec.message().c_str());
+        return false;
+    }
+
+    return Start(api, techniques, uniforms);
+}
+
+bool AddonHost::Start(device_api api, const vector<string>& techniques, const vector<UniformDesc>& uniforms)
+{
+    BenchStub::ModuleFileName = _directory / "ReshadeEffectShaderToggler.addon";
+
+    if (!DllMain(reinterpret_cast<HMODULE>(&g_module), DLL_PROCESS_ATTACH, nullptr))
+    {
+        return false;
+    }
+    _loaded = true;
+
+    ShaderToggler::Startup::Wait();
+
+    _device = make_unique<StubDevice>(api, _counters);
+    _queue = make_unique<StubQueue>(*_device);
+    _runtime = make_unique<StubRuntime>(*_device, *_queue, WIDTH, HEIGHT);
+    _runtime->SetTechniques(techniques);
+    _runtime->SetUniforms(uniforms);
+
+    reshade::invoke_addon_event<reshade::addon_event::init_device>(_device.get());
+    reshade::invoke_addon_event<reshade::addon_event::init_command_list>(&_queue->ImmediateCommandList());
+    reshade::invoke_addon_event<reshade::addon_event::init_swapchain>(_runtime.get());
+    reshade::invoke_addon_event<reshade::addon_event::init_effect_runtime>(_runtime.get());
+
+    // ReShade enables the preset's techniques one by one before announcing the reload
+    for (size_t i = 0; i < techniques.size(); i++)
+    {
+        reshade::invoke_addon_event<reshade::addon_event::reshade_set_technique_state>(_runtime.get(), effect_technique{ i + 1 }, true);
+    }
+    reshade::invoke_addon_event<reshade::addon_event::reshade_reloaded_effects>(_runtime.get());
+
+    Present();
+    _counters.Reset();
+
+    return true;
+}
+
+void AddonHost::Unload()
+{
+    if (!_loaded)
+    {
+        return;
+    }
+
+    reshade::invoke_addon_event<reshade::addon_event::destroy_effect_runtime>(_runtime.get());
+    reshade::invoke_addon_event<reshade::addon_event::destroy_swapchain>(_runtime.get());
+    for (const auto& cmd_list : _commandLists)
+    {
+        reshade::invoke_addon_event<reshade::addon_event::destroy_command_list>(cmd_list.get());
+    }
+    reshade::invoke_addon_event<reshade::addon_event::destroy_command_list>(&_queue->ImmediateCommandList());
+    reshade::invoke_addon_event<reshade::addon_event::destroy_device>(_device.get());
+
+    DllMain(reinterpret_cast<HMODULE>(&g_module), DLL_PROCESS_DETACH, nullptr);
+    _loaded = false;
+
+    _commandLists.clear();
+    _runtime.reset();
+    _queue.reset();
+    _device.reset();
+
+    error_code ec;
+    filesystem::remove_all(_directory, ec);
+}
+
+StubCommandList& AddonHost::CreateCommandList(bool deferred)
+{
+    _commandLists.push_back(make_unique<StubCommandList>(*_device, deferred));
+    reshade::invoke_addon_event<reshade::addon_event::init_command_list>(_commandLists.back().get());
+
+    return *_commandLists.back();
+}
+
+void AddonHost::CreatePipeline(pipeline pipeline, uint32_t pixelShaderHash, uint32_t vertexShaderHash)
+{
+    const vector<uint8_t> psCode = ShaderCodeForHash(pixelShaderHash);
+    const vector<uint8_t> vsCode = ShaderCodeForHash(vertexShaderHash);
+    shader_desc ps = { psCode.data(), psCode.size() };
+    shader_desc vs = { vsCode.data(), vsCode.size() };
+
+    pipeline_subobject subobjects[2];
+    uint32_t count = 0;
+    if (pixelShaderHash != 0)
+    {
+        subobjects[count++] = { pipeline_subobject_type::pixel_shader, 1, &ps };
+    }
+    if (vertexShaderHash != 0)
+    {
+        subobjects[count++] = { pipeline_subobject_type::vertex_shader, 1, &vs };
+    }
+
+    reshade::invoke_addon_event<reshade::addon_event::init_pipeline>(_device.get(), pipeline_layout{ 0 }, count, subobjects, pipeline);
+}
+
+resource_view AddonHost::CreateRenderTarget(format format)
+{
+    const resource_desc desc(WIDTH, HEIGHT, 1, 1, format, 1, memory_heap::gpu_only, resource_usage::render_target | resource_usage::shader_resource);
+    resource res;
+    _device->create_resource(desc, nullptr, resource_usage::render_target, &res);
+    reshade::invoke_addon_event<reshade::addon_event::init_resource>(_device.get(), desc, nullptr, resource_usage::render_target, res);
+
+    const resource_view_desc viewDesc(format);
+    resource_view view;
+    _device->create_resource_view(res, resource_usage::render_target, viewDesc, &view);
+    reshade::invoke_addon_event<reshade::addon_event::init_resource_view>(_device.get(), res, resource_usage::render_target, viewDesc, view);
+
+    return view;
+}
+
+resource AddonHost::CreateConstantBuffer(uint64_t size)
+{
+    const resource_desc desc(size, memory_heap::cpu_to_gpu, resource_usage::constant_buffer);
+    resource res;
+    _device->create_resource(desc, nullptr, resource_usage::constant_buffer, &res);
+    reshade::invoke_addon_event<reshade::addon_event::init_resource>(_device.get(), desc, nullptr, resource_usage::constant_buffer, res);
+
+    return res;
+}
+
+void AddonHost::AddRenderTarget(resource_view view, resource resource, uint32_t width, uint32_t height, format format)
+{
+    const resource_desc desc(width, height, 1, 1, format, 1, memory_heap::gpu_only, resource_usage::render_target | resource_usage::shader_resource);
+    if (_device->AddResource(resource, desc))
+    {
+        reshade::invoke_addon_event<reshade::addon_event::init_resource>(_device.get(), desc, nullptr, resource_usage::render_target, resource);
+    }
+
+    const resource_view_desc viewDesc(format);
+    if (_device->AddView(view, resource, viewDesc))
+    {
+        reshade::invoke_addon_event<reshade::addon_event::init_resource_view>(_device.get(), resource, resource_usage::render_target, viewDesc, view);
+    }
+}
+
+void AddonHost::AddConstantBuffer(resource resource, uint64_t size)
+{
+    const resource_desc desc(size, memory_heap::cpu_to_gpu, resource_usage::constant_buffer);
+    if (_device->AddResource(resource, desc))
+    {
+        reshade::invoke_addon_event<reshade::addon_event::init_resource>(_device.get(), desc, nullptr, resource_usage::constant_buffer, resource);
+    }
+}
+
+void AddonHost::BeginCommandList(StubCommandList& cmd_list)
+{
+    reshade::invoke_addon_event<reshade::addon_event::reset_command_list>(&cmd_list);
+}
+
+void AddonHost::EndCommandList(StubCommandList& cmd_list)
+{
+    reshade::invoke_addon_event<reshade::addon_event::close_command_list>(&cmd_list);
+}
+
+void AddonHost::Present()
+{
+    reshade::invoke_addon_event<reshade::addon_event::present>(static_cast<command_queue*>(_queue.get()), static_cast<swapchain*>(_runtime.get()),
+        nullptr, nullptr, 0u, nullptr);
+    reshade::invoke_addon_event<reshade::addon_event::reshade_present>(static_cast<effect_runtime*>(_runtime.get()));
+}
+
+vector<uint8_t> AddonHost::ShaderCodeForHash(uint32_t hash)
+{
+    static const auto table = [] {
+        array<uint32_t, 256> t = {};
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    // The table's top bytes are unique, so each step of the CRC can be undone from the state it leaves. Walking back four
+    // steps from the final state gives the state after the first byte's lookup, XOR with the initial one leaves the bytes.
+    uint32_t state = ~hash;
+    for (int i = 0; i < 4; i++)
+    {
+        const uint32_t index = static_cast<uint32_t>(find_if(table.begin(), table.end(), [state](uint32_t t) { return (t >> 24) == (state >> 24); }) - table.begin());
+        state = ((state ^ table[index]) << 8) | index;
+    }
+    state ^= 0xFFFFFFFFu;
+
+    return { static_cast<uint8_t>(state), static_cast<uint8_t>(state >> 8), static_cast<uint8_t>(state >> 16), static_cast<uint8_t>(state >> 24) };
+}
+
+vector<string> AddonHost::ConfigTechniques(const filesystem::path& configFile)
+{
+    vector<string> techniques;
+
+    CDataFile file;
+    if (!file.Load(configFile.string()))
+    {
+        return techniques;
+    }
+
+    const int groups = file.GetInt("AmountGroups", "General");
+    for (int i = 0; i < groups; i++)
+    {
+        stringstream ss(file.GetString("Techniques", "Group" + to_string(i)));
+        string name;
+        while (getline(ss, name, ','))
+        {
+            if (!name.empty() && find(techniques.begin(), techniques.end(), name) == techniques.end())
+            {
+                techniques.push_back(name);
+            }
+        }
+    }
+
+    return techniques;
+}
@@ -0,0 +1,369 @@
+// Hosts the addon outside of a game. Stand-ins for ReShade's device, command lists, queue and effect runtime answer what the
+// addon asks and count the calls which would cost real work in a game; AddonHost loads the addon through its DllMain and
+// raises the events ReShade would, so the harnesses drive the same handlers a game does.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <d3d11.h>
+#include <reshade.hpp>
+
+namespace Bench
+{
+    /// <summary>
+    /// Calls the addon made on the stub API objects
+    /// </summary>
+    struct Counters
+    {
+        std::atomic_uint64_t techniquesRendered = 0;    // render_technique
+        std::atomic_uint64_t effectBatches = 0;         // render_effects, issued once per batch of techniques
+        std::atomic_uint64_t stateRebinds = 0;          // bind_* calls restoring the game's state after effects
+        std::atomic_uint64_t copies = 0;                // copy_resource
+        std::atomic_uint64_t clears = 0;                // clear_render_target_view
+        std::atomic_uint64_t bindingUpdates = 0;        // update_texture_bindings
+        std::atomic_uint64_t uniformWrites = 0;         // set_uniform_value_*
+
+        void Reset();
+    };
+
+    /// <summary>
+    /// What ReShade keeps per API object for addons, keyed by the private data key's address
+    /// </summary>
+    class PrivateData
+    {
+    public:
+        bool Get(const uint8_t guid[16], uint64_t* data) const;
+        void Set(const uint8_t guid[16], uint64_t data);
+
+    private:
+        std::vector<std::pair<const uint8_t*, uint64_t>> _entries;
+    };
+
+    class StubDevice final : public reshade::api::device
+    {
+    public:
+        StubDevice(reshade::api::device_api api, Counters& counters) : _api(api), _counters(counters) {}
+
+        bool get_private_data(const uint8_t guid[16], uint64_t* data) const override { return _privateData.Get(guid, data); }
+        void set_private_data(const uint8_t guid[16], const uint64_t data) override { _privateData.Set(guid, data); }
+        uint64_t get_native() const override { return 0; }
+
+        reshade::api::device_api get_api() const override { return _api; }
+
+        bool create_resource(const reshade::api::resource_desc& desc, const reshade::api::subresource_data* initial_data, reshade::api::resource_usage initial_state, reshade::api::resource* out_handle, void** shared_handle = nullptr) override;
+        void destroy_resource(reshade::api::resource handle) override;
+        reshade::api::resource_desc get_resource_desc(reshade::api::resource resource) const override;
+
+        bool create_resource_view(reshade::api::resource resource, reshade::api::resource_usage usage_type, const reshade::api::resource_view_desc& desc, reshade::api::resource_view* out_handle) override;
+        void destroy_resource_view(reshade::api::resource_view handle) override;
+        reshade::api::resource get_resource_from_view(reshade::api::resource_view view) const override;
+        reshade::api::resource_view_desc get_resource_view_desc(reshade::api::resource_view view) const override;
+
+        bool map_buffer_region(reshade::api::resource resource, uint64_t offset, uint64_t size, reshade::api::map_access access, void** out_data) override;
+        void unmap_buffer_region(reshade::api::resource resource) override {}
+
+        /// <summary>
+        /// Adds a resource or view under a handle the caller picked, replays keep the recorded ones. Returns false if the handle
+        /// is taken already.
+        /// </summary>
+        bool AddResource(reshade::api::resource handle, const reshade::api::resource_desc& desc);
+        bool AddView(reshade::api::resource_view handle, reshade::api::resource resource, const reshade::api::resource_view_desc& desc);
+
+        /// <summary>
+        /// Copies a buffer's contents, for copy_resource. Does nothing for textures, which don't keep any.
+        /// </summary>
+        void CopyBuffer(reshade::api::resource source, reshade::api::resource dest);
+
+        Counters& Stats() { return _counters; }
+
+    private:
+        struct Resource
+        {
+            reshade::api::resource_desc desc;
+            std::vector<uint8_t> data;
+        };
+
+        // Handles this device hands out start high above those games use, so they don't collide with recorded ones
+        static constexpr uint64_t FIRST_HANDLE = 0xB000000000000000ull;
+
+        const reshade::api::device_api _api;
+        Counters& _counters;
+        PrivateData _privateData;
+
+        mutable std::shared_mutex _mutex;
+        uint64_t _nextHandle = FIRST_HANDLE;
+        std::unordered_map<uint64_t, Resource> _resources;
+        std::unordered_map<uint64_t, std::pair<reshade::api::resource, reshade::api::resource_view_desc>> _views;
+    };
+
+    class StubCommandList final : public reshade::api::command_list
+    {
+    public:
+        StubCommandList(StubDevice& device, bool deferred) : _device(device), _context(deferred) {}
+
+        bool get_private_data(const uint8_t guid[16], uint64_t* data) const override { return _privateData.Get(guid, data); }
+        void set_private_data(const uint8_t guid[16], const uint64_t data) override { _privateData.Set(guid, data); }
+        uint64_t get_native() const override { return reinterpret_cast<uintptr_t>(static_cast<const ID3D11DeviceContext*>(&_context)); }
+
+        reshade::api::device* get_device() override { return &_device; }
+
+        void bind_pipeline(reshade::api::pipeline_stage, reshade::api::pipeline) override { _device.Stats().stateRebinds++; }
+        void bind_pipeline_states(uint32_t, const reshade::api::dynamic_state*, const uint32_t*) override { _device.Stats().stateRebinds++; }
+        void bind_viewports(uint32_t, uint32_t, const reshade::api::viewport*) override { _device.Stats().stateRebinds++; }
+        void bind_scissor_rects(uint32_t, uint32_t, const reshade::api::rect*) override { _device.Stats().stateRebinds++; }
+        void bind_descriptor_tables(reshade::api::shader_stage, reshade::api::pipeline_layout, uint32_t, uint32_t, const reshade::api::descriptor_table*) override { _device.Stats().stateRebinds++; }
+        void bind_render_targets_and_depth_stencil(uint32_t, const reshade::api::resource_view*, reshade::api::resource_view = { 0 }) override { _device.Stats().stateRebinds++; }
+
+        void copy_resource(reshade::api::resource source, reshade::api::resource dest) override;
+        void clear_render_target_view(reshade::api::resource_view, const float[4], uint32_t = 0, const reshade::api::rect* = nullptr) override { _device.Stats().clears++; }
+
+    private:
+        // What get_native answers on D3D11, where the addon asks the context whether it's deferred
+        class Context final : public ID3D11DeviceContext
+        {
+        public:
+            explicit Context(bool deferred) : _type(deferred ? D3D11_DEVICE_CONTEXT_DEFERRED : D3D11_DEVICE_CONTEXT_IMMEDIATE) {}
+
+            D3D11_DEVICE_CONTEXT_TYPE GetType() override { return _type; }
+            HRESULT Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) override { return -1; }
+            void Unmap(ID3D11Resource*, UINT) override {}
+
+        private:
+            const D3D11_DEVICE_CONTEXT_TYPE _type;
+        };
+
+        StubDevice& _device;
+        Context _context;
+        PrivateData _privateData;
+    };
+
+    class StubQueue final : public reshade::api::command_queue
+    {
+    public:
+        explicit StubQueue(StubDevice& device) : _device(device), _immediate(device, false) {}
+
+        bool get_private_data(const uint8_t guid[16], uint64_t* data) const override { return _privateData.Get(guid, data); }
+        void set_private_data(const uint8_t guid[16], const uint64_t data) override { _privateData.Set(guid, data); }
+        uint64_t get_native() const override { return 0; }
+
+        reshade::api::device* get_device() override { return &_device; }
+
+        reshade::api::command_list* get_immediate_command_list() override { return &_immediate; }
+        void flush_immediate_command_list() const override {}
+        void wait_idle() const override {}
+
+        StubCommandList& ImmediateCommandList() { return _immediate; }
+
+    private:
+        StubDevice& _device;
+        StubCommandList _immediate;
+        PrivateData _privateData;
+    };
+
+    /// <summary>
+    /// A uniform variable of the stub effects, annotated with the source the addon's constant handler looks for
+    /// </summary>
+    struct UniformDesc
+    {
+        std::string source;
+        reshade::api::format type = reshade::api::format::r32_float;
+        uint32_t rows = 1;
+        uint32_t columns = 1;
+        uint32_t arrayLength = 0;
+    };
+
+    class StubRuntime final : public reshade::api::effect_runtime
+    {
+    public:
+        StubRuntime(StubDevice& device, StubQueue& queue, uint32_t width, uint32_t height);
+
+        bool get_private_data(const uint8_t guid[16], uint64_t* data) const override { return _privateData.Get(guid, data); }
+        void set_private_data(const uint8_t guid[16], const uint64_t data) override { _privateData.Set(guid, data); }
+        uint64_t get_native() const override { return 0; }
+
+        reshade::api::device* get_device() override { return &_device; }
+
+        void* get_hwnd() const override { return nullptr; }
+        reshade::api::resource get_back_buffer(uint32_t index) override { return _backBuffers[index]; }
+        uint32_t get_back_buffer_count() const override { return static_cast<uint32_t>(_backBuffers.size()); }
+        uint32_t get_current_back_buffer_index() const override { return _backBufferIndex; }
+
+        reshade::api::command_queue* get_command_queue() override { return &_queue; }
+
+        void render_effects(reshade::api::command_list*, reshade::api::resource_view, reshade::api::resource_view = { 0 }) override { _device.Stats().effectBatches++; }
+        void render_technique(reshade::api::effect_technique, reshade::api::command_list*, reshade::api::resource_view, reshade::api::resource_view = { 0 }) override { _device.Stats().techniquesRendered++; }
+
+        bool get_effects_state() const override { return true; }
+        void set_effects_state(bool) override {}
+
+        void get_screenshot_width_and_height(uint32_t* out_width, uint32_t* out_height) const override;
+
+        bool is_key_down(uint32_t) const override { return false; }
+        bool is_key_pressed(uint32_t) const override { return false; }
+
+        void enumerate_uniform_variables(const char* effect_name, void(*callback)(effect_runtime* runtime, reshade::api::effect_uniform_variable variable, void* user_data), void* user_data) override;
+        void get_uniform_variable_type(reshade::api::effect_uniform_variable variable, reshade::api::format* out_base_type, uint32_t* out_rows = nullptr, uint32_t* out_columns = nullptr, uint32_t* out_array_length = nullptr) const override;
+        bool get_annotation_string_from_uniform_variable(reshade::api::effect_uniform_variable variable, const char* name, char* value, size_t* length) const override;
+
+        void get_uniform_value_float(reshade::api::effect_uniform_variable variable, float* values, size_t count, size_t array_index = 0) const override { GetUniform(variable, values, count, array_index); }
+        void get_uniform_value_int(reshade::api::effect_uniform_variable variable, int32_t* values, size_t count, size_t array_index = 0) const override { GetUniform(variable, values, count, array_index); }
+        void get_uniform_value_uint(reshade::api::effect_uniform_variable variable, uint32_t* values, size_t count, size_t array_index = 0) const override { GetUniform(variable, values, count, array_index); }
+        void set_uniform_value_float(reshade::api::effect_uniform_variable variable, const float* values, size_t count, size_t array_index = 0) override { SetUniform(variable, values, count, array_index); }
+        void set_uniform_value_int(reshade::api::effect_uniform_variable variable, const int32_t* values, size_t count, size_t array_index = 0) override { SetUniform(variable, values, count, array_index); }
+        void set_uniform_value_uint(reshade::api::effect_uniform_variable variable, const uint32_t* values, size_t count, size_t array_index = 0) override { SetUniform(variable, values, count, array_index); }
+
+        void update_texture_bindings(const char*, reshade::api::resource_view, reshade::api::resource_view = { 0 }) override { _device.Stats().bindingUpdates++; }
+
+        void enumerate_techniques(const char* effect_name, void(*callback)(effect_runtime* runtime, reshade::api::effect_technique technique, void* user_data), void* user_data) override;
+        void get_technique_name(reshade::api::effect_technique technique, char* value, size_t* length) const override;
+        bool get_technique_state(reshade::api::effect_technique technique) const override { return _techniques[technique.handle - 1].enabled; }
+        void set_technique_state(reshade::api::effect_technique technique, bool enabled) override { _techniques[technique.handle - 1].enabled = enabled; }
+
+        void SetTechniques(const std::vector<std::string>& names);
+        void SetUniforms(const std::vector<UniformDesc>& uniforms);
+
+    private:
+        struct Technique
+        {
+            std::string name;
+            bool enabled = true;
+        };
+
+        struct Uniform
+        {
+            UniformDesc desc;
+            std::vector<uint32_t> values;
+        };
+
+        template<typename T>
+        void GetUniform(reshade::api::effect_uniform_variable variable, T* values, size_t count, size_t array_index) const;
+        template<typename T>
+        void SetUniform(reshade::api::effect_uniform_variable variable, const T* values, size_t count, size_t array_index);
+
+        StubDevice& _device;
+        StubQueue& _queue;
+        PrivateData _privateData;
+        const uint32_t _width;
+        const uint32_t _height;
+        std::vector<reshade::api::resource> _backBuffers;
+        uint32_t _backBufferIndex = 0;
+        std::vector<Technique> _techniques;
+        std::vector<Uniform> _uniforms;
+    };
+
+    /// <summary>
+    /// A toggle group of a generated config
+    /// </summary>
+    struct GroupDesc
+    {
+        std::string name;
+        std::vector<uint32_t> pixelShaders;
+        std::vector<uint32_t> vertexShaders;
+        std::vector<std::string> techniques;
+        uint32_t invocationLocation = 0;
+        bool active = true;
+        bool extractConstants = false;
+        uint32_t constantSlot = 0;
+        std::vector<std::pair<std::string, uint32_t>> constants;    // uniform source and its offset in the constant buffer
+    };
+
+    struct AddonConfig
+    {
+        std::vector<GroupDesc> groups;
+        std::string constantCopy = "gpu_readback";
+
+        /// <summary>
+        /// Writes the config the way the addon reads it, with a key per shader hash
+        /// </summary>
+        bool Write(const std::filesystem::path& path) const;
+    };
+
+    class AddonHost
+    {
+    public:
+        static constexpr uint32_t WIDTH = 1920;
+        static constexpr uint32_t HEIGHT = 1080;
+
+        AddonHost() = default;
+        AddonHost(const AddonHost&) = delete;
+        AddonHost& operator=(const AddonHost&) = delete;
+        ~AddonHost();
+
+        /// <summary>
+        /// Puts the config into a fresh directory next to a pretend addon module, loads the addon through its DllMain and brings
+        /// up a device, queue and effect runtime with the given techniques the way ReShade does. Ends with one present, which
+        /// subscribes the draw events. The addon keeps its state in statics, so a process loads it once.
+        /// </summary>
+        bool Load(const AddonConfig& config, reshade::api::device_api api, const std::vector<std::string>& techniques, const std::vector<UniformDesc>& uniforms = {});
+        bool Load(const std::filesystem::path& configFile, reshade::api::device_api api, const std::vector<std::string>& techniques, const std::vector<UniformDesc>& uniforms = {});
+
+        /// <summary>
+        /// Destroys everything in the order ReShade does and unloads the addon
+        /// </summary>
+        void Unload();
+
+        StubDevice& Device() { return *_device; }
+        StubQueue& Queue() { return *_queue; }
+        StubRuntime& Runtime() { return *_runtime; }
+        Counters& Stats() { return _counters; }
+
+        /// <summary>
+        /// Creates a command list, deferred ones record on other threads than the one presenting
+        /// </summary>
+        StubCommandList& CreateCommandList(bool deferred);
+
+        /// <summary>
+        /// Creates a pipeline with shaders which hash to the given values, 0 leaves the stage out
+        /// </summary>
+        void CreatePipeline(reshade::api::pipeline pipeline, uint32_t pixelShaderHash, uint32_t vertexShaderHash);
+
+        /// <summary>
+        /// Creates a render target of the runtime's size and returns its view
+        /// </summary>
+        reshade::api::resource_view CreateRenderTarget(reshade::api::format format = reshade::api::format::r8g8b8a8_unorm);
+
+        reshade::api::resource CreateConstantBuffer(uint64_t size);
+
+        /// <summary>
+        /// Same as the above, under handles a capture recorded. Handles seen before are left alone.
+        /// </summary>
+        void AddRenderTarget(reshade::api::resource_view view, reshade::api::resource resource, uint32_t width, uint32_t height, reshade::api::format format);
+        void AddConstantBuffer(reshade::api::resource resource, uint64_t size);
+
+        void BeginCommandList(StubCommandList& cmd_list);
+        void EndCommandList(StubCommandList& cmd_list);
+
+        /// <summary>
+        /// Ends the frame, with the present event followed by ReShade's own
+        /// </summary>
+        void Present();
+
+        /// <summary>
+        /// Shader code of four bytes whose CRC32, the addon's shader hash, is the given value
+        /// </summary>
+        static std::vector<uint8_t> ShaderCodeForHash(uint32_t hash);
+
+        /// <summary>
+        /// The techniques the groups of a config ask for, in order and without duplicates
+        /// </summary>
+        static std::vector<std::string> ConfigTechniques(const std::filesystem::path& configFile);
+
+    private:
+        bool Start(reshade::api::device_api api, const std::vector<std::string>& techniques, const std::vector<UniformDesc>& uniforms);
+
+        std::filesystem::path _directory;
+        bool _loaded = false;
+        Counters _counters;
+        std::unique_ptr<StubDevice> _device;
+        std::unique_ptr<StubQueue> _queue;
+        std::unique_ptr<StubRuntime> _runtime;
+        std::vector<std::unique_ptr<StubCommandList>> _commandLists;
+    };
+}
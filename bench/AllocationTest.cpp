@@ -0,0 +1,196 @@
+// Counts the heap allocations the addon makes on synthetic frames once it's warmed up. Every global operator new is replaced
+// by one which counts while a frame is measured, so anything on the bind_pipeline and draw path allocating per call, such as
+// the shader hash and group lookups or the per command list queues missing their pool, shows up as a count above zero.
+//
+//   allocation_test [--draws <n>] [--threads <n>] [--warmup <n>] [--frames <n>] [--api d3d11|d3d12|vulkan]
+//
+// Recording threads record their command lists concurrently and the frame is presented once they're done, presents included in
+// the count. Warm-up frames fill the pools and scratch lists first, starting with a frame per thread recorded by that thread
+// alone: a technique is only queued by lists drawing before another list rendered it, so racing threads could leave a list's
+// pool untouched for any number of frames. Exits with 1 if a measured frame allocates, or renders none of the techniques.
+
+#include <atomic>
+#include <barrier>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+#include "SyntheticWorkload.h"
+
+using namespace Bench;
+using namespace reshade::api;
+using namespace std;
+
+static atomic_bool g_counting = false;
+static atomic_uint64_t g_allocations = 0;
+static atomic_uint64_t g_bytes = 0;
+
+static void* Allocate(size_t size, size_t alignment, bool nothrow)
+{
+    if (g_counting.load(memory_order_relaxed))
+    {
+        g_allocations.fetch_add(1, memory_order_relaxed);
+        g_bytes.fetch_add(size, memory_order_relaxed);
+    }
+
+    size = size == 0 ? 1 : size;
+    void* memory = alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? malloc(size) : aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (memory == nullptr && !nothrow)
+    {
+        throw bad_alloc();
+    }
+
+    return memory;
+}
+
+void* operator new(size_t size) { return Allocate(size, 0, false); }
+void* operator new[](size_t size) { return Allocate(size, 0, false); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return Allocate(size, 0, true); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return Allocate(size, 0, true); }
+void* operator new(size_t size, align_val_t alignment) { return Allocate(size, static_cast<size_t>(alignment), false); }
+void* operator new[](size_t size, align_val_t alignment) { return Allocate(size, static_cast<size_t>(alignment), false); }
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept { return Allocate(size, static_cast<size_t>(alignment), true); }
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept { return Allocate(size, static_cast<size_t>(alignment), true); }
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, align_val_t) noexcept { free(memory); }
+void operator delete[](void* memory, align_val_t) noexcept { free(memory); }
+void operator delete(void* memory, size_t, align_val_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t, align_val_t) noexcept { free(memory); }
+
+static bool ParseApi(const char* name, device_api& api)
+{
+    if (strcmp(name, "d3d11") == 0)
+        api = device_api::d3d11;
+    else if (strcmp(name, "d3d12") == 0)
+        api = device_api::d3d12;
+    else if (strcmp(name, "vulkan") == 0)
+        api = device_api::vulkan;
+    else
+        return false;
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t draws = 4000;
+    uint32_t threads = 2;
+    uint32_t warmup = 4;
+    uint32_t frames = 8;
+    const char* apiName = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--draws") == 0)
+            draws = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--threads") == 0)
+            threads = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--warmup") == 0)
+            warmup = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--frames") == 0)
+            frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--api") == 0)
+            apiName = argv[i + 1];
+    }
+
+    threads = max(threads, 1u);
+    draws = max(draws, threads);
+    frames = max(frames, 1u);
+
+    device_api api = device_api::d3d12;
+    if (apiName != nullptr && !ParseApi(apiName, api))
+    {
+        printf("FAIL unknown API \"%s\"\n", apiName);
+        return 1;
+    }
+
+    WorkloadParams params;
+    SyntheticWorkload workload(params);
+    AddonHost host;
+    if (!host.Load(workload.Config(), api, workload.Techniques()))
+    {
+        printf("FAIL could not load the addon\n");
+        return 1;
+    }
+    workload.Create(host, threads);
+
+    printf("%u pipelines, %u groups of %u hashes, %u techniques, %u threads drawing %u, %u warm-up and %u measured frames, api 0x%x\n",
+        params.pipelines, params.groups, params.hashes, params.techniques, threads, draws, warmup, frames, static_cast<uint32_t>(api));
+
+    // The presenting thread turns counting on before releasing the recording threads and off once the frame is presented, so
+    // the threads' own waiting is all that's counted besides the addon
+    const uint32_t solo = threads;
+    const uint32_t total = solo + warmup + frames;
+    barrier sync(threads + 1);
+    vector<thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]() {
+            for (uint32_t frame = 0; frame < total; frame++)
+            {
+                sync.arrive_and_wait();
+                if (frame >= solo || frame == t)
+                {
+                    workload.Record(host, t, threads, frame, draws, nullptr);
+                }
+                sync.arrive_and_wait();
+            }
+            });
+    }
+
+    bool failed = false;
+    for (uint32_t frame = 0; frame < total; frame++)
+    {
+        const bool measured = frame >= solo + warmup;
+        if (frame == solo + warmup)
+        {
+            host.Stats().Reset();
+        }
+
+        const uint64_t allocations = g_allocations.load();
+        const uint64_t bytes = g_bytes.load();
+        g_counting = measured;
+        sync.arrive_and_wait();
+        sync.arrive_and_wait();
+        host.Present();
+        g_counting = false;
+
+        if (measured && g_allocations.load() != allocations)
+        {
+            printf("FAIL frame %u allocated %llu times, %llu bytes\n", frame, static_cast<unsigned long long>(g_allocations.load() - allocations),
+                static_cast<unsigned long long>(g_bytes.load() - bytes));
+            failed = true;
+        }
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    const uint64_t techniques = host.Stats().techniquesRendered.load();
+    printf("%llu allocations, %llu bytes in %u measured frames, %.2f techniques per frame\n", static_cast<unsigned long long>(g_allocations.load()),
+        static_cast<unsigned long long>(g_bytes.load()), frames, static_cast<double>(techniques) / frames);
+
+    if (techniques == 0)
+    {
+        printf("FAIL no techniques rendered\n");
+        failed = true;
+    }
+
+    host.Unload();
+
+    if (failed)
+    {
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Writes command captures in the format CommandCapture records in the game, so scripted workloads replay through the same
+// CaptureReader path as recorded ones. Header only, the harnesses build their scripts in memory.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "CaptureFormat.h"
+
+namespace Bench
+{
+    class CaptureScript
+    {
+    public:
+        explicit CaptureScript(uint32_t deviceApi) : _deviceApi(deviceApi) {}
+
+        /// <summary>
+        /// Starts a segment of the thread's stream in the given frame. Segments of a frame are replayed one thread after the
+        /// other, in the order they were begun.
+        /// </summary>
+        void Begin(uint32_t threadId, uint32_t frame)
+        {
+            _threadId = threadId;
+            _payload.clear();
+            Varint(Profiling::CAPTURE_FRAME);
+            Varint(frame);
+
+            if (frame + 1 > _frameCount)
+            {
+                _frameCount = frame + 1;
+            }
+        }
+
+        void End()
+        {
+            Varint(_chunks, _threadId);
+            Varint(_chunks, _payload.size());
+            _chunks.insert(_chunks.end(), _payload.begin(), _payload.end());
+            _payload.clear();
+        }
+
+        void CommandList(uint64_t cmd_list)
+        {
+            Varint(Profiling::CAPTURE_COMMAND_LIST);
+            Varint(cmd_list);
+        }
+
+        void BindPipeline(uint32_t stages, uint64_t pipeline, uint32_t psHash, uint32_t vsHash)
+        {
+            Varint(Profiling::CAPTURE_BIND_PIPELINE);
+            Varint(stages);
+            Varint(pipeline);
+            Varint(psHash);
+            Varint(vsHash);
+        }
+
+        void BindRenderTarget(uint64_t view, uint64_t resource, uint32_t width, uint32_t height, uint32_t format)
+        {
+            Varint(Profiling::CAPTURE_BIND_RENDER_TARGETS);
+            Varint(1);
+            Varint(view);
+            Varint(resource);
+            Varint(width);
+            Varint(height);
+            Varint(format);
+            Varint(1);
+            Varint(0);
+        }
+
+        void PushConstantBuffer(uint32_t stages, uint64_t layout, uint32_t param, uint32_t binding, uint64_t buffer, uint64_t offset, uint64_t size)
+        {
+            Varint(Profiling::CAPTURE_PUSH_DESCRIPTORS);
+            Varint(stages);
+            Varint(layout);
+            Varint(param);
+            Varint(binding);
+            Varint(Profiling::CAPTURE_DESCRIPTOR_CONSTANT_BUFFER);
+            Varint(1);
+            Varint(buffer);
+            Varint(offset);
+            Varint(size);
+        }
+
+        void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+        {
+            Varint(Profiling::CAPTURE_DRAW_INDEXED);
+            Varint(indexCount);
+            Varint(instanceCount);
+            Varint(firstIndex);
+            Varint((static_cast<uint64_t>(vertexOffset) << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(vertexOffset) >> 63));
+            Varint(firstInstance);
+        }
+
+        void Present(uint64_t queue, uint64_t swapchain)
+        {
+            Varint(Profiling::CAPTURE_PRESENT);
+            Varint(queue);
+            Varint(swapchain);
+        }
+
+        /// <summary>
+        /// The capture file's contents, header included
+        /// </summary>
+        std::vector<uint8_t> Finish() const
+        {
+            Profiling::CaptureHeader header = {};
+            memcpy(header.magic, Profiling::CaptureHeader::MAGIC, sizeof(header.magic));
+            header.version = Profiling::CaptureHeader::VERSION;
+            header.deviceApi = _deviceApi;
+            header.dataSize = _chunks.size();
+            header.frameCount = _frameCount;
+
+            std::vector<uint8_t> data(sizeof(header) + _chunks.size());
+            memcpy(data.data(), &header, sizeof(header));
+            if (!_chunks.empty())
+            {
+                memcpy(data.data() + sizeof(header), _chunks.data(), _chunks.size());
+            }
+            return data;
+        }
+
+    private:
+        static void Varint(std::vector<uint8_t>& out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        void Varint(uint64_t value) { Varint(_payload, value); }
+
+        const uint32_t _deviceApi;
+        uint32_t _threadId = 0;
+        uint32_t _frameCount = 0;
+        std::vector<uint8_t> _payload;
+        std::vector<uint8_t> _chunks;
+    };
+}
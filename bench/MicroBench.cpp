@@ -0,0 +1,610 @@
+// Times the kernels of the addon's hot paths one at a time, each at a few scales, so a regression shows up in the component
+// it's in without a full replay.
+//
+//   micro_bench [--runs <n>] [--only <name>] [--scales <n,...>]
+//
+// Each row is the best of --runs timings of a batch of calls, per call and per item of the scale: bytes hashed, groups
+// matched, variables applied, keys written or read. --only runs the kernels whose name contains the text, --scales replaces
+// their default scales. The kernels run on the addon's own classes, set up directly against the stub device, command list
+// and effect runtime without loading the addon. Exits with 1 if a kernel doesn't give the result it's set up for.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "AddonHost.h"
+#include "AddonUIData.h"
+#include "CDataFile.h"
+#include "ConstantCopyMemcpyNested.h"
+#include "ConstantHandlerBase.h"
+#include "PipelineStateTracker.h"
+#include "RenderingManager.h"
+#include "ShaderManager.h"
+#include "crc32_hash.hpp"
+
+using namespace AddonImGui;
+using namespace Bench;
+using namespace Rendering;
+using namespace ShaderToggler;
+using namespace Shim::Constants;
+using namespace StateTracker;
+using namespace reshade::api;
+using namespace std;
+
+struct Random
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    uint64_t Next()
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+struct Options
+{
+    uint32_t runs = 5;
+    const char* only = nullptr;
+    vector<uint32_t> scales;
+};
+
+// Keeps results alive so the timed calls aren't optimized away
+static volatile uint64_t g_sink;
+
+template<typename F>
+static double TimeBest(uint32_t runs, F&& f)
+{
+    double best = 1e300;
+    for (uint32_t i = 0; i < runs; i++)
+    {
+        const auto start = chrono::steady_clock::now();
+        f();
+        const auto end = chrono::steady_clock::now();
+        best = std::min(best, chrono::duration<double, milli>(end - start).count());
+    }
+
+    return best;
+}
+
+static bool Selected(const Options& options, const char* kernel)
+{
+    return options.only == nullptr || strstr(kernel, options.only) != nullptr;
+}
+
+static vector<uint32_t> Scales(const Options& options, const vector<uint32_t>& defaults)
+{
+    return options.scales.empty() ? defaults : options.scales;
+}
+
+// Per item costs are left out for lookups, which shouldn't grow with the scale
+static void Report(const char* kernel, uint32_t scale, const char* unit, double ms, uint64_t calls, bool perItem = true)
+{
+    const double perCall = ms * 1e6 / calls;
+    if (perItem)
+        printf("%-34s %8u %-10s %12.1f ns %12.2f ns/item\n", kernel, scale, unit, perCall, perCall / scale);
+    else
+        printf("%-34s %8u %-10s %12.1f ns\n", kernel, scale, unit, perCall);
+}
+
+static vector<uint32_t> ParseList(const char* text)
+{
+    vector<uint32_t> values;
+    for (const char* p = text; *p != '\0';)
+    {
+        char* end;
+        const uint32_t value = static_cast<uint32_t>(strtoul(p, &end, 10));
+        if (end == p)
+        {
+            break;
+        }
+
+        if (value > 0)
+        {
+            values.push_back(value);
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+
+    return values;
+}
+
+// Shader code hashing at init_pipeline, by code size
+static bool BenchCrc32(const Options& options)
+{
+    bool ok = true;
+    Random random;
+
+    for (uint32_t size : Scales(options, { 64, 1024, 16384, 262144 }))
+    {
+        vector<uint8_t> code(size);
+        for (auto& byte : code)
+        {
+            byte = static_cast<uint8_t>(random.Next());
+        }
+
+        const uint64_t calls = max<uint64_t>(16ull * 1024 * 1024 / size, 1);
+        const double ms = TimeBest(options.runs, [&]() {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                sum += compute_crc32(code.data(), code.size());
+            }
+            g_sink = sum;
+            });
+
+        Report("compute_crc32", size, "bytes", ms, calls);
+    }
+
+    const uint32_t hash = static_cast<uint32_t>(random.Next());
+    const vector<uint8_t> forged = AddonHost::ShaderCodeForHash(hash);
+    if (compute_crc32(forged.data(), forged.size()) != hash)
+    {
+        printf("FAIL compute_crc32 doesn't hash forged shader code to %08X\n", hash);
+        ok = false;
+    }
+
+    return ok;
+}
+
+// Pipeline to shader hash lookup at every bind_pipeline, by pipelines known
+static bool BenchShaderHash(const Options& options)
+{
+    bool ok = true;
+
+    for (uint32_t pipelines : Scales(options, { 1000, 10000, 100000 }))
+    {
+        Random random;
+        ShaderManager manager;
+        vector<uint32_t> hashes(pipelines);
+        for (uint32_t i = 0; i < pipelines; i++)
+        {
+            hashes[i] = static_cast<uint32_t>(random.Next()) | 1;
+            manager.addHashHandlePair(hashes[i], 0x10000 + i);
+        }
+
+        vector<uint32_t> order(4096);
+        for (auto& index : order)
+        {
+            index = static_cast<uint32_t>(random.Next() % pipelines);
+        }
+
+        const uint64_t calls = 1 << 20;
+        const double ms = TimeBest(options.runs, [&]() {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                sum += manager.safeGetShaderHash(0x10000 + order[i & 4095]);
+            }
+            g_sink = sum;
+            });
+
+        Report("safeGetShaderHash", pipelines, "pipelines", ms, calls, false);
+
+        if (manager.safeGetShaderHash(0x10000 + order[0]) != hashes[order[0]] || manager.safeGetShaderHash(0x10000 + pipelines) != 0)
+        {
+            printf("FAIL safeGetShaderHash with %u pipelines answers the wrong hash\n", pipelines);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+// Shader hash to group lookup at every bind_pipeline, by hashes in groups of 100. Most shaders a game binds are in no group,
+// so three of four lookups miss.
+static bool BenchGroupLookup(const Options& options)
+{
+    bool ok = true;
+
+    for (uint32_t hashes : Scales(options, { 100, 1000, 10000, 100000 }))
+    {
+        Random random;
+        ShaderManager pixelShaders;
+        ShaderManager vertexShaders;
+        atomic_uint32_t frameCounter = 0;
+        vector<string> techniques;
+        AddonUIData uiData(&pixelShaders, &vertexShaders, nullptr, &frameCounter, &techniques);
+
+        vector<uint32_t> grouped;
+        for (uint32_t g = 0; g * 100 < hashes; g++)
+        {
+            unordered_set<uint32_t> groupHashes;
+            for (uint32_t h = g * 100; h < min(hashes, g * 100 + 100); h++)
+            {
+                const uint32_t hash = static_cast<uint32_t>(random.Next()) | 1;
+                groupHashes.insert(hash);
+                grouped.push_back(hash);
+            }
+
+            const int id = ToggleGroup::getNewGroupId();
+            ToggleGroup& group = uiData.GetToggleGroups().emplace(id, ToggleGroup("Group" + to_string(g), id)).first->second;
+            group.storeCollectedHashes(groupHashes, {});
+        }
+        uiData.UpdateToggleGroupsForShaderHashes();
+
+        vector<uint32_t> lookups(4096);
+        for (auto& hash : lookups)
+        {
+            hash = random.Next() % 4 == 0 ? grouped[random.Next() % grouped.size()] : static_cast<uint32_t>(random.Next()) & ~1u;
+        }
+
+        const uint64_t calls = 1 << 20;
+        const double ms = TimeBest(options.runs, [&]() {
+            uint64_t found = 0;
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                found += uiData.GetToggleGroupsForPixelShaderHash(lookups[i & 4095]) != nullptr;
+            }
+            g_sink = found;
+            });
+
+        Report("GetToggleGroupsForPixelShaderHash", hashes, "hashes", ms, calls, false);
+
+        if (uiData.GetToggleGroupsForPixelShaderHash(grouped.back()) == nullptr)
+        {
+            printf("FAIL GetToggleGroupsForPixelShaderHash with %u hashes doesn't find a grouped hash\n", hashes);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+// Queueing a bound shader's groups and their techniques, by groups matching the shader. The techniques are queued by the
+// first call, later calls find them queued as they would until the draw renders them.
+static bool BenchCheckCall(const Options& options)
+{
+    bool ok = true;
+    const uint32_t hash = 0x1234;
+    const uint32_t techniqueCount = 8;
+
+    for (uint32_t groups : Scales(options, { 1, 4, 16, 64 }))
+    {
+        ShaderManager pixelShaders;
+        ShaderManager vertexShaders;
+        atomic_uint32_t frameCounter = 0;
+        vector<string> techniques;
+        AddonUIData uiData(&pixelShaders, &vertexShaders, nullptr, &frameCounter, &techniques);
+        ResourceManager resourceManager;
+        RenderingManager renderingManager(uiData, resourceManager);
+
+        DeviceDataContainer deviceData;
+        for (uint32_t t = 0; t < techniqueCount; t++)
+        {
+            techniques.push_back("Effect" + to_string(t));
+            deviceData.allEnabledTechniques.emplace(techniques.back(), false);
+        }
+
+        for (uint32_t g = 0; g < groups; g++)
+        {
+            const int id = ToggleGroup::getNewGroupId();
+            ToggleGroup& group = uiData.GetToggleGroups().emplace(id, ToggleGroup("Group" + to_string(g), id)).first->second;
+            group.storeCollectedHashes({ hash }, {});
+            group.setAllowAllTechniques(false);
+            group.setPreferredTechniques({ techniques[g % techniqueCount] });
+            group.toggleActive();
+        }
+        uiData.UpdateToggleGroupsForShaderHashes();
+
+        CommandListDataContainer commandListData;
+        commandListData.ps.id = 1;
+        commandListData.ps.activeShaderHash = hash;
+        commandListData.ps.blockedShaderGroups = uiData.GetToggleGroupsForPixelShaderHash(hash);
+
+        const uint64_t calls = 1 << 18;
+        const double ms = TimeBest(options.runs, [&]() {
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                renderingManager._CheckCallForCommandList(commandListData.ps, commandListData, deviceData);
+            }
+            g_sink = commandListData.commandQueue;
+            });
+
+        Report("_CheckCallForCommandList", groups, "groups", ms, calls);
+
+        if (commandListData.ps.techniquesToRender.size() != min(groups, techniqueCount))
+        {
+            printf("FAIL _CheckCallForCommandList with %u groups queued %zu techniques\n", groups, commandListData.ps.techniquesToRender.size());
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+// Restoring the game's D3D12 state after effects rendered, by descriptor tables bound. Every eighth is transient, splitting
+// the tables into runs bound with a call each.
+static bool BenchReApplyState(const Options& options)
+{
+    bool ok = true;
+    const pipeline_layout layout = { 0x7000 };
+
+    for (uint32_t tables : Scales(options, { 4, 16, 64 }))
+    {
+        Counters counters;
+        StubDevice device(device_api::d3d12, counters);
+        StubCommandList cmdList(device, true);
+        PipelineStateTracker tracker;
+
+        vector<descriptor_table> sets(tables);
+        unordered_map<uint64_t, vector<bool>> transientMask;
+        vector<bool>& mask = transientMask[layout.handle];
+        mask.resize(tables);
+
+        uint32_t runs = 0;
+        for (uint32_t i = 0; i < tables; i++)
+        {
+            sets[i] = descriptor_table{ 0x8000 + i };
+            mask[i] = i % 8 == 7;
+            runs += !mask[i] && (i == 0 || mask[i - 1]) ? 1 : 0;
+        }
+
+        const resource_view rtv = { 0x9000 };
+        const viewport view = { 0, 0, 1920, 1080, 0, 1 };
+        const rect scissor = { 0, 0, 1920, 1080 };
+        tracker.OnBindPipeline(&cmdList, pipeline_stage::pixel_shader | pipeline_stage::vertex_shader, pipeline{ 0x10000 });
+        tracker.OnBindRenderTargetsAndDepthStencil(&cmdList, 1, &rtv, resource_view{ 0 });
+        tracker.OnBindViewports(&cmdList, 0, 1, &view);
+        tracker.OnBindScissorRects(&cmdList, 0, 1, &scissor);
+        tracker.OnBindDescriptorSets(&cmdList, shader_stage::all_graphics, layout, 0, tables, sets.data());
+
+        const uint64_t calls = 1 << 16;
+        const double ms = TimeBest(options.runs, [&]() {
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                tracker.ReApplyState(&cmdList, transientMask);
+            }
+            });
+
+        Report("ReApplyState", tables, "tables", ms, calls);
+
+        counters.Reset();
+        tracker.ReApplyState(&cmdList, transientMask);
+        if (counters.stateRebinds != 4 + runs)
+        {
+            printf("FAIL ReApplyState with %u tables made %llu calls, expected %u\n", tables, static_cast<unsigned long long>(counters.stateRebinds.load()), 4 + runs);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+// Copying a group's extracted constants into the effect uniforms, by variables mapped. Unchanged constants are compared
+// and skipped, changed ones uploaded.
+static bool BenchApplyConstants(const Options& options)
+{
+    bool ok = true;
+
+    for (uint32_t variables : Scales(options, { 4, 32, 256 }))
+    {
+        Counters counters;
+        StubDevice device(device_api::d3d12, counters);
+        StubQueue queue(device);
+        StubRuntime runtime(device, queue, AddonHost::WIDTH, AddonHost::HEIGHT);
+        ConstantHandlerBase handler;
+
+        const int id = ToggleGroup::getNewGroupId();
+        ToggleGroup group("Constants", id);
+        vector<UniformDesc> uniforms;
+        unordered_map<string, tuple<constant_type, vector<effect_uniform_variable>>> constants;
+        for (uint32_t i = 0; i < variables; i++)
+        {
+            string name = "Var" + to_string(i);
+            uniforms.push_back({ name });
+            constants.emplace(name, make_tuple(constant_type::type_float, vector<effect_uniform_variable>{ effect_uniform_variable{ i + 1 } }));
+            group.SetVarMapping(i * sizeof(float), name, false);
+        }
+        runtime.SetUniforms(uniforms);
+
+        // A float per variable, plus a row so the last one isn't at the buffer's end
+        vector<uint32_t> buffers[2];
+        for (uint32_t b = 0; b < 2; b++)
+        {
+            buffers[b].resize(variables + 4);
+            for (uint32_t i = 0; i < variables; i++)
+            {
+                const float value = 1.0f + i + b * 0.5f;
+                memcpy(&buffers[b][i], &value, sizeof(value));
+            }
+        }
+
+        command_list* cmdList = &queue.ImmediateCommandList();
+        const uint64_t calls = 1 << 14;
+
+        handler.SetConstants(&group, buffers[0], &device, cmdList);
+        handler.ApplyConstantValues(&runtime, &group, constants);
+        if (counters.uniformWrites != variables)
+        {
+            printf("FAIL ApplyConstantValues with %u variables wrote %llu uniforms\n", variables, static_cast<unsigned long long>(counters.uniformWrites.load()));
+            ok = false;
+        }
+
+        const double same = TimeBest(options.runs, [&]() {
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                handler.ApplyConstantValues(&runtime, &group, constants);
+            }
+            });
+
+        const double changed = TimeBest(options.runs, [&]() {
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                handler.SetConstants(&group, buffers[(i + 1) & 1], &device, cmdList);
+                handler.ApplyConstantValues(&runtime, &group, constants);
+            }
+            });
+
+        Report("ApplyConstantValues unchanged", variables, "variables", same, calls);
+        Report("ApplyConstantValues changed", variables, "variables", changed, calls);
+    }
+
+    return ok;
+}
+
+// Writing and parsing the config, by keys in sections of 100 like group hash lists
+static bool BenchDataFile(const Options& options)
+{
+    bool ok = true;
+    const filesystem::path path = filesystem::temp_directory_path() / ("shadertoggler-micro-" + to_string(GetCurrentProcessId()) + ".ini");
+
+    for (uint32_t keys : Scales(options, { 1000, 10000, 100000 }))
+    {
+        CDataFile source;
+        source.SetFileName(path.string());
+        for (uint32_t i = 0; i < keys; i++)
+        {
+            source.SetUInt("ShaderHash" + to_string(i % 100), 0x9E3779B9u * (i + 1), "", "Group" + to_string(i / 100));
+        }
+
+        bool saved = true;
+        const double save = TimeBest(options.runs, [&]() { saved &= source.Save(); });
+
+        int loadedKeys = 0;
+        const double load = TimeBest(options.runs, [&]() {
+            CDataFile file;
+            file.Load(path.string());
+            loadedKeys = file.KeyCount();
+
+            // Loading leaves the file dirty, clear it so destroying it doesn't try to save
+            file.Clear();
+            });
+
+        Report("CDataFile::Save", keys, "keys", save, 1);
+        Report("CDataFile::Load", keys, "keys", load, 1);
+
+        if (!saved || static_cast<uint32_t>(loadedKeys) != keys)
+        {
+            printf("FAIL CDataFile loaded %d of %u keys saved\n", loadedKeys, keys);
+            ok = false;
+        }
+    }
+
+    error_code ec;
+    filesystem::remove(path, ec);
+    return ok;
+}
+
+// The memcpy detour's check whether a copy goes into a mapped constant buffer, by buffers mapped. Nearly every copy a game
+// makes goes elsewhere.
+static bool BenchMemcpyFilter(const Options& options)
+{
+    bool ok = true;
+    const uint64_t bufferSize = 256;
+
+    for (uint32_t buffers : Scales(options, { 1, 16, 256 }))
+    {
+        Counters counters;
+        StubDevice device(device_api::d3d11, counters);
+        ConstantCopyMemcpyNested filter;
+
+        const resource_desc desc(bufferSize, memory_heap::cpu_to_gpu, resource_usage::constant_buffer);
+        vector<resource> resources(buffers);
+        void* mapped = nullptr;
+        for (auto& res : resources)
+        {
+            device.create_resource(desc, nullptr, resource_usage::constant_buffer, &res);
+            filter.OnInitResource(&device, desc, nullptr, resource_usage::constant_buffer, res);
+            device.map_buffer_region(res, 0, bufferSize, map_access::write_discard, &mapped);
+            filter.OnMapBufferRegion(&device, res, 0, bufferSize, map_access::write_discard, &mapped);
+        }
+
+        uint8_t source[64];
+        uint8_t elsewhere[64];
+        for (uint32_t i = 0; i < sizeof(source); i++)
+        {
+            source[i] = static_cast<uint8_t>(i + 1);
+        }
+
+        const uint64_t calls = 1 << 18;
+        const double miss = TimeBest(options.runs, [&]() {
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                filter.OnMemcpy(elsewhere, source, sizeof(source));
+            }
+            });
+
+        const double hit = TimeBest(options.runs, [&]() {
+            for (uint64_t i = 0; i < calls; i++)
+            {
+                filter.OnMemcpy(mapped, source, sizeof(source));
+            }
+            });
+
+        Report("memcpy filter miss", buffers, "buffers", miss, calls);
+        Report("memcpy filter hit", buffers, "buffers", hit, calls, false);
+
+        vector<uint8_t> host(bufferSize);
+        filter.GetHostConstantBuffer(nullptr, host, bufferSize, resources.back().handle);
+        if (memcmp(host.data(), source, sizeof(source)) != 0)
+        {
+            printf("FAIL memcpy filter with %u buffers didn't copy into the mapped buffer\n", buffers);
+            ok = false;
+        }
+
+        for (const auto& res : resources)
+        {
+            filter.OnUnmapBufferRegion(&device, res);
+            filter.OnDestroyResource(&device, res);
+        }
+    }
+
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--runs") == 0)
+            options.runs = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--only") == 0)
+            options.only = argv[i + 1];
+        else if (strcmp(argv[i], "--scales") == 0)
+            options.scales = ParseList(argv[i + 1]);
+    }
+
+    options.runs = max(options.runs, 1u);
+
+    const struct
+    {
+        const char* name;
+        bool (*run)(const Options&);
+    } kernels[] = {
+        { "compute_crc32", BenchCrc32 },
+        { "safeGetShaderHash", BenchShaderHash },
+        { "GetToggleGroupsForPixelShaderHash", BenchGroupLookup },
+        { "_CheckCallForCommandList", BenchCheckCall },
+        { "ReApplyState", BenchReApplyState },
+        { "ApplyConstantValues", BenchApplyConstants },
+        { "CDataFile", BenchDataFile },
+        { "memcpy filter", BenchMemcpyFilter },
+    };
+
+    bool failed = false;
+    for (const auto& kernel : kernels)
+    {
+        if (Selected(options, kernel.name) && !kernel.run(options))
+        {
+            failed = true;
+        }
+    }
+
+    if (failed)
+    {
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,581 @@
+// Replays a command capture through the addon's handlers, loaded against the stub ReShade objects of AddonHost, and reports
+// what the addon costs per draw and per pipeline bind and what it makes the game's API do.
+//
+//   replay_harness [--capture <file>] [--config <ini>] [--loops <n>] [--frames <n>] [--draws <n>] [--api d3d11|d3d12|vulkan]
+//
+// Without --capture a scripted workload is replayed: two threads recording a command list each, with pipelines from a pool
+// bound before every draw, into a config with two effect groups and one extracting constants. Recorded captures bring the
+// pipelines' shader hashes along; without --config they replay into a single group matching every pixel shader seen.
+// Exits with 1 if the capture can't be read, a shader can't be made to hash as recorded, or the scripted workload doesn't
+// render the techniques, restore state and read back constants the config asks for.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AddonHost.h"
+#include "CaptureReader.h"
+#include "CaptureScript.h"
+#include "crc32_hash.hpp"
+
+using namespace Bench;
+using namespace Profiling;
+using namespace reshade::api;
+using namespace std;
+
+struct Random
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    uint64_t Next()
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+// Everything a replay has to create before the first frame, the capture only names it where it's used
+class CaptureInventory final : public CaptureVisitor
+{
+public:
+    struct Pipeline
+    {
+        uint32_t psHash = 0;
+        uint32_t vsHash = 0;
+    };
+
+    map<uint64_t, Pipeline> pipelines;
+    map<uint64_t, CaptureTarget> targets;
+    map<uint64_t, uint64_t> constantBuffers;    // buffer, size
+    set<uint32_t> presentThreads;
+    set<uint32_t> pixelShaders;
+
+    void OnThread(uint32_t threadId, uint32_t) override { _thread = threadId; }
+
+    void OnBindPipeline(uint32_t stages, uint64_t pipeline, uint32_t psHash, uint32_t vsHash) override
+    {
+        Pipeline& p = pipelines[pipeline];
+        if (psHash != 0)
+        {
+            p.psHash = psHash;
+            pixelShaders.insert(psHash);
+        }
+        if (vsHash != 0)
+        {
+            p.vsHash = vsHash;
+        }
+    }
+
+    void OnBindRenderTargets(const vector<CaptureTarget>& rtvs, uint64_t) override { AddTargets(rtvs); }
+    void OnBeginRenderPass(const vector<CaptureTarget>& rts, uint64_t) override { AddTargets(rts); }
+
+    void OnPushDescriptors(uint32_t, uint64_t, uint32_t, uint32_t, uint32_t type, uint32_t count, const vector<uint64_t>& descriptors) override
+    {
+        if (type != CAPTURE_DESCRIPTOR_CONSTANT_BUFFER)
+        {
+            return;
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint64_t buffer = descriptors[i * 3];
+            const uint64_t end = descriptors[i * 3 + 2] == UINT64_MAX ? descriptors[i * 3 + 1] + 256 : descriptors[i * 3 + 1] + descriptors[i * 3 + 2];
+            if (buffer != 0)
+            {
+                uint64_t& size = constantBuffers[buffer];
+                size = max(size, end);
+            }
+        }
+    }
+
+    void OnPresent(uint64_t, uint64_t) override { presentThreads.insert(_thread); }
+
+private:
+    void AddTargets(const vector<CaptureTarget>& rtvs)
+    {
+        for (const auto& target : rtvs)
+        {
+            if (target.view != 0)
+            {
+                targets.emplace(target.view, target);
+            }
+        }
+    }
+
+    uint32_t _thread = 0;
+};
+
+struct ReplayStats
+{
+    uint32_t frames = 0;
+    uint64_t draws = 0;
+    uint64_t binds = 0;
+    double drawNs = 0;
+    double bindNs = 0;
+    double presentNs = 0;
+};
+
+// Raises the events of a capture on the host's command lists, as ReShade would for the game recording them
+class CaptureReplay final : public CaptureVisitor
+{
+public:
+    CaptureReplay(AddonHost& host, const set<uint32_t>& presentThreads) : _host(host), _presentThreads(presentThreads) {}
+
+    const ReplayStats& Stats() const { return _stats; }
+
+    void OnThread(uint32_t threadId, uint32_t frame) override
+    {
+        if (_inFrame && frame != _frame)
+        {
+            EndFrame();
+        }
+
+        _inFrame = true;
+        _frame = frame;
+        _thread = threadId;
+        _cmdList = nullptr;
+    }
+
+    void OnCommandList(uint64_t handle) override
+    {
+        // D3D11 records on the presenting thread into the immediate context, everywhere else into lists of their own
+        const bool immediate = _host.Device().get_api() == device_api::d3d11 && _presentThreads.contains(_thread);
+        if (immediate)
+        {
+            _cmdList = &_host.Queue().ImmediateCommandList();
+            return;
+        }
+
+        auto it = _lists.find(handle);
+        if (it == _lists.end())
+        {
+            it = _lists.emplace(handle, &_host.CreateCommandList(true)).first;
+        }
+
+        _cmdList = it->second;
+        if (_recording.insert(_cmdList).second)
+        {
+            _host.BeginCommandList(*_cmdList);
+        }
+    }
+
+    void OnBindPipeline(uint32_t stages, uint64_t pipeline, uint32_t, uint32_t) override
+    {
+        command_list* cmd_list = List();
+        const auto start = chrono::steady_clock::now();
+        reshade::invoke_addon_event<reshade::addon_event::bind_pipeline>(cmd_list, static_cast<pipeline_stage>(stages), reshade::api::pipeline{ pipeline });
+        _stats.bindNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        _stats.binds++;
+    }
+
+    void OnBindRenderTargets(const vector<CaptureTarget>& rtvs, uint64_t dsv) override
+    {
+        Views(rtvs);
+        reshade::invoke_addon_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(List(), static_cast<uint32_t>(_views.size()), _views.data(), resource_view{ dsv });
+    }
+
+    void OnBeginRenderPass(const vector<CaptureTarget>& rts, uint64_t dsv) override
+    {
+        vector<render_pass_render_target_desc> descs(rts.size());
+        for (size_t i = 0; i < rts.size(); i++)
+        {
+            descs[i].view = resource_view{ rts[i].view };
+        }
+
+        render_pass_depth_stencil_desc ds;
+        ds.view = resource_view{ dsv };
+        reshade::invoke_addon_event<reshade::addon_event::begin_render_pass>(List(), static_cast<uint32_t>(descs.size()), descs.data(), dsv != 0 ? &ds : nullptr);
+    }
+
+    void OnPushDescriptors(uint32_t stages, uint64_t layout, uint32_t param, uint32_t binding, uint32_t type, uint32_t count, const vector<uint64_t>& descriptors) override
+    {
+        descriptor_table_update update;
+        update.binding = binding;
+        update.count = count;
+        update.type = static_cast<descriptor_type>(type);
+
+        // Flattened values line up with ReShade's descriptor structs, which are made of 64-bit handles and offsets only
+        update.descriptors = descriptors.data();
+        reshade::invoke_addon_event<reshade::addon_event::push_descriptors>(List(), static_cast<shader_stage>(stages), pipeline_layout{ layout }, param, update);
+    }
+
+    void OnPushConstants(uint32_t stages, uint64_t layout, uint32_t param, uint32_t first, const vector<uint32_t>& values) override
+    {
+        reshade::invoke_addon_event<reshade::addon_event::push_constants>(List(), static_cast<shader_stage>(stages), pipeline_layout{ layout }, param, first,
+            static_cast<uint32_t>(values.size()), values.data());
+    }
+
+    void OnDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override
+    {
+        command_list* cmd_list = List();
+        const auto start = chrono::steady_clock::now();
+        reshade::invoke_addon_event<reshade::addon_event::draw>(cmd_list, vertexCount, instanceCount, firstVertex, firstInstance);
+        _stats.drawNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        _stats.draws++;
+    }
+
+    void OnDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) override
+    {
+        command_list* cmd_list = List();
+        const auto start = chrono::steady_clock::now();
+        reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(cmd_list, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+        _stats.drawNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        _stats.draws++;
+    }
+
+    void OnDrawIndirect(uint32_t type, uint64_t buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) override
+    {
+        command_list* cmd_list = List();
+        const auto start = chrono::steady_clock::now();
+        reshade::invoke_addon_event<reshade::addon_event::draw_or_dispatch_indirect>(cmd_list, static_cast<indirect_command>(type), resource{ buffer }, offset, drawCount, stride);
+        _stats.drawNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        _stats.draws++;
+    }
+
+    /// <summary>
+    /// Closes the lists recorded in the frame and presents it. The capture's present is only a marker, lists of other
+    /// threads are delivered after it.
+    /// </summary>
+    void EndFrame()
+    {
+        if (!_inFrame)
+        {
+            return;
+        }
+
+        for (StubCommandList* cmd_list : _recording)
+        {
+            _host.EndCommandList(*cmd_list);
+        }
+        _recording.clear();
+
+        const auto start = chrono::steady_clock::now();
+        _host.Present();
+        _stats.presentNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+        _stats.frames++;
+        _inFrame = false;
+    }
+
+private:
+    // Events before the thread's first command list go to the immediate one, like state set up on D3D11's immediate context
+    command_list* List()
+    {
+        return _cmdList != nullptr ? static_cast<command_list*>(_cmdList) : &_host.Queue().ImmediateCommandList();
+    }
+
+    void Views(const vector<CaptureTarget>& targets)
+    {
+        _views.resize(targets.size());
+        for (size_t i = 0; i < targets.size(); i++)
+        {
+            _views[i] = resource_view{ targets[i].view };
+        }
+    }
+
+    AddonHost& _host;
+    const set<uint32_t>& _presentThreads;
+    unordered_map<uint64_t, StubCommandList*> _lists;
+    set<StubCommandList*> _recording;
+    StubCommandList* _cmdList = nullptr;
+    vector<resource_view> _views;
+    uint32_t _thread = 0;
+    uint32_t _frame = 0;
+    bool _inFrame = false;
+    ReplayStats _stats;
+};
+
+static const vector<string> ScriptTechniques = { "Bloom", "Tonemap", "Sharpen", "Vignette" };
+
+static constexpr uint32_t SCRIPT_PIPELINES = 64;
+static constexpr uint64_t SCRIPT_TARGET_VIEW = 0x1000;
+static constexpr uint64_t SCRIPT_TARGET = 0x1001;
+static constexpr uint64_t SCRIPT_CONSTANT_BUFFER = 0x2000;
+static constexpr uint64_t SCRIPT_LAYOUT = 0x3000;
+static constexpr uint32_t SCRIPT_CONSTANT_SLOT = 2;
+
+// Two threads recording a command list each per frame, binding a random pipeline of the pool before every draw. The first
+// presents.
+static vector<uint8_t> ScriptWorkload(device_api api, uint32_t frames, uint32_t draws, const vector<pair<uint32_t, uint32_t>>& hashes)
+{
+    CaptureScript script(static_cast<uint32_t>(api));
+    Random random;
+
+    const uint32_t stages = static_cast<uint32_t>(pipeline_stage::pixel_shader | pipeline_stage::vertex_shader);
+    const uint32_t threads = 2;
+
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        for (uint32_t thread = 0; thread < threads; thread++)
+        {
+            script.Begin(thread + 1, frame);
+            script.CommandList(0x100 * (thread + 1));
+            script.BindRenderTarget(SCRIPT_TARGET_VIEW, SCRIPT_TARGET, AddonHost::WIDTH, AddonHost::HEIGHT, static_cast<uint32_t>(format::r8g8b8a8_unorm));
+            script.PushConstantBuffer(static_cast<uint32_t>(shader_stage::pixel), SCRIPT_LAYOUT, SCRIPT_CONSTANT_SLOT, 0, SCRIPT_CONSTANT_BUFFER, 0, 256);
+
+            for (uint32_t draw = thread; draw < draws; draw += threads)
+            {
+                const uint32_t index = static_cast<uint32_t>(random.Next() % hashes.size());
+                script.BindPipeline(stages, 0x10000 + index, hashes[index].first, hashes[index].second);
+                script.DrawIndexed(36, 1, 0, 0, 0);
+            }
+
+            if (thread == 0)
+            {
+                script.Present(0x9000, 0x9001);
+            }
+            script.End();
+        }
+    }
+
+    return script.Finish();
+}
+
+static AddonConfig ScriptConfig(const vector<pair<uint32_t, uint32_t>>& hashes)
+{
+    AddonConfig config;
+
+    GroupDesc scene;
+    scene.name = "Scene";
+    scene.pixelShaders = { hashes[0].first, hashes[1].first, hashes[2].first, hashes[3].first };
+    scene.techniques = { "Bloom", "Tonemap" };
+    config.groups.push_back(scene);
+
+    GroupDesc hud;
+    hud.name = "Hud";
+    hud.vertexShaders = { hashes[5].second };
+    hud.techniques = { "Sharpen" };
+    config.groups.push_back(hud);
+
+    GroupDesc exposure;
+    exposure.name = "Exposure";
+    exposure.pixelShaders = { hashes[7].first };
+    exposure.extractConstants = true;
+    exposure.constantSlot = SCRIPT_CONSTANT_SLOT;
+    exposure.constants = { { "Exposure", 0 }, { "WhitePoint", 4 } };
+    config.groups.push_back(exposure);
+
+    return config;
+}
+
+static bool ParseApi(const char* name, device_api& api)
+{
+    if (strcmp(name, "d3d11") == 0)
+        api = device_api::d3d11;
+    else if (strcmp(name, "d3d12") == 0)
+        api = device_api::d3d12;
+    else if (strcmp(name, "vulkan") == 0)
+        api = device_api::vulkan;
+    else
+        return false;
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const char* capturePath = nullptr;
+    const char* configPath = nullptr;
+    const char* apiName = nullptr;
+    uint32_t loops = 1;
+    uint32_t frames = 60;
+    uint32_t draws = 2000;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--capture") == 0)
+            capturePath = argv[i + 1];
+        else if (strcmp(argv[i], "--config") == 0)
+            configPath = argv[i + 1];
+        else if (strcmp(argv[i], "--loops") == 0)
+            loops = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--frames") == 0)
+            frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--draws") == 0)
+            draws = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--api") == 0)
+            apiName = argv[i + 1];
+    }
+
+    loops = max(loops, 1u);
+    frames = max(frames, 1u);
+    draws = max(draws, 2u);
+
+    device_api api = device_api::d3d12;
+    if (apiName != nullptr && !ParseApi(apiName, api))
+    {
+        printf("FAIL unknown API \"%s\"\n", apiName);
+        return 1;
+    }
+
+    // Scripted pipelines get a shader hash per stage, drawn from the same generator as the workload
+    Random random;
+    vector<pair<uint32_t, uint32_t>> scriptHashes(SCRIPT_PIPELINES);
+    for (auto& [ps, vs] : scriptHashes)
+    {
+        ps = static_cast<uint32_t>(random.Next() % 0xFFFFFFFEu) + 1;
+        vs = static_cast<uint32_t>(random.Next() % 0xFFFFFFFEu) + 1;
+    }
+
+    vector<uint8_t> capture;
+    if (capturePath != nullptr)
+    {
+        ifstream file(capturePath, ios::in | ios::binary);
+        capture.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+    else
+    {
+        capture = ScriptWorkload(api, frames, draws, scriptHashes);
+    }
+
+    CaptureInventory inventory;
+    CaptureHeader header;
+    if (!CaptureReader::Decode(capture.data(), capture.size(), inventory, &header))
+    {
+        printf("FAIL %s isn't a readable capture\n", capturePath != nullptr ? capturePath : "the scripted workload");
+        return 1;
+    }
+
+    if (capturePath != nullptr)
+    {
+        api = static_cast<device_api>(header.deviceApi);
+    }
+
+    bool failed = false;
+    for (const auto& [handle, pipeline] : inventory.pipelines)
+    {
+        for (const uint32_t hash : { pipeline.psHash, pipeline.vsHash })
+        {
+            const vector<uint8_t> code = AddonHost::ShaderCodeForHash(hash);
+            if (hash != 0 && compute_crc32(code.data(), code.size()) != hash)
+            {
+                printf("FAIL shader code for hash %08X hashes to %08X\n", hash, compute_crc32(code.data(), code.size()));
+                failed = true;
+            }
+        }
+    }
+
+    AddonHost host;
+    bool loaded;
+    if (configPath != nullptr)
+    {
+        loaded = host.Load(filesystem::path(configPath), api, AddonHost::ConfigTechniques(configPath));
+    }
+    else if (capturePath != nullptr)
+    {
+        AddonConfig config;
+        GroupDesc all;
+        all.name = "All";
+        all.pixelShaders.assign(inventory.pixelShaders.begin(), inventory.pixelShaders.end());
+        all.techniques = { ScriptTechniques[0] };
+        config.groups.push_back(all);
+        loaded = host.Load(config, api, ScriptTechniques);
+    }
+    else
+    {
+        loaded = host.Load(ScriptConfig(scriptHashes), api, ScriptTechniques, { { "Exposure" }, { "WhitePoint" } });
+    }
+
+    if (!loaded)
+    {
+        printf("FAIL could not load the addon\n");
+        return 1;
+    }
+
+    for (const auto& [handle, pipeline] : inventory.pipelines)
+    {
+        host.CreatePipeline(reshade::api::pipeline{ handle }, pipeline.psHash, pipeline.vsHash);
+    }
+    for (const auto& [view, target] : inventory.targets)
+    {
+        host.AddRenderTarget(resource_view{ view }, resource{ target.resource }, target.width, target.height, static_cast<format>(target.format));
+    }
+    for (const auto& [buffer, size] : inventory.constantBuffers)
+    {
+        host.AddConstantBuffer(resource{ buffer }, size);
+    }
+
+    // Give the scripted constants values other than the uniforms' zero, so extracting them has something to write
+    void* constants = nullptr;
+    if (capturePath == nullptr && host.Device().map_buffer_region(resource{ SCRIPT_CONSTANT_BUFFER }, 0, 8, map_access::write_only, &constants))
+    {
+        const float values[] = { 1.5f, 4.0f };
+        memcpy(constants, values, sizeof(values));
+        host.Device().unmap_buffer_region(resource{ SCRIPT_CONSTANT_BUFFER });
+    }
+
+    CaptureReplay replay(host, inventory.presentThreads);
+    for (uint32_t loop = 0; loop < loops && !failed; loop++)
+    {
+        if (!CaptureReader::Decode(capture.data(), capture.size(), replay))
+        {
+            printf("FAIL the capture stopped decoding midway\n");
+            failed = true;
+        }
+        replay.EndFrame();
+    }
+
+    const ReplayStats& stats = replay.Stats();
+    Counters& counters = host.Stats();
+
+    printf("%u frames, %llu draws, %llu pipeline binds, %zu pipelines, api 0x%x\n", stats.frames, static_cast<unsigned long long>(stats.draws),
+        static_cast<unsigned long long>(stats.binds), inventory.pipelines.size(), static_cast<uint32_t>(api));
+    printf("%-24s %10.1f ns\n", "per draw", stats.draws > 0 ? stats.drawNs / stats.draws : 0.0);
+    printf("%-24s %10.1f ns\n", "per pipeline bind", stats.binds > 0 ? stats.bindNs / stats.binds : 0.0);
+    printf("%-24s %10.1f us\n", "per present", stats.frames > 0 ? stats.presentNs / stats.frames / 1000.0 : 0.0);
+    printf("%-24s %10llu\n", "techniques rendered", static_cast<unsigned long long>(counters.techniquesRendered.load()));
+    printf("%-24s %10llu\n", "effect batches", static_cast<unsigned long long>(counters.effectBatches.load()));
+    printf("%-24s %10llu\n", "state re-binds", static_cast<unsigned long long>(counters.stateRebinds.load()));
+    printf("%-24s %10llu\n", "copies", static_cast<unsigned long long>(counters.copies.load()));
+    printf("%-24s %10llu\n", "uniform writes", static_cast<unsigned long long>(counters.uniformWrites.load()));
+
+    if (capturePath == nullptr && !failed)
+    {
+        // Every frame draws each group's shaders, so each technique a group names renders once, the constants are read back
+        // once and land in the uniforms, and D3D12 and Vulkan restore the game's state after each batch of effects
+        const uint64_t techniques = 3ull * stats.frames;
+        if (counters.techniquesRendered != techniques)
+        {
+            printf("FAIL %llu techniques rendered, expected %llu\n", static_cast<unsigned long long>(counters.techniquesRendered.load()),
+                static_cast<unsigned long long>(techniques));
+            failed = true;
+        }
+
+        if (counters.copies != stats.frames)
+        {
+            printf("FAIL %llu constant buffer copies, expected one per frame\n", static_cast<unsigned long long>(counters.copies.load()));
+            failed = true;
+        }
+
+        if (counters.uniformWrites == 0)
+        {
+            printf("FAIL no extracted constants written to the effects' uniforms\n");
+            failed = true;
+        }
+
+        if ((api == device_api::d3d12 || api == device_api::vulkan) && counters.stateRebinds == 0)
+        {
+            printf("FAIL no state restored after rendering effects\n");
+            failed = true;
+        }
+    }
+
+    host.Unload();
+
+    if (failed)
+    {
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,296 @@
+// Checks SignatureScanner against one Signature::Find pass per signature on a synthetic module image, then times both.
+//
+//   signature_scanner [--size <MB>] [--threads <n>] [--runs <n>]
+//
+// The image is pseudo random bytes split into three executable regions with data in between. Every signature but the last
+// is planted in it: some twice, on chunk boundaries, at a region's start or end, and some only outside the regions or straddling
+// their bounds where they must not be found. One more region sits in an allocation of its own, flush against a page that
+// can't be read, so reading past a region's end faults instead of landing in the bytes after it. Exits with 1 on any mismatch.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Signature.h"
+#include "SignatureScanner.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace Shim;
+using namespace std;
+
+// The memcpy, FFXIV and NieR signatures the addon scans for
+static const char* const Patterns[] = {
+    "48 8B C1 4C 8D 15 ?? ?? ?? ?? 49 83 F8 0F",
+    "48 8B C1 49 83 F8 08 72 ?? 49 83 F8 10",
+    "4C 8B D9 4C 8B D2 49 83 F8 10",
+    "4C 8B D9 48 2B D1 ?? ?? ?? ?? ?? ?? 49 83 F8 08 ?? ?? F6 C1 07",
+    "57 56 8B 74 24 ?? 8B 4C 24 ?? 8B 7C 24 ?? 8B C1 8B D1 03 C6 3B FE 76 ??",
+    "57 56 8B 74 24 ?? 8B 4C 24 ?? 8B 7C 24 ?? 8B C1 8B D1 03 C6 3B FE 77 ??",
+    "4C 89 44 24 ?? 56 57 41 57",
+    "48 89 5C 24 ?? 48 89 74 24 ?? 57 48 83 EC 40 80 B9 ?? ?? ?? ?? 00 48 8B F2 41 8B F8",
+    "40 55 53 57 41 54 41 57 48 8D AC 24 ?? ?? ?? ?? B8 E0 21 00 00",
+    "40 55 53 56 57 41 55 48 8B EC 48 83 EC 60 48 8B 35 ?? ?? ?? ??",
+    "40 55 53 41 55 48 8B EC 48 83 EC 50",
+    "?? ?? 8B 05 ?? ?? ?? ?? C3",
+    "E8 ?? ?? ?? ?? 90 CC CC CC CC CC CC CC CC CC CC CC CC CC CC",	// never planted
+};
+
+static constexpr size_t MB = 1024 * 1024;
+
+struct Random
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    uint64_t Next()
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+static void Plant(vector<uint8_t>& image, size_t offset, const Signature& sig, Random& random)
+{
+    for (size_t i = 0; i < sig.Size(); i++)
+    {
+        image[offset + i] = sig.Mask()[i] ? sig.Bytes()[i] : static_cast<uint8_t>(random.Next());
+    }
+}
+
+static vector<const uint8_t*> FindEach(const vector<Signature>& sigs, const vector<ScanRegion>& regions)
+{
+    vector<const uint8_t*> results(sigs.size(), nullptr);
+
+    for (size_t i = 0; i < sigs.size(); i++)
+    {
+        for (const auto& region : regions)
+        {
+            const uint8_t* match = sigs[i].Find(region.data, region.size);
+            if (match != nullptr)
+            {
+                results[i] = match;
+                break;
+            }
+        }
+    }
+
+    return results;
+}
+
+// Bytes followed by a page without access, nullptr if the pages can't be had. Freed with the process.
+static uint8_t* AllocateBeforeGuardPage(size_t size)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t page = info.dwPageSize;
+#else
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    const size_t pages = (size + page - 1) / page;
+
+#ifdef _WIN32
+    uint8_t* base = static_cast<uint8_t*>(VirtualAlloc(nullptr, (pages + 1) * page, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+    DWORD oldProtect;
+    if (base == nullptr || !VirtualProtect(base + pages * page, page, PAGE_NOACCESS, &oldProtect))
+    {
+        return nullptr;
+    }
+#else
+    void* mapping = mmap(nullptr, (pages + 1) * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    uint8_t* base = static_cast<uint8_t*>(mapping);
+    if (mprotect(base + pages * page, page, PROT_NONE) != 0)
+    {
+        return nullptr;
+    }
+#endif
+
+    return base + pages * page - size;
+}
+
+template<typename F>
+static double TimeBest(uint32_t runs, F&& f)
+{
+    double best = 1e300;
+    for (uint32_t i = 0; i < runs; i++)
+    {
+        const auto start = chrono::steady_clock::now();
+        f();
+        const auto end = chrono::steady_clock::now();
+        best = std::min(best, chrono::duration<double, milli>(end - start).count());
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    size_t sizeMB = 100;
+    uint32_t threads = 0;
+    uint32_t runs = 3;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--size") == 0)
+            sizeMB = strtoull(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--threads") == 0)
+            threads = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--runs") == 0)
+            runs = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+    }
+
+    sizeMB = std::max<size_t>(sizeMB, 16);
+
+    vector<Signature> sigs;
+    for (const char* pattern : Patterns)
+    {
+        sigs.emplace_back(pattern);
+    }
+
+    Random random;
+    vector<uint8_t> image(sizeMB * MB);
+    for (size_t i = 0; i + 8 <= image.size(); i += 8)
+    {
+        const uint64_t value = random.Next();
+        memcpy(image.data() + i, &value, sizeof(value));
+    }
+
+    // A tiny stub section too small for the SIMD loop, then .text takes most of the image, a second code section and a small third
+    // one follow, each after some data
+    const size_t stubBegin = 64;
+    const size_t stubEnd = stubBegin + 48;
+    const size_t textBegin = 4096;
+    const size_t textEnd = image.size() * 3 / 4;
+    const size_t text2Begin = textEnd + MB;
+    const size_t text2End = image.size() - 2 * MB;
+    const size_t text3Begin = text2End + 64 * 1024;
+    const size_t text3End = image.size() - 4096;
+
+    vector<ScanRegion> regions = {
+        ScanRegion{ image.data() + stubBegin, stubEnd - stubBegin },
+        ScanRegion{ image.data() + textBegin, textEnd - textBegin },
+        ScanRegion{ image.data() + text2Begin, text2End - text2Begin },
+        ScanRegion{ image.data() + text3Begin, text3End - text3Begin },
+    };
+
+    // A last code section ending on a page boundary, with nothing planted so every signature is still looked for at its end
+    const size_t guardedSize = 3 * 4096 - 24;
+    uint8_t* guarded = AllocateBeforeGuardPage(guardedSize);
+    if (guarded == nullptr)
+    {
+        printf("FAIL could not allocate a region before a guard page\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < guardedSize; i++)
+    {
+        guarded[i] = static_cast<uint8_t>(random.Next());
+    }
+    regions.push_back(ScanRegion{ guarded, guardedSize });
+
+    const size_t planted = sigs.size() - 1;
+    for (size_t i = 0; i < planted; i++)
+    {
+        const Signature& sig = sigs[i];
+        switch (i % 6)
+        {
+        case 0:
+            // Straddling the 4 MB chunk boundary, chunks split start positions only
+            Plant(image, textBegin + 4 * MB * (i / 6 + 1) - sig.Size() / 2, sig, random);
+            break;
+        case 1:
+            // Twice, the lower one has to win even when it's in a later chunk than the thread that finishes first
+            Plant(image, textBegin + (textEnd - textBegin) / 2 + i * 4099, sig, random);
+            Plant(image, textBegin + (textEnd - textBegin) / 3 + i * 4099, sig, random);
+            break;
+        case 2:
+            // Ending exactly at a region's end
+            Plant(image, (i / 6 % 2 == 0 ? text2End : textEnd) - sig.Size(), sig, random);
+            break;
+        case 3:
+            // Only in data between code sections and straddling a code section's bounds, neither may be found
+            Plant(image, textEnd + 4096 + i, sig, random);
+            Plant(image, (i / 6 % 2 == 0 ? text3End : text2Begin) - sig.Size() / 2, sig, random);
+            break;
+        case 4:
+            // First byte of a section
+            Plant(image, i / 6 % 2 == 0 ? text3Begin : text2Begin, sig, random);
+            break;
+        default:
+            // Anywhere in .text, and the second one at the stub section's end as well
+            Plant(image, textBegin + random.Next() % (textEnd - textBegin - sig.Size()), sig, random);
+            if (i / 6 % 2 != 0)
+            {
+                Plant(image, stubEnd - sig.Size(), sig, random);
+            }
+            break;
+        }
+    }
+
+    SignatureScanner scanner;
+    for (const auto& sig : sigs)
+    {
+        scanner.Add(&sig);
+    }
+
+    const vector<const uint8_t*> expected = FindEach(sigs, regions);
+
+    bool failed = false;
+    for (uint32_t threadCount : { 1u, 3u, threads })
+    {
+        const vector<const uint8_t*> results = scanner.Scan(regions, threadCount);
+        for (size_t i = 0; i < sigs.size(); i++)
+        {
+            if (results[i] != expected[i])
+            {
+                printf("FAIL %u thread(s): \"%s\" found at %td, expected %td\n", threadCount, sigs[i].Pattern().c_str(),
+                    results[i] != nullptr ? results[i] - image.data() : -1, expected[i] != nullptr ? expected[i] - image.data() : -1);
+                failed = true;
+            }
+        }
+    }
+
+    size_t found = 0;
+    for (const uint8_t* match : expected)
+    {
+        found += match != nullptr ? 1 : 0;
+    }
+
+    size_t scannedBytes = 0;
+    for (const auto& region : regions)
+    {
+        scannedBytes += region.size;
+    }
+
+    const double scannedMB = static_cast<double>(scannedBytes) / MB;
+    const double findEach = TimeBest(runs, [&]() { FindEach(sigs, regions); });
+    const double single = TimeBest(runs, [&]() { scanner.Scan(regions, 1); });
+    const double parallel = TimeBest(runs, [&]() { scanner.Scan(regions, threads); });
+
+    printf("%zu signatures, %zu found, %.0f MB in %zu regions\n", sigs.size(), found, scannedMB, regions.size());
+    printf("%-24s %10.2f ms %10.0f MB/s\n", "Signature::Find each", findEach, scannedMB * 1000.0 / findEach);
+    printf("%-24s %10.2f ms %10.0f MB/s\n", "Scan, 1 thread", single, scannedMB * 1000.0 / single);
+    printf("%-24s %10.2f ms %10.0f MB/s\n", "Scan, all threads", parallel, scannedMB * 1000.0 / parallel);
+
+    if (failed)
+    {
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
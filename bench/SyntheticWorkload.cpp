@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <chrono>
+#include "SyntheticWorkload.h"
+
+using namespace Bench;
+using namespace reshade::api;
+using namespace std;
+
+namespace
+{
+    struct Random
+    {
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+
+        uint64_t Next()
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        // Uniform in [0, 1)
+        double Unit() { return static_cast<double>(Next() >> 11) * 0x1.0p-53; }
+    };
+
+    constexpr uint64_t FIRST_PIPELINE = 0x10000;
+    constexpr uint32_t PASSES = 4;
+    constexpr uint32_t MAX_RUN = 8;
+
+    uint32_t NonZeroHash(Random& random)
+    {
+        const uint32_t hash = static_cast<uint32_t>(random.Next());
+        return hash != 0 ? hash : 1;
+    }
+
+    uint32_t Elapsed(chrono::steady_clock::time_point start)
+    {
+        return static_cast<uint32_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+    }
+}
+
+SyntheticWorkload::SyntheticWorkload(const WorkloadParams& params) : _params(params)
+{
+    Random random;
+
+    _pipelines.resize(max(_params.pipelines, 1u));
+    for (auto& pipeline : _pipelines)
+    {
+        pipeline.psHash = NonZeroHash(random);
+        pipeline.vsHash = NonZeroHash(random);
+    }
+
+    for (uint32_t i = 0; i < _params.techniques; i++)
+    {
+        _techniques.push_back("Effect" + to_string(i));
+    }
+
+    // Each group takes distinct pipelines' shaders, hashes past the pipeline count match nothing drawn
+    vector<uint32_t> order(_pipelines.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+
+    for (uint32_t g = 0; g < _params.groups; g++)
+    {
+        GroupDesc group;
+        group.name = "Group" + to_string(g);
+        const bool vertex = g % 4 == 3;
+
+        for (uint32_t h = 0; h < _params.hashes; h++)
+        {
+            uint32_t hash;
+            if (h < order.size())
+            {
+                swap(order[h], order[h + random.Next() % (order.size() - h)]);
+                hash = vertex ? _pipelines[order[h]].vsHash : _pipelines[order[h]].psHash;
+            }
+            else
+            {
+                hash = NonZeroHash(random);
+            }
+
+            (vertex ? group.vertexShaders : group.pixelShaders).push_back(hash);
+        }
+
+        for (uint32_t t = g; t < _params.techniques; t += _params.groups)
+        {
+            group.techniques.push_back(_techniques[t]);
+        }
+
+        _config.groups.push_back(move(group));
+    }
+}
+
+void SyntheticWorkload::Create(AddonHost& host, uint32_t maxThreads)
+{
+    for (uint32_t i = 0; i < _pipelines.size(); i++)
+    {
+        host.CreatePipeline(pipeline{ FIRST_PIPELINE + i }, _pipelines[i].psHash, _pipelines[i].vsHash);
+    }
+
+    while (_threads.size() < maxThreads)
+    {
+        Thread thread;
+        thread.cmdList = &host.CreateCommandList(true);
+        thread.targets[0] = host.CreateRenderTarget(format::r16g16b16a16_float);
+        thread.targets[1] = host.CreateRenderTarget(format::r8g8b8a8_unorm);
+        _threads.push_back(thread);
+    }
+}
+
+void SyntheticWorkload::Record(AddonHost& host, uint32_t thread, uint32_t threads, uint32_t frame, uint32_t draws, DrawTimes* times) const
+{
+    const Thread& data = _threads[thread];
+    command_list* cmd_list = data.cmdList;
+    const pipeline_stage stages = pipeline_stage::pixel_shader | pipeline_stage::vertex_shader;
+    const uint32_t count = DrawsPerThread(thread, threads, draws);
+
+    Random random;
+    random.state ^= (static_cast<uint64_t>(thread) << 32 | frame) * 0xBF58476D1CE4E5B9ull;
+    if (random.state == 0)
+    {
+        random.state = 1;
+    }
+
+    host.BeginCommandList(*data.cmdList);
+
+    uint32_t pass = UINT32_MAX;
+    uint32_t run = 0;
+    for (uint32_t draw = 0; draw < count; draw++)
+    {
+        if (draw * PASSES / count != pass)
+        {
+            pass = draw * PASSES / count;
+            reshade::invoke_addon_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(cmd_list, 1u, &data.targets[pass & 1], resource_view{ 0 });
+            run = 0;
+        }
+
+        if (run == 0)
+        {
+            // Cubing a uniform variable puts half the draws on the first eighth of the pipelines
+            const double u = random.Unit();
+            const uint32_t index = min(static_cast<uint32_t>(u * u * u * _pipelines.size()), static_cast<uint32_t>(_pipelines.size() - 1));
+            run = 1 + static_cast<uint32_t>(random.Next() % MAX_RUN);
+
+            const auto start = chrono::steady_clock::now();
+            reshade::invoke_addon_event<reshade::addon_event::bind_pipeline>(cmd_list, stages, pipeline{ FIRST_PIPELINE + index });
+            if (times != nullptr)
+            {
+                times->binds.push_back(Elapsed(start));
+            }
+        }
+        run--;
+
+        const auto start = chrono::steady_clock::now();
+        reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(cmd_list, 36u, 1u, 0u, 0, 0u);
+        if (times != nullptr)
+        {
+            times->draws.push_back(Elapsed(start));
+        }
+    }
+
+    host.EndCommandList(*data.cmdList);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AddonHost.h"
+
+namespace Bench
+{
+    struct WorkloadParams
+    {
+        uint32_t pipelines = 512;
+        uint32_t groups = 8;
+        uint32_t hashes = 16;       // per group
+        uint32_t techniques = 8;
+    };
+
+    /// <summary>
+    /// Per-call times of a recording thread, in nanoseconds
+    /// </summary>
+    struct DrawTimes
+    {
+        std::vector<uint32_t> binds;
+        std::vector<uint32_t> draws;
+    };
+
+    /// <summary>
+    /// Frames shaped like a deferred renderer's: every recording thread records its share of the draws into a command list of
+    /// its own, in passes alternating between two render targets. Pipeline popularity is skewed so a few pipelines take most
+    /// draws, and draws come sorted into runs on one pipeline, which is only bound when it changes. Groups match pixel shaders,
+    /// every fourth one vertex shaders, out of the pipelines' shaders, and between them ask for every technique.
+    /// </summary>
+    class SyntheticWorkload
+    {
+    public:
+        explicit SyntheticWorkload(const WorkloadParams& params);
+
+        const WorkloadParams& Params() const { return _params; }
+        const AddonConfig& Config() const { return _config; }
+        const std::vector<std::string>& Techniques() const { return _techniques; }
+
+        /// <summary>
+        /// Creates the pipelines, and a command list and render targets for each of up to the given number of threads, on a
+        /// loaded host
+        /// </summary>
+        void Create(AddonHost& host, uint32_t maxThreads);
+
+        /// <summary>
+        /// Records the thread's share of a frame's draws on the thread's command list, from reset to close. Times each bind
+        /// and draw event when given somewhere to put them. Threads record their own lists, so any number can run at once.
+        /// </summary>
+        void Record(AddonHost& host, uint32_t thread, uint32_t threads, uint32_t frame, uint32_t draws, DrawTimes* times) const;
+
+        /// <summary>
+        /// The thread's share of a frame's draws
+        /// </summary>
+        static uint32_t DrawsPerThread(uint32_t thread, uint32_t threads, uint32_t draws) { return draws / threads + (thread < draws % threads ? 1 : 0); }
+
+    private:
+        struct Pipeline
+        {
+            uint32_t psHash;
+            uint32_t vsHash;
+        };
+
+        struct Thread
+        {
+            StubCommandList* cmdList;
+            reshade::api::resource_view targets[2];
+        };
+
+        const WorkloadParams _params;
+        std::vector<Pipeline> _pipelines;
+        std::vector<std::string> _techniques;
+        AddonConfig _config;
+        std::vector<Thread> _threads;
+    };
+}
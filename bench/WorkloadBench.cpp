@@ -0,0 +1,348 @@
+// Times the addon's draw path on synthetic frames, sweeping the number of recording threads and draws per frame. Every
+// bind_pipeline and draw event runs onBindPipeline and CheckDrawCall, which looks the bound shaders up and renders the
+// groups' techniques through CheckCallForCommandList, on command lists recorded concurrently.
+//
+//   workload_bench [--draws <n,...>] [--threads <n,...>] [--pipelines <n>] [--groups <n>] [--hashes <n>] [--techniques <n>]
+//                  [--frames <n>] [--api d3d11|d3d12|vulkan] [--json <file>] [--csv <file>]
+//
+// Draws and threads take comma separated lists and every combination runs, after two warm-up frames each, in one load of
+// the addon. Bind and draw percentiles are over every event of the measured frames. --json and --csv write the same
+// results for comparing builds. Exits with 1 if a frame renders none of the techniques.
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SyntheticWorkload.h"
+
+using namespace Bench;
+using namespace reshade::api;
+using namespace std;
+
+static constexpr uint32_t WARMUP_FRAMES = 2;
+
+struct Percentiles
+{
+    uint32_t p50 = 0;
+    uint32_t p90 = 0;
+    uint32_t p99 = 0;
+    uint32_t max = 0;
+    double mean = 0;
+};
+
+struct Result
+{
+    uint32_t threads;
+    uint32_t draws;
+    uint64_t binds;
+    Percentiles draw;
+    Percentiles bind;
+    double recordMs;
+    double presentUs;
+    double techniques;
+};
+
+static Percentiles Summarize(vector<uint32_t>& samples)
+{
+    Percentiles result;
+    if (samples.empty())
+    {
+        return result;
+    }
+
+    auto at = [&samples](double p) {
+        const auto nth = samples.begin() + static_cast<ptrdiff_t>(p * (samples.size() - 1));
+        nth_element(samples.begin(), nth, samples.end());
+        return *nth;
+    };
+
+    double sum = 0;
+    for (uint32_t sample : samples)
+    {
+        sum += sample;
+    }
+
+    result.mean = sum / samples.size();
+    result.p50 = at(0.5);
+    result.p90 = at(0.9);
+    result.p99 = at(0.99);
+    result.max = *max_element(samples.begin(), samples.end());
+    return result;
+}
+
+static vector<uint32_t> ParseList(const char* text)
+{
+    vector<uint32_t> values;
+    for (const char* p = text; *p != '\0';)
+    {
+        char* end;
+        const uint32_t value = static_cast<uint32_t>(strtoul(p, &end, 10));
+        if (end == p)
+        {
+            break;
+        }
+
+        if (value > 0)
+        {
+            values.push_back(value);
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+
+    return values;
+}
+
+static bool ParseApi(const char* name, device_api& api)
+{
+    if (strcmp(name, "d3d11") == 0)
+        api = device_api::d3d11;
+    else if (strcmp(name, "d3d12") == 0)
+        api = device_api::d3d12;
+    else if (strcmp(name, "vulkan") == 0)
+        api = device_api::vulkan;
+    else
+        return false;
+
+    return true;
+}
+
+// Runs the given number of recording threads for the warm-up and measured frames, each frame presented once all threads
+// closed their lists
+static Result Run(AddonHost& host, const SyntheticWorkload& workload, uint32_t threads, uint32_t draws, uint32_t frames, uint32_t& frameIndex)
+{
+    const uint32_t total = WARMUP_FRAMES + frames;
+    vector<DrawTimes> times(threads);
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        const size_t perFrame = SyntheticWorkload::DrawsPerThread(t, threads, draws);
+        times[t].draws.reserve(perFrame * frames);
+        times[t].binds.reserve(perFrame * frames);
+    }
+
+    barrier sync(threads + 1);
+    vector<thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]() {
+            for (uint32_t frame = 0; frame < total; frame++)
+            {
+                sync.arrive_and_wait();
+                workload.Record(host, t, threads, frameIndex + frame, draws, frame >= WARMUP_FRAMES ? &times[t] : nullptr);
+                sync.arrive_and_wait();
+            }
+            });
+    }
+
+    double recordNs = 0;
+    double presentNs = 0;
+    for (uint32_t frame = 0; frame < total; frame++)
+    {
+        if (frame == WARMUP_FRAMES)
+        {
+            host.Stats().Reset();
+        }
+
+        // Taken before releasing the threads, which can finish recording before this thread runs again
+        const auto start = chrono::steady_clock::now();
+        sync.arrive_and_wait();
+        sync.arrive_and_wait();
+        const auto recorded = chrono::steady_clock::now();
+        host.Present();
+        const auto presented = chrono::steady_clock::now();
+
+        if (frame >= WARMUP_FRAMES)
+        {
+            recordNs += chrono::duration<double, nano>(recorded - start).count();
+            presentNs += chrono::duration<double, nano>(presented - recorded).count();
+        }
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    frameIndex += total;
+
+    vector<uint32_t> drawSamples;
+    vector<uint32_t> bindSamples;
+    for (const auto& t : times)
+    {
+        drawSamples.insert(drawSamples.end(), t.draws.begin(), t.draws.end());
+        bindSamples.insert(bindSamples.end(), t.binds.begin(), t.binds.end());
+    }
+
+    Result result;
+    result.threads = threads;
+    result.draws = draws;
+    result.binds = bindSamples.size() / frames;
+    result.draw = Summarize(drawSamples);
+    result.bind = Summarize(bindSamples);
+    result.recordMs = recordNs / frames / 1e6;
+    result.presentUs = presentNs / frames / 1e3;
+    result.techniques = static_cast<double>(host.Stats().techniquesRendered.load()) / frames;
+    return result;
+}
+
+static void WriteJson(FILE* file, const WorkloadParams& params, uint32_t frames, device_api api, const vector<Result>& results)
+{
+    fprintf(file, "{\n  \"pipelines\": %u, \"groups\": %u, \"hashes\": %u, \"techniques\": %u, \"frames\": %u, \"api\": %u,\n  \"runs\": [\n",
+        params.pipelines, params.groups, params.hashes, params.techniques, frames, static_cast<uint32_t>(api));
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        fprintf(file, "    { \"threads\": %u, \"draws\": %u, \"binds\": %llu, "
+            "\"draw_ns\": { \"mean\": %.1f, \"p50\": %u, \"p90\": %u, \"p99\": %u, \"max\": %u }, "
+            "\"bind_ns\": { \"mean\": %.1f, \"p50\": %u, \"p90\": %u, \"p99\": %u, \"max\": %u }, "
+            "\"record_ms\": %.3f, \"present_us\": %.1f, \"techniques_per_frame\": %.2f }%s\n",
+            r.threads, r.draws, static_cast<unsigned long long>(r.binds),
+            r.draw.mean, r.draw.p50, r.draw.p90, r.draw.p99, r.draw.max,
+            r.bind.mean, r.bind.p50, r.bind.p90, r.bind.p99, r.bind.max,
+            r.recordMs, r.presentUs, r.techniques, i + 1 < results.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+}
+
+static void WriteCsv(FILE* file, const WorkloadParams& params, uint32_t frames, device_api api, const vector<Result>& results)
+{
+    fprintf(file, "pipelines,groups,hashes,techniques,frames,api,threads,draws,binds,"
+        "draw_mean_ns,draw_p50_ns,draw_p90_ns,draw_p99_ns,draw_max_ns,bind_mean_ns,bind_p50_ns,bind_p90_ns,bind_p99_ns,bind_max_ns,"
+        "record_ms,present_us,techniques_per_frame\n");
+
+    for (const Result& r : results)
+    {
+        fprintf(file, "%u,%u,%u,%u,%u,%u,%u,%u,%llu,%.1f,%u,%u,%u,%u,%.1f,%u,%u,%u,%u,%.3f,%.1f,%.2f\n",
+            params.pipelines, params.groups, params.hashes, params.techniques, frames, static_cast<uint32_t>(api),
+            r.threads, r.draws, static_cast<unsigned long long>(r.binds),
+            r.draw.mean, r.draw.p50, r.draw.p90, r.draw.p99, r.draw.max,
+            r.bind.mean, r.bind.p50, r.bind.p90, r.bind.p99, r.bind.max,
+            r.recordMs, r.presentUs, r.techniques);
+    }
+}
+
+static bool Write(const char* path, void (*writer)(FILE*, const WorkloadParams&, uint32_t, device_api, const vector<Result>&),
+    const WorkloadParams& params, uint32_t frames, device_api api, const vector<Result>& results)
+{
+    FILE* file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        printf("FAIL could not write %s\n", path);
+        return false;
+    }
+
+    writer(file, params, frames, api, results);
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    WorkloadParams params;
+    vector<uint32_t> drawCounts = { 1000, 10000, 50000 };
+    vector<uint32_t> threadCounts = { 1, 2, 4, 8 };
+    uint32_t frames = 20;
+    const char* apiName = nullptr;
+    const char* jsonPath = nullptr;
+    const char* csvPath = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--draws") == 0)
+            drawCounts = ParseList(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0)
+            threadCounts = ParseList(argv[i + 1]);
+        else if (strcmp(argv[i], "--pipelines") == 0)
+            params.pipelines = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--groups") == 0)
+            params.groups = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--hashes") == 0)
+            params.hashes = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--techniques") == 0)
+            params.techniques = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--frames") == 0)
+            frames = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+        else if (strcmp(argv[i], "--api") == 0)
+            apiName = argv[i + 1];
+        else if (strcmp(argv[i], "--json") == 0)
+            jsonPath = argv[i + 1];
+        else if (strcmp(argv[i], "--csv") == 0)
+            csvPath = argv[i + 1];
+    }
+
+    params.pipelines = max(params.pipelines, 1u);
+    frames = max(frames, 1u);
+
+    device_api api = device_api::d3d12;
+    if (apiName != nullptr && !ParseApi(apiName, api))
+    {
+        printf("FAIL unknown API \"%s\"\n", apiName);
+        return 1;
+    }
+
+    if (drawCounts.empty() || threadCounts.empty())
+    {
+        printf("FAIL no draw or thread counts to run\n");
+        return 1;
+    }
+
+    SyntheticWorkload workload(params);
+    AddonHost host;
+    if (!host.Load(workload.Config(), api, workload.Techniques()))
+    {
+        printf("FAIL could not load the addon\n");
+        return 1;
+    }
+    workload.Create(host, *max_element(threadCounts.begin(), threadCounts.end()));
+
+    printf("%u pipelines, %u groups of %u hashes, %u techniques, %u frames, api 0x%x\n", params.pipelines, params.groups, params.hashes,
+        params.techniques, frames, static_cast<uint32_t>(api));
+    printf("%7s %7s %7s | %8s %6s %6s %6s | %8s %6s %6s %6s | %9s %9s %6s\n", "threads", "draws", "binds", "draw ns", "p50", "p90", "p99",
+        "bind ns", "p50", "p90", "p99", "record ms", "present", "techs");
+
+    bool failed = false;
+    uint32_t frameIndex = 0;
+    vector<Result> results;
+    for (uint32_t threads : threadCounts)
+    {
+        for (uint32_t draws : drawCounts)
+        {
+            const Result r = Run(host, workload, threads, max(draws, threads), frames, frameIndex);
+            results.push_back(r);
+
+            printf("%7u %7u %7llu | %8.1f %6u %6u %6u | %8.1f %6u %6u %6u | %9.3f %6.1f us %6.2f\n", r.threads, r.draws,
+                static_cast<unsigned long long>(r.binds), r.draw.mean, r.draw.p50, r.draw.p90, r.draw.p99, r.bind.mean, r.bind.p50,
+                r.bind.p90, r.bind.p99, r.recordMs, r.presentUs, r.techniques);
+
+            if (params.groups > 0 && params.techniques > 0 && r.techniques == 0)
+            {
+                printf("FAIL %u threads drawing %u rendered no techniques\n", r.threads, r.draws);
+                failed = true;
+            }
+        }
+    }
+
+    host.Unload();
+
+    if (jsonPath != nullptr && !Write(jsonPath, WriteJson, params, frames, api, results))
+    {
+        failed = true;
+    }
+    if (csvPath != nullptr && !Write(csvPath, WriteCsv, params, frames, api, results))
+    {
+        failed = true;
+    }
+
+    if (failed)
+    {
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,42 @@
+// The part of D3D11 the addon uses. Command lists of a D3D11 device expose a context through get_native, the bench's stub
+// contexts implement these calls.
+
+#pragma once
+
+#include <windows.h>
+
+enum D3D11_DEVICE_CONTEXT_TYPE
+{
+    D3D11_DEVICE_CONTEXT_IMMEDIATE = 0,
+    D3D11_DEVICE_CONTEXT_DEFERRED = 1
+};
+
+enum D3D11_MAP
+{
+    D3D11_MAP_READ = 1,
+    D3D11_MAP_WRITE = 2,
+    D3D11_MAP_READ_WRITE = 3,
+    D3D11_MAP_WRITE_DISCARD = 4,
+    D3D11_MAP_WRITE_NO_OVERWRITE = 5
+};
+
+struct D3D11_MAPPED_SUBRESOURCE
+{
+    void* pData;
+    UINT RowPitch;
+    UINT DepthPitch;
+};
+
+struct ID3D11Resource
+{
+};
+
+struct ID3D11DeviceContext
+{
+    virtual D3D11_DEVICE_CONTEXT_TYPE GetType() = 0;
+    virtual HRESULT Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags, D3D11_MAPPED_SUBRESOURCE* mappedResource) = 0;
+    virtual void Unmap(ID3D11Resource* resource, UINT subresource) = 0;
+
+protected:
+    ~ID3D11DeviceContext() = default;
+};
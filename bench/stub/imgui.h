@@ -0,0 +1,219 @@
+// The part of Dear ImGui's API the addon's overlay uses, with ImGui's signatures. Nothing is drawn: widgets report that they
+// weren't clicked and windows that they're collapsed, which is what a build without the overlay needs.
+
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+
+#define IM_ARRAYSIZE(_ARR) ((int)(sizeof(_ARR) / sizeof(*(_ARR))))
+
+typedef unsigned long long ImTextureID;
+typedef unsigned int ImGuiID;
+typedef int ImGuiCol;
+typedef int ImGuiCond;
+typedef int ImGuiKey;
+typedef int ImGuiStyleVar;
+typedef int ImGuiComboFlags;
+typedef int ImGuiInputTextFlags;
+typedef int ImGuiSelectableFlags;
+typedef int ImGuiTabBarFlags;
+typedef int ImGuiTabItemFlags;
+typedef int ImGuiTableFlags;
+typedef int ImGuiTableColumnFlags;
+typedef int ImGuiTableRowFlags;
+typedef int ImGuiTreeNodeFlags;
+typedef int ImGuiWindowFlags;
+typedef int ImGuiMouseButton;
+typedef int ImGuiPopupFlags;
+typedef int ImGuiSliderFlags;
+
+struct ImVec2
+{
+    float x, y;
+    constexpr ImVec2() : x(0.0f), y(0.0f) {}
+    constexpr ImVec2(float _x, float _y) : x(_x), y(_y) {}
+};
+
+struct ImVec4
+{
+    float x, y, z, w;
+    constexpr ImVec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    constexpr ImVec4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+};
+
+struct ImDrawList;
+struct ImDrawCmd;
+typedef void (*ImDrawCallback)(const ImDrawList* parent_list, const ImDrawCmd* cmd);
+
+struct ImDrawCmd
+{
+    ImVec4 ClipRect;
+    ImTextureID TextureId = 0;
+    unsigned int VtxOffset = 0;
+    unsigned int IdxOffset = 0;
+    unsigned int ElemCount = 0;
+    ImDrawCallback UserCallback = nullptr;
+    void* UserCallbackData = nullptr;
+};
+
+struct ImDrawList
+{
+    void AddCallback(ImDrawCallback, void*) {}
+};
+
+struct ImGuiStyle
+{
+    float Alpha = 1.0f;
+    ImVec2 WindowPadding = ImVec2(8, 8);
+    ImVec2 FramePadding = ImVec2(4, 3);
+    ImVec2 ItemSpacing = ImVec2(8, 4);
+    ImVec2 ItemInnerSpacing = ImVec2(4, 4);
+};
+
+struct ImGuiIO
+{
+    float DeltaTime = 1.0f / 60.0f;
+    ImVec2 MousePos;
+    ImVec2 MouseDelta;
+};
+
+struct ImGuiListClipper
+{
+    int DisplayStart = 0;
+    int DisplayEnd = 0;
+    int ItemsCount = -1;
+
+    void Begin(int items_count, float = -1.0f) { ItemsCount = items_count; }
+    void End() {}
+    bool Step() { return false; }
+};
+
+enum ImGuiCol_ { ImGuiCol_Text, ImGuiCol_TextDisabled, ImGuiCol_WindowBg, ImGuiCol_Button, ImGuiCol_ButtonHovered, ImGuiCol_ButtonActive, ImGuiCol_Header };
+enum ImGuiCond_ { ImGuiCond_None = 0, ImGuiCond_Always = 1 << 0, ImGuiCond_Once = 1 << 1, ImGuiCond_FirstUseEver = 1 << 2, ImGuiCond_Appearing = 1 << 3 };
+enum ImGuiKey_ { ImGuiKey_None = 0, ImGuiKey_Tab = 512, ImGuiKey_Enter = 525, ImGuiKey_Escape = 526, ImGuiKey_Backspace = 523, ImGuiKey_Delete = 522 };
+enum ImGuiStyleVar_ { ImGuiStyleVar_Alpha, ImGuiStyleVar_WindowPadding, ImGuiStyleVar_FramePadding = 10, ImGuiStyleVar_ItemSpacing = 13 };
+enum ImGuiComboFlags_ { ImGuiComboFlags_None = 0 };
+enum ImGuiInputTextFlags_
+{
+    ImGuiInputTextFlags_None = 0,
+    ImGuiInputTextFlags_CharsDecimal = 1 << 0,
+    ImGuiInputTextFlags_CharsHexadecimal = 1 << 1,
+    ImGuiInputTextFlags_ReadOnly = 1 << 14,
+    ImGuiInputTextFlags_NoHorizontalScroll = 1 << 12,
+    ImGuiInputTextFlags_NoUndoRedo = 1 << 16
+};
+enum ImGuiSelectableFlags_ { ImGuiSelectableFlags_None = 0, ImGuiSelectableFlags_AllowDoubleClick = 1 << 2 };
+enum ImGuiTabBarFlags_ { ImGuiTabBarFlags_None = 0 };
+enum ImGuiTableFlags_
+{
+    ImGuiTableFlags_None = 0,
+    ImGuiTableFlags_Resizable = 1 << 0,
+    ImGuiTableFlags_RowBg = 1 << 6,
+    ImGuiTableFlags_BordersInnerH = 1 << 7,
+    ImGuiTableFlags_BordersOuterH = 1 << 8,
+    ImGuiTableFlags_BordersInnerV = 1 << 9,
+    ImGuiTableFlags_BordersOuterV = 1 << 10,
+    ImGuiTableFlags_Borders = ImGuiTableFlags_BordersInnerH | ImGuiTableFlags_BordersOuterH | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersOuterV,
+    ImGuiTableFlags_NoBordersInBody = 1 << 11,
+    ImGuiTableFlags_SizingStretchProp = 3 << 13,
+    ImGuiTableFlags_ScrollY = 1 << 25
+};
+enum ImGuiTableColumnFlags_ { ImGuiTableColumnFlags_None = 0, ImGuiTableColumnFlags_WidthFixed = 1 << 4, ImGuiTableColumnFlags_NoHeaderLabel = 1 << 13 };
+enum ImGuiTreeNodeFlags_ { ImGuiTreeNodeFlags_None = 0, ImGuiTreeNodeFlags_DefaultOpen = 1 << 5 };
+enum ImGuiWindowFlags_ { ImGuiWindowFlags_None = 0, ImGuiWindowFlags_AlwaysAutoResize = 1 << 6, ImGuiWindowFlags_NoFocusOnAppearing = 1 << 12 };
+
+namespace ImGui
+{
+    inline ImGuiIO& GetIO() { static ImGuiIO io; return io; }
+    inline ImGuiStyle& GetStyle() { static ImGuiStyle style; return style; }
+
+    inline bool Begin(const char*, bool* = nullptr, ImGuiWindowFlags = 0) { return false; }
+    inline void End() {}
+    inline bool BeginChild(const char*, const ImVec2& = ImVec2(0, 0), bool = false, ImGuiWindowFlags = 0) { return false; }
+    inline void EndChild() {}
+    inline void SetNextWindowSize(const ImVec2&, ImGuiCond = 0) {}
+    inline void SetNextWindowBgAlpha(float) {}
+    inline float GetWindowWidth() { return 800.0f; }
+    inline float GetWindowHeight() { return 600.0f; }
+    inline float GetFrameHeightWithSpacing() { return 20.0f; }
+    inline ImVec2 GetCursorPos() { return ImVec2(); }
+    inline void SetCursorPos(const ImVec2&) {}
+    inline void SetCursorPosX(float) {}
+    inline ImDrawList* GetWindowDrawList() { static ImDrawList list; return &list; }
+
+    inline void PushStyleVar(ImGuiStyleVar, float) {}
+    inline void PushStyleVar(ImGuiStyleVar, const ImVec2&) {}
+    inline void PopStyleVar(int = 1) {}
+    inline void PushStyleColor(ImGuiCol, const ImVec4&) {}
+    inline void PopStyleColor(int = 1) {}
+    inline void PushItemWidth(float) {}
+    inline void PopItemWidth() {}
+    inline void PushTextWrapPos(float = 0.0f) {}
+    inline void PopTextWrapPos() {}
+    inline void PushID(const char*) {}
+    inline void PushID(const void*) {}
+    inline void PushID(int) {}
+    inline void PopID() {}
+
+    inline void Separator() {}
+    inline void SameLine(float = 0.0f, float = -1.0f) {}
+    inline void AlignTextToFramePadding() {}
+    inline void BeginDisabled(bool = true) {}
+    inline void EndDisabled() {}
+
+    inline void TextUnformatted(const char*, const char* = nullptr) {}
+    inline void Text(const char*, ...) {}
+    inline void TextDisabled(const char*, ...) {}
+    inline void TextWrapped(const char*, ...) {}
+    inline void SetTooltip(const char*, ...) {}
+    inline void BeginTooltip() {}
+    inline void EndTooltip() {}
+
+    inline bool Button(const char*, const ImVec2& = ImVec2(0, 0)) { return false; }
+    inline bool SmallButton(const char*) { return false; }
+    inline void Image(ImTextureID, const ImVec2&, const ImVec2& = ImVec2(0, 0), const ImVec2& = ImVec2(1, 1), const ImVec4& = ImVec4(1, 1, 1, 1), const ImVec4& = ImVec4(0, 0, 0, 0)) {}
+    inline bool Checkbox(const char*, bool*) { return false; }
+    inline bool Selectable(const char*, bool = false, ImGuiSelectableFlags = 0, const ImVec2& = ImVec2(0, 0)) { return false; }
+    inline bool Selectable(const char*, bool*, ImGuiSelectableFlags = 0, const ImVec2& = ImVec2(0, 0)) { return false; }
+    inline bool BeginCombo(const char*, const char*, ImGuiComboFlags = 0) { return false; }
+    inline void EndCombo() {}
+    inline bool Combo(const char*, int*, const char* const[], int, int = -1) { return false; }
+    inline bool InputText(const char*, char*, size_t, ImGuiInputTextFlags = 0, void* = nullptr, void* = nullptr) { return false; }
+    inline bool InputTextWithHint(const char*, const char*, char*, size_t, ImGuiInputTextFlags = 0, void* = nullptr, void* = nullptr) { return false; }
+    inline bool InputInt(const char*, int*, int = 1, int = 100, ImGuiInputTextFlags = 0) { return false; }
+    inline bool SliderInt(const char*, int*, int, int, const char* = "%d", ImGuiSliderFlags = 0) { return false; }
+    inline bool SliderFloat(const char*, float*, float, float, const char* = "%.3f", ImGuiSliderFlags = 0) { return false; }
+    inline void PlotHistogram(const char*, const float*, int, int = 0, const char* = nullptr, float = 3.402823466e+38f, float = 3.402823466e+38f, ImVec2 = ImVec2(0, 0), int = sizeof(float)) {}
+    inline void SetItemDefaultFocus() {}
+
+    inline bool CollapsingHeader(const char*, ImGuiTreeNodeFlags = 0) { return false; }
+    inline bool TreeNode(const char*) { return false; }
+    inline bool TreeNode(const char*, const char*, ...) { return false; }
+    inline void TreePop() {}
+
+    inline bool BeginTabBar(const char*, ImGuiTabBarFlags = 0) { return false; }
+    inline void EndTabBar() {}
+    inline bool BeginTabItem(const char*, bool* = nullptr, ImGuiTabItemFlags = 0) { return false; }
+    inline void EndTabItem() {}
+
+    inline bool BeginTable(const char*, int, ImGuiTableFlags = 0, const ImVec2& = ImVec2(0.0f, 0.0f), float = 0.0f) { return false; }
+    inline void EndTable() {}
+    inline void TableNextRow(ImGuiTableRowFlags = 0, float = 0.0f) {}
+    inline bool TableNextColumn() { return false; }
+    inline void TableSetupColumn(const char*, ImGuiTableColumnFlags = 0, float = 0.0f, ImGuiID = 0) {}
+    inline void TableSetupScrollFreeze(int, int) {}
+    inline void TableHeadersRow() {}
+    inline void TableHeader(const char*) {}
+
+    inline void OpenPopup(const char*, ImGuiPopupFlags = 0) {}
+    inline bool BeginPopupModal(const char*, bool* = nullptr, ImGuiWindowFlags = 0) { return false; }
+    inline void EndPopup() {}
+    inline void CloseCurrentPopup() {}
+
+    inline bool IsItemHovered(int = 0) { return false; }
+    inline bool IsItemActive() { return false; }
+    inline bool IsItemFocused() { return false; }
+    inline bool IsKeyPressed(ImGuiKey, bool = true) { return false; }
+    inline bool IsMouseDoubleClicked(ImGuiMouseButton) { return false; }
+}
@@ -0,0 +1,16 @@
+// MSVC's intrinsics header. The addon uses SSE2 and the two bit scans, which are spelled out here so no -mlzcnt/-mbmi is
+// needed.
+
+#pragma once
+
+#include <emmintrin.h>
+
+inline unsigned int _lzcnt_u32(unsigned int value)
+{
+    return value == 0 ? 32 : __builtin_clz(value);
+}
+
+inline unsigned int _tzcnt_u32(unsigned int value)
+{
+    return value == 0 ? 32 : __builtin_ctz(value);
+}
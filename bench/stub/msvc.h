@@ -0,0 +1,19 @@
+// Force-included into every translation unit of the addon. Covers the MSVC keywords and CRT functions the addon uses before
+// it includes anything, and the standard headers MSVC's own headers pull in for it.
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#define __declspec(x)
+#define __fastcall __attribute__(())
+#define __stdcall __attribute__(())
+#define __cdecl __attribute__(())
+
+#define _snprintf_s(buffer, count, ...) snprintf(buffer, count, __VA_ARGS__)
+#define _vsnprintf_s(buffer, count, format, args) vsnprintf(buffer, count, format, args)
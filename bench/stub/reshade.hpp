@@ -0,0 +1,103 @@
+// Stand-in for ReShade's reshade.hpp. ReShade exports the registration functions from its module, here they keep the event
+// lists in process so the bench harness can dispatch events the way ReShade does, through whatever the addon registered.
+
+#pragma once
+
+#include <windows.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "reshade_events.hpp"
+
+namespace reshade
+{
+    enum class log_level
+    {
+        error = 1,
+        warning = 2,
+        info = 3,
+        debug = 4
+    };
+
+    namespace internal
+    {
+        inline std::vector<void*> event_lists[static_cast<size_t>(addon_event::max)];
+        inline void(*overlay_callback)(api::effect_runtime* runtime) = nullptr;
+        inline log_level log_threshold = log_level::warning;
+    }
+
+    /// <summary>
+    /// Messages above the bench's log threshold are dropped, the rest go to stderr.
+    /// </summary>
+    inline void log_message(log_level level, const char* message)
+    {
+        if (level <= internal::log_threshold)
+        {
+            fprintf(stderr, "%s | %s\n", level == log_level::error ? "ERROR" : level == log_level::warning ? "WARN " : level == log_level::info ? "INFO " : "DEBUG", message);
+        }
+    }
+
+    inline bool register_addon(HMODULE, HMODULE = nullptr)
+    {
+        return true;
+    }
+
+    inline void unregister_addon(HMODULE, HMODULE = nullptr)
+    {
+    }
+
+    template<addon_event ev>
+    inline void register_event(typename addon_event_traits<ev>::decl callback)
+    {
+        internal::event_lists[static_cast<size_t>(ev)].push_back(reinterpret_cast<void*>(callback));
+    }
+
+    template<addon_event ev>
+    inline void unregister_event(typename addon_event_traits<ev>::decl callback)
+    {
+        auto& list = internal::event_lists[static_cast<size_t>(ev)];
+        const auto it = std::find(list.begin(), list.end(), reinterpret_cast<void*>(callback));
+        if (it != list.end())
+        {
+            list.erase(it);
+        }
+    }
+
+    inline void register_overlay(const char*, void(*callback)(api::effect_runtime* runtime))
+    {
+        internal::overlay_callback = callback;
+    }
+
+    inline void unregister_overlay(const char*, void(*)(api::effect_runtime* runtime))
+    {
+        internal::overlay_callback = nullptr;
+    }
+
+    /// <summary>
+    /// Calls every callback registered for the event, as ReShade does where the API call happens. For events which can skip the
+    /// call, returns whether any callback asked to.
+    /// </summary>
+    template<addon_event ev, typename... Args>
+    inline typename addon_event_traits<ev>::type invoke_addon_event(Args&&... args)
+    {
+        using decl = typename addon_event_traits<ev>::decl;
+        const auto& list = internal::event_lists[static_cast<size_t>(ev)];
+
+        if constexpr (std::is_same_v<typename addon_event_traits<ev>::type, bool>)
+        {
+            bool skip = false;
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                skip |= reinterpret_cast<decl>(list[i])(args...);
+            }
+            return skip;
+        }
+        else
+        {
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                reinterpret_cast<decl>(list[i])(args...);
+            }
+        }
+    }
+}
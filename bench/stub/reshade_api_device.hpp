@@ -0,0 +1,220 @@
+// Subset of ReShade's reshade_api_device.hpp the addon uses. The interfaces keep ReShade's shape, abstract classes a runtime
+// implements, so the bench harness can provide its own device, command lists and queues.
+
+#pragma once
+
+#include "reshade_api_pipeline.hpp"
+
+namespace reshade::api
+{
+    enum class device_api
+    {
+        d3d9 = 0x9000,
+        d3d10 = 0xa000,
+        d3d11 = 0xb000,
+        d3d12 = 0xc000,
+        opengl = 0x10000,
+        vulkan = 0x20000
+    };
+
+    enum class indirect_command
+    {
+        unknown,
+        draw,
+        draw_indexed,
+        dispatch,
+        dispatch_mesh,
+        dispatch_rays
+    };
+
+    struct viewport
+    {
+        float x, y;
+        float width, height;
+        float min_depth, max_depth;
+    };
+
+    struct rect
+    {
+        int32_t left;
+        int32_t top;
+        int32_t right;
+        int32_t bottom;
+
+        constexpr uint32_t width() const { return right - left; }
+        constexpr uint32_t height() const { return bottom - top; }
+    };
+
+    struct buffer_range
+    {
+        resource buffer = { 0 };
+        uint64_t offset = 0;
+        uint64_t size = UINT64_MAX;
+    };
+
+    struct sampler_with_resource_view
+    {
+        api::sampler sampler = { 0 };
+        resource_view view = { 0 };
+    };
+
+    enum class render_pass_load_op : uint32_t
+    {
+        load,
+        clear,
+        discard,
+        no_access
+    };
+
+    enum class render_pass_store_op : uint32_t
+    {
+        store,
+        discard,
+        no_access
+    };
+
+    struct render_pass_render_target_desc
+    {
+        resource_view view = { 0 };
+        render_pass_load_op load_op = render_pass_load_op::load;
+        render_pass_store_op store_op = render_pass_store_op::store;
+        float clear_color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    };
+
+    struct render_pass_depth_stencil_desc
+    {
+        resource_view view = { 0 };
+        render_pass_load_op depth_load_op = render_pass_load_op::load;
+        render_pass_store_op depth_store_op = render_pass_store_op::store;
+        render_pass_load_op stencil_load_op = render_pass_load_op::load;
+        render_pass_store_op stencil_store_op = render_pass_store_op::store;
+        float clear_depth = 0.0f;
+        uint8_t clear_stencil = 0;
+    };
+
+    /// <summary>
+    /// The private data key for T. ReShade uses the type's __uuidof, which isn't available here, so every type gets the address
+    /// of its own static instead.
+    /// </summary>
+    template<typename T>
+    struct private_data_key
+    {
+        static inline const uint8_t guid[16] = {};
+    };
+
+    struct __declspec(novtable) api_object
+    {
+        virtual bool get_private_data(const uint8_t guid[16], uint64_t* data) const = 0;
+        virtual void set_private_data(const uint8_t guid[16], const uint64_t data) = 0;
+
+        virtual uint64_t get_native() const = 0;
+
+        template<typename T>
+        T& get_private_data() const
+        {
+            uint64_t res = 0;
+            get_private_data(private_data_key<T>::guid, &res);
+            return *reinterpret_cast<T*>(static_cast<uintptr_t>(res));
+        }
+
+        template<typename T>
+        T& create_private_data()
+        {
+            uint64_t res = reinterpret_cast<uintptr_t>(new T());
+            set_private_data(private_data_key<T>::guid, res);
+            return *reinterpret_cast<T*>(static_cast<uintptr_t>(res));
+        }
+
+        template<typename T>
+        void destroy_private_data()
+        {
+            uint64_t res = 0;
+            get_private_data(private_data_key<T>::guid, &res);
+            delete reinterpret_cast<T*>(static_cast<uintptr_t>(res));
+            set_private_data(private_data_key<T>::guid, 0);
+        }
+
+    protected:
+        ~api_object() = default;
+    };
+
+    struct __declspec(novtable) device : public api_object
+    {
+        virtual device_api get_api() const = 0;
+
+        virtual bool create_resource(const resource_desc& desc, const subresource_data* initial_data, resource_usage initial_state, resource* out_handle, void** shared_handle = nullptr) = 0;
+        virtual void destroy_resource(resource handle) = 0;
+        virtual resource_desc get_resource_desc(resource resource) const = 0;
+
+        virtual bool create_resource_view(resource resource, resource_usage usage_type, const resource_view_desc& desc, resource_view* out_handle) = 0;
+        virtual void destroy_resource_view(resource_view handle) = 0;
+        virtual resource get_resource_from_view(resource_view view) const = 0;
+        virtual resource_view_desc get_resource_view_desc(resource_view view) const = 0;
+
+        virtual bool map_buffer_region(resource resource, uint64_t offset, uint64_t size, map_access access, void** out_data) = 0;
+        virtual void unmap_buffer_region(resource resource) = 0;
+
+    protected:
+        ~device() = default;
+    };
+
+    struct __declspec(novtable) device_object : public api_object
+    {
+        virtual device* get_device() = 0;
+
+    protected:
+        ~device_object() = default;
+    };
+
+    struct __declspec(novtable) command_list : public device_object
+    {
+        virtual void bind_pipeline(pipeline_stage stages, pipeline pipeline) = 0;
+        virtual void bind_pipeline_states(uint32_t count, const dynamic_state* states, const uint32_t* values) = 0;
+        virtual void bind_viewports(uint32_t first, uint32_t count, const viewport* viewports) = 0;
+        virtual void bind_scissor_rects(uint32_t first, uint32_t count, const rect* rects) = 0;
+        virtual void bind_descriptor_tables(shader_stage stages, pipeline_layout layout, uint32_t first, uint32_t count, const descriptor_table* tables) = 0;
+        virtual void bind_render_targets_and_depth_stencil(uint32_t count, const resource_view* rtvs, resource_view dsv = { 0 }) = 0;
+
+        virtual void copy_resource(resource source, resource dest) = 0;
+        virtual void clear_render_target_view(resource_view rtv, const float color[4], uint32_t rect_count = 0, const rect* rects = nullptr) = 0;
+
+        void bind_pipeline_state(dynamic_state state, uint32_t value) { bind_pipeline_states(1, &state, &value); }
+
+    protected:
+        ~command_list() = default;
+    };
+
+    struct __declspec(novtable) command_queue : public device_object
+    {
+        virtual command_list* get_immediate_command_list() = 0;
+        virtual void flush_immediate_command_list() const = 0;
+        virtual void wait_idle() const = 0;
+
+    protected:
+        ~command_queue() = default;
+    };
+
+    struct swapchain_desc
+    {
+        resource_desc back_buffer;
+        uint32_t back_buffer_count = 0;
+        uint32_t present_mode = 0;
+        uint32_t present_flags = 0;
+        bool fullscreen_state = false;
+        uint32_t fullscreen_refresh_rate = 0;
+        uint32_t sync_interval = UINT32_MAX;
+    };
+
+    struct __declspec(novtable) swapchain : public device_object
+    {
+        virtual void* get_hwnd() const = 0;
+        virtual resource get_back_buffer(uint32_t index) = 0;
+        virtual uint32_t get_back_buffer_count() const = 0;
+        virtual uint32_t get_current_back_buffer_index() const = 0;
+
+        resource get_current_back_buffer() { return get_back_buffer(get_current_back_buffer_index()); }
+
+    protected:
+        ~swapchain() = default;
+    };
+}
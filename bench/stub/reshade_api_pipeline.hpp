@@ -0,0 +1,234 @@
+// Subset of ReShade's reshade_api_pipeline.hpp the addon uses.
+
+#pragma once
+
+#include "reshade_api_resource.hpp"
+
+namespace reshade::api
+{
+    enum class shader_stage : uint32_t
+    {
+        vertex = 0x1,
+        hull = 0x2,
+        domain = 0x4,
+        geometry = 0x8,
+        pixel = 0x10,
+        compute = 0x20,
+
+        all = 0x7FFFFFFF,
+        all_compute = compute,
+        all_graphics = vertex | hull | domain | geometry | pixel
+    };
+    RESHADE_DEFINE_ENUM_FLAG_OPERATORS(shader_stage);
+
+    enum class pipeline_stage : uint32_t
+    {
+        vertex_shader = 0x8,
+        hull_shader = 0x10,
+        domain_shader = 0x20,
+        geometry_shader = 0x40,
+        pixel_shader = 0x80,
+        compute_shader = 0x800,
+
+        input_assembler = 0x2,
+        stream_output = 0x4,
+        rasterizer = 0x100,
+        depth_stencil = 0x200,
+        output_merger = 0x400,
+
+        all = 0x7FFFFFFF,
+        all_compute = compute_shader,
+        all_graphics = vertex_shader | hull_shader | domain_shader | geometry_shader | pixel_shader | input_assembler | stream_output | rasterizer | depth_stencil | output_merger,
+        all_shader_stages = vertex_shader | hull_shader | domain_shader | geometry_shader | pixel_shader | compute_shader
+    };
+    RESHADE_DEFINE_ENUM_FLAG_OPERATORS(pipeline_stage);
+
+    enum class descriptor_type : uint32_t
+    {
+        sampler = 0,
+        sampler_with_resource_view = 1,
+        shader_resource_view = 2,
+        unordered_access_view = 3,
+        buffer_shader_resource_view = 4,
+        buffer_unordered_access_view = 5,
+        constant_buffer = 6,
+        shader_storage_buffer = 7,
+        acceleration_structure = 8
+    };
+
+    struct constant_range
+    {
+        uint32_t offset = 0;
+        uint32_t binding = 0;
+        uint32_t dx_register_index = 0;
+        uint32_t dx_register_space = 0;
+        uint32_t count = 0;
+        shader_stage visibility = shader_stage::all;
+    };
+
+    struct descriptor_range
+    {
+        uint32_t offset = 0;
+        uint32_t binding = 0;
+        uint32_t dx_register_index = 0;
+        uint32_t dx_register_space = 0;
+        uint32_t count = 0;
+        uint32_t array_size = 1;
+        descriptor_type type = descriptor_type::sampler;
+        shader_stage visibility = shader_stage::all;
+    };
+
+    enum class pipeline_layout_param_type : uint32_t
+    {
+        push_constants = 1,
+        descriptor_table = 0,
+        push_descriptors = 2,
+        push_descriptors_with_ranges = 3
+    };
+
+    struct pipeline_layout_param
+    {
+        constexpr pipeline_layout_param() : push_descriptors() {}
+        constexpr pipeline_layout_param(const constant_range& push_constants) : type(pipeline_layout_param_type::push_constants), push_constants(push_constants) {}
+        constexpr pipeline_layout_param(const descriptor_range& push_descriptors) : type(pipeline_layout_param_type::push_descriptors), push_descriptors(push_descriptors) {}
+
+        pipeline_layout_param_type type = pipeline_layout_param_type::push_descriptors;
+
+        union
+        {
+            constant_range push_constants;
+            descriptor_range push_descriptors;
+            struct
+            {
+                uint32_t count;
+                const descriptor_range* ranges;
+            } descriptor_table;
+        };
+    };
+
+    struct shader_desc
+    {
+        const void* code = nullptr;
+        size_t code_size = 0;
+        const char* entry_point = nullptr;
+        uint32_t spec_constants = 0;
+        const uint32_t* spec_constant_ids = nullptr;
+        const uint32_t* spec_constant_values = nullptr;
+    };
+
+    enum class pipeline_subobject_type : uint32_t
+    {
+        unknown,
+        vertex_shader,
+        hull_shader,
+        domain_shader,
+        geometry_shader,
+        pixel_shader,
+        compute_shader,
+        input_layout,
+        stream_output_state,
+        blend_state,
+        sample_mask,
+        rasterizer_state,
+        depth_stencil_state,
+        primitive_topology,
+        depth_stencil_format,
+        render_target_formats,
+        sample_count,
+        viewport_count,
+        dynamic_pipeline_states,
+        max_vertex_count
+    };
+
+    struct pipeline_subobject
+    {
+        pipeline_subobject_type type = pipeline_subobject_type::unknown;
+        uint32_t count = 0;
+        void* data = nullptr;
+    };
+
+    RESHADE_DEFINE_HANDLE(pipeline_layout);
+    RESHADE_DEFINE_HANDLE(pipeline);
+
+    enum class dynamic_state : uint32_t
+    {
+        unknown = 0,
+        alpha_test_enable = 15,
+        alpha_reference_value = 24,
+        alpha_func = 25,
+        srgb_write_enable = 194,
+        primitive_topology = 1000,
+        sample_mask = 162,
+        alpha_to_coverage_enable = 1003,
+        blend_enable = 27,
+        logic_op_enable = 1004,
+        color_blend_op = 171,
+        source_color_blend_factor = 19,
+        dest_color_blend_factor = 20,
+        alpha_blend_op = 209,
+        source_alpha_blend_factor = 207,
+        dest_alpha_blend_factor = 208,
+        logic_op = 1005,
+        blend_constant = 193,
+        render_target_write_mask = 168,
+        fill_mode = 8,
+        cull_mode = 22,
+        front_counter_clockwise = 1001,
+        depth_bias = 195,
+        depth_bias_clamp = 1002,
+        depth_bias_slope_scaled = 175,
+        depth_clip_enable = 136,
+        scissor_enable = 174,
+        multisample_enable = 161,
+        antialiased_line_enable = 176,
+        depth_enable = 7,
+        depth_write_mask = 14,
+        depth_func = 23,
+        stencil_enable = 52,
+        stencil_read_mask = 58,
+        stencil_write_mask = 59,
+        stencil_reference_value = 57,
+        front_stencil_func = 56,
+        front_stencil_pass_op = 55,
+        front_stencil_fail_op = 53,
+        front_stencil_depth_fail_op = 54,
+        back_stencil_func = 189,
+        back_stencil_pass_op = 188,
+        back_stencil_fail_op = 186,
+        back_stencil_depth_fail_op = 187
+    };
+
+    RESHADE_DEFINE_HANDLE(descriptor_table);
+
+    struct descriptor_table_copy
+    {
+        descriptor_table source_table;
+        uint32_t source_binding;
+        uint32_t source_array_offset;
+        descriptor_table dest_table;
+        uint32_t dest_binding;
+        uint32_t dest_array_offset;
+        uint32_t count;
+    };
+
+    struct descriptor_table_update
+    {
+        descriptor_table table = {};
+        uint32_t binding = 0;
+        uint32_t array_offset = 0;
+        uint32_t count = 0;
+        descriptor_type type = descriptor_type::sampler;
+        const void* descriptors = nullptr;
+    };
+
+    RESHADE_DEFINE_HANDLE(descriptor_heap);
+    RESHADE_DEFINE_HANDLE(query_heap);
+
+    enum class query_type
+    {
+        occlusion = 0,
+        binary_occlusion = 1,
+        timestamp = 2,
+        pipeline_statistics = 3
+    };
+}
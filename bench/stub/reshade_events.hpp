@@ -0,0 +1,118 @@
+// Subset of ReShade's reshade_events.hpp the addon uses. Values are ReShade's.
+
+#pragma once
+
+#include "reshade_api.hpp"
+
+namespace reshade
+{
+    enum class addon_event : uint32_t
+    {
+        init_device = 0,
+        destroy_device = 1,
+        init_command_list = 2,
+        destroy_command_list = 3,
+        init_command_queue = 4,
+        destroy_command_queue = 5,
+        init_swapchain = 6,
+        create_swapchain = 64,
+        destroy_swapchain = 7,
+        init_effect_runtime = 8,
+        destroy_effect_runtime = 9,
+        init_sampler = 10,
+        create_sampler = 65,
+        destroy_sampler = 11,
+        init_resource = 12,
+        create_resource = 66,
+        destroy_resource = 13,
+        init_resource_view = 14,
+        create_resource_view = 67,
+        destroy_resource_view = 15,
+        map_buffer_region = 73,
+        unmap_buffer_region = 74,
+        update_buffer_region = 34,
+        init_pipeline = 16,
+        create_pipeline = 68,
+        destroy_pipeline = 17,
+        init_pipeline_layout = 18,
+        create_pipeline_layout = 69,
+        destroy_pipeline_layout = 19,
+        barrier = 23,
+        begin_render_pass = 24,
+        end_render_pass = 25,
+        bind_render_targets_and_depth_stencil = 26,
+        bind_pipeline = 27,
+        bind_pipeline_states = 28,
+        bind_viewports = 29,
+        bind_scissor_rects = 30,
+        push_constants = 31,
+        push_descriptors = 32,
+        bind_descriptor_tables = 33,
+        draw = 37,
+        draw_indexed = 38,
+        draw_or_dispatch_indirect = 40,
+        reset_command_list = 54,
+        close_command_list = 55,
+        present = 57,
+        reshade_present = 59,
+        reshade_overlay = 61,
+        reshade_reloaded_effects = 62,
+        reshade_set_technique_state = 79,
+
+        max = 98
+    };
+
+    template<addon_event ev>
+    struct addon_event_traits;
+
+#define RESHADE_DEFINE_ADDON_EVENT_TRAITS(ev, ret, ...) \
+    template<> \
+    struct addon_event_traits<ev> \
+    { \
+        using decl = ret(*)(__VA_ARGS__); \
+        using type = ret; \
+    }
+
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::init_device, void, api::device* device);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::destroy_device, void, api::device* device);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::init_command_list, void, api::command_list* cmd_list);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::destroy_command_list, void, api::command_list* cmd_list);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::init_swapchain, void, api::swapchain* swapchain);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::destroy_swapchain, void, api::swapchain* swapchain);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::init_effect_runtime, void, api::effect_runtime* runtime);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::destroy_effect_runtime, void, api::effect_runtime* runtime);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::init_resource, void, api::device* device, const api::resource_desc& desc, const api::subresource_data* initial_data, api::resource_usage initial_state, api::resource resource);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::create_resource, bool, api::device* device, api::resource_desc& desc, api::subresource_data* initial_data, api::resource_usage initial_state);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::destroy_resource, void, api::device* device, api::resource resource);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::init_resource_view, void, api::device* device, api::resource resource, api::resource_usage usage_type, const api::resource_view_desc& desc, api::resource_view view);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::create_resource_view, bool, api::device* device, api::resource resource, api::resource_usage usage_type, api::resource_view_desc& desc);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::destroy_resource_view, void, api::device* device, api::resource_view view);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::map_buffer_region, void, api::device* device, api::resource resource, uint64_t offset, uint64_t size, api::map_access access, void** data);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::unmap_buffer_region, void, api::device* device, api::resource resource);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::update_buffer_region, bool, api::device* device, const void* data, api::resource resource, uint64_t offset, uint64_t size);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::init_pipeline, void, api::device* device, api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject* subobjects, api::pipeline pipeline);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::destroy_pipeline, void, api::device* device, api::pipeline pipeline);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::init_pipeline_layout, void, api::device* device, uint32_t param_count, const api::pipeline_layout_param* params, api::pipeline_layout layout);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::destroy_pipeline_layout, void, api::device* device, api::pipeline_layout layout);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::begin_render_pass, void, api::command_list* cmd_list, uint32_t count, const api::render_pass_render_target_desc* rts, const api::render_pass_depth_stencil_desc* ds);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::bind_render_targets_and_depth_stencil, void, api::command_list* cmd_list, uint32_t count, const api::resource_view* rtvs, api::resource_view dsv);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::bind_pipeline, void, api::command_list* cmd_list, api::pipeline_stage stages, api::pipeline pipeline);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::bind_pipeline_states, void, api::command_list* cmd_list, uint32_t count, const api::dynamic_state* states, const uint32_t* values);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::bind_viewports, void, api::command_list* cmd_list, uint32_t first, uint32_t count, const api::viewport* viewports);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::bind_scissor_rects, void, api::command_list* cmd_list, uint32_t first, uint32_t count, const api::rect* rects);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::push_constants, void, api::command_list* cmd_list, api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, uint32_t first, uint32_t count, const void* values);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::push_descriptors, void, api::command_list* cmd_list, api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update& update);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::bind_descriptor_tables, void, api::command_list* cmd_list, api::shader_stage stages, api::pipeline_layout layout, uint32_t first, uint32_t count, const api::descriptor_table* tables);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::draw, bool, api::command_list* cmd_list, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::draw_indexed, bool, api::command_list* cmd_list, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::draw_or_dispatch_indirect, bool, api::command_list* cmd_list, api::indirect_command type, api::resource buffer, uint64_t offset, uint32_t draw_count, uint32_t stride);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::reset_command_list, void, api::command_list* cmd_list);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::close_command_list, void, api::command_list* cmd_list);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::present, void, api::command_queue* queue, api::swapchain* swapchain, const api::rect* source_rect, const api::rect* dest_rect, uint32_t dirty_rect_count, const api::rect* dirty_rects);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::reshade_present, void, api::effect_runtime* runtime);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::reshade_overlay, void, api::effect_runtime* runtime);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::reshade_reloaded_effects, void, api::effect_runtime* runtime);
+    RESHADE_DEFINE_ADDON_EVENT_TRAITS(addon_event::reshade_set_technique_state, bool, api::effect_runtime* runtime, api::effect_technique technique, bool enabled);
+
+#undef RESHADE_DEFINE_ADDON_EVENT_TRAITS
+}
@@ -0,0 +1,5 @@
+// Nothing from this header is used outside of windows.h, which the bench provides.
+
+#pragma once
+
+#include <windows.h>
@@ -0,0 +1,13 @@
+// tsl::robin_map, with std::unordered_map standing in for it. Lookups are slower than the real one's, which the bench's
+// numbers for the shader managers reflect.
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+
+namespace tsl
+{
+    template<class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+    using robin_map = std::unordered_map<Key, T, Hash, KeyEqual>;
+}
@@ -0,0 +1,330 @@
+// The part of the Win32 API the addon uses, enough to build it on other platforms. Nothing here reaches the OS: modules
+// aren't found, files aren't created, so the addon takes the same paths it takes when a game lacks what it looks for. Only
+// the addon's own module path is answered, from BenchStub::ModuleFileName, as the config lives next to it.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+#include <string>
+#include <strings.h>
+#include <thread>
+#include <unistd.h>
+
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef unsigned int UINT;
+typedef int64_t LONGLONG;
+typedef uintptr_t ULONG_PTR;
+typedef size_t SIZE_T;
+typedef wchar_t WCHAR;
+typedef char CHAR;
+typedef char TCHAR;
+typedef void* HANDLE;
+typedef void* LPVOID;
+typedef const void* LPCVOID;
+typedef const char* LPCSTR;
+typedef const char* LPCTSTR;
+typedef char* LPSTR;
+typedef const wchar_t* LPCWSTR;
+typedef wchar_t* LPWSTR;
+typedef long HRESULT;
+
+struct HINSTANCE__;
+typedef HINSTANCE__* HMODULE;
+typedef HINSTANCE__* HINSTANCE;
+struct HRSRC__;
+typedef HRSRC__* HRSRC;
+typedef void* HGLOBAL;
+typedef int (*FARPROC)();
+typedef DWORD (*LPTHREAD_START_ROUTINE)(LPVOID);
+
+union LARGE_INTEGER
+{
+    struct
+    {
+        DWORD LowPart;
+        LONG HighPart;
+    };
+    LONGLONG QuadPart;
+};
+
+#define WINAPI
+#define APIENTRY
+#define CALLBACK
+
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(static_cast<intptr_t>(-1)))
+#define MAKEINTRESOURCE(i) (reinterpret_cast<LPCTSTR>(static_cast<ULONG_PTR>(static_cast<WORD>(i))))
+#define RT_RCDATA MAKEINTRESOURCE(10)
+#define S_OK 0L
+
+#define DLL_PROCESS_ATTACH 1
+#define DLL_PROCESS_DETACH 0
+
+#define GENERIC_READ 0x80000000u
+#define GENERIC_WRITE 0x40000000u
+#define CREATE_ALWAYS 2
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define PAGE_READWRITE 0x04
+#define FILE_MAP_WRITE 0x0002
+#define FILE_BEGIN 0
+#define GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS 0x00000004
+
+#define VK_BACK 0x08
+#define VK_TAB 0x09
+#define VK_RETURN 0x0D
+#define VK_SHIFT 0x10
+#define VK_CONTROL 0x11
+#define VK_MENU 0x12
+#define VK_CAPITAL 0x14
+#define VK_ESCAPE 0x1B
+#define VK_SPACE 0x20
+#define VK_XBUTTON2 0x06
+#define VK_NUMPAD0 0x60
+#define VK_NUMPAD1 0x61
+#define VK_NUMPAD2 0x62
+#define VK_NUMPAD3 0x63
+#define VK_NUMPAD4 0x64
+#define VK_NUMPAD5 0x65
+#define VK_NUMPAD6 0x66
+#define VK_NUMPAD7 0x67
+#define VK_NUMPAD8 0x68
+#define VK_NUMPAD9 0x69
+#define VK_MULTIPLY 0x6A
+#define VK_ADD 0x6B
+#define VK_SUBTRACT 0x6D
+#define VK_DECIMAL 0x6E
+#define VK_DIVIDE 0x6F
+#define VK_F1 0x70
+#define VK_F10 0x79
+#define VK_F11 0x7A
+#define VK_F12 0x7B
+
+#define IMAGE_SCN_MEM_EXECUTE 0x20000000
+
+struct IMAGE_DOS_HEADER
+{
+    WORD e_magic;
+    WORD e_unused[29];
+    LONG e_lfanew;
+};
+
+struct IMAGE_FILE_HEADER
+{
+    WORD Machine;
+    WORD NumberOfSections;
+    DWORD TimeDateStamp;
+    DWORD PointerToSymbolTable;
+    DWORD NumberOfSymbols;
+    WORD SizeOfOptionalHeader;
+    WORD Characteristics;
+};
+
+struct IMAGE_OPTIONAL_HEADER
+{
+    WORD Magic;
+    BYTE MajorLinkerVersion;
+    BYTE MinorLinkerVersion;
+    DWORD SizeOfCode;
+    DWORD SizeOfInitializedData;
+    DWORD SizeOfUninitializedData;
+    DWORD AddressOfEntryPoint;
+    DWORD BaseOfCode;
+    uint64_t ImageBase;
+    DWORD SectionAlignment;
+    DWORD FileAlignment;
+    WORD MajorOperatingSystemVersion;
+    WORD MinorOperatingSystemVersion;
+    WORD MajorImageVersion;
+    WORD MinorImageVersion;
+    WORD MajorSubsystemVersion;
+    WORD MinorSubsystemVersion;
+    DWORD Win32VersionValue;
+    DWORD SizeOfImage;
+    DWORD SizeOfHeaders;
+    DWORD CheckSum;
+};
+
+struct IMAGE_NT_HEADERS
+{
+    DWORD Signature;
+    IMAGE_FILE_HEADER FileHeader;
+    IMAGE_OPTIONAL_HEADER OptionalHeader;
+};
+
+struct IMAGE_SECTION_HEADER
+{
+    BYTE Name[8];
+    union
+    {
+        DWORD PhysicalAddress;
+        DWORD VirtualSize;
+    } Misc;
+    DWORD VirtualAddress;
+    DWORD SizeOfRawData;
+    DWORD PointerToRawData;
+    DWORD PointerToRelocations;
+    DWORD PointerToLinenumbers;
+    WORD NumberOfRelocations;
+    WORD NumberOfLinenumbers;
+    DWORD Characteristics;
+};
+
+#define IMAGE_FIRST_SECTION(ntheader) (reinterpret_cast<const IMAGE_SECTION_HEADER*>(reinterpret_cast<const uint8_t*>(ntheader) + \
+    offsetof(IMAGE_NT_HEADERS, OptionalHeader) + (ntheader)->FileHeader.SizeOfOptionalHeader))
+
+namespace BenchStub
+{
+    /// <summary>
+    /// What GetModuleFileName answers for the addon's module, set by the harness before it loads the addon.
+    /// </summary>
+    inline std::filesystem::path ModuleFileName;
+}
+
+inline DWORD GetCurrentThreadId()
+{
+    return static_cast<DWORD>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+inline DWORD GetCurrentProcessId()
+{
+    return static_cast<DWORD>(getpid());
+}
+
+inline DWORD GetModuleFileNameW(HMODULE module, LPWSTR fileName, DWORD size)
+{
+    const std::wstring name = module != nullptr ? BenchStub::ModuleFileName.wstring() : std::wstring();
+    if (name.empty() || name.size() >= size)
+    {
+        return 0;
+    }
+
+    wcscpy(fileName, name.c_str());
+    return static_cast<DWORD>(name.size());
+}
+
+inline DWORD GetModuleFileNameA(HMODULE module, LPSTR fileName, DWORD size)
+{
+    const std::string name = module != nullptr ? BenchStub::ModuleFileName.string() : std::string();
+    if (name.empty() || name.size() >= size)
+    {
+        return 0;
+    }
+
+    strcpy(fileName, name.c_str());
+    return static_cast<DWORD>(name.size());
+}
+
+inline HMODULE GetModuleHandleW(LPCWSTR)
+{
+    return nullptr;
+}
+
+inline BOOL GetModuleHandleEx(DWORD, LPCTSTR, HMODULE* module)
+{
+    *module = nullptr;
+    return FALSE;
+}
+
+inline BOOL GetModuleHandleExW(DWORD, LPCWSTR, HMODULE* module)
+{
+    *module = nullptr;
+    return FALSE;
+}
+
+// Threads run detached, the handle only stands for success
+inline HANDLE CreateThread(void*, SIZE_T, LPTHREAD_START_ROUTINE start, LPVOID parameter, DWORD, DWORD*)
+{
+    std::thread([start, parameter] { start(parameter); }).detach();
+    return reinterpret_cast<HANDLE>(static_cast<intptr_t>(1));
+}
+
+// No module is ever found, so there's never a reference to give back
+[[noreturn]] inline void FreeLibraryAndExitThread(HMODULE, DWORD)
+{
+    std::terminate();
+}
+
+inline FARPROC GetProcAddress(HMODULE, LPCSTR)
+{
+    return nullptr;
+}
+
+inline HRSRC FindResource(HMODULE, LPCTSTR, LPCTSTR)
+{
+    return nullptr;
+}
+
+inline DWORD SizeofResource(HMODULE, HRSRC)
+{
+    return 0;
+}
+
+inline HGLOBAL LoadResource(HMODULE, HRSRC)
+{
+    return nullptr;
+}
+
+inline LPVOID LockResource(HGLOBAL)
+{
+    return nullptr;
+}
+
+inline HANDLE CreateFileW(const std::filesystem::path&, DWORD, DWORD, void*, DWORD, DWORD, HANDLE)
+{
+    return INVALID_HANDLE_VALUE;
+}
+
+inline HANDLE CreateFileMappingW(HANDLE, void*, DWORD, DWORD, DWORD, LPCWSTR)
+{
+    return nullptr;
+}
+
+inline LPVOID MapViewOfFile(HANDLE, DWORD, DWORD, DWORD, SIZE_T)
+{
+    return nullptr;
+}
+
+inline BOOL UnmapViewOfFile(LPCVOID)
+{
+    return TRUE;
+}
+
+inline BOOL CloseHandle(HANDLE)
+{
+    return TRUE;
+}
+
+inline BOOL SetFilePointerEx(HANDLE, LARGE_INTEGER, LARGE_INTEGER*, DWORD)
+{
+    return FALSE;
+}
+
+inline BOOL SetEndOfFile(HANDLE)
+{
+    return FALSE;
+}
+
+inline int _stricmp(const char* a, const char* b)
+{
+    return strcasecmp(a, b);
+}
+
+inline int strncpy_s(char* dest, size_t size, const char* src, size_t count)
+{
+    const size_t n = count < size - 1 ? count : size - 1;
+    memcpy(dest, src, n);
+    dest[n] = '\0';
+    return 0;
+}
@@ -310,6 +310,21 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
 
             ImGui::Checkbox("Use previous value", &prevValue);
 
+            static int elementCount = 1;
+            const auto& selectedVar = instance.GetRESTVariables()->find(varSelectedItem);
+            const bool isArray = selectedVar != instance.GetRESTVariables()->end() && Shim::Constants::type_is_array(std::get<0>(selectedVar->second));
+
+            if (!isArray)
+            {
+                ImGui::BeginDisabled();
+            }
+            ImGui::InputInt("Elements", &elementCount);
+            elementCount = std::max(elementCount, 1);
+            if (!isArray)
+            {
+                ImGui::EndDisabled();
+            }
+
             ImGui::Separator();
 
             ImGui::SetCursorPosX(ImGui::GetWindowWidth() / 2 - 120 - ImGui::GetStyle().ItemSpacing.x / 2 - ImGui::GetStyle().FramePadding.x / 2);
@@ -317,7 +332,7 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
             {
                 if (varSelectedItem.size() > 0)
                 {
-                    group->SetVarMapping(std::stoul(std::string(offsetInputBuf), nullptr, 16), varSelectedItem, prevValue);
+                    group->SetVarMapping(std::stoul(std::string(offsetInputBuf), nullptr, 16), varSelectedItem, prevValue, isArray ? static_cast<uint32_t>(elementCount) : 1);
                 }
                 ImGui::CloseCurrentPopup();
             }
@@ -331,7 +346,7 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
             ImGui::EndPopup();
         }
 
-        const char* varColumns[] = { "Variable", "Offset", "Type", "Use Previous Value" };
+        const char* varColumns[] = { "Variable", "Offset", "Type", "Elements", "Use Previous Value" };
         std::vector<std::string> removal;
 
         if (varMap.size() > 0 && ImGui::BeginTable("Buffer View Grid##vartable", IM_ARRAYSIZE(varColumns) + 1, ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_ScrollY | ImGuiTableFlags_NoBordersInBody))
@@ -347,7 +362,7 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
             {
                 if (!instance.GetRESTVariables()->contains(varName))
                     continue;
-                const auto& [varOffset, varEnabled] = varData;
+                const auto& [varOffset, varEnabled, varElements] = varData;
                 ImGui::TableNextColumn();
                 ImGui::Text(varName.c_str());
                 ImGui::TableNextColumn();
@@ -355,6 +370,8 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
                 ImGui::TableNextColumn();
                 ImGui::Text(Shim::Constants::type_desc[static_cast<uint32_t>(std::get<0>(instance.GetRESTVariables()->at(varName)))]);
                 ImGui::TableNextColumn();
+                ImGui::Text("%u", varElements);
+                ImGui::TableNextColumn();
                 ImGui::Text(std::format("{}", varEnabled).c_str());
                 ImGui::TableNextColumn();
                 if (ImGui::Button(std::format("Remove##{}", varName).c_str()))
@@ -30,9 +30,15 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <format>
 #include "AddonUIData.h"
+#include "ConfigWriter.h"
+#include "ConfigWatcher.h"
 #include "RenderingManager.h"
+#include "SignatureCache.h"
+#include "Profiler.h"
+#include "ShaderUsage.h"
 
 using namespace AddonImGui;
 using namespace reshade::api;
@@ -62,6 +68,11 @@ AddonUIData::AddonUIData(ShaderManager* pixelShaderManager, ShaderManager* verte
     _keyBindings[Keybind::INVOCATION_UP] = VK_NUMPAD8;
     _keyBindings[Keybind::DESCRIPTOR_DOWN] = VK_SUBTRACT;
     _keyBindings[Keybind::DESCRIPTOR_UP] = VK_ADD;
+    _keyBindings[Keybind::TRACE_DUMP] = VK_F10 | (VK_CONTROL << 8);
+    _keyBindings[Keybind::COMMAND_CAPTURE] = VK_F11 | (VK_CONTROL << 8);
+    _keyBindings[Keybind::BISECT_GONE] = VK_NUMPAD9;
+    _keyBindings[Keybind::BISECT_VISIBLE] = VK_NUMPAD0;
+    _keyBindings[Keybind::BISECT_BOTH] = VK_DECIMAL;
 }
 
 
@@ -71,8 +82,10 @@ unordered_map<int, ToggleGroup>& AddonUIData::GetToggleGroups()
 }
 
 
-const vector<ToggleGroup*>* AddonUIData::GetToggleGroupsForPixelShaderHash(uint32_t hash)
+const vector<uint32_t>* AddonUIData::GetToggleGroupsForPixelShaderHash(uint32_t hash)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_GROUP_LOOKUP);
+
     const auto& it = _pixelShaderHashToToggleGroups.find(hash);
 
     if (it != _pixelShaderHashToToggleGroups.end())
@@ -83,8 +96,10 @@ const vector<ToggleGroup*>* AddonUIData::GetToggleGroupsForPixelShaderHash(uint3
     return nullptr;
 }
 
-const vector<ToggleGroup*>* AddonUIData::GetToggleGroupsForVertexShaderHash(uint32_t hash)
+const vector<uint32_t>* AddonUIData::GetToggleGroupsForVertexShaderHash(uint32_t hash)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_GROUP_LOOKUP);
+
     const auto& it = _vertexShaderHashToToggleGroups.find(hash);
 
     if (it != _vertexShaderHashToToggleGroups.end())
@@ -95,39 +110,269 @@ const vector<ToggleGroup*>* AddonUIData::GetToggleGroupsForVertexShaderHash(uint
     return nullptr;
 }
 
+uint32_t AddonUIData::FindTextureBindingId(const string& bindingName) const
+{
+    const auto& it = _textureBindingIds.find(bindingName);
+
+    if (it != _textureBindingIds.end())
+    {
+        return it->second;
+    }
+
+    return INVALID_BINDING_ID;
+}
+
+ToggleGroupHotData AddonUIData::MakeHotData(ToggleGroup& group)
+{
+    // Binding ids are never reassigned so per-frame state keyed by them stays valid across regenerations
+    uint32_t bindingId = INVALID_BINDING_ID;
+    if (group.isProvidingTextureBinding())
+    {
+        const auto& [it, inserted] = _textureBindingIds.try_emplace(group.getTextureBindingName(), static_cast<uint32_t>(_textureBindingIds.size()));
+        if (inserted)
+        {
+            // Command lists read the names while this runs, so a new name goes into a copy which is published whole. Earlier
+            // versions are kept since a reader may still be indexing them
+            auto names = std::make_unique<vector<string>>();
+            if (!_textureBindingNameVersions.empty())
+            {
+                *names = *_textureBindingNameVersions.back();
+            }
+            names->push_back(group.getTextureBindingName());
+
+            _textureBindingNames.store(names.get(), memory_order_release);
+            _textureBindingNameVersions.push_back(std::move(names));
+        }
+        bindingId = it->second;
+    }
+
+    uint16_t flags = 0;
+    flags |= group.isActive() ? HOT_GROUP_ACTIVE : 0;
+    flags |= group.getExtractConstants() ? HOT_GROUP_EXTRACT_CONSTANTS : 0;
+    flags |= group.isProvidingTextureBinding() ? HOT_GROUP_PROVIDES_BINDING : 0;
+    flags |= group.getCopyTextureBinding() ? HOT_GROUP_COPY_BINDING : 0;
+    flags |= group.getExtractResourceViews() ? HOT_GROUP_EXTRACT_RESOURCE_VIEWS : 0;
+    flags |= group.getAllowAllTechniques() ? HOT_GROUP_ALLOW_ALL_TECHNIQUES : 0;
+    flags |= group.getHasTechniqueExceptions() ? HOT_GROUP_TECHNIQUE_EXCEPTIONS : 0;
+    flags |= group.preferredTechniques().size() > 0 ? HOT_GROUP_PREFERRED_TECHNIQUES : 0;
+
+    return ToggleGroupHotData{ &group, group.getId(), bindingId, flags,
+        static_cast<uint8_t>(group.getInvocationLocation()), static_cast<uint8_t>(group.getBindingInvocationLocation()) };
+}
+
+void AddonUIData::AddHuntedHashes(ShaderManager* shaderManager, unordered_map<uint32_t, vector<uint32_t>>& lookup, uint32_t index)
+{
+    if (!shaderManager->isInHuntingMode())
+    {
+        return;
+    }
+
+    if (!shaderManager->isBisecting())
+    {
+        lookup[shaderManager->getActiveHuntedShaderHash()].push_back(index);
+        return;
+    }
+
+    for (const auto h : shaderManager->getBisectTestedHashes())
+    {
+        lookup[h].push_back(index);
+    }
+}
+
 void AddonUIData::UpdateToggleGroupsForShaderHashes()
 {
     _pixelShaderHashToToggleGroups.clear();
     _vertexShaderHashToToggleGroups.clear();
+    _hotToggleGroups.clear();
+    _hotToggleGroups.reserve(_toggleGroups.size());
+    _hotStateVersion = ToggleGroup::getHotStateVersion();
+    _hashVersion = ToggleGroup::getHashVersion();
 
     for (auto& [_,group] : _toggleGroups)
     {
-        // Only consider the currently hunted hash for the group being edited
+        const uint32_t index = static_cast<uint32_t>(_hotToggleGroups.size());
+        _hotToggleGroups.push_back(MakeHotData(group));
+
+        // Only consider the currently hunted hash for the group being edited, or the tested half while bisecting
         if (group.getId() == _toggleGroupIdShaderEditing && (_pixelShaderManager->isInHuntingMode() || _vertexShaderManager->isInHuntingMode()))
         {
-            if (_pixelShaderManager->isInHuntingMode())
-            {
-                _pixelShaderHashToToggleGroups[_pixelShaderManager->getActiveHuntedShaderHash()].push_back(&group);
-            }
-
-            if (_vertexShaderManager->isInHuntingMode())
-            {
-                _vertexShaderHashToToggleGroups[_vertexShaderManager->getActiveHuntedShaderHash()].push_back(&group);
-            }
+            AddHuntedHashes(_pixelShaderManager, _pixelShaderHashToToggleGroups, index);
+            AddHuntedHashes(_vertexShaderManager, _vertexShaderHashToToggleGroups, index);
 
             continue;
         }
 
         for (const auto& h : group.getPixelShaderHashes())
         {
-            _pixelShaderHashToToggleGroups[h].push_back(&group);
+            _pixelShaderHashToToggleGroups[h].push_back(index);
         }
 
         for (const auto& h : group.getVertexShaderHashes())
         {
-            _vertexShaderHashToToggleGroups[h].push_back(&group);
+            _vertexShaderHashToToggleGroups[h].push_back(index);
+        }
+    }
+}
+
+bool AddonUIData::IsHashLookupCurrent()
+{
+    if (_hotToggleGroups.size() != _toggleGroups.size())
+    {
+        return false;
+    }
+
+    if (_hashVersion == ToggleGroup::getHashVersion())
+    {
+        return true;
+    }
+
+    // The version is bumped by groups outside of _toggleGroups too, e.g. the ones the config watcher parses
+    for (const auto& [_,group] : _toggleGroups)
+    {
+        if (group.getHashStamp() > _hashVersion)
+        {
+            return false;
+        }
+    }
+
+    _hashVersion = ToggleGroup::getHashVersion();
+    return true;
+}
+
+void AddonUIData::RefreshToggleGroups()
+{
+    if (!IsHashLookupCurrent())
+    {
+        UpdateToggleGroupsForShaderHashes();
+        return;
+    }
+
+    if (_hotStateVersion == ToggleGroup::getHotStateVersion())
+    {
+        return;
+    }
+
+    // Flag changes only, patch the entries in place so the hash lookups handed out to command lists stay valid
+    _hotStateVersion = ToggleGroup::getHotStateVersion();
+    for (auto& hot : _hotToggleGroups)
+    {
+        hot = MakeHotData(*hot.group);
+    }
+}
+
+static void PatchHashLookup(unordered_map<uint32_t, vector<uint32_t>>& lookup, const unordered_set<uint32_t>& oldHashes, const unordered_set<uint32_t>& newHashes, uint32_t index)
+{
+    for (const auto h : oldHashes)
+    {
+        if (newHashes.contains(h))
+        {
+            continue;
+        }
+
+        // Emptied entries are kept, command lists may still hold a pointer to them
+        const auto it = lookup.find(h);
+        if (it != lookup.end())
+        {
+            it->second.erase(std::remove(it->second.begin(), it->second.end(), index), it->second.end());
+        }
+    }
+
+    for (const auto h : newHashes)
+    {
+        if (!oldHashes.contains(h))
+        {
+            lookup[h].push_back(index);
+        }
+    }
+}
+
+/// <summary>
+/// Applies the groups of an outside edit of the config file, if the config watcher has one. Groups are matched by the position
+/// they're saved at. Only groups which differ are touched and the hash lookups are patched for them, unless groups were added or
+/// removed. Postponed while a group is edited in the overlay. The lookup entries are patched in place, so it's only called while
+/// no command list records. Groups which are removed, deactivated or stop extracting constants are dropped from the constant
+/// handler, as when that's done in the overlay.
+/// </summary>
+/// <param name="device"></param>
+/// <returns>true if a texture binding definition changed and the bindings have to be recreated</returns>
+bool AddonUIData::ApplyConfigReload(reshade::api::device* device)
+{
+    if (!ConfigWatcher::HasReload() || _toggleGroupIdShaderEditing >= 0 || _toggleGroupIdEffectEditing >= 0 || _toggleGroupIdConstantEditing >= 0)
+    {
+        return false;
+    }
+
+    vector<ToggleGroup> groups;
+    if (!ConfigWatcher::TakeReload(groups))
+    {
+        return false;
+    }
+
+    const bool patchLookup = IsHashLookupCurrent() && groups.size() == _toggleGroups.size();
+    bool bindingsChanged = false;
+    uint32_t changedGroups = 0;
+
+    // The hot index of a group is its position in _toggleGroups, as long as the lookup is current
+    uint32_t index = 0;
+    vector<int> removed;
+    for (auto& [id,group] : _toggleGroups)
+    {
+        if (index >= groups.size())
+        {
+            bindingsChanged |= group.isProvidingTextureBinding();
+            removed.push_back(id);
+            if (_constantHandler != nullptr)
+            {
+                _constantHandler->RemoveGroup(&group, device);
+            }
+            continue;
         }
+
+        const ToggleGroup& source = groups[index];
+        if (patchLookup)
+        {
+            PatchHashLookup(_pixelShaderHashToToggleGroups, group.getPixelShaderHashes(), source.getPixelShaderHashes(), index);
+            PatchHashLookup(_vertexShaderHashToToggleGroups, group.getVertexShaderHashes(), source.getVertexShaderHashes(), index);
+        }
+
+        const bool wasExtracting = group.isActive() && group.getExtractConstants();
+        const uint32_t changes = group.applyState(source);
+        if (wasExtracting && !(group.isActive() && group.getExtractConstants()) && _constantHandler != nullptr)
+        {
+            _constantHandler->RemoveGroup(&group, device);
+        }
+
+        bindingsChanged |= (changes & GROUP_CHANGE_BINDING) != 0;
+        changedGroups += changes != GROUP_CHANGE_NONE ? 1 : 0;
+        index++;
     }
+
+    for (const int id : removed)
+    {
+        _toggleGroups.erase(id);
+    }
+
+    const size_t added = groups.size() > index ? groups.size() - index : 0;
+    for (; index < groups.size(); index++)
+    {
+        ToggleGroup group("", ToggleGroup::getNewGroupId());
+        group.applyState(groups[index]);
+        bindingsChanged |= group.isProvidingTextureBinding();
+        _toggleGroups.emplace(group.getId(), group);
+    }
+
+    reshade::log_message(reshade::log_level::info, std::format("Applied config reload: {} groups changed, {} removed, {} added", changedGroups, removed.size(), added).c_str());
+
+    if (patchLookup)
+    {
+        _hashVersion = ToggleGroup::getHashVersion();
+    }
+    else
+    {
+        UpdateToggleGroupsForShaderHashes();
+    }
+
+    return bindingsChanged;
 }
 
 const vector<string>* AddonUIData::GetAllTechniques() const
@@ -148,6 +393,58 @@ void AddonUIData::StopHuntingMode()
 }
 
 
+/// <summary>
+/// Starts bisecting the given collected shaders of the given manager, e.g. the ones left by the filters of the shader list.
+/// Only one shader type is bisected at a time, so an answer can't be ambiguous.
+/// </summary>
+/// <param name="shaderManager"></param>
+/// <param name="candidates"></param>
+void AddonUIData::StartBisection(ShaderManager* shaderManager, const vector<uint32_t>& candidates)
+{
+    ShaderManager* other = shaderManager == _pixelShaderManager ? _vertexShaderManager : _pixelShaderManager;
+    other->stopBisection();
+
+    if (!shaderManager->startBisection(candidates))
+    {
+        reshade::log_message(reshade::log_level::info, "No unmarked shaders to bisect");
+    }
+
+    UpdateToggleGroupsForShaderHashes();
+}
+
+
+void AddonUIData::StopBisection()
+{
+    _pixelShaderManager->stopBisection();
+    _vertexShaderManager->stopBisection();
+
+    UpdateToggleGroupsForShaderHashes();
+}
+
+
+/// <summary>
+/// Passes the answer to the bisection step on to the shader manager bisecting, if any.
+/// </summary>
+/// <param name="answer"></param>
+void AddonUIData::AnswerBisection(BisectAnswer answer)
+{
+    ShaderManager* shaderManager = _pixelShaderManager->isBisecting() ? _pixelShaderManager : _vertexShaderManager;
+    if (!shaderManager->isBisecting())
+    {
+        return;
+    }
+
+    shaderManager->answerBisection(answer);
+
+    if (!shaderManager->isBisecting() && shaderManager->getBisectMissCount() > 0)
+    {
+        reshade::log_message(reshade::log_level::info, std::format("Bisection done, {} range(s) ended without a shader affecting the element", shaderManager->getBisectMissCount()).c_str());
+    }
+
+    UpdateToggleGroupsForShaderHashes();
+}
+
+
 /// <summary>
 /// Adds a default group with VK_CAPITAL as toggle key. Only used if there aren't any groups defined in the ini file.
 /// </summary>
@@ -169,7 +466,15 @@ void AddonUIData::LoadShaderTogglerIniFile(const string& fileName)
     reshade::log_message(reshade::log_level::info, std::format("Loading config file from \"{}\"", (_basePath / fileName).string()).c_str());
 
     CDataFile iniFile;
-    if (!iniFile.Load((_basePath / fileName).string()))
+    bool loaded;
+    {
+        PROFILE_SCOPE(Profiling::PROFILE_CONFIG_LOAD);
+        loaded = iniFile.Load((_basePath / fileName).string());
+        PROFILE_SET_ITEMS(iniFile.KeyCount());
+    }
+    Shim::SignatureCache::Load(iniFile);
+
+    if (!loaded)
     {
         reshade::log_message(reshade::log_level::info, std::format("Could not find config file at \"{}\"", (_basePath / fileName).string()).c_str());
         // not there
@@ -194,6 +499,15 @@ void AddonUIData::LoadShaderTogglerIniFile(const string& fileName)
         _constHookCopyType = "gpu_readback";
     }
 
+    const int dynamicSubscription = iniFile.GetInt("DynamicEventSubscription", "General");
+    _dynamicEventSubscription = dynamicSubscription == INT_MIN || dynamicSubscription != 0;
+
+    const int traceRecording = iniFile.GetInt("TraceRecording", "General");
+    _traceRecording = traceRecording != INT_MIN && traceRecording != 0;
+
+    const int commandCaptureFrames = iniFile.GetInt("CommandCaptureFrames", "General");
+    _commandCaptureFrames = commandCaptureFrames > 0 ? commandCaptureFrames : FRAMECOUNT_COMMAND_CAPTURE_DEFAULT;
+
     for (uint32_t i = 0; i < ARRAYSIZE(KeybindNames); i++)
     {
         uint32_t keybinding = iniFile.GetUInt(KeybindNames[i], "Keybindings");
@@ -223,51 +537,46 @@ void AddonUIData::LoadShaderTogglerIniFile(const string& fileName)
     {
         group.loadState(iniFile, groupCounter);		// groupCounter is normally 0 or greater. For when the old format is detected, it's -1 (and there's 1 group).
         groupCounter++;
-
-        for (const auto& h : group.getPixelShaderHashes())
-        {
-            _pixelShaderHashToToggleGroups[h].push_back(&group);
-        }
-
-        for (const auto& h : group.getVertexShaderHashes())
-        {
-            _vertexShaderHashToToggleGroups[h].push_back(&group);
-        }
     }
+
+    UpdateToggleGroupsForShaderHashes();
 }
 
 
 /// <summary>
-/// Saves the currently known toggle groups with their shader hashes to the shadertoggler.ini file
+/// Saves the currently known toggle groups with their shader hashes to the shadertoggler.ini file. The file is written in the background.
 /// </summary>
 void AddonUIData::SaveShaderTogglerIniFile(const string& fileName)
 {
     // format: first section with # of groups, then per group a section with pixel and vertex shaders, as well as their name and key value.
     // groups are stored with "Group" + group counter, starting with 0.
-    CDataFile iniFile;
+    // Only a snapshot is taken here, serializing and writing the file happens on the config writer's thread.
+    ConfigSnapshot snapshot;
+    snapshot.path = _basePath / fileName;
 
-    iniFile.SetValue("ResourceShim", _resourceShim, "", "General");
+    auto& settings = snapshot.settings;
+    settings.push_back({ "General", "ResourceShim", _resourceShim });
 
-    iniFile.SetValue("ConstantBufferHookType", _constHookType, "", "General");
-    iniFile.SetValue("ConstantBufferHookCopyType", _constHookCopyType, "", "General");
+    settings.push_back({ "General", "ConstantBufferHookType", _constHookType });
+    settings.push_back({ "General", "ConstantBufferHookCopyType", _constHookCopyType });
+    settings.push_back({ "General", "DynamicEventSubscription", _dynamicEventSubscription ? "1" : "0" });
+    settings.push_back({ "General", "TraceRecording", _traceRecording ? "1" : "0" });
+    settings.push_back({ "General", "CommandCaptureFrames", std::to_string(_commandCaptureFrames) });
 
     for (uint32_t i = 0; i < ARRAYSIZE(KeybindNames); i++)
     {
-        uint32_t keybinding = iniFile.SetUInt(KeybindNames[i], _keyBindings[i], "", "Keybindings");
+        settings.push_back({ "Keybindings", KeybindNames[i], std::to_string(_keyBindings[i]) });
     }
 
-    iniFile.SetInt("AmountGroups", static_cast<int>(_toggleGroups.size()), "", "General");
+    settings.push_back({ "General", "AmountGroups", std::to_string(_toggleGroups.size()) });
 
-    int groupCounter = 0;
+    snapshot.groups.reserve(_toggleGroups.size());
     for (const auto& [_,group] : _toggleGroups)
     {
-        group.saveState(iniFile, groupCounter);
-        groupCounter++;
+        snapshot.groups.push_back(group);
     }
-    reshade::log_message(reshade::log_level::info, std::format("Creating config file at \"{}\"", (_basePath / fileName).string()).c_str());
 
-    iniFile.SetFileName((_basePath / fileName).string());
-    iniFile.Save();
+    ConfigWriter::Queue(std::move(snapshot));
 }
 
 
@@ -305,6 +614,7 @@ void AddonUIData::StartShaderEditing(ToggleGroup& groupEditing)
         EndShaderEditing(false, groupEditing);
     }
     _toggleGroupIdShaderEditing = groupEditing.getId();
+    ShaderUsage::Reset();
     *_activeCollectorFrameCounter = _startValueFramecountCollectionPhase;
     _pixelShaderManager->startHuntingMode(groupEditing.getPixelShaderHashes());
     _vertexShaderManager->startHuntingMode(groupEditing.getVertexShaderHashes());
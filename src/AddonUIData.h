@@ -32,6 +32,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <memory>
 #include <filesystem>
 #include <reshade.hpp>
 #include "ShaderManager.h"
@@ -40,6 +41,7 @@
 #include "ConstantHandlerBase.h"
 
 constexpr auto FRAMECOUNT_COLLECTION_PHASE_DEFAULT = 10;
+constexpr auto FRAMECOUNT_COMMAND_CAPTURE_DEFAULT = 3;
 constexpr auto HASH_FILE_NAME = "ReshadeEffectShaderToggler.ini";
 
 namespace AddonImGui
@@ -59,7 +61,12 @@ namespace AddonImGui
         INVOCATION_DOWN,
         INVOCATION_UP,
         DESCRIPTOR_DOWN,
-        DESCRIPTOR_UP
+        DESCRIPTOR_UP,
+        TRACE_DUMP,
+        COMMAND_CAPTURE,
+        BISECT_GONE,
+        BISECT_VISIBLE,
+        BISECT_BOTH
     };
 
     static const char* KeybindNames[] = {
@@ -76,7 +83,12 @@ namespace AddonImGui
         "INVOCATION_DOWN",
         "INVOCATION_UP",
         "DESCRIPTOR_DOWN",
-        "DESCRIPTOR_UP"
+        "DESCRIPTOR_UP",
+        "TRACE_DUMP",
+        "COMMAND_CAPTURE",
+        "BISECT_GONE",
+        "BISECT_VISIBLE",
+        "BISECT_BOTH"
     };
 
     enum TabType : uint32_t
@@ -101,23 +113,41 @@ namespace AddonImGui
         std::atomic_int _toggleGroupIdEffectEditing = -1;
         std::atomic_int _toggleGroupIdConstantEditing = -1;
         std::unordered_map<int, ShaderToggler::ToggleGroup> _toggleGroups;
-        std::unordered_map<uint32_t, std::vector<ShaderToggler::ToggleGroup*>> _pixelShaderHashToToggleGroups;
-        std::unordered_map<uint32_t, std::vector<ShaderToggler::ToggleGroup*>> _vertexShaderHashToToggleGroups;
+        std::vector<ShaderToggler::ToggleGroupHotData> _hotToggleGroups;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> _pixelShaderHashToToggleGroups;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> _vertexShaderHashToToggleGroups;
+        std::atomic<const std::vector<std::string>*> _textureBindingNames = nullptr;	// latest of _textureBindingNameVersions
+        std::vector<std::unique_ptr<const std::vector<std::string>>> _textureBindingNameVersions;
+        std::unordered_map<std::string, uint32_t> _textureBindingIds;
+        uint32_t _hotStateVersion = 0;
+        uint32_t _hashVersion = 0;
         int _startValueFramecountCollectionPhase = FRAMECOUNT_COLLECTION_PHASE_DEFAULT;
         float _overlayOpacity = 0.2f;
         uint32_t _keyBindings[ARRAYSIZE(KeybindNames)];
         std::string _constHookType = "default";
         std::string _constHookCopyType = "gpu_readback";
         std::string _resourceShim = "none";
+        bool _dynamicEventSubscription = true;
+        bool _traceRecording = false;
+        int _commandCaptureFrames = FRAMECOUNT_COMMAND_CAPTURE_DEFAULT;
         std::filesystem::path _basePath;
         TabType _currentTab = TabType::TAB_NONE;
+
+        ShaderToggler::ToggleGroupHotData MakeHotData(ShaderToggler::ToggleGroup& group);
+        bool IsHashLookupCurrent();
+        static void AddHuntedHashes(ShaderToggler::ShaderManager* shaderManager, std::unordered_map<uint32_t, std::vector<uint32_t>>& lookup, uint32_t index);
     public:
         AddonUIData(ShaderToggler::ShaderManager* pixelShaderManager, ShaderToggler::ShaderManager* vertexShaderManager, Shim::Constants::ConstantHandlerBase* constants, std::atomic_uint32_t* activeCollectorFrameCounter,
             std::vector<std::string>* techniques);
         std::unordered_map<int, ShaderToggler::ToggleGroup>& GetToggleGroups();
-        const std::vector<ShaderToggler::ToggleGroup*>* GetToggleGroupsForPixelShaderHash(uint32_t hash);
-        const std::vector<ShaderToggler::ToggleGroup*>* GetToggleGroupsForVertexShaderHash(uint32_t hash);
+        const std::vector<uint32_t>* GetToggleGroupsForPixelShaderHash(uint32_t hash);
+        const std::vector<uint32_t>* GetToggleGroupsForVertexShaderHash(uint32_t hash);
+        const std::vector<ShaderToggler::ToggleGroupHotData>& GetHotToggleGroups() const { return _hotToggleGroups; }
         void UpdateToggleGroupsForShaderHashes();
+        void RefreshToggleGroups();
+        bool ApplyConfigReload(reshade::api::device* device);
+        uint32_t FindTextureBindingId(const std::string& bindingName) const;
+        const std::string& GetTextureBindingName(uint32_t bindingId) const { return (*_textureBindingNames.load(std::memory_order_acquire))[bindingId]; }
         void AddDefaultGroup();
         const std::atomic_int& GetToggleGroupIdShaderEditing() const;
         void EndShaderEditing(bool acceptCollectedShaderHashes, ShaderToggler::ToggleGroup& groupEditing);
@@ -127,6 +157,9 @@ namespace AddonImGui
         void StartConstantEditing(ShaderToggler::ToggleGroup& groupEditing);
         void EndConstantEditing();
         void StopHuntingMode();
+        void StartBisection(ShaderToggler::ShaderManager* shaderManager, const std::vector<uint32_t>& candidates);
+        void StopBisection();
+        void AnswerBisection(ShaderToggler::BisectAnswer answer);
         void SetBasePath(const std::filesystem::path& basePath) { _basePath = basePath; };
         std::filesystem::path GetBasePath() { return _basePath; };
         void SaveShaderTogglerIniFile(const std::string& fileName = HASH_FILE_NAME);
@@ -153,6 +186,12 @@ namespace AddonImGui
         const std::string& GetResourceShim() { return _resourceShim; }
         void SetConstHookCopyType(std::string& copyType) { _constHookCopyType = copyType; }
         void SetResourceShim(std::string& shim) { _resourceShim = shim; }
+        bool GetDynamicEventSubscription() const { return _dynamicEventSubscription; }
+        bool* DynamicEventSubscription() { return &_dynamicEventSubscription; }
+        bool GetTraceRecording() const { return _traceRecording; }
+        bool* TraceRecording() { return &_traceRecording; }
+        int GetCommandCaptureFrames() const { return _commandCaptureFrames; }
+        int* CommandCaptureFrames() { return &_commandCaptureFrames; }
         void SetKeybinding(Keybind keybind, uint32_t keys);
         const std::unordered_map<std::string, std::tuple<Shim::Constants::constant_type, std::vector<reshade::api::effect_uniform_variable>>>* GetRESTVariables() { return _constantHandler->GetRESTVariables(); };
         reshade::api::format cFormat;
@@ -40,6 +40,10 @@
 #include "KeyData.h"
 #include "ResourceManager.h"
 #include "ConstantManager.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
+#include "CommandCapture.h"
+#include "ShaderUsage.h"
 
 #define MAX_DESCRIPTOR_INDEX 10
 
@@ -424,6 +428,145 @@ static void DisplayRenderTargets(AddonImGui::AddonUIData& instance, Rendering::R
     ImGui::PopStyleVar();
 }
 
+static std::string FormatName(reshade::api::format format)
+{
+    switch (format)
+    {
+    case reshade::api::format::r8g8b8a8_unorm: return "RGBA8";
+    case reshade::api::format::r8g8b8a8_unorm_srgb: return "RGBA8 sRGB";
+    case reshade::api::format::b8g8r8a8_unorm: return "BGRA8";
+    case reshade::api::format::b8g8r8a8_unorm_srgb: return "BGRA8 sRGB";
+    case reshade::api::format::r10g10b10a2_unorm: return "RGB10A2";
+    case reshade::api::format::r11g11b10_float: return "R11G11B10F";
+    case reshade::api::format::r16g16b16a16_float: return "RGBA16F";
+    case reshade::api::format::r32g32b32a32_float: return "RGBA32F";
+    default: return std::format("Format {}", static_cast<uint32_t>(format));
+    }
+}
+
+enum ShaderSortMode : int
+{
+    SHADER_SORT_COLLECTED = 0,
+    SHADER_SORT_DRAWS,
+    SHADER_SORT_FIRST_DRAW,
+    SHADER_SORT_LAST_DRAW
+};
+
+/// <summary>
+/// Filters and sorts the collected shaders on the statistics gathered while collecting them. Entries hold the index of the
+/// hash in the collected set, which is what the hunted shader is selected by.
+/// </summary>
+static void DisplayShaderFilters(ShaderToggler::ShaderUsageStage stage, const std::unordered_set<uint32_t>& hashes, std::vector<std::pair<uint32_t, uint32_t>>& entries)
+{
+    static const char* sortModes[] = { "Collection order", "Draw count", "First draw", "Last draw" };
+    static int sortMode = SHADER_SORT_COLLECTED;
+    static bool swapchainSized = false;
+    static bool afterDepth = false;
+    static uint32_t targetFormat = 0;
+
+    std::vector<uint32_t> formats;
+    uint32_t index = 0;
+    for (const auto h : hashes)
+    {
+        const ShaderToggler::ShaderUsageStatistics* statistics = ShaderToggler::ShaderUsage::Get(stage, h);
+        const uint32_t position = index++;
+
+        if (statistics == nullptr)
+        {
+            if (!swapchainSized && !afterDepth && targetFormat == 0)
+            {
+                entries.emplace_back(position, h);
+            }
+            continue;
+        }
+
+        for (uint32_t i = 0; i < statistics->targetCount; i++)
+        {
+            const uint32_t format = static_cast<uint32_t>(statistics->targets[i].format);
+            if (std::find(formats.begin(), formats.end(), format) == formats.end())
+            {
+                formats.push_back(format);
+            }
+        }
+
+        // "After the last depth pass" in most of the frames it drew in, a stray frame shouldn't hide it
+        if ((swapchainSized && !statistics->swapchainSized) || (afterDepth && statistics->framesAfterDepth * 2 <= statistics->frameCount) ||
+            (targetFormat != 0 && !statistics->HasTargetFormat(static_cast<reshade::api::format>(targetFormat))))
+        {
+            continue;
+        }
+
+        entries.emplace_back(position, h);
+    }
+
+    if (sortMode != SHADER_SORT_COLLECTED)
+    {
+        // Shaders without statistics go last
+        const auto key = [stage](uint32_t hash) -> uint64_t {
+            const ShaderToggler::ShaderUsageStatistics* statistics = ShaderToggler::ShaderUsage::Get(stage, hash);
+            if (statistics == nullptr)
+            {
+                return UINT64_MAX;
+            }
+
+            switch (sortMode)
+            {
+            case SHADER_SORT_DRAWS: return UINT64_MAX - 1 - statistics->drawCount;
+            case SHADER_SORT_FIRST_DRAW: return statistics->firstDraw;
+            default: return UINT64_MAX - 1 - statistics->lastDraw;
+            }
+        };
+
+        std::stable_sort(entries.begin(), entries.end(), [&key](const auto& lhs, const auto& rhs) { return key(lhs.second) < key(rhs.second); });
+    }
+
+    std::sort(formats.begin(), formats.end());
+
+    ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.5f);
+    ImGui::Combo("Sort", &sortMode, sortModes, IM_ARRAYSIZE(sortModes));
+    if (ImGui::BeginCombo("Target format", targetFormat == 0 ? "Any" : FormatName(static_cast<reshade::api::format>(targetFormat)).c_str(), ImGuiComboFlags_None))
+    {
+        if (ImGui::Selectable("Any", targetFormat == 0))
+        {
+            targetFormat = 0;
+        }
+
+        for (const auto format : formats)
+        {
+            if (ImGui::Selectable(FormatName(static_cast<reshade::api::format>(format)).c_str(), targetFormat == format))
+            {
+                targetFormat = format;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::PopItemWidth();
+
+    ImGui::Checkbox("Back buffer sized", &swapchainSized);
+    ImGui::SameLine();
+    ImGui::Checkbox("After depth pass", &afterDepth);
+    ImGui::Text("%zu of %zu shaders", entries.size(), hashes.size());
+}
+
+static void DisplayShaderStatistics(const ShaderToggler::ShaderUsageStatistics* statistics)
+{
+    if (statistics == nullptr)
+    {
+        ImGui::SetTooltip("No draws recorded");
+        return;
+    }
+
+    std::string targets;
+    for (uint32_t i = 0; i < statistics->targetCount; i++)
+    {
+        targets += std::format("\n  {} {}x{}", FormatName(statistics->targets[i].format), statistics->targets[i].width, statistics->targets[i].height);
+    }
+
+    ImGui::SetTooltip("%s", std::format("Draws: {} in {} frames\nDraw ordinals: {} to {}\nAfter the last depth pass in {} frames\nBack buffer sized target: {}\nTargets:{}",
+        statistics->drawCount, statistics->frameCount, statistics->firstDraw, statistics->lastDraw, statistics->framesAfterDepth, statistics->swapchainSized ? "yes" : "no",
+        targets.empty() ? " none" : targets).c_str());
+}
+
 static void DisplayGroupView(AddonImGui::AddonUIData& instance, Rendering::ResourceManager& resManager, reshade::api::effect_runtime* runtime, ShaderToggler::ToggleGroup* group, ShaderToggler::ShaderManager* shaderManager)
 {
     float height = ImGui::GetWindowHeight();
@@ -435,31 +578,97 @@ static void DisplayGroupView(AddonImGui::AddonUIData& instance, Rendering::Resou
     }
 
     const std::unordered_set<uint32_t>& hashes = shaderManager->getCollectedShaderHashes();
+    const ShaderToggler::ShaderUsageStage stage = shaderManager == instance.GetPixelShaderManager() ? ShaderToggler::USAGE_PIXEL : ShaderToggler::USAGE_VERTEX;
     static int32_t selected = -1;
-    uint32_t index = 0;
     ImGuiStyle style = ImGui::GetStyle();
 
-    if (ImGui::BeginTable("ShaderHashView", 1, ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_ScrollY | ImGuiTableFlags_NoBordersInBody | ImGuiTableColumnFlags_NoHeaderLabel, ImVec2(0, height - 47)))
+    std::vector<std::pair<uint32_t, uint32_t>> entries;
+    entries.reserve(hashes.size());
+    DisplayShaderFilters(stage, hashes, entries);
+
+    if (shaderManager->isBisecting())
+    {
+        if (ImGui::Button("Gone"))
+        {
+            instance.AnswerBisection(ShaderToggler::BISECT_GONE);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Visible"))
+        {
+            instance.AnswerBisection(ShaderToggler::BISECT_VISIBLE);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Both"))
+        {
+            instance.AnswerBisection(ShaderToggler::BISECT_BOTH);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Stop"))
+        {
+            instance.StopBisection();
+        }
+        ImGui::SameLine();
+        ImGui::Text("%zu candidates, at most %u steps left, %zu queued, %zu not found", shaderManager->getBisectCandidateCount(), shaderManager->getBisectStepsLeft(), shaderManager->getBisectPendingCount(),
+            shaderManager->getBisectMissCount());
+    }
+    else
     {
-        for (auto h : hashes)
+        if (ImGui::Button("Bisect"))
         {
-            bool marked = false;
-            if (shaderManager->isHuntedShaderMarked(shaderManager->getCollectedShaderHash(index)))
+            std::vector<uint32_t> candidates;
+            candidates.reserve(entries.size());
+            for (const auto& [_, h] : entries)
             {
-                marked = true;
+                candidates.push_back(h);
+            }
+
+            instance.StartBisection(shaderManager, candidates);
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("%s", std::format("Assigns half of the unmarked shaders listed to the group at once. Answer with {} if the element you're looking for is affected, {} if it isn't and {} if only part of it is. Each answer halves the candidates until the shader is found and marked.",
+                ShaderToggler::reshade_key_name(instance.GetKeybinding(AddonImGui::Keybind::BISECT_GONE)), ShaderToggler::reshade_key_name(instance.GetKeybinding(AddonImGui::Keybind::BISECT_VISIBLE)),
+                ShaderToggler::reshade_key_name(instance.GetKeybinding(AddonImGui::Keybind::BISECT_BOTH))).c_str());
+        }
+    }
+
+    if (ImGui::BeginTable("ShaderHashView", 1, ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_ScrollY | ImGuiTableFlags_NoBordersInBody | ImGuiTableColumnFlags_NoHeaderLabel, ImVec2(0, height - 47 - ImGui::GetFrameHeightWithSpacing() * 5)))
+    {
+        const bool bisecting = shaderManager->isBisecting();
+
+        for (size_t row = 0; row < entries.size(); row++)
+        {
+            const auto [index, h] = entries[row];
+            const ShaderToggler::ShaderUsageStatistics* statistics = ShaderToggler::ShaderUsage::Get(stage, h);
+
+            bool highlighted = false;
+            if (shaderManager->isHuntedShaderMarked(h))
+            {
+                highlighted = true;
                 ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.0f, 1.0f));
             }
+            else if (bisecting && shaderManager->isBisectTestedHash(h))
+            {
+                highlighted = true;
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 1.0f, 1.0f, 1.0f));
+            }
 
-            if (ImGui::Selectable(std::format("{:#08x}", h).c_str(), selected == index, ImGuiSelectableFlags_AllowDoubleClick) && (ImGui::IsMouseDoubleClicked(0) || ImGui::IsKeyPressed(ImGuiKey_Enter, false)))
+            const std::string label = statistics != nullptr ? std::format("{:#08x}  {} draws", h, statistics->drawCount) : std::format("{:#08x}", h);
+            if (ImGui::Selectable(label.c_str(), selected == index, ImGuiSelectableFlags_AllowDoubleClick) && (ImGui::IsMouseDoubleClicked(0) || ImGui::IsKeyPressed(ImGuiKey_Enter, false)))
             {
                 shaderManager->toggleMarkOnHuntedShader();
             }
 
-            if (marked)
+            if (highlighted)
             {
                 ImGui::PopStyleColor();
             }
 
+            if (ImGui::IsItemHovered())
+            {
+                DisplayShaderStatistics(statistics);
+            }
+
             if (ImGui::IsItemFocused())
             {
                 shaderManager->setActivedHuntedShaderIndex(index);
@@ -467,10 +676,8 @@ static void DisplayGroupView(AddonImGui::AddonUIData& instance, Rendering::Resou
                 selected = index;
             };
 
-            if (index < hashes.size() - 1)
+            if (row < entries.size() - 1)
                 ImGui::TableNextColumn();
-
-            index++;
         }
 
         ImGui::EndTable();
@@ -750,8 +957,213 @@ static void DisplayTextureBindings(AddonImGui::AddonUIData& instance, ShaderTogg
     ImGui::PopStyleVar();
 }
 
+
+static void ShowHelpMarker(const char* desc)
+{
+    ImGui::TextDisabled("(?)");
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::PushTextWrapPos(450.0f);
+        ImGui::TextUnformatted(desc);
+        ImGui::PopTextWrapPos();
+        ImGui::EndTooltip();
+    }
+}
+
+
+#ifdef SHADERTOGGLER_PROFILER
+static bool showProfilerOverlay = false;
+
+static void DisplayProfilerTable()
+{
+    const Profiling::ScopeStats* frame = Profiling::Profiler::GetFrameStats();
+    const Profiling::ScopeStats* total = Profiling::Profiler::GetTotalStats();
+    const uint64_t frames = std::max<uint64_t>(Profiling::Profiler::GetFrameCount(), 1);
+
+    ImGui::Text("Frames: %llu", Profiling::Profiler::GetFrameCount());
+
+    if (ImGui::BeginTable("Profiler##table", 8, ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+    {
+        ImGui::TableSetupColumn("Hook");
+        ImGui::TableSetupColumn("Calls/frame");
+        ImGui::TableSetupColumn("ns/item");
+        ImGui::TableSetupColumn("ms/frame");
+        ImGui::TableSetupColumn("Avg us");
+        ImGui::TableSetupColumn("p99 us");
+        ImGui::TableSetupColumn("Max us");
+        ImGui::TableSetupColumn("Last frame ms");
+        ImGui::TableHeadersRow();
+
+        for (uint32_t scope = 0; scope < Profiling::PROFILE_SCOPE_COUNT; scope++)
+        {
+            const Profiling::ScopeStats& stats = total[scope];
+            if (stats.count == 0)
+            {
+                continue;
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(Profiling::ProfileScopeNames[scope]);
+            if (ImGui::IsItemHovered())
+            {
+                float buckets[Profiling::HISTOGRAM_BUCKETS];
+                for (uint32_t i = 0; i < Profiling::HISTOGRAM_BUCKETS; i++)
+                {
+                    buckets[i] = static_cast<float>(stats.histogram[i]);
+                }
+
+                ImGui::BeginTooltip();
+                ImGui::TextUnformatted("Calls per log2(ns) bucket, 1ns to 8ms+");
+                ImGui::PlotHistogram("##histogram", buckets, Profiling::HISTOGRAM_BUCKETS, 0, nullptr, 0.0f, FLT_MAX, ImVec2(360, 80));
+                ImGui::EndTooltip();
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", static_cast<double>(stats.count) / frames);
+            ImGui::TableNextColumn();
+            if (stats.items != stats.count && stats.items > 0)
+            {
+                ImGui::Text("%.2f", static_cast<double>(stats.totalNs) / stats.items);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.totalNs / 1e6 / frames);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats.totalNs / 1e3 / stats.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("<%.2f", stats.Percentile(0.99) / 1e3);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats.maxNs / 1e3);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", frame[scope].totalNs / 1e6);
+        }
+
+        ImGui::EndTable();
+    }
+}
+
+static void DisplayProfilerThreads()
+{
+    const std::vector<Profiling::ThreadStats> threads = Profiling::Profiler::GetThreadStats();
+    const uint64_t frames = std::max<uint64_t>(Profiling::Profiler::GetFrameCount(), 1);
+
+    // Hooks nest (CheckDrawCall contains RenderEffects, ...), only count the outermost ones for a thread's share
+    static const Profiling::ProfileScope outerScopes[] = {
+        Profiling::PROFILE_BIND_PIPELINE, Profiling::PROFILE_BIND_RENDER_TARGETS, Profiling::PROFILE_BEGIN_RENDER_PASS, Profiling::PROFILE_PUSH_DESCRIPTORS,
+        Profiling::PROFILE_PUSH_CONSTANTS, Profiling::PROFILE_BIND_DESCRIPTOR_TABLES, Profiling::PROFILE_BIND_VIEWPORTS, Profiling::PROFILE_BIND_SCISSOR_RECTS,
+        Profiling::PROFILE_BIND_PIPELINE_STATES, Profiling::PROFILE_CHECK_DRAW_CALL, Profiling::PROFILE_BUFFER_REGION, Profiling::PROFILE_PRESENT,
+        Profiling::PROFILE_RESHADE_PRESENT, Profiling::PROFILE_SHADER_HASH, Profiling::PROFILE_MEMCPY_FILTER };
+
+    std::vector<uint64_t> threadNs(threads.size(), 0);
+    uint64_t allNs = 0;
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        for (const auto scope : outerScopes)
+        {
+            threadNs[i] += threads[i].total[scope].totalNs;
+        }
+        allNs += threadNs[i];
+    }
+
+    uint32_t activeThreads = 0;
+    for (const auto& thread : threads)
+    {
+        activeThreads += thread.frameCount > 0 ? 1 : 0;
+    }
+
+    ImGui::Text("Threads recording in the last frame: %u", activeThreads);
+
+    if (ImGui::BeginTable("ProfilerThreads##table", 5, ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+    {
+        ImGui::TableSetupColumn("Thread");
+        ImGui::TableSetupColumn("Calls/frame");
+        ImGui::TableSetupColumn("ms/frame");
+        ImGui::TableSetupColumn("Share");
+        ImGui::TableSetupColumn("Last frame calls");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            uint64_t calls = 0;
+            for (const auto scope : outerScopes)
+            {
+                calls += threads[i].total[scope].count;
+            }
+
+            if (calls == 0)
+            {
+                continue;
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", threads[i].threadId);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", static_cast<double>(calls) / frames);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", threadNs[i] / 1e6 / frames);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", allNs > 0 ? 100.0 * threadNs[i] / allNs : 0.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", threads[i].frameCount);
+        }
+
+        ImGui::EndTable();
+    }
+}
+
+static void DisplayProfiler(AddonImGui::AddonUIData& instance)
+{
+    bool enabled = Profiling::Profiler::IsEnabled();
+    if (ImGui::Checkbox("Record hook timings", &enabled))
+    {
+        Profiling::Profiler::SetEnabled(enabled);
+    }
+    ImGui::SameLine();
+    ShowHelpMarker("Times every hook the addon registers. Times are inclusive, e.g. CheckDrawCall contains the RenderEffects and UpdateTextureBindings calls it makes. Hover a hook to see its latency histogram.");
+    ImGui::SameLine();
+    ImGui::Checkbox("Show overlay", &showProfilerOverlay);
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+    {
+        Profiling::Profiler::Reset();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV"))
+    {
+        const std::filesystem::path csvPath = instance.GetBasePath() / "ShaderTogglerProfile.csv";
+        const std::filesystem::path threadCsvPath = instance.GetBasePath() / "ShaderTogglerProfileThreads.csv";
+        if (!Profiling::Profiler::ExportCsv(csvPath) || !Profiling::Profiler::ExportThreadCsv(threadCsvPath))
+        {
+            reshade::log_message(reshade::log_level::error, std::format("Failed to write profile to {}", csvPath.string()).c_str());
+        }
+    }
+
+    DisplayProfilerTable();
+
+    if (ImGui::TreeNode("Threads"))
+    {
+        DisplayProfilerThreads();
+        ImGui::TreePop();
+    }
+}
+#endif
+
 static void DisplayOverlay(AddonImGui::AddonUIData& instance, Rendering::ResourceManager& resManager, reshade::api::effect_runtime* runtime)
 {
+#ifdef SHADERTOGGLER_PROFILER
+    if (showProfilerOverlay)
+    {
+        ImGui::SetNextWindowBgAlpha(*instance.OverlayOpacity());
+        ImGui::SetNextWindowSize({ 640, 0 }, ImGuiCond_Once);
+        if (ImGui::Begin("ShaderToggler profiler", &showProfilerOverlay, ImGuiWindowFlags_NoFocusOnAppearing))
+        {
+            DisplayProfilerTable();
+        }
+        ImGui::End();
+    }
+#endif
+
     if (instance.GetToggleGroupIdShaderEditing() >= 0)
     {
         std::string editingGroupName = "";
@@ -875,19 +1287,58 @@ static void CheckHotkeys(AddonImGui::AddonUIData& instance, reshade::api::effect
     {
         --(*instance.ActiveCollectorFrameCounter());
     }
+
+    if (instance.GetTraceRecording() && ShaderToggler::areKeysPressed(instance.GetKeybinding(AddonImGui::Keybind::TRACE_DUMP), runtime))
+    {
+        const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        Profiling::TraceRecorder::Dump(instance.GetBasePath() / std::format("ShaderTogglerTrace-{}.json", timestamp));
+    }
+
+    if (ShaderToggler::areKeysPressed(instance.GetKeybinding(AddonImGui::Keybind::COMMAND_CAPTURE), runtime))
+    {
+        const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        Profiling::CommandCapture::Start(instance.GetBasePath() / std::format("ShaderTogglerCapture-{}.stcap", timestamp), instance.GetCommandCaptureFrames(), runtime->get_device()->get_api());
+    }
+
+    if (instance.GetToggleGroupIdShaderEditing() >= 0)
+    {
+        if (ShaderToggler::areKeysPressed(instance.GetKeybinding(AddonImGui::Keybind::BISECT_GONE), runtime))
+        {
+            instance.AnswerBisection(ShaderToggler::BISECT_GONE);
+        }
+        else if (ShaderToggler::areKeysPressed(instance.GetKeybinding(AddonImGui::Keybind::BISECT_VISIBLE), runtime))
+        {
+            instance.AnswerBisection(ShaderToggler::BISECT_VISIBLE);
+        }
+        else if (ShaderToggler::areKeysPressed(instance.GetKeybinding(AddonImGui::Keybind::BISECT_BOTH), runtime))
+        {
+            instance.AnswerBisection(ShaderToggler::BISECT_BOTH);
+        }
+    }
 }
 
 
-static void ShowHelpMarker(const char* desc)
+static void DisplayGroupStatistics(ShaderToggler::ToggleGroup& group)
 {
-    ImGui::TextDisabled("(?)");
-    if (ImGui::IsItemHovered())
+    ShaderToggler::ToggleGroupStatistics& statistics = group.getStatistics();
+
+    if (ImGui::BeginTable("GroupStatistics", 2, ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_NoBordersInBody))
     {
-        ImGui::BeginTooltip();
-        ImGui::PushTextWrapPos(450.0f);
-        ImGui::TextUnformatted(desc);
-        ImGui::PopTextWrapPos();
-        ImGui::EndTooltip();
+        for (uint32_t i = 0; i < ShaderToggler::STAT_COUNT; i++)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ShaderToggler::GroupStatisticNames[i]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", statistics.Get(static_cast<ShaderToggler::GroupStatistic>(i)));
+        }
+
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Reset statistics"))
+    {
+        statistics.Reset();
     }
 }
 
@@ -907,6 +1358,9 @@ static void DisplaySettings(AddonImGui::AddonUIData& instance, reshade::api::eff
         ImGui::TextUnformatted("* Numpad 4 and Numpad 5: previous/next vertex shader");
         ImGui::TextUnformatted("* Ctrl + Numpad 4 and Ctrl + Numpad 5: previous/next marked vertex shader in the group");
         ImGui::TextUnformatted("* Numpad 6: mark/unmark the current vertex shader as being part of the group");
+        ImGui::TextUnformatted(std::format("* Bisect, then {}, {} or {}: the element is affected, unaffected or partly affected by the highlighted half of the shaders",
+            ShaderToggler::reshade_key_name(instance.GetKeybinding(AddonImGui::Keybind::BISECT_GONE)), ShaderToggler::reshade_key_name(instance.GetKeybinding(AddonImGui::Keybind::BISECT_VISIBLE)),
+            ShaderToggler::reshade_key_name(instance.GetKeybinding(AddonImGui::Keybind::BISECT_BOTH))).c_str());
         ImGui::TextUnformatted("\nWhen you step through the shaders, the current shader is disabled in the 3D scene so you can see if that's the shader you were looking for.");
         ImGui::TextUnformatted("When you're done, make sure you click 'Save all toggle groups' to preserve the groups you defined so next time you start your game they're loaded in and you can use them right away.");
         ImGui::PopTextWrapPos();
@@ -963,7 +1417,31 @@ static void DisplaySettings(AddonImGui::AddonUIData& instance, reshade::api::eff
             ImGui::EndCombo();
         }
         instance.SetConstHookCopyType(varSelectedCopyMethod);
+
+        ImGui::AlignTextToFramePadding();
+        ImGui::Checkbox("Unsubscribe draw events while idle", instance.DynamicEventSubscription());
+        ImGui::SameLine();
+        ShowHelpMarker("When no group is active and no shaders are being hunted, the per-draw and per-bind callbacks are removed from ReShade to avoid their overhead. Disable this if a game misbehaves when groups are toggled on.");
+
+        ImGui::AlignTextToFramePadding();
+        ImGui::Checkbox("Record addon timeline", instance.TraceRecording());
+        ImGui::SameLine();
+        ShowHelpMarker(std::format("Keeps a timeline of the addon's own work. Pressing {} writes the last {} frames to a ShaderTogglerTrace-*.json file next to the addon, which can be opened in chrome://tracing or ui.perfetto.dev.",
+            ShaderToggler::reshade_key_name(instance.GetKeybinding(AddonImGui::Keybind::TRACE_DUMP)), Profiling::TraceRecorder::DUMP_FRAMES).c_str());
+
+        ImGui::AlignTextToFramePadding();
+        ImGui::SliderInt("# of frames to capture", instance.CommandCaptureFrames(), 1, 60);
+        ImGui::SameLine();
+        ShowHelpMarker(std::format("Pressing {} writes every hooked command of the next frames to a ShaderTogglerCapture-*.stcap file next to the addon, for profiling and testing group matching offline.",
+            ShaderToggler::reshade_key_name(instance.GetKeybinding(AddonImGui::Keybind::COMMAND_CAPTURE))).c_str());
+    }
+
+#ifdef SHADERTOGGLER_PROFILER
+    if (ImGui::CollapsingHeader("Profiler", ImGuiTreeNodeFlags_None))
+    {
+        DisplayProfiler(instance);
     }
+#endif
 
     if (ImGui::CollapsingHeader("Keybindings", ImGuiTreeNodeFlags_None))
     {
@@ -1055,6 +1533,12 @@ static void DisplaySettings(AddonImGui::AddonUIData& instance, reshade::api::eff
                 ImGui::Text(" %s", group.getName().c_str());
             }
 
+            if (ImGui::TreeNode("Statistics"))
+            {
+                DisplayGroupStatistics(group);
+                ImGui::TreePop();
+            }
+
             if (group.isEditing())
             {
                 ImGui::Separator();
@@ -66,7 +66,7 @@ CDataFile::CDataFile(t_Str szFileName)
     m_bDirty = false;
     m_szFileName = szFileName;
     m_Flags = (AUTOCREATE_SECTIONS | AUTOCREATE_KEYS);
-    m_Sections.push_back(*(new t_Section));
+    AddSection("", "");
 
     Load(m_szFileName);
 }
@@ -75,7 +75,7 @@ CDataFile::CDataFile()
 {
     Clear();
     m_Flags = (AUTOCREATE_SECTIONS | AUTOCREATE_KEYS);
-    m_Sections.push_back(*(new t_Section));
+    AddSection("", "");
 }
 
 // ~CDataFile
@@ -93,6 +93,7 @@ void CDataFile::Clear()
     m_bDirty = false;
     m_szFileName = t_Str("");
     m_Sections.clear();
+    m_SectionIndex.clear();
 }
 
 // SetFileName
@@ -119,77 +120,80 @@ bool CDataFile::Load(t_Str szFileName)
 {
     // We dont want to create a new file here.  If it doesn't exist, just
     // return false and report the failure.
-    fstream File(szFileName.c_str(), ios::in);
+    ifstream File(szFileName.c_str(), ios::in | ios::binary);
 
-    if (File.is_open())
+    if (!File.is_open())
     {
-        bool bDone = false;
-        bool bAutoKey = (m_Flags & AUTOCREATE_KEYS) == AUTOCREATE_KEYS;
-        bool bAutoSec = (m_Flags & AUTOCREATE_SECTIONS) == AUTOCREATE_SECTIONS;
+        Report(E_INFO, "[CDataFile::Load] Unable to open file. Does it exist?");
+        return false;
+    }
 
-        t_Str szLine;
-        t_Str szComment;
-        char buffer[MAX_BUFFER_LEN];
-        t_Section* pSection = GetSection("");
+    // Read the whole file at once and parse it in place, line endings are
+    // taken care of by trimming
+    File.seekg(0, ios::end);
+    const streamoff fileSize = File.tellg();
+    File.seekg(0, ios::beg);
 
-        // These need to be set, we'll restore the original values later.
-        m_Flags |= AUTOCREATE_KEYS;
-        m_Flags |= AUTOCREATE_SECTIONS;
+    t_Str szContent(fileSize > 0 ? static_cast<size_t>(fileSize) : 0, '\0');
+    File.read(szContent.data(), static_cast<streamsize>(szContent.size()));
+    szContent.resize(static_cast<size_t>(File.gcount()));
+    File.close();
 
-        while (!bDone)
-        {
-            memset(buffer, 0, MAX_BUFFER_LEN);
-            File.getline(buffer, MAX_BUFFER_LEN);
+    const t_Str szTrimChars = WhiteSpace + EqualIndicators;
+    const string_view content(szContent);
 
-            szLine = buffer;
-            Trim(szLine);
+    t_Str szComment;
+    t_Section* pSection = GetSection("");
 
-            bDone = (File.eof() || File.bad() || File.fail());
+    if (pSection == NULL)
+        pSection = AddSection("", "");
 
-            if (szLine.find_first_of(CommentIndicators) == 0)
-            {
-                szComment += "\n";
-                szComment += szLine;
-            }
-            else
-                if (szLine.find_first_of('[') == 0) // new section
-                {
-                    szLine.erase(0, 1);
-                    szLine.erase(szLine.find_last_of(']'), 1);
+    for (size_t pos = 0; pos < content.size();)
+    {
+        size_t end = content.find('\n', pos);
+        if (end == string_view::npos)
+            end = content.size();
 
-                    CreateSection(szLine, szComment);
-                    pSection = GetSection(szLine);
-                    szComment = t_Str("");
-                }
-                else
-                    if (szLine.size() > 0) // we have a key, add this key/value pair
-                    {
-                        t_Str szKey = GetNextWord(szLine);
-                        t_Str szValue = szLine;
-
-                        if (szKey.size() > 0 && szValue.size() > 0)
-                        {
-                            SetValue(szKey, szValue, szComment, pSection->szName);
-                            szComment = t_Str("");
-                        }
-                    }
+        const string_view szLine = TrimView(content.substr(pos, end - pos), szTrimChars);
+        pos = end + 1;
+
+        if (szLine.empty())
+            continue;
+
+        if (CommentIndicators.find(szLine[0]) != t_Str::npos)
+        {
+            szComment += "\n";
+            szComment += szLine;
         }
+        else if (szLine[0] == '[') // new section
+        {
+            t_Str szName(szLine.substr(1));
+            const size_t close = szName.find_last_of(']');
+            if (close != t_Str::npos)
+                szName.erase(close, 1);
+
+            pSection = GetSection(szName);
+            if (pSection == NULL)
+                pSection = AddSection(szName, szComment);
+            else
+                Report(E_INFO, "[CDataFile::Load] Section <%s> allready exists.", szName.c_str());
 
-        // Restore the original flag values.
-        if (!bAutoKey)
-            m_Flags &= ~AUTOCREATE_KEYS;
+            szComment.clear();
+        }
+        else // we have a key, add this key/value pair
+        {
+            const size_t equal = szLine.find_first_of(EqualIndicators);
+            const string_view szKey = TrimView(szLine.substr(0, equal), szTrimChars);
+            const string_view szValue = equal == string_view::npos ? string_view() : szLine.substr(equal + 1);
 
-        if (!bAutoSec)
-            m_Flags &= ~AUTOCREATE_SECTIONS;
-    }
-    else
-    {
-        Report(E_INFO, "[CDataFile::Load] Unable to open file. Does it exist?");
-        return false;
+            if (szKey.size() > 0 && szValue.size() > 0)
+            {
+                AddKey(pSection, szKey, szValue, szComment);
+                szComment.clear();
+            }
+        }
     }
 
-    File.close();
-
     return true;
 }
 
@@ -213,62 +217,64 @@ bool CDataFile::Save()
         return false;
     }
 
-    fstream File(m_szFileName.c_str(), ios::out | ios::trunc);
+    // Build the whole file in memory first so it's written with a single call
+    t_Str szOut;
+    szOut.reserve(static_cast<size_t>(KeyCount()) * 32);
 
-    if (File.is_open())
+    for (const auto& Section : m_Sections)
     {
-        SectionItor s_pos;
-        KeyItor k_pos;
-        t_Section Section;
-        t_Key Key;
+        bool bWroteComment = false;
 
-        for (s_pos = m_Sections.begin(); s_pos != m_Sections.end(); s_pos++)
+        if (Section.szComment.size() > 0)
         {
-            Section = (*s_pos);
-            bool bWroteComment = false;
-
-            if (Section.szComment.size() > 0)
-            {
-                bWroteComment = true;
-                WriteLn(File, "\n%s", CommentStr(Section.szComment).c_str());
-            }
+            bWroteComment = true;
+            szOut += "\n";
+            szOut += CommentStr(Section.szComment);
+            szOut += "\n";
+        }
 
-            if (Section.szName.size() > 0)
-            {
-                WriteLn(File, "%s[%s]",
-                    bWroteComment ? "" : "\n",
-                    Section.szName.c_str());
-            }
+        if (Section.szName.size() > 0)
+        {
+            if (!bWroteComment)
+                szOut += "\n";
+            szOut += "[";
+            szOut += Section.szName;
+            szOut += "]\n";
+        }
 
-            for (k_pos = Section.Keys.begin(); k_pos != Section.Keys.end(); k_pos++)
+        for (const auto& Key : Section.Keys)
+        {
+            if (Key.szKey.size() > 0 && Key.szValue.size() > 0)
             {
-                Key = (*k_pos);
-
-                if (Key.szKey.size() > 0 && Key.szValue.size() > 0)
+                if (Key.szComment.size() > 0)
                 {
-                    WriteLn(File, "%s%s%s%s%c%s",
-                        Key.szComment.size() > 0 ? "\n" : "",
-                        CommentStr(Key.szComment).c_str(),
-                        Key.szComment.size() > 0 ? "\n" : "",
-                        Key.szKey.c_str(),
-                        EqualIndicators[0],
-                        Key.szValue.c_str());
+                    szOut += "\n";
+                    szOut += CommentStr(Key.szComment);
+                    szOut += "\n";
                 }
+
+                szOut += Key.szKey;
+                szOut += EqualIndicators[0];
+                szOut += Key.szValue;
+                szOut += "\n";
             }
         }
-
     }
-    else
+
+    fstream File(m_szFileName.c_str(), ios::out | ios::trunc);
+
+    if (!File.is_open())
     {
         Report(E_ERROR, "[CDataFile::Save] Unable to save file.");
         return false;
     }
 
-    m_bDirty = false;
-
+    File.write(szOut.data(), static_cast<streamsize>(szOut.size()));
     File.flush();
     File.close();
 
+    m_bDirty = false;
+
     return true;
 }
 
@@ -276,24 +282,15 @@ bool CDataFile::Save()
 // Set the comment of a given key. Returns true if the key is not found.
 bool CDataFile::SetKeyComment(t_Str szKey, t_Str szComment, t_Str szSection)
 {
-    KeyItor k_pos;
-    t_Section* pSection;
+    t_Key* pKey = GetKey(szKey, szSection);
 
-    if ((pSection = GetSection(szSection)) == NULL)
+    if (pKey == NULL)
         return false;
 
-    for (k_pos = pSection->Keys.begin(); k_pos != pSection->Keys.end(); k_pos++)
-    {
-        if (CompareNoCase((*k_pos).szKey, szKey) == 0)
-        {
-            (*k_pos).szComment = szComment;
-            m_bDirty = true;
-            return true;
-        }
-    }
-
-    return false;
+    pKey->szComment = szComment;
+    m_bDirty = true;
 
+    return true;
 }
 
 // SetSectionComment
@@ -301,19 +298,15 @@ bool CDataFile::SetKeyComment(t_Str szKey, t_Str szComment, t_Str szSection)
 // was not found.
 bool CDataFile::SetSectionComment(t_Str szSection, t_Str szComment)
 {
-    SectionItor s_pos;
+    t_Section* pSection = GetSection(szSection);
 
-    for (s_pos = m_Sections.begin(); s_pos != m_Sections.end(); s_pos++)
-    {
-        if (CompareNoCase((*s_pos).szName, szSection) == 0)
-        {
-            (*s_pos).szComment = szComment;
-            m_bDirty = true;
-            return true;
-        }
-    }
+    if (pSection == NULL)
+        return false;
 
-    return false;
+    pSection->szComment = szComment;
+    m_bDirty = true;
+
+    return true;
 }
 
 
@@ -324,7 +317,6 @@ bool CDataFile::SetSectionComment(t_Str szSection, t_Str szComment)
 // the proper value and place it in the section requested.
 bool CDataFile::SetValue(t_Str szKey, t_Str szValue, t_Str szComment, t_Str szSection)
 {
-    t_Key* pKey = GetKey(szKey, szSection);
     t_Section* pSection = GetSection(szSection);
 
     if (pSection == NULL)
@@ -339,27 +331,21 @@ bool CDataFile::SetValue(t_Str szKey, t_Str szValue, t_Str szComment, t_Str szSe
     if (pSection == NULL)
         return false;
 
+    t_Key* pKey = GetKey(pSection, szKey);
+
     // if the key does not exist in that section, and the value passed 
     // is not t_Str("") then add the new key.
     if (pKey == NULL && szValue.size() > 0 && (m_Flags & AUTOCREATE_KEYS))
     {
-        pKey = new t_Key;
-
-        pKey->szKey = szKey;
-        pKey->szValue = szValue;
-        pKey->szComment = szComment;
-
-        m_bDirty = true;
-
-        pSection->Keys.push_back(*pKey);
+        AddKey(pSection, szKey, szValue, szComment);
 
         return true;
     }
 
     if (pKey != NULL)
     {
-        pKey->szValue = szValue;
-        pKey->szComment = szComment;
+        pKey->szValue = std::move(szValue);
+        pKey->szComment = std::move(szComment);
 
         m_bDirty = true;
 
@@ -519,18 +505,19 @@ bool CDataFile::GetBoolOrDefault(t_Str szKey, t_Str szSection, bool defaultValue
 // found or true when sucessfully deleted.
 bool CDataFile::DeleteSection(t_Str szSection)
 {
-    SectionItor s_pos;
+    const auto it = m_SectionIndex.find(string_view(szSection));
 
-    for (s_pos = m_Sections.begin(); s_pos != m_Sections.end(); s_pos++)
-    {
-        if (CompareNoCase((*s_pos).szName, szSection) == 0)
-        {
-            m_Sections.erase(s_pos);
-            return true;
-        }
-    }
+    if (it == m_SectionIndex.end())
+        return false;
 
-    return false;
+    m_Sections.erase(m_Sections.begin() + it->second);
+
+    // Positions after the erased section have shifted
+    m_SectionIndex.clear();
+    for (size_t i = 0; i < m_Sections.size(); i++)
+        m_SectionIndex.emplace(m_Sections[i].szName, i);
+
+    return true;
 }
 
 // DeleteKey
@@ -538,22 +525,24 @@ bool CDataFile::DeleteSection(t_Str szSection)
 // cannot be found or true when sucessfully deleted.
 bool CDataFile::DeleteKey(t_Str szKey, t_Str szFromSection)
 {
-    KeyItor k_pos;
     t_Section* pSection;
 
     if ((pSection = GetSection(szFromSection)) == NULL)
         return false;
 
-    for (k_pos = pSection->Keys.begin(); k_pos != pSection->Keys.end(); k_pos++)
-    {
-        if (CompareNoCase((*k_pos).szKey, szKey) == 0)
-        {
-            pSection->Keys.erase(k_pos);
-            return true;
-        }
-    }
+    const auto it = pSection->KeyIndex.find(string_view(szKey));
 
-    return false;
+    if (it == pSection->KeyIndex.end())
+        return false;
+
+    pSection->Keys.erase(pSection->Keys.begin() + it->second);
+
+    // Positions after the erased key have shifted
+    pSection->KeyIndex.clear();
+    for (size_t i = 0; i < pSection->Keys.size(); i++)
+        pSection->KeyIndex.emplace(pSection->Keys[i].szKey, i);
+
+    return true;
 }
 
 // CreateKey
@@ -592,11 +581,7 @@ bool CDataFile::CreateSection(t_Str szSection, t_Str szComment)
         return false;
     }
 
-    pSection = new t_Section;
-
-    pSection->szName = szSection;
-    pSection->szComment = szComment;
-    m_Sections.push_back(*pSection);
+    AddSection(szSection, szComment);
     m_bDirty = true;
 
     return true;
@@ -618,20 +603,9 @@ bool CDataFile::CreateSection(t_Str szSection, t_Str szComment, KeyList Keys)
     if (!pSection)
         return false;
 
-    KeyItor k_pos;
+    for (const auto& Key : Keys)
+        AddKey(pSection, Key.szKey, Key.szValue, Key.szComment);
 
-    pSection->szName = szSection;
-    for (k_pos = Keys.begin(); k_pos != Keys.end(); k_pos++)
-    {
-        t_Key* pKey = new t_Key;
-        pKey->szComment = (*k_pos).szComment;
-        pKey->szKey = (*k_pos).szKey;
-        pKey->szValue = (*k_pos).szValue;
-
-        pSection->Keys.push_back(*pKey);
-    }
-
-    m_Sections.push_back(*pSection);
     m_bDirty = true;
 
     return true;
@@ -664,9 +638,8 @@ int CDataFile::KeyCount()
 // GetKey
 // Given a key and section name, looks up the key and if found, returns a
 // pointer to that key, otherwise returns NULL.
-t_Key* CDataFile::GetKey(t_Str szKey, t_Str szSection)
+t_Key* CDataFile::GetKey(string_view szKey, string_view szSection)
 {
-    KeyItor k_pos;
     t_Section* pSection;
 
     // Since our default section has a name value of t_Str("") this should
@@ -675,29 +648,60 @@ t_Key* CDataFile::GetKey(t_Str szKey, t_Str szSection)
     if ((pSection = GetSection(szSection)) == NULL)
         return NULL;
 
-    for (k_pos = pSection->Keys.begin(); k_pos != pSection->Keys.end(); k_pos++)
-    {
-        if (CompareNoCase((*k_pos).szKey, szKey) == 0)
-            return (t_Key*)&(*k_pos);
-    }
+    return GetKey(pSection, szKey);
+}
 
-    return NULL;
+// GetKey
+// Looks up the key in the given section, returns NULL if it's not there.
+t_Key* CDataFile::GetKey(t_Section* pSection, string_view szKey)
+{
+    const auto it = pSection->KeyIndex.find(szKey);
+
+    return it == pSection->KeyIndex.end() ? NULL : &pSection->Keys[it->second];
 }
 
 // GetSection
 // Given a section name, locates that section in the list and returns a pointer
 // to it. If the section was not found, returns NULL
-t_Section* CDataFile::GetSection(t_Str szSection)
+t_Section* CDataFile::GetSection(string_view szSection)
 {
-    SectionItor s_pos;
+    const auto it = m_SectionIndex.find(szSection);
 
-    for (s_pos = m_Sections.begin(); s_pos != m_Sections.end(); s_pos++)
+    return it == m_SectionIndex.end() ? NULL : &m_Sections[it->second];
+}
+
+// AddSection
+// Appends a new section to the list and indexes it. Callers make sure the
+// section doesn't exist yet.
+t_Section* CDataFile::AddSection(string_view szSection, string_view szComment)
+{
+    t_Section& Section = m_Sections.emplace_back();
+
+    Section.szName = szSection;
+    Section.szComment = szComment;
+    m_SectionIndex.emplace(Section.szName, m_Sections.size() - 1);
+
+    return &Section;
+}
+
+// AddKey
+// Sets the value and comment of a key in the given section, appending the key
+// if the section doesn't contain it yet.
+void CDataFile::AddKey(t_Section* pSection, string_view szKey, string_view szValue, string_view szComment)
+{
+    t_Key* pKey = GetKey(pSection, szKey);
+
+    if (pKey == NULL)
     {
-        if (CompareNoCase((*s_pos).szName, szSection) == 0)
-            return (t_Section*)&(*s_pos);
+        pKey = &pSection->Keys.emplace_back();
+        pKey->szKey = szKey;
+        pSection->KeyIndex.emplace(pKey->szKey, pSection->Keys.size() - 1);
     }
 
-    return NULL;
+    pKey->szValue = szValue;
+    pKey->szComment = szComment;
+
+    m_bDirty = true;
 }
 
 
@@ -726,6 +730,50 @@ t_Str CDataFile::CommentStr(t_Str szComment)
 // Utility Functions ////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////
 
+// NoCaseHash
+// FNV-1a over the lower cased characters, so names differing only in case
+// land in the same bucket.
+size_t NoCaseHash::operator()(string_view str) const
+{
+    size_t hash = 14695981039346656037ull;
+
+    for (const char c : str)
+    {
+        hash ^= static_cast<size_t>(tolower(static_cast<unsigned char>(c)));
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+// NoCaseEqual
+// Case insensitive equality, the index counterpart of CompareNoCase.
+bool NoCaseEqual::operator()(string_view str1, string_view str2) const
+{
+    if (str1.size() != str2.size())
+        return false;
+
+    for (size_t i = 0; i < str1.size(); i++)
+    {
+        if (tolower(static_cast<unsigned char>(str1[i])) != tolower(static_cast<unsigned char>(str2[i])))
+            return false;
+    }
+
+    return true;
+}
+
+// TrimView
+// Trims the given characters from both sides of a string_view without copying.
+string_view TrimView(string_view szStr, string_view szTrimChars)
+{
+    const size_t nPos = szStr.find_first_not_of(szTrimChars);
+
+    if (nPos == string_view::npos)
+        return string_view();
+
+    return szStr.substr(nPos, szStr.find_last_not_of(szTrimChars) - nPos + 1);
+}
+
 // GetNextWord
 // Given a key +delimiter+ value string, pulls the key name from the string,
 // deletes the delimiter and alters the original string to contain the
@@ -17,6 +17,8 @@
 #include <vector>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 // Globally defined structures, defines, & types
 //////////////////////////////////////////////////////////////////////////////////
@@ -68,6 +70,24 @@ enum e_DebugLevel
 
 typedef std::string t_Str;
 
+// NoCaseHash / NoCaseEqual
+// Case insensitive hashing and comparison for the section and key indices. Both
+// are transparent so lookups by string_view don't have to build a t_Str first.
+struct NoCaseHash
+{
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const;
+};
+
+struct NoCaseEqual
+{
+    using is_transparent = void;
+    bool operator()(std::string_view str1, std::string_view str2) const;
+};
+
+// Maps a (case insensitive) name to its position in the owning list
+typedef std::unordered_map<t_Str, size_t, NoCaseHash, NoCaseEqual> NameIndex;
+
 // CommentIndicators
 // This constant contains the characters that we check for to determine if a 
 // line is a comment or not. Note that the first character in this constant is
@@ -114,12 +134,14 @@ typedef KeyList::iterator KeyItor;
 // st_section
 // This structure stores the definition of a section. A section contains any number
 // of keys (see st_keys), and may or may not have a comment. Like keys, all
-// comments must precede the section.
+// comments must precede the section. Keys are kept in file order, KeyIndex finds
+// them by name.
 typedef struct st_section
 {
     t_Str		szName;
     t_Str		szComment;
     KeyList		Keys;
+    NameIndex	KeyIndex;
 
     st_section()
     {
@@ -141,6 +163,7 @@ void	Report(e_DebugLevel DebugLevel, const char* fmt, ...);
 t_Str	GetNextWord(t_Str& CommandLine);
 int		CompareNoCase(t_Str str1, t_Str str2);
 void	Trim(t_Str& szStr);
+std::string_view	TrimView(std::string_view szStr, std::string_view szTrimChars);
 int		WriteLn(std::fstream& stream, const char* fmt, ...);
 
 
@@ -264,9 +287,15 @@ protected:
 
     // GetKey: Returns the requested key (if found) from the requested
     // Section. Returns NULL otherwise.
-    t_Key* GetKey(t_Str szKey, t_Str szSection);
+    t_Key* GetKey(std::string_view szKey, std::string_view szSection);
+    // GetKey: Returns the requested key (if found) from the given section.
+    t_Key* GetKey(t_Section* pSection, std::string_view szKey);
     // GetSection: Returns the requested section (if found), NULL otherwise.
-    t_Section* GetSection(t_Str szSection);
+    t_Section* GetSection(std::string_view szSection);
+    // AddSection: Appends a section without checking whether it exists.
+    t_Section* AddSection(std::string_view szSection, std::string_view szComment);
+    // AddKey: Sets the key's value in the given section, appending it if needed.
+    void		AddKey(t_Section* pSection, std::string_view szKey, std::string_view szValue, std::string_view szComment);
 
 
     // Data
@@ -275,6 +304,7 @@ public:
 
 protected:
     SectionList	m_Sections;		// Our list of sections
+    NameIndex	m_SectionIndex;	// Section positions in m_Sections by name
     t_Str		m_szFileName;	// The filename to write to
     bool		m_bDirty;		// Tracks whether or not data has changed.
 };
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Profiling
+{
+    /// <summary>
+    /// On-disk layout of a command capture. The file starts with a CaptureHeader, followed by chunks of
+    /// [varint thread id][varint payload size][payload]. Concatenating the payloads of one thread id in file order gives
+    /// that thread's event stream. Each event is a varint CaptureEventType followed by its fields, all varints unless
+    /// noted otherwise. Handles are written as-is, signed values zigzag-encoded.
+    /// Only depends on the standard library, so tools reading captures don't need ReShade or Windows.
+    /// </summary>
+    enum CaptureEventType : uint32_t
+    {
+        CAPTURE_FRAME = 0,              // frame index; written to a thread's stream when it first records in a frame
+        CAPTURE_COMMAND_LIST,           // command list handle; all following events of the thread belong to it
+        CAPTURE_BIND_PIPELINE,          // stages, pipeline handle, pixel shader hash, vertex shader hash
+        CAPTURE_BIND_RENDER_TARGETS,    // count, count * target, dsv; a target is its view, followed by resource, width, height, format and samples if the view isn't 0
+        CAPTURE_BEGIN_RENDER_PASS,      // count, count * target, dsv
+        CAPTURE_PUSH_DESCRIPTORS,       // stages, layout, param, binding, type, count, count * descriptor; buffer ranges are buffer, offset, size
+        CAPTURE_PUSH_CONSTANTS,         // stages, layout, param, first, count, count * raw uint32
+        CAPTURE_DRAW,                   // vertex count, instance count, first vertex, first instance
+        CAPTURE_DRAW_INDEXED,           // index count, instance count, first index, zigzag vertex offset, first instance
+        CAPTURE_DRAW_INDIRECT,          // indirect command, buffer, offset, draw count, stride
+        CAPTURE_PRESENT,                // queue handle, swapchain handle
+        CAPTURE_EVENT_TYPE_COUNT
+    };
+
+    /// <summary>
+    /// The reshade::api::descriptor_type values whose descriptors take more than one value in CAPTURE_PUSH_DESCRIPTORS.
+    /// CommandCapture.cpp checks them against ReShade's.
+    /// </summary>
+    enum CaptureDescriptorType : uint32_t
+    {
+        CAPTURE_DESCRIPTOR_SAMPLER_WITH_RESOURCE_VIEW = 1,
+        CAPTURE_DESCRIPTOR_CONSTANT_BUFFER = 6,
+        CAPTURE_DESCRIPTOR_SHADER_STORAGE_BUFFER = 7
+    };
+
+    /// <summary>
+    /// Values written per descriptor of the given type: samplers and views are one, sampler/view pairs two, buffer ranges
+    /// three (buffer, offset, size)
+    /// </summary>
+    constexpr uint32_t CaptureDescriptorWidth(uint32_t type)
+    {
+        switch (type)
+        {
+        case CAPTURE_DESCRIPTOR_SAMPLER_WITH_RESOURCE_VIEW:
+            return 2;
+        case CAPTURE_DESCRIPTOR_CONSTANT_BUFFER:
+        case CAPTURE_DESCRIPTOR_SHADER_STORAGE_BUFFER:
+            return 3;
+        default:
+            return 1;
+        }
+    }
+
+    struct CaptureHeader
+    {
+        static constexpr char MAGIC[8] = { 'S', 'T', 'C', 'A', 'P', 'T', 'R', 0 };
+        static constexpr uint32_t VERSION = 1;
+
+        char magic[8];
+        uint32_t version;
+        uint32_t deviceApi;
+        uint64_t dataSize;          // bytes of chunk data following the header
+        uint32_t frameCount;
+        uint32_t droppedChunks;     // chunks which didn't fit in the file anymore
+    };
+}
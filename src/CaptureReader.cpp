@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "CaptureReader.h"
+
+using namespace Profiling;
+using namespace std;
+
+namespace
+{
+    struct Cursor
+    {
+        const uint8_t* data;
+        size_t size;
+        size_t pos = 0;
+
+        bool AtEnd() const { return pos >= size; }
+
+        bool Varint(uint64_t& value)
+        {
+            value = 0;
+            for (uint32_t shift = 0; shift < 64 && pos < size; shift += 7)
+            {
+                const uint8_t byte = data[pos++];
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+                if (byte < 0x80)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        template<typename T>
+        bool Varint(T& value)
+        {
+            uint64_t v;
+            if (!Varint(v))
+            {
+                return false;
+            }
+
+            value = static_cast<T>(v);
+            return true;
+        }
+
+        bool Raw(void* dest, size_t count)
+        {
+            if (size - pos < count)
+            {
+                return false;
+            }
+
+            memcpy(dest, data + pos, count);
+            pos += count;
+            return true;
+        }
+    };
+
+    struct Scratch
+    {
+        vector<CaptureTarget> targets;
+        vector<uint64_t> descriptors;
+        vector<uint32_t> constants;
+    };
+
+    struct Segment
+    {
+        uint32_t frame;
+        uint32_t stream;
+        size_t begin;
+        size_t end;
+    };
+
+    bool DecodeTargets(Cursor& cursor, vector<CaptureTarget>& targets)
+    {
+        uint32_t count;
+        if (!cursor.Varint(count) || count > cursor.size - cursor.pos)
+        {
+            return false;
+        }
+
+        targets.resize(count);
+        for (auto& target : targets)
+        {
+            target = CaptureTarget();
+
+            if (!cursor.Varint(target.view))
+            {
+                return false;
+            }
+
+            if (target.view != 0 && !(cursor.Varint(target.resource) && cursor.Varint(target.width) && cursor.Varint(target.height) &&
+                cursor.Varint(target.format) && cursor.Varint(target.samples)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool DecodeEvent(Cursor& cursor, uint32_t threadId, CaptureVisitor& visitor, Scratch& scratch, uint32_t& type)
+    {
+        if (!cursor.Varint(type))
+        {
+            return false;
+        }
+
+        switch (type)
+        {
+        case CAPTURE_FRAME:
+        {
+            uint32_t frame;
+            if (!cursor.Varint(frame))
+                return false;
+            visitor.OnThread(threadId, frame);
+            return true;
+        }
+        case CAPTURE_COMMAND_LIST:
+        {
+            uint64_t cmd_list;
+            if (!cursor.Varint(cmd_list))
+                return false;
+            visitor.OnCommandList(cmd_list);
+            return true;
+        }
+        case CAPTURE_BIND_PIPELINE:
+        {
+            uint32_t stages, psHash, vsHash;
+            uint64_t pipeline;
+            if (!(cursor.Varint(stages) && cursor.Varint(pipeline) && cursor.Varint(psHash) && cursor.Varint(vsHash)))
+                return false;
+            visitor.OnBindPipeline(stages, pipeline, psHash, vsHash);
+            return true;
+        }
+        case CAPTURE_BIND_RENDER_TARGETS:
+        case CAPTURE_BEGIN_RENDER_PASS:
+        {
+            uint64_t dsv;
+            if (!DecodeTargets(cursor, scratch.targets) || !cursor.Varint(dsv))
+                return false;
+            if (type == CAPTURE_BIND_RENDER_TARGETS)
+                visitor.OnBindRenderTargets(scratch.targets, dsv);
+            else
+                visitor.OnBeginRenderPass(scratch.targets, dsv);
+            return true;
+        }
+        case CAPTURE_PUSH_DESCRIPTORS:
+        {
+            uint32_t stages, param, binding, descriptorType, count;
+            uint64_t layout;
+            if (!(cursor.Varint(stages) && cursor.Varint(layout) && cursor.Varint(param) && cursor.Varint(binding) && cursor.Varint(descriptorType) && cursor.Varint(count)))
+                return false;
+
+            const uint64_t values = static_cast<uint64_t>(count) * CaptureDescriptorWidth(descriptorType);
+            if (values > cursor.size - cursor.pos)
+                return false;
+
+            scratch.descriptors.resize(static_cast<size_t>(values));
+            for (auto& value : scratch.descriptors)
+            {
+                if (!cursor.Varint(value))
+                    return false;
+            }
+
+            visitor.OnPushDescriptors(stages, layout, param, binding, descriptorType, count, scratch.descriptors);
+            return true;
+        }
+        case CAPTURE_PUSH_CONSTANTS:
+        {
+            uint32_t stages, param, first, count;
+            uint64_t layout;
+            if (!(cursor.Varint(stages) && cursor.Varint(layout) && cursor.Varint(param) && cursor.Varint(first) && cursor.Varint(count)))
+                return false;
+            if (count > (cursor.size - cursor.pos) / sizeof(uint32_t))
+                return false;
+
+            scratch.constants.resize(count);
+            cursor.Raw(scratch.constants.data(), count * sizeof(uint32_t));
+
+            visitor.OnPushConstants(stages, layout, param, first, scratch.constants);
+            return true;
+        }
+        case CAPTURE_DRAW:
+        {
+            uint32_t vertexCount, instanceCount, firstVertex, firstInstance;
+            if (!(cursor.Varint(vertexCount) && cursor.Varint(instanceCount) && cursor.Varint(firstVertex) && cursor.Varint(firstInstance)))
+                return false;
+            visitor.OnDraw(vertexCount, instanceCount, firstVertex, firstInstance);
+            return true;
+        }
+        case CAPTURE_DRAW_INDEXED:
+        {
+            uint32_t indexCount, instanceCount, firstIndex, firstInstance;
+            uint64_t vertexOffset;
+            if (!(cursor.Varint(indexCount) && cursor.Varint(instanceCount) && cursor.Varint(firstIndex) && cursor.Varint(vertexOffset) && cursor.Varint(firstInstance)))
+                return false;
+            visitor.OnDrawIndexed(indexCount, instanceCount, firstIndex, static_cast<int32_t>(static_cast<int64_t>(vertexOffset >> 1) ^ -static_cast<int64_t>(vertexOffset & 1)), firstInstance);
+            return true;
+        }
+        case CAPTURE_DRAW_INDIRECT:
+        {
+            uint32_t indirectType, drawCount, stride;
+            uint64_t buffer, offset;
+            if (!(cursor.Varint(indirectType) && cursor.Varint(buffer) && cursor.Varint(offset) && cursor.Varint(drawCount) && cursor.Varint(stride)))
+                return false;
+            visitor.OnDrawIndirect(indirectType, buffer, offset, drawCount, stride);
+            return true;
+        }
+        case CAPTURE_PRESENT:
+        {
+            uint64_t queue, swapchain;
+            if (!(cursor.Varint(queue) && cursor.Varint(swapchain)))
+                return false;
+            visitor.OnPresent(queue, swapchain);
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+}
+
+bool CaptureReader::Read(const filesystem::path& path, CaptureVisitor& visitor, CaptureHeader* header)
+{
+    ifstream file(path, ios::in | ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    vector<uint8_t> data(static_cast<size_t>(filesystem::file_size(path)));
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<streamsize>(data.size())))
+    {
+        return false;
+    }
+
+    return Decode(data.data(), data.size(), visitor, header);
+}
+
+bool CaptureReader::Decode(const uint8_t* data, size_t size, CaptureVisitor& visitor, CaptureHeader* header)
+{
+    CaptureHeader fileHeader;
+    if (size < sizeof(CaptureHeader))
+    {
+        return false;
+    }
+
+    memcpy(&fileHeader, data, sizeof(fileHeader));
+    if (memcmp(fileHeader.magic, CaptureHeader::MAGIC, sizeof(fileHeader.magic)) != 0 || fileHeader.version != CaptureHeader::VERSION ||
+        fileHeader.dataSize > size - sizeof(CaptureHeader))
+    {
+        return false;
+    }
+
+    if (header != nullptr)
+    {
+        *header = fileHeader;
+    }
+
+    // Stitch each thread's chunks back together, in file order
+    vector<uint32_t> threadIds;
+    vector<vector<uint8_t>> streams;
+    Cursor chunks = { data + sizeof(CaptureHeader), static_cast<size_t>(fileHeader.dataSize) };
+
+    while (!chunks.AtEnd())
+    {
+        uint32_t threadId;
+        uint64_t chunkSize;
+        if (!chunks.Varint(threadId) || !chunks.Varint(chunkSize) || chunkSize > chunks.size - chunks.pos)
+        {
+            return false;
+        }
+
+        const auto it = std::find(threadIds.begin(), threadIds.end(), threadId);
+        const size_t stream = it - threadIds.begin();
+        if (it == threadIds.end())
+        {
+            threadIds.push_back(threadId);
+            streams.emplace_back();
+        }
+
+        streams[stream].insert(streams[stream].end(), chunks.data + chunks.pos, chunks.data + chunks.pos + chunkSize);
+        chunks.pos += static_cast<size_t>(chunkSize);
+    }
+
+    // Split the streams at their frame markers, so threads can be interleaved frame by frame
+    CaptureVisitor skip;
+    Scratch scratch;
+    vector<Segment> segments;
+
+    for (uint32_t stream = 0; stream < streams.size(); stream++)
+    {
+        Cursor cursor = { streams[stream].data(), streams[stream].size() };
+
+        while (!cursor.AtEnd())
+        {
+            const size_t begin = cursor.pos;
+            uint32_t type;
+            if (!DecodeEvent(cursor, 0, skip, scratch, type))
+            {
+                return false;
+            }
+
+            if (type == CAPTURE_FRAME || segments.empty() || segments.back().stream != stream)
+            {
+                Cursor frameCursor = { cursor.data, cursor.size, begin };
+                uint64_t frame = 0;
+                if (type == CAPTURE_FRAME)
+                {
+                    frameCursor.Varint(frame);
+                    frameCursor.Varint(frame);
+                }
+
+                segments.push_back({ static_cast<uint32_t>(frame), stream, begin, cursor.pos });
+            }
+            else
+            {
+                segments.back().end = cursor.pos;
+            }
+        }
+    }
+
+    std::stable_sort(segments.begin(), segments.end(), [](const auto& lhs, const auto& rhs) { return lhs.frame < rhs.frame; });
+
+    for (const auto& segment : segments)
+    {
+        Cursor cursor = { streams[segment.stream].data(), segment.end, segment.begin };
+
+        while (!cursor.AtEnd())
+        {
+            uint32_t type;
+            if (!DecodeEvent(cursor, threadIds[segment.stream], visitor, scratch, type))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
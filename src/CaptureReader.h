@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "CaptureFormat.h"
+
+namespace Profiling
+{
+    struct CaptureTarget
+    {
+        uint64_t view = 0;
+        uint64_t resource = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t format = 0;
+        uint32_t samples = 0;
+    };
+
+    /// <summary>
+    /// Receives the events of a command capture. Everything defaults to a no-op so replays only implement what they
+    /// drive. Buffers passed in are only valid for the duration of the call.
+    /// </summary>
+    class CaptureVisitor
+    {
+    public:
+        virtual ~CaptureVisitor() = default;
+
+        virtual void OnThread(uint32_t threadId, uint32_t frame) {}
+        virtual void OnCommandList(uint64_t cmd_list) {}
+        virtual void OnBindPipeline(uint32_t stages, uint64_t pipeline, uint32_t psHash, uint32_t vsHash) {}
+        virtual void OnBindRenderTargets(const std::vector<CaptureTarget>& rtvs, uint64_t dsv) {}
+        virtual void OnBeginRenderPass(const std::vector<CaptureTarget>& rts, uint64_t dsv) {}
+        // Descriptors are flattened: samplers and views are one value, sampler/view pairs two, buffer ranges three (buffer, offset, size)
+        virtual void OnPushDescriptors(uint32_t stages, uint64_t layout, uint32_t param, uint32_t binding, uint32_t type, uint32_t count, const std::vector<uint64_t>& descriptors) {}
+        virtual void OnPushConstants(uint32_t stages, uint64_t layout, uint32_t param, uint32_t first, const std::vector<uint32_t>& values) {}
+        virtual void OnDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {}
+        virtual void OnDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {}
+        virtual void OnDrawIndirect(uint32_t type, uint64_t buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) {}
+        virtual void OnPresent(uint64_t queue, uint64_t swapchain) {}
+    };
+
+    /// <summary>
+    /// Decodes a file written by CommandCapture. Only depends on the standard library, so a replay can run outside of the
+    /// game, on any platform. Events are delivered frame by frame; within a frame each recording thread's
+    /// events are delivered in order, one thread after the other, starting with OnThread.
+    /// </summary>
+    class __declspec(novtable) CaptureReader final
+    {
+    public:
+        /// <summary>
+        /// Reads and replays the capture into the visitor. Returns false if the file isn't a capture of a supported version
+        /// or is malformed, in which case the visitor may have received part of it.
+        /// </summary>
+        static bool Read(const std::filesystem::path& path, CaptureVisitor& visitor, CaptureHeader* header = nullptr);
+
+        /// <summary>
+        /// Same as Read, for a capture already in memory
+        /// </summary>
+        static bool Decode(const uint8_t* data, size_t size, CaptureVisitor& visitor, CaptureHeader* header = nullptr);
+    };
+}
@@ -0,0 +1,451 @@
+#include <windows.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include "CommandCapture.h"
+
+using namespace Profiling;
+using namespace reshade::api;
+using namespace std;
+
+static_assert(CAPTURE_DESCRIPTOR_SAMPLER_WITH_RESOURCE_VIEW == static_cast<uint32_t>(descriptor_type::sampler_with_resource_view));
+static_assert(CAPTURE_DESCRIPTOR_CONSTANT_BUFFER == static_cast<uint32_t>(descriptor_type::constant_buffer));
+static_assert(CAPTURE_DESCRIPTOR_SHADER_STORAGE_BUFFER == static_cast<uint32_t>(descriptor_type::shader_storage_buffer));
+
+atomic_bool CommandCapture::_capturing = false;
+atomic_uint32_t CommandCapture::_pendingFrames = 0;
+atomic_uint32_t CommandCapture::_frame = 0;
+atomic_uint64_t CommandCapture::_writeOffset = 0;
+atomic_uint64_t CommandCapture::_dataEnd = 0;
+atomic_uint32_t CommandCapture::_droppedChunks = 0;
+atomic_uint32_t CommandCapture::_generation = 0;
+uint32_t CommandCapture::_framesLeft = 0;
+uint32_t CommandCapture::_deviceApi = 0;
+filesystem::path CommandCapture::_path;
+void* CommandCapture::_file = INVALID_HANDLE_VALUE;
+void* CommandCapture::_mapping = nullptr;
+uint8_t* CommandCapture::_view = nullptr;
+mutex CommandCapture::_bufferMutex;
+vector<unique_ptr<CommandCapture::ThreadBuffer>> CommandCapture::_buffers;
+
+static inline uint32_t EncodeVarint(uint8_t* dest, uint64_t value)
+{
+    uint32_t size = 0;
+    while (value >= 0x80)
+    {
+        dest[size++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    dest[size++] = static_cast<uint8_t>(value);
+
+    return size;
+}
+
+void CommandCapture::ThreadBuffer::Varint(uint64_t value)
+{
+    EnsureSpace(*this, 10);
+    size += EncodeVarint(data + size, value);
+}
+
+void CommandCapture::ThreadBuffer::Raw(const void* value, uint32_t valueSize)
+{
+    EnsureSpace(*this, valueSize);
+    memcpy(data + size, value, valueSize);
+    size += valueSize;
+}
+
+bool CommandCapture::Start(const filesystem::path& path, uint32_t frames, device_api api)
+{
+    if (frames == 0 || IsActive())
+    {
+        return false;
+    }
+
+    _path = path;
+    _deviceApi = static_cast<uint32_t>(api);
+    _pendingFrames.store(frames, memory_order_relaxed);
+
+    return true;
+}
+
+void CommandCapture::EndFrame()
+{
+    if (IsCapturing())
+    {
+        _frame.fetch_add(1, memory_order_relaxed);
+
+        if (--_framesLeft == 0)
+        {
+            Finish();
+        }
+
+        return;
+    }
+
+    const uint32_t frames = _pendingFrames.exchange(0, memory_order_relaxed);
+    if (frames == 0)
+    {
+        return;
+    }
+
+    _file = CreateFileW(_path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_file != INVALID_HANDLE_VALUE)
+    {
+        _mapping = CreateFileMappingW(_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(FILE_CAPACITY >> 32), static_cast<DWORD>(FILE_CAPACITY), nullptr);
+        if (_mapping != nullptr)
+        {
+            _view = static_cast<uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(FILE_CAPACITY)));
+        }
+    }
+
+    if (_view == nullptr)
+    {
+        reshade::log_message(reshade::log_level::error, std::format("Failed to create command capture {}", _path.string()).c_str());
+
+        if (_mapping != nullptr)
+        {
+            CloseHandle(_mapping);
+            _mapping = nullptr;
+        }
+
+        if (_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(_file);
+            _file = INVALID_HANDLE_VALUE;
+        }
+
+        return;
+    }
+
+    _framesLeft = frames;
+    _frame.store(0, memory_order_relaxed);
+    _writeOffset.store(sizeof(CaptureHeader), memory_order_relaxed);
+    _dataEnd.store(FILE_CAPACITY, memory_order_relaxed);
+    _droppedChunks.store(0, memory_order_relaxed);
+    _generation.fetch_add(1, memory_order_relaxed);
+    _capturing.store(true, memory_order_release);
+}
+
+void CommandCapture::Stop()
+{
+    _pendingFrames.store(0, memory_order_relaxed);
+
+    if (IsCapturing())
+    {
+        Finish();
+    }
+}
+
+void CommandCapture::Finish()
+{
+    _capturing.store(false, memory_order_relaxed);
+
+    {
+        // Writers re-check the capture state under their buffer's lock, after this nothing touches the mapping anymore
+        unique_lock<mutex> lock(_bufferMutex);
+        const uint32_t generation = _generation.load(memory_order_relaxed);
+
+        for (auto& buffer : _buffers)
+        {
+            unique_lock<mutex> bufferLock(buffer->mutex);
+            if (buffer->generation == generation)
+            {
+                Flush(*buffer);
+            }
+        }
+    }
+
+    const uint64_t dataEnd = std::min(_writeOffset.load(memory_order_relaxed), _dataEnd.load(memory_order_relaxed));
+
+    CaptureHeader header;
+    memcpy(header.magic, CaptureHeader::MAGIC, sizeof(header.magic));
+    header.version = CaptureHeader::VERSION;
+    header.deviceApi = _deviceApi;
+    header.dataSize = dataEnd - sizeof(CaptureHeader);
+    header.frameCount = _frame.load(memory_order_relaxed);
+    header.droppedChunks = _droppedChunks.load(memory_order_relaxed);
+    memcpy(_view, &header, sizeof(header));
+
+    UnmapViewOfFile(_view);
+    CloseHandle(_mapping);
+    _view = nullptr;
+    _mapping = nullptr;
+
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(dataEnd);
+    SetFilePointerEx(_file, size, nullptr, FILE_BEGIN);
+    SetEndOfFile(_file);
+    CloseHandle(_file);
+    _file = INVALID_HANDLE_VALUE;
+
+    if (header.droppedChunks > 0)
+    {
+        reshade::log_message(reshade::log_level::warning, std::format("Command capture {} is truncated, {} chunks didn't fit", _path.string(), header.droppedChunks).c_str());
+    }
+
+    reshade::log_message(reshade::log_level::info, std::format("Wrote {} frames, {} bytes of commands to {}", header.frameCount, header.dataSize, _path.string()).c_str());
+}
+
+CommandCapture::ThreadBuffer* CommandCapture::Begin(command_list* cmd_list, CaptureEventType type, unique_lock<mutex>& lock)
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if (buffer == nullptr)
+    {
+        // Buffers outlive their threads so Finish never flushes freed memory
+        unique_lock<mutex> registerLock(_bufferMutex);
+        _buffers.push_back(make_unique<ThreadBuffer>());
+        buffer = _buffers.back().get();
+        buffer->threadId = GetCurrentThreadId();
+    }
+
+    lock = unique_lock<mutex>(buffer->mutex);
+
+    if (!_capturing.load(memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    const uint32_t generation = _generation.load(memory_order_relaxed);
+    if (buffer->generation != generation)
+    {
+        buffer->generation = generation;
+        buffer->frame = UINT32_MAX;
+        buffer->commandList = 0;
+        buffer->size = 0;
+    }
+
+    const uint32_t frame = _frame.load(memory_order_relaxed);
+    if (buffer->frame != frame)
+    {
+        buffer->Varint(CAPTURE_FRAME);
+        buffer->Varint(frame);
+        buffer->frame = frame;
+
+        // Command lists are recycled across frames, make each frame's stream self-contained
+        buffer->commandList = 0;
+    }
+
+    if (cmd_list != nullptr && buffer->commandList != reinterpret_cast<uint64_t>(cmd_list))
+    {
+        buffer->commandList = reinterpret_cast<uint64_t>(cmd_list);
+        buffer->Varint(CAPTURE_COMMAND_LIST);
+        buffer->Varint(buffer->commandList);
+    }
+
+    buffer->Varint(type);
+
+    return buffer;
+}
+
+void CommandCapture::EnsureSpace(ThreadBuffer& buffer, uint32_t size)
+{
+    if (buffer.size + size > THREAD_BUFFER_SIZE)
+    {
+        Flush(buffer);
+    }
+}
+
+void CommandCapture::Flush(ThreadBuffer& buffer)
+{
+    if (buffer.size == 0)
+    {
+        return;
+    }
+
+    uint8_t chunkHeader[20];
+    uint32_t chunkHeaderSize = EncodeVarint(chunkHeader, buffer.threadId);
+    chunkHeaderSize += EncodeVarint(chunkHeader + chunkHeaderSize, buffer.size);
+
+    const uint64_t chunkSize = chunkHeaderSize + buffer.size;
+    const uint64_t offset = _writeOffset.fetch_add(chunkSize, memory_order_relaxed);
+
+    if (offset + chunkSize <= FILE_CAPACITY)
+    {
+        memcpy(_view + offset, chunkHeader, chunkHeaderSize);
+        memcpy(_view + offset + chunkHeaderSize, buffer.data, buffer.size);
+    }
+    else
+    {
+        // Everything reserved after the first chunk that didn't fit is lost as well, the file ends before it
+        uint64_t dataEnd = _dataEnd.load(memory_order_relaxed);
+        while (offset < dataEnd && !_dataEnd.compare_exchange_weak(dataEnd, offset, memory_order_relaxed))
+        {
+        }
+
+        _droppedChunks.fetch_add(1, memory_order_relaxed);
+    }
+
+    buffer.size = 0;
+}
+
+void CommandCapture::WriteTargetDesc(ThreadBuffer& buffer, device* device, resource_view view)
+{
+    buffer.Varint(view.handle);
+
+    if (view.handle == 0)
+    {
+        return;
+    }
+
+    const resource res = device->get_resource_from_view(view);
+    const resource_desc desc = res.handle != 0 ? device->get_resource_desc(res) : resource_desc();
+
+    buffer.Varint(res.handle);
+    buffer.Varint(desc.texture.width);
+    buffer.Varint(desc.texture.height);
+    buffer.Varint(static_cast<uint32_t>(desc.texture.format));
+    buffer.Varint(desc.texture.samples);
+}
+
+void CommandCapture::_RecordBindPipeline(command_list* cmd_list, pipeline_stage stages, pipeline pipeline, uint32_t psHash, uint32_t vsHash)
+{
+    unique_lock<mutex> lock;
+    ThreadBuffer* buffer = Begin(cmd_list, CAPTURE_BIND_PIPELINE, lock);
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    buffer->Varint(static_cast<uint32_t>(stages));
+    buffer->Varint(pipeline.handle);
+    buffer->Varint(psHash);
+    buffer->Varint(vsHash);
+}
+
+void CommandCapture::_RecordBindRenderTargets(command_list* cmd_list, uint32_t count, const resource_view* rtvs, resource_view dsv)
+{
+    unique_lock<mutex> lock;
+    ThreadBuffer* buffer = Begin(cmd_list, CAPTURE_BIND_RENDER_TARGETS, lock);
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    device* device = cmd_list->get_device();
+
+    buffer->Varint(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        WriteTargetDesc(*buffer, device, rtvs[i]);
+    }
+    buffer->Varint(dsv.handle);
+}
+
+void CommandCapture::_RecordBeginRenderPass(command_list* cmd_list, uint32_t count, const render_pass_render_target_desc* rts, const render_pass_depth_stencil_desc* ds)
+{
+    unique_lock<mutex> lock;
+    ThreadBuffer* buffer = Begin(cmd_list, CAPTURE_BEGIN_RENDER_PASS, lock);
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    device* device = cmd_list->get_device();
+
+    buffer->Varint(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        WriteTargetDesc(*buffer, device, rts[i].view);
+    }
+    buffer->Varint(ds != nullptr ? ds->view.handle : 0);
+}
+
+void CommandCapture::_RecordPushDescriptors(command_list* cmd_list, shader_stage stages, pipeline_layout layout, uint32_t param, const descriptor_table_update& update)
+{
+    unique_lock<mutex> lock;
+    ThreadBuffer* buffer = Begin(cmd_list, CAPTURE_PUSH_DESCRIPTORS, lock);
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    buffer->Varint(static_cast<uint32_t>(stages));
+    buffer->Varint(layout.handle);
+    buffer->Varint(param);
+    buffer->Varint(update.binding);
+    buffer->Varint(static_cast<uint32_t>(update.type));
+    buffer->Varint(update.count);
+
+    for (uint32_t i = 0; i < update.count; i++)
+    {
+        switch (update.type)
+        {
+        case descriptor_type::sampler:
+            buffer->Varint(static_cast<const sampler*>(update.descriptors)[i].handle);
+            break;
+        case descriptor_type::sampler_with_resource_view:
+            buffer->Varint(static_cast<const sampler_with_resource_view*>(update.descriptors)[i].sampler.handle);
+            buffer->Varint(static_cast<const sampler_with_resource_view*>(update.descriptors)[i].view.handle);
+            break;
+        case descriptor_type::constant_buffer:
+        case descriptor_type::shader_storage_buffer:
+        {
+            const buffer_range& range = static_cast<const buffer_range*>(update.descriptors)[i];
+            buffer->Varint(range.buffer.handle);
+            buffer->Varint(range.offset);
+            buffer->Varint(range.size);
+            break;
+        }
+        default:
+            buffer->Varint(static_cast<const resource_view*>(update.descriptors)[i].handle);
+            break;
+        }
+    }
+}
+
+void CommandCapture::_RecordPushConstants(command_list* cmd_list, shader_stage stages, pipeline_layout layout, uint32_t param, uint32_t first, uint32_t count, const void* values)
+{
+    unique_lock<mutex> lock;
+    ThreadBuffer* buffer = Begin(cmd_list, CAPTURE_PUSH_CONSTANTS, lock);
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    buffer->Varint(static_cast<uint32_t>(stages));
+    buffer->Varint(layout.handle);
+    buffer->Varint(param);
+    buffer->Varint(first);
+    buffer->Varint(count);
+
+    // Constants are mostly floats, which don't shrink as varints
+    const uint32_t* constants = static_cast<const uint32_t*>(values);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        buffer->Raw(&constants[i], sizeof(uint32_t));
+    }
+}
+
+void CommandCapture::_RecordDraw(command_list* cmd_list, CaptureEventType type, uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e)
+{
+    unique_lock<mutex> lock;
+    ThreadBuffer* buffer = Begin(cmd_list, type, lock);
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    buffer->Varint(a);
+    buffer->Varint(b);
+    buffer->Varint(c);
+    buffer->Varint(d);
+
+    if (type != CAPTURE_DRAW)
+    {
+        buffer->Varint(e);
+    }
+}
+
+void CommandCapture::_RecordPresent(command_queue* queue, swapchain* swapchain)
+{
+    unique_lock<mutex> lock;
+    ThreadBuffer* buffer = Begin(nullptr, CAPTURE_PRESENT, lock);
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    buffer->Varint(reinterpret_cast<uint64_t>(queue));
+    buffer->Varint(reinterpret_cast<uint64_t>(swapchain));
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <reshade.hpp>
+#include <cstdint>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "CaptureFormat.h"
+
+namespace Profiling
+{
+    /// <summary>
+    /// Writes every hooked command of a range of frames to a memory-mapped file. Events are varint-encoded into a buffer
+    /// per thread, which is copied into the mapping with a single atomic reservation once full, so recording never makes
+    /// a system call. Outside of a capture the hooks only pay for one relaxed load.
+    /// </summary>
+    class __declspec(novtable) CommandCapture final
+    {
+    public:
+        static constexpr uint64_t FILE_CAPACITY = 256ull * 1024 * 1024;
+        static constexpr uint32_t THREAD_BUFFER_SIZE = 64 * 1024;
+
+        static constexpr uint64_t ZigZag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+
+        static bool IsCapturing() { return _capturing.load(std::memory_order_relaxed); }
+
+        /// <summary>
+        /// True while a capture is requested or running
+        /// </summary>
+        static bool IsActive() { return _pendingFrames.load(std::memory_order_relaxed) > 0 || IsCapturing(); }
+
+        /// <summary>
+        /// Requests a capture of the given amount of frames, starting with the next frame. Returns false if a capture is
+        /// already running.
+        /// </summary>
+        static bool Start(const std::filesystem::path& path, uint32_t frames, reshade::api::device_api api);
+
+        /// <summary>
+        /// Marks the end of a frame. Starts and finishes captures. Called from the present thread.
+        /// </summary>
+        static void EndFrame();
+
+        /// <summary>
+        /// Finishes a running capture early. Called on shutdown.
+        /// </summary>
+        static void Stop();
+
+        static void OnBindPipeline(reshade::api::command_list* cmd_list, reshade::api::pipeline_stage stages, reshade::api::pipeline pipeline, uint32_t psHash, uint32_t vsHash)
+        {
+            if (IsCapturing())
+                _RecordBindPipeline(cmd_list, stages, pipeline, psHash, vsHash);
+        }
+
+        static void OnBindRenderTargets(reshade::api::command_list* cmd_list, uint32_t count, const reshade::api::resource_view* rtvs, reshade::api::resource_view dsv)
+        {
+            if (IsCapturing())
+                _RecordBindRenderTargets(cmd_list, count, rtvs, dsv);
+        }
+
+        static void OnBeginRenderPass(reshade::api::command_list* cmd_list, uint32_t count, const reshade::api::render_pass_render_target_desc* rts, const reshade::api::render_pass_depth_stencil_desc* ds)
+        {
+            if (IsCapturing())
+                _RecordBeginRenderPass(cmd_list, count, rts, ds);
+        }
+
+        static void OnPushDescriptors(reshade::api::command_list* cmd_list, reshade::api::shader_stage stages, reshade::api::pipeline_layout layout, uint32_t param, const reshade::api::descriptor_table_update& update)
+        {
+            if (IsCapturing())
+                _RecordPushDescriptors(cmd_list, stages, layout, param, update);
+        }
+
+        static void OnPushConstants(reshade::api::command_list* cmd_list, reshade::api::shader_stage stages, reshade::api::pipeline_layout layout, uint32_t param, uint32_t first, uint32_t count, const void* values)
+        {
+            if (IsCapturing())
+                _RecordPushConstants(cmd_list, stages, layout, param, first, count, values);
+        }
+
+        static void OnDraw(reshade::api::command_list* cmd_list, CaptureEventType type, uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e = 0)
+        {
+            if (IsCapturing())
+                _RecordDraw(cmd_list, type, a, b, c, d, e);
+        }
+
+        static void OnPresent(reshade::api::command_queue* queue, reshade::api::swapchain* swapchain)
+        {
+            if (IsCapturing())
+                _RecordPresent(queue, swapchain);
+        }
+
+    private:
+        struct ThreadBuffer
+        {
+            std::mutex mutex;
+            uint32_t threadId = 0;
+            uint32_t generation = 0;
+            uint32_t frame = UINT32_MAX;
+            uint64_t commandList = 0;
+            uint32_t size = 0;
+            uint8_t data[THREAD_BUFFER_SIZE];
+
+            void Varint(uint64_t value);
+            void Raw(const void* value, uint32_t size);
+        };
+
+        static ThreadBuffer* Begin(reshade::api::command_list* cmd_list, CaptureEventType type, std::unique_lock<std::mutex>& lock);
+        static void EnsureSpace(ThreadBuffer& buffer, uint32_t size);
+        static void Flush(ThreadBuffer& buffer);
+        static void Finish();
+
+        static void WriteTargetDesc(ThreadBuffer& buffer, reshade::api::device* device, reshade::api::resource_view view);
+
+        static void _RecordBindPipeline(reshade::api::command_list* cmd_list, reshade::api::pipeline_stage stages, reshade::api::pipeline pipeline, uint32_t psHash, uint32_t vsHash);
+        static void _RecordBindRenderTargets(reshade::api::command_list* cmd_list, uint32_t count, const reshade::api::resource_view* rtvs, reshade::api::resource_view dsv);
+        static void _RecordBeginRenderPass(reshade::api::command_list* cmd_list, uint32_t count, const reshade::api::render_pass_render_target_desc* rts, const reshade::api::render_pass_depth_stencil_desc* ds);
+        static void _RecordPushDescriptors(reshade::api::command_list* cmd_list, reshade::api::shader_stage stages, reshade::api::pipeline_layout layout, uint32_t param, const reshade::api::descriptor_table_update& update);
+        static void _RecordPushConstants(reshade::api::command_list* cmd_list, reshade::api::shader_stage stages, reshade::api::pipeline_layout layout, uint32_t param, uint32_t first, uint32_t count, const void* values);
+        static void _RecordDraw(reshade::api::command_list* cmd_list, CaptureEventType type, uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e);
+        static void _RecordPresent(reshade::api::command_queue* queue, reshade::api::swapchain* swapchain);
+
+        static std::atomic_bool _capturing;
+        static std::atomic_uint32_t _pendingFrames;
+        static std::atomic_uint32_t _frame;
+        static std::atomic_uint64_t _writeOffset;
+        static std::atomic_uint64_t _dataEnd;
+        static std::atomic_uint32_t _droppedChunks;
+        static std::atomic_uint32_t _generation;
+        static uint32_t _framesLeft;
+        static uint32_t _deviceApi;
+        static std::filesystem::path _path;
+        static void* _file;
+        static void* _mapping;
+        static uint8_t* _view;
+        static std::mutex _bufferMutex;
+        static std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+    };
+}
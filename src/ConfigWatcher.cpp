@@ -0,0 +1,155 @@
+#include <format>
+#include <thread>
+#include <reshade.hpp>
+#include "ConfigWatcher.h"
+
+using namespace ShaderToggler;
+using namespace std;
+
+mutex ConfigWatcher::_mutex;
+condition_variable ConfigWatcher::_wake;
+filesystem::path ConfigWatcher::_path;
+filesystem::file_time_type ConfigWatcher::_knownWriteTime;
+unique_ptr<vector<ToggleGroup>> ConfigWatcher::_reload;
+atomic_bool ConfigWatcher::_hasReload = false;
+bool ConfigWatcher::_running = false;
+bool ConfigWatcher::_stopping = false;
+
+void ConfigWatcher::Start(const filesystem::path& path)
+{
+    unique_lock<mutex> lock(_mutex);
+
+    if (_running)
+    {
+        return;
+    }
+
+    error_code error;
+    _path = path;
+    _knownWriteTime = filesystem::last_write_time(path, error);
+
+    // Detached like the config writer, Stop waits for it through _running
+    _running = true;
+    thread(Run).detach();
+}
+
+
+void ConfigWatcher::Stop()
+{
+    unique_lock<mutex> lock(_mutex);
+
+    if (_running)
+    {
+        _stopping = true;
+        _wake.notify_all();
+        _wake.wait(lock, [] { return !_running; });
+        _stopping = false;
+    }
+
+    _reload.reset();
+    _hasReload = false;
+}
+
+
+bool ConfigWatcher::TakeReload(vector<ToggleGroup>& groups)
+{
+    unique_ptr<vector<ToggleGroup>> reload;
+
+    {
+        unique_lock<mutex> lock(_mutex);
+
+        reload = std::move(_reload);
+        _hasReload = false;
+    }
+
+    if (reload == nullptr)
+    {
+        return false;
+    }
+
+    groups = std::move(*reload);
+    return true;
+}
+
+
+void ConfigWatcher::Replace(const filesystem::path& from, const filesystem::path& to, error_code& error)
+{
+    unique_lock<mutex> lock(_mutex);
+
+    filesystem::rename(from, to, error);
+    if (error)
+    {
+        return;
+    }
+
+    if (to == _path)
+    {
+        error_code timeError;
+        _knownWriteTime = filesystem::last_write_time(to, timeError);
+        _reload.reset();
+        _hasReload = false;
+    }
+}
+
+
+void ConfigWatcher::Run()
+{
+    unique_lock<mutex> lock(_mutex);
+
+    while (!_wake.wait_for(lock, POLL_INTERVAL, [] { return _stopping; }))
+    {
+        error_code error;
+        const auto writeTime = filesystem::last_write_time(_path, error);
+        if (error || writeTime == _knownWriteTime)
+        {
+            continue;
+        }
+
+        _knownWriteTime = writeTime;
+        const filesystem::path path = _path;
+
+        lock.unlock();
+        unique_ptr<vector<ToggleGroup>> groups = make_unique<vector<ToggleGroup>>();
+        const bool parsed = Parse(path, *groups);
+        lock.lock();
+
+        // A save replacing the file while it was parsed wins over the edit
+        if (parsed && writeTime == _knownWriteTime)
+        {
+            reshade::log_message(reshade::log_level::info, std::format("Config file \"{}\" changed, reloading {} groups", path.string(), groups->size()).c_str());
+
+            _reload = std::move(groups);
+            _hasReload = true;
+        }
+    }
+
+    _running = false;
+    _wake.notify_all();
+}
+
+
+bool ConfigWatcher::Parse(const filesystem::path& path, vector<ToggleGroup>& groups)
+{
+    CDataFile iniFile;
+    if (!iniFile.Load(path.string()))
+    {
+        return false;
+    }
+
+    // Pre 1.0 configs aren't reloaded, neither are files caught mid write without a General section
+    const int numberOfGroups = iniFile.GetInt("AmountGroups", "General");
+    if (numberOfGroups < 0)
+    {
+        return false;
+    }
+
+    groups.reserve(numberOfGroups);
+    for (int i = 0; i < numberOfGroups; i++)
+    {
+        ToggleGroup group("", 0);
+        group.loadState(iniFile, i);
+        groups.push_back(std::move(group));
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <vector>
+#include "ToggleGroup.h"
+
+namespace ShaderToggler
+{
+    /// <summary>
+    /// Polls the config file for edits made outside of the addon. A changed file is parsed on the watcher thread, the
+    /// groups read from it are handed to the present thread through TakeReload. The addon's own saves replace the file
+    /// through Replace, so they aren't mistaken for an outside edit.
+    /// </summary>
+    class __declspec(novtable) ConfigWatcher final
+    {
+    public:
+        static constexpr std::chrono::milliseconds POLL_INTERVAL = std::chrono::milliseconds(1000);
+
+        /// <summary>
+        /// Starts watching the given file, taking its current contents as known. Does nothing if already watching.
+        /// </summary>
+        static void Start(const std::filesystem::path& path);
+
+        /// <summary>
+        /// Stops the watcher thread and drops a reload which wasn't taken yet. Called on shutdown.
+        /// </summary>
+        static void Stop();
+
+        static bool HasReload() { return _hasReload.load(std::memory_order_acquire); }
+
+        /// <summary>
+        /// Moves the groups of the last outside edit into groups, in the order they appear in the file. Returns false if
+        /// there's no reload pending.
+        /// </summary>
+        static bool TakeReload(std::vector<ToggleGroup>& groups);
+
+        /// <summary>
+        /// Renames from over to, marking the result as known. Drops a pending reload, the save replaces the edit.
+        /// </summary>
+        static void Replace(const std::filesystem::path& from, const std::filesystem::path& to, std::error_code& error);
+
+    private:
+        static void Run();
+        static bool Parse(const std::filesystem::path& path, std::vector<ToggleGroup>& groups);
+
+        static std::mutex _mutex;
+        static std::condition_variable _wake;
+        static std::filesystem::path _path;
+        static std::filesystem::file_time_type _knownWriteTime;
+        static std::unique_ptr<std::vector<ToggleGroup>> _reload;
+        static std::atomic_bool _hasReload;
+        static bool _running;
+        static bool _stopping;
+    };
+}
@@ -0,0 +1,181 @@
+#include <format>
+#include <thread>
+#include <reshade.hpp>
+#include "ConfigWriter.h"
+#include "ConfigWatcher.h"
+#include "SignatureCache.h"
+#include "Profiler.h"
+
+using namespace ShaderToggler;
+using namespace std;
+
+mutex ConfigWriter::_mutex;
+condition_variable ConfigWriter::_wake;
+unique_ptr<ConfigSnapshot> ConfigWriter::_pending;
+uint64_t ConfigWriter::_queued = 0;
+bool ConfigWriter::_running = false;
+bool ConfigWriter::_stopping = false;
+unordered_map<int, EncodedHashes> ConfigWriter::_encodedHashes;
+mutex ConfigWriter::_fileMutex;
+
+void ConfigWriter::Queue(ConfigSnapshot&& snapshot)
+{
+    unique_ptr<ConfigSnapshot> replaced = make_unique<ConfigSnapshot>(std::move(snapshot));
+
+    {
+        unique_lock<mutex> lock(_mutex);
+
+        _pending.swap(replaced);
+        _queued++;
+
+        if (!_running)
+        {
+            // Detached so a process exiting without a shutdown event isn't terminated by a joinable thread. The temp
+            // file keeps the config intact if the process dies mid write.
+            _running = true;
+            thread(Run).detach();
+        }
+    }
+
+    _wake.notify_all();
+
+    // A replaced snapshot is freed here, outside of the lock
+}
+
+
+void ConfigWriter::Join()
+{
+    unique_lock<mutex> lock(_mutex);
+
+    if (!_running)
+    {
+        return;
+    }
+
+    _stopping = true;
+    _wake.notify_all();
+    _wake.wait(lock, [] { return !_running; });
+    _stopping = false;
+}
+
+
+void ConfigWriter::Run()
+{
+    unique_lock<mutex> lock(_mutex);
+
+    while (true)
+    {
+        _wake.wait(lock, [] { return _pending != nullptr || _stopping; });
+
+        if (_pending == nullptr)
+        {
+            break;
+        }
+
+        // Wait for the burst to settle, each new save restarts the window
+        const auto deadline = chrono::steady_clock::now() + COALESCE_LIMIT;
+        for (uint64_t queued = _queued; !_stopping && chrono::steady_clock::now() < deadline; queued = _queued)
+        {
+            if (!_wake.wait_for(lock, COALESCE_WINDOW, [queued] { return _stopping || _queued != queued; }))
+            {
+                break;
+            }
+        }
+
+        const unique_ptr<ConfigSnapshot> snapshot = std::move(_pending);
+
+        lock.unlock();
+        Write(*snapshot);
+        lock.lock();
+    }
+
+    _running = false;
+    _wake.notify_all();
+}
+
+
+void ConfigWriter::Write(const ConfigSnapshot& snapshot)
+{
+    CDataFile iniFile;
+
+    for (const auto& setting : snapshot.settings)
+    {
+        iniFile.SetValue(setting.key, setting.value, "", setting.section);
+    }
+
+    // Reuse the encoded hash lists of groups whose hashes didn't change since the last write
+    unordered_map<int, EncodedHashes> encodedHashes;
+    int groupCounter = 0;
+    for (const auto& group : snapshot.groups)
+    {
+        EncodedHashes& encoded = encodedHashes[group.getId()];
+        const auto it = _encodedHashes.find(group.getId());
+        if (it != _encodedHashes.end())
+        {
+            encoded = std::move(it->second);
+        }
+
+        group.saveState(iniFile, groupCounter, &encoded);
+        groupCounter++;
+    }
+    _encodedHashes = std::move(encodedHashes);
+
+    Shim::SignatureCache::Save(iniFile);
+
+    reshade::log_message(reshade::log_level::info, std::format("Creating config file at \"{}\"", snapshot.path.string()).c_str());
+
+    unique_lock<mutex> lock(_fileMutex);
+    WriteFile(iniFile, snapshot.path);
+}
+
+
+bool ConfigWriter::FlushSignatureCache(const filesystem::path& path)
+{
+    if (!Shim::SignatureCache::IsDirty())
+    {
+        return false;
+    }
+
+    // Held from reading to replacing the file, so a save of the writer thread can't land in between and be overwritten
+    unique_lock<mutex> lock(_fileMutex);
+
+    // Only ever extend an existing config, an ini holding nothing but the cache would be mistaken for a pre 1.0 one
+    CDataFile iniFile;
+    if (!iniFile.Load(path.string()))
+    {
+        return false;
+    }
+
+    Shim::SignatureCache::Save(iniFile);
+
+    return WriteFile(iniFile, path);
+}
+
+
+bool ConfigWriter::WriteFile(CDataFile& iniFile, const filesystem::path& path)
+{
+    filesystem::path tempPath = path;
+    tempPath += ".tmp";
+
+    iniFile.SetFileName(tempPath.string());
+
+    {
+        PROFILE_SCOPE_ITEMS(Profiling::PROFILE_CONFIG_SAVE, iniFile.KeyCount());
+        if (!iniFile.Save())
+        {
+            reshade::log_message(reshade::log_level::error, std::format("Failed to write config file \"{}\"", tempPath.string()).c_str());
+            return false;
+        }
+    }
+
+    error_code error;
+    ConfigWatcher::Replace(tempPath, path, error);
+    if (error)
+    {
+        reshade::log_message(reshade::log_level::error, std::format("Failed to replace config file \"{}\": {}", path.string(), error.message()).c_str());
+        filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ToggleGroup.h"
+
+namespace ShaderToggler
+{
+    struct ConfigValue
+    {
+        std::string section;
+        std::string key;
+        std::string value;
+    };
+
+    /// <summary>
+    /// Everything a config save writes, copied out on the thread requesting the save
+    /// </summary>
+    struct ConfigSnapshot
+    {
+        std::filesystem::path path;
+        std::vector<ConfigValue> settings;	// written before the groups, in order
+        std::vector<ToggleGroup> groups;	// written as Group0, Group1, ... in order
+    };
+
+    /// <summary>
+    /// Writes the config on a background thread, so saving from the overlay doesn't stall the frame. Saves queued while
+    /// one is pending replace it, a burst of saves ends up as a single write once no new one arrived for COALESCE_WINDOW.
+    /// The file is written next to the config and renamed over it, an interrupted write never leaves a truncated config.
+    /// </summary>
+    class __declspec(novtable) ConfigWriter final
+    {
+    public:
+        static constexpr std::chrono::milliseconds COALESCE_WINDOW = std::chrono::milliseconds(250);
+        // Upper bound of the delay of a write, even if saves keep coming in
+        static constexpr std::chrono::milliseconds COALESCE_LIMIT = std::chrono::milliseconds(2000);
+
+        /// <summary>
+        /// Queues the snapshot for writing, replacing a snapshot which is still pending.
+        /// </summary>
+        static void Queue(ConfigSnapshot&& snapshot);
+
+        /// <summary>
+        /// Writes a pending snapshot right away and stops the writer thread. Called on shutdown.
+        /// </summary>
+        static void Join();
+
+        /// <summary>
+        /// Writes the signature locations resolved since the config was loaded into the existing config at path, on the
+        /// calling thread. Serialized with the writer thread's saves. A config which doesn't exist yet is left to the next
+        /// save, which includes the cache. Returns true if the file was written.
+        /// </summary>
+        static bool FlushSignatureCache(const std::filesystem::path& path);
+
+    private:
+        static void Run();
+        static void Write(const ConfigSnapshot& snapshot);
+        static bool WriteFile(CDataFile& iniFile, const std::filesystem::path& path);
+
+        static std::mutex _mutex;
+        static std::condition_variable _wake;
+        static std::unique_ptr<ConfigSnapshot> _pending;
+        static uint64_t _queued;
+        static bool _running;
+        static bool _stopping;
+        static std::unordered_map<int, EncodedHashes> _encodedHashes;	// by group id, only touched by the writer thread
+        static std::mutex _fileMutex;	// held while the config file is written, and read for an update
+    };
+}
@@ -17,7 +17,7 @@ ConstantCopyBase::~ConstantCopyBase()
 
 }
 
-void ConstantCopyBase::GetHostConstantBuffer(reshade::api::command_list* cmd_list, vector<uint8_t>& dest, size_t size, uint64_t resourceHandle)
+size_t ConstantCopyBase::GetHostConstantBuffer(reshade::api::command_list* cmd_list, vector<uint8_t>& dest, size_t size, uint64_t resourceHandle)
 {
     shared_lock<shared_mutex> lock(deviceHostMutex);
     const auto& it = deviceToHostConstantBuffer.find(resourceHandle);
@@ -25,7 +25,10 @@ void ConstantCopyBase::GetHostConstantBuffer(reshade::api::command_list* cmd_lis
     {
         auto& [_, buffer] = *it;
         std::memcpy(dest.data(), buffer.data(), size);
+        return size;
     }
+
+    return 0;
 }
 
 void ConstantCopyBase::CreateHostConstantBuffer(device* dev, resource resource, size_t size)
@@ -4,6 +4,7 @@
 #include <reshade_api_device.hpp>
 #include <reshade_api_pipeline.hpp>
 #include <unordered_map>
+#include <vector>
 #include <shared_mutex>
 
 namespace Shim
@@ -18,7 +19,8 @@ namespace Shim
             virtual bool Init() = 0;
             virtual bool UnInit() = 0;
 
-            virtual void GetHostConstantBuffer(reshade::api::command_list* cmd_list, std::vector<uint8_t>& dest, size_t size, uint64_t resourceHandle);
+            // Returns the amount of bytes written to dest
+            virtual size_t GetHostConstantBuffer(reshade::api::command_list* cmd_list, std::vector<uint8_t>& dest, size_t size, uint64_t resourceHandle);
             virtual void CreateHostConstantBuffer(reshade::api::device* dev, reshade::api::resource resource, size_t size);
             virtual void DeleteHostConstantBuffer(reshade::api::resource resource);
             virtual inline void SetHostConstantBuffer(const uint64_t handle, const void* buffer, size_t size, uintptr_t offset, uint64_t bufferSize);
@@ -29,6 +31,10 @@ namespace Shim
             virtual void OnUpdateBufferRegion(reshade::api::device* device, const void* data, reshade::api::resource resource, uint64_t offset, uint64_t size) = 0;
             virtual void OnMapBufferRegion(reshade::api::device* device, reshade::api::resource resource, uint64_t offset, uint64_t size, reshade::api::map_access access, void** data) = 0;
             virtual void OnUnmapBufferRegion(reshade::api::device* device, reshade::api::resource resource) = 0;
+
+            // Byte ranges ([offset, offset + size)) of a resource read by an owner's variable bindings. Only used by backends that copy selectively
+            virtual void SetRequiredRanges(const uint64_t resourceHandle, const void* owner, const std::vector<std::pair<uint64_t, uint64_t>>& ranges) {};
+            virtual void ClearRequiredRanges(const void* owner) {};
         protected:
             static std::unordered_map<uint64_t, std::vector<uint8_t>> deviceToHostConstantBuffer;
             static std::shared_mutex deviceHostMutex;
@@ -28,8 +28,10 @@ bool ConstantCopyFFXIV::UnInit()
     return MH_Uninitialize() == MH_OK;
 }
 
-void ConstantCopyFFXIV::GetHostConstantBuffer(command_list* cmd_list, vector<uint8_t>& dest, size_t size, uint64_t resourceHandle)
+size_t ConstantCopyFFXIV::GetHostConstantBuffer(command_list* cmd_list, vector<uint8_t>& dest, size_t size, uint64_t resourceHandle)
 {
+    size_t copied = 0;
+
     for (uint32_t i = 0; i < _hostResourceBuffer.size(); i++)
     {
         auto& [buffer,bufHandle,bufSize] = _hostResourceBuffer[i];
@@ -37,8 +39,11 @@ void ConstantCopyFFXIV::GetHostConstantBuffer(command_list* cmd_list, vector<uin
         {
             size_t minSize = std::min(size, bufSize);
             memcpy(dest.data(), buffer, minSize);
+            copied = std::max(copied, minSize);
         }
     }
+
+    return copied;
 }
 
 inline void ConstantCopyFFXIV::set_host_resource_data_location(void* origin, size_t len, int64_t resource_handle, uint64_t index)
@@ -1,6 +1,7 @@
 #include <cstring>
 #include "ConstantCopyGPUReadback.h"
 #include "PipelinePrivateData.h"
+#include "TraceRecorder.h"
 
 using namespace Shim::Constants;
 using namespace reshade::api;
@@ -8,13 +9,15 @@ using namespace ShaderToggler;
 using namespace std;
 
 
-void ConstantCopyGPUReadback::GetHostConstantBuffer(reshade::api::command_list* cmd_list, vector<uint8_t>& dest, size_t size, uint64_t resourceHandle)
+size_t ConstantCopyGPUReadback::GetHostConstantBuffer(reshade::api::command_list* cmd_list, vector<uint8_t>& dest, size_t size, uint64_t resourceHandle)
 {
     shared_lock<shared_mutex> lock(deviceHostMutex);
 
     const auto& it = resToCopyBuffer.find(resourceHandle);
     if (it != resToCopyBuffer.end())
     {
+        TRACE_SCOPE(Profiling::TRACE_CONSTANT_READBACK, static_cast<uint32_t>(size));
+
         const auto& [_, cpuRead] = *it;
         void* data = nullptr;
         resource src = resource{ resourceHandle };
@@ -24,9 +27,12 @@ void ConstantCopyGPUReadback::GetHostConstantBuffer(reshade::api::command_list*
         {
             memcpy(dest.data(), data, size);
             cmd_list->get_device()->unmap_buffer_region(cpuRead);
+
+            return size;
         }
-        
     }
+
+    return 0;
 }
 
 void ConstantCopyGPUReadback::OnInitResource(device* device, const resource_desc& desc, const subresource_data* initData, resource_usage usage, reshade::api::resource handle)
@@ -17,7 +17,7 @@ namespace Shim
             bool Init() override final { return true; };
             bool UnInit() override final { return true; };
 
-            virtual void GetHostConstantBuffer(reshade::api::command_list* cmd_list, std::vector<uint8_t>& dest, size_t size, uint64_t resourceHandle) override final;
+            virtual size_t GetHostConstantBuffer(reshade::api::command_list* cmd_list, std::vector<uint8_t>& dest, size_t size, uint64_t resourceHandle) override final;
             virtual void CreateHostConstantBuffer(reshade::api::device* dev, reshade::api::resource resource, size_t size) override final {};
             virtual void DeleteHostConstantBuffer(reshade::api::resource resource) override final {};
             virtual void SetHostConstantBuffer(const uint64_t handle, const void* buffer, size_t size, uintptr_t offset, uint64_t bufferSize) override final {};
@@ -0,0 +1,162 @@
+#include <cstring>
+#include <algorithm>
+#include "ConstantCopyMapSnapshot.h"
+
+using namespace Shim::Constants;
+using namespace reshade::api;
+using namespace std;
+
+void ConstantCopyMapSnapshot::OnMapBufferRegion(device* device, resource resource, uint64_t offset, uint64_t size, map_access access, void** data)
+{
+    if ((access != map_access::write_discard && access != map_access::write_only) || data == nullptr || *data == nullptr)
+    {
+        return;
+    }
+
+    {
+        shared_lock<shared_mutex> lock(_range_mutex);
+        if (!_requiredRanges.contains(resource.handle))
+        {
+            return;
+        }
+    }
+
+    unique_lock<shared_mutex> lock(_map_mutex);
+    _mappedRegions[resource.handle] = MappedRegion{ static_cast<const uint8_t*>(*data), offset, size };
+}
+
+void ConstantCopyMapSnapshot::OnUnmapBufferRegion(device* device, resource resource)
+{
+    MappedRegion region;
+
+    {
+        unique_lock<shared_mutex> lock(_map_mutex);
+        const auto& it = _mappedRegions.find(resource.handle);
+        if (it == _mappedRegions.end())
+        {
+            return;
+        }
+
+        region = it->second;
+        _mappedRegions.erase(it);
+    }
+
+    shared_lock<shared_mutex> rangeLock(_range_mutex);
+    const auto& rangeIt = _requiredRanges.find(resource.handle);
+    if (rangeIt == _requiredRanges.end())
+    {
+        return;
+    }
+
+    unique_lock<shared_mutex> lock(deviceHostMutex);
+    const auto& it = deviceToHostConstantBuffer.find(resource.handle);
+    if (it == deviceToHostConstantBuffer.end())
+    {
+        return;
+    }
+
+    auto& [_, cBuffer] = *it;
+    const uint64_t regionEnd = region.size == UINT64_MAX ? cBuffer.size() : std::min<uint64_t>(region.offset + region.size, cBuffer.size());
+
+    for (const auto& [rangeOffset, rangeSize] : rangeIt->second.merged)
+    {
+        const uint64_t start = std::max(rangeOffset, region.offset);
+        const uint64_t end = std::min(rangeOffset + rangeSize, regionEnd);
+
+        if (start < end)
+        {
+            memcpy(&cBuffer[start], region.data + (start - region.offset), static_cast<size_t>(end - start));
+        }
+    }
+}
+
+void ConstantCopyMapSnapshot::SetRequiredRanges(const uint64_t resourceHandle, const void* owner, const vector<pair<uint64_t, uint64_t>>& ranges)
+{
+    {
+        shared_lock<shared_mutex> lock(_range_mutex);
+        const auto& it = _requiredRanges.find(resourceHandle);
+        if (it != _requiredRanges.end())
+        {
+            const auto& ownerIt = it->second.owners.find(owner);
+            if (ownerIt != it->second.owners.end() && ownerIt->second == ranges)
+            {
+                return;
+            }
+        }
+    }
+
+    unique_lock<shared_mutex> lock(_range_mutex);
+
+    // An owner only reads from a single buffer at a time, drop its ranges on the buffer it used before
+    for (auto it = _requiredRanges.begin(); it != _requiredRanges.end();)
+    {
+        if (it->first != resourceHandle && it->second.owners.erase(owner) > 0)
+        {
+            if (it->second.owners.empty())
+            {
+                it = _requiredRanges.erase(it);
+                continue;
+            }
+
+            MergeRanges(it->second);
+        }
+        it++;
+    }
+
+    RequiredRanges& required = _requiredRanges[resourceHandle];
+    required.owners[owner] = ranges;
+    MergeRanges(required);
+}
+
+void ConstantCopyMapSnapshot::ClearRequiredRanges(const void* owner)
+{
+    unique_lock<shared_mutex> lock(_range_mutex);
+
+    for (auto it = _requiredRanges.begin(); it != _requiredRanges.end();)
+    {
+        if (it->second.owners.erase(owner) > 0)
+        {
+            if (it->second.owners.empty())
+            {
+                it = _requiredRanges.erase(it);
+                continue;
+            }
+
+            MergeRanges(it->second);
+        }
+        it++;
+    }
+}
+
+void ConstantCopyMapSnapshot::MergeRanges(RequiredRanges& ranges)
+{
+    ranges.merged.clear();
+
+    for (const auto& [_, ownerRanges] : ranges.owners)
+    {
+        ranges.merged.insert(ranges.merged.end(), ownerRanges.begin(), ownerRanges.end());
+    }
+
+    std::sort(ranges.merged.begin(), ranges.merged.end());
+
+    size_t last = 0;
+    for (size_t i = 1; i < ranges.merged.size(); i++)
+    {
+        auto& [lastOffset, lastSize] = ranges.merged[last];
+        const auto& [curOffset, curSize] = ranges.merged[i];
+
+        if (curOffset <= lastOffset + lastSize)
+        {
+            lastSize = std::max(lastOffset + lastSize, curOffset + curSize) - lastOffset;
+        }
+        else
+        {
+            ranges.merged[++last] = ranges.merged[i];
+        }
+    }
+
+    if (!ranges.merged.empty())
+    {
+        ranges.merged.resize(last + 1);
+    }
+}
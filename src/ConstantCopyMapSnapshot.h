@@ -0,0 +1,52 @@
+#pragma once
+
+#include <reshade_api.hpp>
+#include <reshade_api_device.hpp>
+#include <reshade_api_pipeline.hpp>
+#include <unordered_map>
+#include <vector>
+#include <shared_mutex>
+#include "ConstantCopyBase.h"
+
+namespace Shim
+{
+    namespace Constants
+    {
+        struct MappedRegion
+        {
+            const uint8_t* data = nullptr;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+        };
+
+        struct RequiredRanges
+        {
+            std::unordered_map<const void*, std::vector<std::pair<uint64_t, uint64_t>>> owners;
+            std::vector<std::pair<uint64_t, uint64_t>> merged;
+        };
+
+        // Snapshots the ranges of a write_discard/write_only mapped constant buffer that are actually bound to variables when it gets unmapped.
+        // Mapped upload memory is usually write-combined: reads from it bypass the cache and are an order of magnitude slower than regular
+        // memory reads, so only the merged required ranges are read, each with a single memcpy, and buffers without bindings are never touched.
+        class ConstantCopyMapSnapshot final : public virtual ConstantCopyBase {
+        public:
+            bool Init() override final { return true; };
+            bool UnInit() override final { return true; };
+
+            virtual void OnUpdateBufferRegion(reshade::api::device* device, const void* data, reshade::api::resource resource, uint64_t offset, uint64_t size) override final {};
+            virtual void OnMapBufferRegion(reshade::api::device* device, reshade::api::resource resource, uint64_t offset, uint64_t size, reshade::api::map_access access, void** data) override final;
+            virtual void OnUnmapBufferRegion(reshade::api::device* device, reshade::api::resource resource) override final;
+
+            virtual void SetRequiredRanges(const uint64_t resourceHandle, const void* owner, const std::vector<std::pair<uint64_t, uint64_t>>& ranges) override final;
+            virtual void ClearRequiredRanges(const void* owner) override final;
+
+        private:
+            static void MergeRanges(RequiredRanges& ranges);
+
+            std::unordered_map<uint64_t, MappedRegion> _mappedRegions;
+            std::unordered_map<uint64_t, RequiredRanges> _requiredRanges;
+            std::shared_mutex _map_mutex;
+            std::shared_mutex _range_mutex;
+        };
+    }
+}
@@ -1,6 +1,8 @@
 #include <cstring>
 #include <MinHook.h>
 #include "ConstantCopyMemcpy.h"
+#include "Profiler.h"
+#include "Startup.h"
 
 using namespace Shim;
 using namespace Shim::Constants;
@@ -20,7 +22,7 @@ ConstantCopyMemcpy::~ConstantCopyMemcpy()
 
 bool ConstantCopyMemcpy::Init()
 {
-    return Hook(&org_memcpy, detour_memcpy, ""_sig);
+    return Hook(&org_memcpy, detour_memcpy);
 }
 
 bool ConstantCopyMemcpy::UnInit()
@@ -31,24 +33,26 @@ bool ConstantCopyMemcpy::UnInit()
 
 bool ConstantCopyMemcpy::HookStatic(sig_memcpy** original, sig_memcpy* detour)
 {
-    string exe = GameHookT<sig_memcpy>::GetExecutableName();
-    if (exe.length() == 0)
-        return false;
-
+    vector<const Signature*> sigs;
     for (const auto& sig : memcpy_static)
     {
-        sigmatch::this_process_target target;
-        sigmatch::search_result result = target.in_module(exe).search(sig);
-
-        for (const std::byte* address : result.matches()) {
-            void* adr = static_cast<void*>(const_cast<std::byte*>(address));
-            *original = GameHookT<sig_memcpy>::InstallHook(adr, detour);
-
-            // Assume signature is unique
-            if (*original != nullptr)
-            {
-                return true;
-            }
+        sigs.push_back(&sig);
+    }
+
+    const vector<const uint8_t*> addresses = GameHook::FindSignatures(sigs);
+
+    for (const uint8_t* address : addresses)
+    {
+        // Assume signature is unique
+        if (address == nullptr)
+        {
+            continue;
+        }
+
+        *original = GameHookT<sig_memcpy>::InstallHook(const_cast<uint8_t*>(address), detour);
+        if (*original != nullptr)
+        {
+            return true;
         }
     }
 
@@ -71,12 +75,12 @@ bool ConstantCopyMemcpy::HookDynamic(sig_memcpy** original, sig_memcpy* detour)
     return false;
 }
 
-bool ConstantCopyMemcpy::Hook(sig_memcpy** original, sig_memcpy* detour, const sigmatch::signature& sig)
+bool ConstantCopyMemcpy::Hook(sig_memcpy** original, sig_memcpy* detour)
 {
     // Try hooking statically linked memcpy first, then look into dynamically linked ones
     if (HookStatic(original, detour) || HookDynamic(original, detour))
     {
-        return !(MH_EnableHook(MH_ALL_HOOKS) != MH_OK);
+        return ShaderToggler::Startup::Install([] { return MH_EnableHook(MH_ALL_HOOKS) == MH_OK; });
     }
 
     return false;
@@ -94,7 +98,10 @@ bool ConstantCopyMemcpy::Unhook()
 
 void* __fastcall ConstantCopyMemcpy::detour_memcpy(void* dest, void* src, size_t size)
 {
-    _instance->OnMemcpy(dest, src, size);
+    {
+        PROFILE_SCOPE(Profiling::PROFILE_MEMCPY_FILTER);
+        _instance->OnMemcpy(dest, src, size);
+    }
 
     return org_memcpy(dest, src, size);
 }
\ No newline at end of file
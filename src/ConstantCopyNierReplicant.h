@@ -13,9 +13,7 @@
 #include "ConstantCopyBase.h"
 #include "GameHookT.h"
 
-using namespace sigmatch_literals;
-
-static const sigmatch::signature nier_replicant_cbload = "48 89 5C 24 ?? 48 89 74 24 ?? 57 48 83 EC 40 80 B9 ?? ?? ?? ?? 00 48 8B F2 41 8B F8"_sig;
+static const Shim::Signature nier_replicant_cbload("48 89 5C 24 ?? 48 89 74 24 ?? 57 48 83 EC 40 80 B9 ?? ?? ?? ?? 00 48 8B F2 41 8B F8");
 
 namespace Shim 
 {
@@ -0,0 +1,58 @@
+#include <cstring>
+#include <algorithm>
+#include "ConstantCopyUpdateBufferRegion.h"
+
+using namespace Shim::Constants;
+using namespace reshade::api;
+using namespace std;
+
+static inline bool IsConstantBuffer(const resource_desc& desc)
+{
+    return desc.type == resource_type::buffer && static_cast<uint32_t>(desc.usage & resource_usage::constant_buffer);
+}
+
+// Constant buffers updated through update_buffer_region usually live in gpu_only memory, so shadow every constant buffer regardless of heap
+void ConstantCopyUpdateBufferRegion::OnInitResource(device* device, const resource_desc& desc, const subresource_data* initData, resource_usage usage, reshade::api::resource handle)
+{
+    if (IsConstantBuffer(desc))
+    {
+        CreateHostConstantBuffer(device, handle, desc.buffer.size);
+        if (initData != nullptr && initData->data != nullptr)
+        {
+            SetHostConstantBuffer(handle.handle, initData->data, desc.buffer.size, 0, desc.buffer.size);
+        }
+    }
+}
+
+void ConstantCopyUpdateBufferRegion::OnDestroyResource(device* device, resource res)
+{
+    resource_desc desc = device->get_resource_desc(res);
+    if (IsConstantBuffer(desc))
+    {
+        DeleteHostConstantBuffer(res);
+    }
+}
+
+void ConstantCopyUpdateBufferRegion::OnUpdateBufferRegion(device* device, const void* data, resource resource, uint64_t offset, uint64_t size)
+{
+    if (data == nullptr || size == 0)
+    {
+        return;
+    }
+
+    unique_lock<shared_mutex> lock(deviceHostMutex);
+    const auto& it = deviceToHostConstantBuffer.find(resource.handle);
+    if (it != deviceToHostConstantBuffer.end())
+    {
+        auto& [_, cBuffer] = *it;
+
+        // Clamp to the shadow, the game may update a region of a buffer we saw with a different size
+        if (offset >= cBuffer.size())
+        {
+            return;
+        }
+
+        const size_t copySize = static_cast<size_t>(std::min<uint64_t>(size, cBuffer.size() - offset));
+        memcpy(&cBuffer[static_cast<size_t>(offset)], data, copySize);
+    }
+}
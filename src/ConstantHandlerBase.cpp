@@ -1,6 +1,9 @@
 #include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
 #include "ConstantHandlerBase.h"
 #include "PipelinePrivateData.h"
+#include "Profiler.h"
 
 using namespace Shim::Constants;
 using namespace reshade::api;
@@ -8,9 +11,26 @@ using namespace ShaderToggler;
 using namespace std;
 
 unordered_map<string, tuple<constant_type, vector<effect_uniform_variable>>> ConstantHandlerBase::restVariables;
+uint32_t ConstantHandlerBase::restVariablesVersion = 0;
 char ConstantHandlerBase::charBuffer[CHAR_BUFFER_SIZE];
 ConstantCopyBase* ConstantHandlerBase::_constCopy;
 
+static inline bool IsEqualBuffer(const uint8_t* lhs, const uint8_t* rhs, size_t size)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+
+    return memcmp(lhs + i, rhs + i, size - i) == 0;
+}
+
 ConstantHandlerBase::ConstantHandlerBase()
 {
 }
@@ -27,9 +47,10 @@ void ConstantHandlerBase::SetConstantCopy(ConstantCopyBase* constantCopy)
 
 size_t ConstantHandlerBase::GetConstantBufferSize(const ToggleGroup* group)
 {
-    if (groupBufferSize.contains(group))
+    const auto& it = groupData.find(group);
+    if (it != groupData.end())
     {
-        return groupBufferSize.at(group);
+        return it->second.size;
     }
 
     return 0;
@@ -37,9 +58,10 @@ size_t ConstantHandlerBase::GetConstantBufferSize(const ToggleGroup* group)
 
 const uint8_t* ConstantHandlerBase::GetConstantBuffer(const ToggleGroup* group)
 {
-    if (groupBufferContent.contains(group))
+    auto it = groupData.find(group);
+    if (it != groupData.end())
     {
-        return groupBufferContent.at(group).data();
+        return it->second.Current().data();
     }
 
     return nullptr;
@@ -53,6 +75,7 @@ unordered_map<string, tuple<constant_type, vector<effect_uniform_variable>>>* Co
 void ConstantHandlerBase::ReloadConstantVariables(effect_runtime* runtime)
 {
     restVariables.clear();
+    restVariablesVersion++;
 
     runtime->enumerate_uniform_variables(nullptr, [](effect_runtime* rt, effect_uniform_variable variable) {
         if (!rt->get_annotation_string_from_uniform_variable<CHAR_BUFFER_SIZE>(variable, "source", charBuffer))
@@ -71,7 +94,14 @@ void ConstantHandlerBase::ReloadConstantVariables(effect_runtime* runtime)
         {
         case reshade::api::format::r32_float:
             if (array_length > 0)
-                type = constant_type::type_unknown;
+            {
+                if (rows == 4 && columns == 4)
+                    type = constant_type::type_float4x4_array;
+                else if (rows == 1 && columns == 1)
+                    type = constant_type::type_float_array;
+                else
+                    type = constant_type::type_unknown;
+            }
             else
             {
                 if (rows == 4 && columns == 4)
@@ -91,16 +121,16 @@ void ConstantHandlerBase::ReloadConstantVariables(effect_runtime* runtime)
             }
             break;
         case reshade::api::format::r32_sint:
-            if (array_length > 0 || rows > 1 || columns > 1)
+            if (rows > 1 || columns > 1)
                 type = constant_type::type_unknown;
             else
-                type = constant_type::type_int;
+                type = array_length > 0 ? constant_type::type_int_array : constant_type::type_int;
             break;
         case reshade::api::format::r32_uint:
-            if (array_length > 0 || rows > 1 || columns > 1)
+            if (rows > 1 || columns > 1)
                 type = constant_type::type_unknown;
             else
-                type = constant_type::type_uint;
+                type = array_length > 0 ? constant_type::type_uint_array : constant_type::type_uint;
             break;
         }
 
@@ -129,6 +159,7 @@ void ConstantHandlerBase::ReloadConstantVariables(effect_runtime* runtime)
 void ConstantHandlerBase::ClearConstantVariables()
 {
     restVariables.clear();
+    restVariablesVersion++;
 }
 
 void ConstantHandlerBase::OnReshadeSetTechniqueState(effect_runtime* runtime, int32_t enabledCount)
@@ -200,6 +231,7 @@ bool ConstantHandlerBase::UpdateConstantBufferEntries(command_list* cmd_list, Co
     if (buf.buffer != 0)
     {
         SetBufferRange(group, buf, cmd_list->get_device(), cmd_list);
+        UpdateRequiredRanges(group, buf.buffer.handle);
         ApplyConstantValues(devData.current_runtime, group, restVariables);
         devData.constantsUpdated.insert(group);
 
@@ -233,6 +265,8 @@ bool ConstantHandlerBase::UpdateConstantEntries(command_list* cmd_list, CommandL
 
 void ConstantHandlerBase::UpdateConstants(command_list* cmd_list)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_UPDATE_CONSTANTS);
+
     if (cmd_list == nullptr || cmd_list->get_device() == nullptr)
     {
         return;
@@ -247,91 +281,157 @@ void ConstantHandlerBase::UpdateConstants(command_list* cmd_list)
         return;
     }
 
-    vector<ToggleGroup*> psRemovalList;
-    vector<ToggleGroup*> vsRemovalList;
-
-    for (const auto& cb : commandListData.ps.constantBuffersToUpdate)
+    for (auto it = commandListData.ps.constantBuffersToUpdate.begin(); it != commandListData.ps.constantBuffersToUpdate.end();)
     {
+        ToggleGroup* cb = *it;
         if (!deviceData.constantsUpdated.contains(cb))
         {
             if (!cb->getCBIsPushMode() && UpdateConstantBufferEntries(cmd_list, commandListData, deviceData, cb, 0) ||
                 cb->getCBIsPushMode() && UpdateConstantEntries(cmd_list, commandListData, deviceData, cb, 0))
             {
-                psRemovalList.push_back(cb);
+                cb->getStatistics().Add(STAT_CONSTANT_REFRESHES);
+                it = commandListData.ps.constantBuffersToUpdate.erase(it);
+                continue;
             }
         }
+        it++;
     }
 
-    for (const auto& cb : commandListData.vs.constantBuffersToUpdate)
+    for (auto it = commandListData.vs.constantBuffersToUpdate.begin(); it != commandListData.vs.constantBuffersToUpdate.end();)
     {
+        ToggleGroup* cb = *it;
         if (!deviceData.constantsUpdated.contains(cb))
         {
             if (!cb->getCBIsPushMode() && UpdateConstantBufferEntries(cmd_list, commandListData, deviceData, cb, 1) ||
                 cb->getCBIsPushMode() && UpdateConstantEntries(cmd_list, commandListData, deviceData, cb, 1))
             {
-                vsRemovalList.push_back(cb);
+                cb->getStatistics().Add(STAT_CONSTANT_REFRESHES);
+                it = commandListData.vs.constantBuffersToUpdate.erase(it);
+                continue;
             }
         }
+        it++;
     }
+}
 
-    for (const auto& g : psRemovalList)
+bool ConstantHandlerBase::CompileBindings(const ToggleGroup* group, const unordered_map<string, tuple<constant_type, vector<effect_uniform_variable>>>& constants, GroupBindings& compiled)
+{
+    if (compiled.mappingVersion == group->getVarMappingVersion() && compiled.variablesVersion == restVariablesVersion && compiled.pushMode == group->getCBIsPushMode())
     {
-        commandListData.ps.constantBuffersToUpdate.erase(g);
+        return false;
     }
 
-    for (const auto& g : vsRemovalList)
+    compiled.mappingVersion = group->getVarMappingVersion();
+    compiled.variablesVersion = restVariablesVersion;
+    compiled.pushMode = group->getCBIsPushMode();
+    compiled.rangeResource = 0;
+    compiled.bindings.clear();
+
+    for (const auto& [varName, varData] : group->GetVarOffsetMapping())
     {
-        commandListData.vs.constantBuffersToUpdate.erase(g);
+        const auto& it = constants.find(varName);
+        if (it == constants.end())
+        {
+            continue;
+        }
+
+        const auto& [offset, prevValue, elements] = varData;
+        const auto& [type, effect_variables] = it->second;
+        uint32_t typeIndex = static_cast<uint32_t>(type);
+
+        UniformBinding binding;
+        binding.offset = offset;
+        binding.type = type;
+        binding.length = static_cast<uint32_t>(type_length[typeIndex]);
+        binding.elements = type_is_array(type) ? std::max(elements, 1u) : 1;
+        binding.elementSize = type_size[typeIndex] * type_length[typeIndex];
+        binding.stride = type_is_array(type) && !compiled.pushMode ? std::max(binding.elementSize, CBUFFER_ARRAY_STRIDE) : binding.elementSize;
+        binding.byteSize = (binding.elements - 1) * binding.stride + binding.elementSize;
+        binding.uploadSize = binding.elements * binding.elementSize;
+        binding.usePrevious = prevValue;
+        binding.variables = effect_variables;
+        binding.current.resize(binding.uploadSize, 0);
+
+        if (binding.stride != binding.elementSize)
+        {
+            binding.packed.resize(binding.uploadSize, 0);
+        }
+
+        compiled.bindings.push_back(std::move(binding));
     }
+
+    return true;
 }
 
 void ConstantHandlerBase::ApplyConstantValues(effect_runtime* runtime, const ToggleGroup* group,
     const unordered_map<string, tuple<constant_type, vector<effect_uniform_variable>>>& constants)
 {
+    PROFILE_SCOPE_ITEMS(Profiling::PROFILE_APPLY_CONSTANT_VALUES, constants.size());
+
     unique_lock<shared_mutex> lock(varMutex);
 
-    if (!groupBufferContent.contains(group) || runtime == nullptr)
+    const auto& it = groupData.find(group);
+    if (it == groupData.end() || runtime == nullptr)
     {
         return;
     }
 
-    const uint8_t* buffer = groupBufferContent.at(group).data();
-    const uint8_t* prevBuffer = groupPrevBufferContent.at(group).data();
-
-    for (const auto& [varName,varData] : group->GetVarOffsetMapping())
-    {
-        const auto& [offset, prevValue] = varData;
+    GroupConstantData& data = it->second;
+    const uint8_t* buffer = data.Current().data();
+    const uint8_t* prevBuffer = data.Previous().data();
+    const size_t bufferSize = data.size;
 
-        const uint8_t* bufferInUse = prevValue ? prevBuffer : buffer;
+    GroupBindings& compiled = data.bindings;
+    CompileBindings(group, constants, compiled);
 
-        if (!constants.contains(varName))
+    for (auto& binding : compiled.bindings)
+    {
+        if (binding.offset + binding.byteSize >= bufferSize)
         {
             continue;
         }
 
-        const auto& [type, effect_variables] = constants.at(varName);
-        uint32_t typeIndex = static_cast<uint32_t>(type);
-        size_t bufferSize = groupBufferSize.at(group);
+        const uint8_t* src = (binding.usePrevious ? prevBuffer : buffer) + binding.offset;
 
-        if (offset + type_size[typeIndex] * type_length[typeIndex] >= bufferSize)
+        // Padded array elements are gathered so the whole array goes up in a single call
+        if (binding.stride != binding.elementSize)
         {
-            continue;
+            for (uint32_t i = 0; i < binding.elements; i++)
+            {
+                memcpy(binding.packed.data() + i * binding.elementSize, src + i * binding.stride, binding.elementSize);
+            }
+            src = binding.packed.data();
         }
 
+        const size_t count = static_cast<size_t>(binding.length) * binding.elements;
+        uint8_t* current = binding.current.data();
 
-        for (const auto& effect_var : effect_variables)
+        // Other groups and the overlay write the same variables, so compare against what each variable holds right now
+        for (const auto& effect_var : binding.variables)
         {
-            if (type <= constant_type::type_float4x4)
+            if (type_is_float(binding.type))
             {
-                runtime->set_uniform_value_float(effect_var, reinterpret_cast<const float*>(bufferInUse + offset), type_length[typeIndex], 0);
+                runtime->get_uniform_value_float(effect_var, reinterpret_cast<float*>(current), count, 0);
+                if (!IsEqualBuffer(src, current, binding.uploadSize))
+                {
+                    runtime->set_uniform_value_float(effect_var, reinterpret_cast<const float*>(src), count, 0);
+                }
             }
-            else if (type == constant_type::type_int)
+            else if (type_is_int(binding.type))
             {
-                runtime->set_uniform_value_int(effect_var, reinterpret_cast<const int32_t*>(bufferInUse + offset), type_length[typeIndex], 0);
+                runtime->get_uniform_value_int(effect_var, reinterpret_cast<int32_t*>(current), count, 0);
+                if (!IsEqualBuffer(src, current, binding.uploadSize))
+                {
+                    runtime->set_uniform_value_int(effect_var, reinterpret_cast<const int32_t*>(src), count, 0);
+                }
             }
             else
             {
-                runtime->set_uniform_value_uint(effect_var, reinterpret_cast<const uint32_t*>(bufferInUse + offset), type_length[typeIndex], 0);
+                runtime->get_uniform_value_uint(effect_var, reinterpret_cast<uint32_t*>(current), count, 0);
+                if (!IsEqualBuffer(src, current, binding.uploadSize))
+                {
+                    runtime->set_uniform_value_uint(effect_var, reinterpret_cast<const uint32_t*>(src), count, 0);
+                }
             }
         }
     }
@@ -345,13 +445,12 @@ void ConstantHandlerBase::SetConstants(const ToggleGroup* group, const vector<ui
         return;
     }
 
-    InitBuffers(group, buf.size());
+    const size_t size = buf.size() * sizeof(uint32_t);
 
-    vector<uint8_t>& bufferContent = groupBufferContent.at(group);
-    vector<uint8_t>& prevBufferContent = groupPrevBufferContent.at(group);
+    GroupConstantData& data = InitBuffers(group, size);
+    data.Swap();
 
-    std::memcpy(prevBufferContent.data(), bufferContent.data(), buf.size());
-    std::memcpy(bufferContent.data(), reinterpret_cast<const uint8_t*>(buf.data()), buf.size() * 4);
+    std::memcpy(data.Current().data(), reinterpret_cast<const uint8_t*>(buf.data()), size);
 }
 
 void ConstantHandlerBase::SetBufferRange(const ToggleGroup* group, buffer_range range, device* dev, command_list* cmd_list)
@@ -364,41 +463,68 @@ void ConstantHandlerBase::SetBufferRange(const ToggleGroup* group, buffer_range
     resource_desc targetBufferDesc = dev->get_resource_desc(range.buffer);
     uint64_t size = targetBufferDesc.buffer.size;
 
-    InitBuffers(group, size);
+    GroupConstantData& data = InitBuffers(group, size);
+    data.Swap();
+
+    vector<uint8_t>& bufferContent = data.Current();
+    const size_t copied = _constCopy->GetHostConstantBuffer(cmd_list, bufferContent, size, range.buffer.handle);
+
+    // The slot now holds data from two refreshes ago, carry over whatever the copy didn't overwrite
+    if (copied < size)
+    {
+        std::memcpy(bufferContent.data() + copied, data.Previous().data() + copied, size - copied);
+    }
+}
+
+GroupConstantData& ConstantHandlerBase::InitBuffers(const ToggleGroup* group, size_t size)
+{
+    GroupConstantData& data = groupData[group];
 
-    vector<uint8_t>& bufferContent = groupBufferContent.at(group);
-    vector<uint8_t>& prevBufferContent = groupPrevBufferContent.at(group);
+    if (data.size != size)
+    {
+        data.slots[0].resize(size, 0);
+        data.slots[1].resize(size, 0);
+        data.size = size;
+    }
 
-    std::memcpy(prevBufferContent.data(), bufferContent.data(), size);
-    _constCopy->GetHostConstantBuffer(cmd_list, bufferContent, size, range.buffer.handle);
+    return data;
 }
 
-void ConstantHandlerBase::InitBuffers(const ToggleGroup* group, size_t size)
+void ConstantHandlerBase::UpdateRequiredRanges(const ToggleGroup* group, uint64_t resourceHandle)
 {
-    const auto& content = groupBufferContent.find(group);
+    vector<pair<uint64_t, uint64_t>> ranges;
 
-    if (content != groupBufferContent.end() && size != content->second.size())
     {
-        groupBufferContent[group].resize(size, 0);
-        groupPrevBufferContent[group].resize(size, 0);
-        groupBufferSize[group] = size;
+        unique_lock<shared_mutex> lock(varMutex);
+
+        GroupBindings& compiled = groupData[group].bindings;
+        if (!CompileBindings(group, restVariables, compiled) && compiled.rangeResource == resourceHandle)
+        {
+            return;
+        }
+
+        compiled.rangeResource = resourceHandle;
+
+        for (const auto& binding : compiled.bindings)
+        {
+            ranges.emplace_back(binding.offset, binding.byteSize);
+        }
     }
-    else if(content == groupBufferContent.end())
+
+    sort(ranges.begin(), ranges.end());
+
+    if (_constCopy != nullptr)
     {
-        groupBufferContent.emplace(group, vector<uint8_t>(size, 0));
-        groupPrevBufferContent.emplace(group, vector<uint8_t>(size, 0));
-        groupBufferSize.emplace(group, size);
+        _constCopy->SetRequiredRanges(resourceHandle, group, ranges);
     }
 }
 
 void ConstantHandlerBase::RemoveGroup(const ToggleGroup* group, device* dev)
 {
-    if (!groupBufferContent.contains(group))
+    if (_constCopy != nullptr)
     {
-        return;
+        _constCopy->ClearRequiredRanges(group);
     }
 
-    groupBufferContent.erase(group);
-    groupPrevBufferContent.erase(group);
-    groupBufferSize.erase(group);
+    groupData.erase(group);
 }
\ No newline at end of file
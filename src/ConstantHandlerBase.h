@@ -28,7 +28,11 @@ namespace Shim
             type_float4x3,
             type_float4x4,
             type_int,
-            type_uint
+            type_uint,
+            type_float_array,
+            type_float4x4_array,
+            type_int_array,
+            type_uint_array
         };
 
         static constexpr size_t type_size[] =
@@ -42,7 +46,11 @@ namespace Shim
             4,  // float4x3
             4,	// float4x4
             4,	// int
-            4	// uint
+            4,	// uint
+            4,	// float[]
+            4,	// float4x4[]
+            4,	// int[]
+            4	// uint[]
         };
 
         static constexpr size_t type_length[] =
@@ -56,7 +64,11 @@ namespace Shim
             12, // float4x3
             16,	// float4x4
             1,	// int
-            1	// uint
+            1,	// uint
+            1,	// float[]
+            16,	// float4x4[]
+            1,	// int[]
+            1	// uint[]
         };
 
         static constexpr const char* type_desc[] =
@@ -70,11 +82,72 @@ namespace Shim
             "float4x3", // float4x3
             "float4x4",	// float4x4
             "int",	// int
-            "uint"	// uint
+            "uint",	// uint
+            "float[]",	// float[]
+            "float4x4[]",	// float4x4[]
+            "int[]",	// int[]
+            "uint[]"	// uint[]
         };
 
+        static constexpr bool type_is_array(constant_type type)
+        {
+            return type >= constant_type::type_float_array;
+        }
+
+        static constexpr bool type_is_float(constant_type type)
+        {
+            return type <= constant_type::type_float4x4 || type == constant_type::type_float_array || type == constant_type::type_float4x4_array;
+        }
+
+        static constexpr bool type_is_int(constant_type type)
+        {
+            return type == constant_type::type_int || type == constant_type::type_int_array;
+        }
+
+        // cbuffer packing places every array element on a 16 byte boundary, push constants are tightly packed
+        static constexpr size_t CBUFFER_ARRAY_STRIDE = 16;
+
         static constexpr size_t CHAR_BUFFER_SIZE = 256;
 
+        struct UniformBinding
+        {
+            uintptr_t offset = 0;
+            constant_type type = constant_type::type_unknown;
+            uint32_t length = 0;
+            uint32_t elements = 1;
+            size_t elementSize = 0;
+            size_t stride = 0;
+            size_t byteSize = 0;
+            size_t uploadSize = 0;
+            bool usePrevious = false;
+            std::vector<reshade::api::effect_uniform_variable> variables;
+            std::vector<uint8_t> current;						// read back value of a variable, compared before uploading
+            std::vector<uint8_t> packed;
+        };
+
+        // Variable mappings of a group resolved against the effect variables, rebuilt when either side changes
+        struct GroupBindings
+        {
+            uint32_t mappingVersion = UINT32_MAX;
+            uint32_t variablesVersion = UINT32_MAX;
+            uint64_t rangeResource = 0;
+            bool pushMode = false;
+            std::vector<UniformBinding> bindings;
+        };
+
+        // Current and previous contents of a group's constant buffer live in two slots, a refresh flips the index instead of copying
+        struct GroupConstantData
+        {
+            std::vector<uint8_t> slots[2];
+            uint32_t current = 0;
+            size_t size = 0;
+            GroupBindings bindings;
+
+            std::vector<uint8_t>& Current() { return slots[current]; }
+            std::vector<uint8_t>& Previous() { return slots[current ^ 1]; }
+            void Swap() { current ^= 1; }
+        };
+
         class __declspec(novtable) ConstantHandlerBase final {
         public:
             ConstantHandlerBase();
@@ -97,18 +170,19 @@ namespace Shim
 
             static void SetConstantCopy(ConstantCopyBase* constantHandler);
         private:
-            std::unordered_map<const ShaderToggler::ToggleGroup*, std::vector<uint8_t>> groupBufferContent;
-            std::unordered_map<const ShaderToggler::ToggleGroup*, std::vector<uint8_t>> groupPrevBufferContent;
-            std::unordered_map<const ShaderToggler::ToggleGroup*, size_t> groupBufferSize;
+            std::unordered_map<const ShaderToggler::ToggleGroup*, GroupConstantData> groupData;
             int32_t previousEnableCount = std::numeric_limits<int32_t>::max();
             std::shared_mutex varMutex;
 
             static std::unordered_map<std::string, std::tuple<constant_type, std::vector<reshade::api::effect_uniform_variable>>> restVariables;
+            static uint32_t restVariablesVersion;
             static char charBuffer[CHAR_BUFFER_SIZE];
 
             static ConstantCopyBase* _constCopy;
 
-            void InitBuffers(const ShaderToggler::ToggleGroup* group, size_t size);
+            GroupConstantData& InitBuffers(const ShaderToggler::ToggleGroup* group, size_t size);
+            void UpdateRequiredRanges(const ShaderToggler::ToggleGroup* group, uint64_t resourceHandle);
+            static bool CompileBindings(const ShaderToggler::ToggleGroup* group, const std::unordered_map<std::string, std::tuple<constant_type, std::vector<reshade::api::effect_uniform_variable>>>& constants, GroupBindings& compiled);
             bool UpdateConstantEntries(reshade::api::command_list* cmd_list, CommandListDataContainer& cmdData, DeviceDataContainer& devData, ShaderToggler::ToggleGroup* group, uint32_t index);
             bool UpdateConstantBufferEntries(reshade::api::command_list* cmd_list, CommandListDataContainer& cmdData, DeviceDataContainer& devData, ShaderToggler::ToggleGroup* group, uint32_t index);
         };
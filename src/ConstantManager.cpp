@@ -5,6 +5,8 @@
 #include "ConstantCopyFFXIV.h"
 #include "ConstantCopyNierReplicant.h"
 #include "ConstantCopyGPUReadback.h"
+#include "ConstantCopyUpdateBufferRegion.h"
+#include "ConstantCopyMapSnapshot.h"
 
 using namespace Shim::Constants;
 using namespace std;
@@ -23,6 +25,10 @@ ConstantCopyType ConstantManager::ResolveConstantCopyType(const string& ctype)
         return ConstantCopyType::Copy_NierReplicant;
     else if (ctype == "gpu_readback")
         return ConstantCopyType::Copy_GPUReadback;
+    else if (ctype == "update_buffer_region")
+        return ConstantCopyType::Copy_UpdateBufferRegion;
+    else if (ctype == "map_snapshot")
+        return ConstantCopyType::Copy_MapSnapshot;
     
     return ConstantCopyType::Copy_None;
 }
@@ -77,6 +83,18 @@ bool ConstantManager::Init(AddonImGui::AddonUIData& data, ConstantCopyBase** con
         *constantCopy = &constantTypeGPUReadback;
     }
         break;
+    case ConstantCopyType::Copy_UpdateBufferRegion:
+    {
+        static ConstantCopyUpdateBufferRegion constantTypeUpdateBufferRegion;
+        *constantCopy = &constantTypeUpdateBufferRegion;
+    }
+        break;
+    case ConstantCopyType::Copy_MapSnapshot:
+    {
+        static ConstantCopyMapSnapshot constantTypeMapSnapshot;
+        *constantCopy = &constantTypeMapSnapshot;
+    }
+        break;
     default:
         *constantCopy = nullptr;
     }
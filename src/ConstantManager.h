@@ -16,6 +16,8 @@ namespace Shim
             Copy_FFXIV,
             Copy_NierReplicant,
             Copy_GPUReadback,
+            Copy_UpdateBufferRegion,
+            Copy_MapSnapshot,
         };
 
         static const std::vector<std::string> ConstantCopyTypeNames = {
@@ -24,7 +26,9 @@ namespace Shim
             "ffxiv",
             "nier_replicant",
             "memcpy_singular",
-            "memcpy_nested"
+            "memcpy_nested",
+            "update_buffer_region",
+            "map_snapshot"
         };
 
         enum ConstantHandlerType
@@ -0,0 +1,70 @@
+#include "EventSubscription.h"
+
+using namespace ShaderToggler;
+using namespace std;
+
+void EventSubscription::Subscribe()
+{
+    if (_subscribed)
+    {
+        return;
+    }
+
+    // Bump before registering so no callback can observe the new events with the old epoch
+    _epoch++;
+
+    for (const auto& [subscribe, _] : _events)
+    {
+        subscribe();
+    }
+
+    _subscribed = true;
+    _idleFrames = 0;
+}
+
+void EventSubscription::Unsubscribe()
+{
+    if (!_subscribed)
+    {
+        return;
+    }
+
+    for (const auto& [_, unsubscribe] : _events)
+    {
+        unsubscribe();
+    }
+
+    _subscribed = false;
+}
+
+void EventSubscription::Clear()
+{
+    Unsubscribe();
+    _events.clear();
+}
+
+void EventSubscription::Update(bool needed, bool canChange)
+{
+    if (needed)
+    {
+        _idleFrames = 0;
+
+        if (!_subscribed && canChange)
+        {
+            Subscribe();
+            reshade::log_message(reshade::log_level::info, "Draw and bind events subscribed");
+        }
+        return;
+    }
+
+    if (_idleFrames < IDLE_FRAMES_BEFORE_UNSUBSCRIBE)
+    {
+        _idleFrames++;
+    }
+
+    if (_subscribed && canChange && _idleFrames >= IDLE_FRAMES_BEFORE_UNSUBSCRIBE)
+    {
+        Unsubscribe();
+        reshade::log_message(reshade::log_level::info, "No active groups, draw and bind events unsubscribed");
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <reshade.hpp>
+#include <vector>
+#include <atomic>
+#include <functional>
+
+namespace ShaderToggler
+{
+    /// <summary>
+    /// A set of addon events which are only registered while something needs them. Used to drop the per-draw and per-bind
+    /// callbacks while the addon is idle. Every resubscription bumps the epoch so command lists can discard work they
+    /// queued before the gap. ReShade doesn't synchronize its event lists with the threads dispatching them, so they're only
+    /// changed at points where no command list records.
+    /// </summary>
+    class __declspec(novtable) EventSubscription final
+    {
+    public:
+        template<reshade::addon_event ev>
+        void Add(typename reshade::addon_event_traits<ev>::decl callback)
+        {
+            _events.push_back(std::make_pair(
+                [callback]() { reshade::register_event<ev>(callback); },
+                [callback]() { reshade::unregister_event<ev>(callback); }));
+        }
+
+        void Subscribe();
+        void Unsubscribe();
+        void Clear();
+
+        /// <summary>
+        /// Called once per frame. Resubscribes as soon as needed, unsubscribes only after a run of idle frames so briefly
+        /// toggling a group doesn't thrash the event lists. Either only happens in a frame where canChange is set, i.e. no
+        /// command list is recording.
+        /// </summary>
+        void Update(bool needed, bool canChange);
+
+        bool IsSubscribed() const { return _subscribed; }
+        uint32_t GetEpoch() const { return _epoch; }
+
+    private:
+        static constexpr uint32_t IDLE_FRAMES_BEFORE_UNSUBSCRIBE = 120;
+
+        std::vector<std::pair<std::function<void()>, std::function<void()>>> _events;
+        std::atomic_uint32_t _epoch = 0;
+        uint32_t _idleFrames = 0;
+        bool _subscribed = false;
+    };
+}
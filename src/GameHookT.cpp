@@ -1,9 +1,121 @@
+#include <filesystem>
+#include <format>
+#include <reshade.hpp>
 #include "GameHookT.h"
+#include "SignatureCache.h"
+#include "SignatureScanner.h"
+#include "Startup.h"
 
 using namespace Shim;
 using namespace std;
 
 bool GameHook::_hooked = false;
+bool GameHook::_identityInitialized = false;
+
+void GameHook::InitModuleIdentity(const uint8_t* imageBase)
+{
+    if (_identityInitialized)
+    {
+        return;
+    }
+
+    const IMAGE_DOS_HEADER* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(imageBase);
+    const IMAGE_NT_HEADERS* ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS*>(imageBase + dosHeader->e_lfanew);
+
+    ModuleIdentity identity;
+    identity.timestamp = ntHeaders->FileHeader.TimeDateStamp;
+    identity.checksum = ntHeaders->OptionalHeader.CheckSum;
+
+    wchar_t fileName[MAX_PATH + 1];
+    if (GetModuleFileNameW(NULL, fileName, MAX_PATH + 1) != 0)
+    {
+        error_code ec;
+        const uintmax_t fileSize = filesystem::file_size(fileName, ec);
+        identity.fileSize = ec ? 0 : static_cast<uint64_t>(fileSize);
+    }
+
+    SignatureCache::SetModuleIdentity(identity);
+    _identityInitialized = true;
+}
+
+const uint8_t* GameHook::FindSignature(const Signature& sig)
+{
+    return FindSignatures({ &sig })[0];
+}
+
+vector<const uint8_t*> GameHook::FindSignatures(const vector<const Signature*>& sigs)
+{
+    vector<const uint8_t*> results(sigs.size(), nullptr);
+
+    const uint8_t* imageBase = reinterpret_cast<const uint8_t*>(GetModuleHandleW(NULL));
+    if (imageBase == nullptr)
+    {
+        return results;
+    }
+
+    InitModuleIdentity(imageBase);
+
+    const IMAGE_DOS_HEADER* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(imageBase);
+    const IMAGE_NT_HEADERS* ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS*>(imageBase + dosHeader->e_lfanew);
+    const size_t imageSize = ntHeaders->OptionalHeader.SizeOfImage;
+
+    // Everything the cache can't answer is resolved in a single scan over the code sections
+    SignatureScanner scanner;
+    vector<size_t> scanned;
+
+    for (size_t i = 0; i < sigs.size(); i++)
+    {
+        const Signature& sig = *sigs[i];
+
+        // An RVA of 0 records that the signature isn't present in this executable
+        uint32_t rva = 0;
+        if (SignatureCache::TryGet(sig, rva))
+        {
+            if (rva == 0)
+            {
+                continue;
+            }
+
+            if (rva + sig.Size() <= imageSize && sig.Matches(imageBase + rva))
+            {
+                results[i] = imageBase + rva;
+                continue;
+            }
+
+            reshade::log_message(reshade::log_level::warning, std::format("Cached location of signature \"{}\" is stale, rescanning", sig.Pattern()).c_str());
+        }
+
+        scanner.Add(&sig);
+        scanned.push_back(i);
+    }
+
+    if (scanned.empty())
+    {
+        return results;
+    }
+
+    vector<ScanRegion> regions;
+    const IMAGE_SECTION_HEADER* section = IMAGE_FIRST_SECTION(ntHeaders);
+    for (WORD i = 0; i < ntHeaders->FileHeader.NumberOfSections; i++, section++)
+    {
+        if (section->Characteristics & IMAGE_SCN_MEM_EXECUTE)
+        {
+            regions.push_back(ScanRegion{ imageBase + section->VirtualAddress, section->Misc.VirtualSize });
+        }
+    }
+
+    // Threads started under the loader lock wait for it before running, joining them there deadlocks. Only the startup worker
+    // is known to run outside of it
+    const vector<const uint8_t*> matches = scanner.Scan(regions, ShaderToggler::Startup::IsWorkerThread() ? 0 : 1);
+    for (size_t i = 0; i < scanned.size(); i++)
+    {
+        const uint8_t* match = matches[i];
+        results[scanned[i]] = match;
+        SignatureCache::Set(*sigs[scanned[i]], match != nullptr ? static_cast<uint32_t>(match - imageBase) : 0);
+    }
+
+    return results;
+}
 
 template<typename T>
 string GameHookT<T>::GetExecutableName()
@@ -25,7 +137,7 @@ T* GameHookT<T>::InstallHook(void* target, T* callback)
 {
     void* original_function = nullptr;
 
-    if (MH_CreateHook(target, reinterpret_cast<void*>(callback), &original_function) != MH_OK)
+    if (!ShaderToggler::Startup::Install([&] { return MH_CreateHook(target, reinterpret_cast<void*>(callback), &original_function) == MH_OK; }))
         return nullptr;
 
     return reinterpret_cast<T*>(original_function);
@@ -34,21 +146,25 @@ T* GameHookT<T>::InstallHook(void* target, T* callback)
 template<typename T>
 T* GameHookT<T>::InstallApiHook(LPCWSTR pszModule, LPCSTR pszProcName, T* callback)
 {
-    void* original_function = nullptr;
+    // What MH_CreateHookApi does, but resolved outside of Install as GetModuleHandle takes the loader lock
+    HMODULE module = GetModuleHandleW(pszModule);
+    if (module == nullptr)
+        return nullptr;
 
-    if (MH_CreateHookApi(pszModule, pszProcName, reinterpret_cast<void*>(callback), &original_function) != MH_OK)
+    void* target = reinterpret_cast<void*>(GetProcAddress(module, pszProcName));
+    if (target == nullptr)
         return nullptr;
 
-    return reinterpret_cast<T*>(original_function);
+    return InstallHook(target, callback);
 }
 
 template<typename T>
-bool GameHookT<T>::Hook(T** original, T* detour, const sigmatch::signature& sig)
+bool GameHookT<T>::Hook(T** original, T* detour, const Signature& sig)
 {
     if (!_hooked)
     {
         // Initialize MinHook.
-        if (MH_Initialize() != MH_OK)
+        if (!ShaderToggler::Startup::Install([] { return MH_Initialize() == MH_OK; }))
         {
             return false;
         }
@@ -56,20 +172,14 @@ bool GameHookT<T>::Hook(T** original, T* detour, const sigmatch::signature& sig)
         _hooked = true;
     }
 
-    string exe = GetExecutableName();
-    if (exe.length() == 0)
-        return false;
-
-    sigmatch::this_process_target target;
-    sigmatch::search_result result = target.in_module(exe).search(sig);
-
-    for (const std::byte* address : result.matches()) {
-        void* adr = static_cast<void*>(const_cast<std::byte*>(address));
-        *original = InstallHook(adr, detour);
+    const uint8_t* address = FindSignature(sig);
+    if (address != nullptr)
+    {
+        *original = InstallHook(const_cast<uint8_t*>(address), detour);
     }
 
-    if (original != nullptr)
-        return MH_EnableHook(MH_ALL_HOOKS) == MH_OK;
+    if (*original != nullptr)
+        return ShaderToggler::Startup::Install([] { return MH_EnableHook(MH_ALL_HOOKS) == MH_OK; });
 
     return false;
 }
@@ -87,7 +197,6 @@ bool GameHookT<T>::Unhook()
 
 template class GameHookT<sig_ffxiv_texture_create>;
 template class GameHookT<sig_ffxiv_textures_create>;
-template class GameHookT<sig_ffxiv_textures_recreate>;
 template class GameHookT<sig_memcpy>;
 template class GameHookT<sig_ffxiv_cbload>;
 template class GameHookT<sig_nier_replicant_cbload>;
\ No newline at end of file
@@ -6,11 +6,9 @@
 #include <unordered_map>
 #include <MinHook.h>
 #include <string>
+#include <vector>
 
-#pragma warning(push)
-#pragma warning(disable : 4005)
-#include <sigmatch.hpp>
-#pragma warning(pop)
+#include "Signature.h"
 
 struct HostBufferData;
 struct param_3_struct;
@@ -22,20 +20,30 @@ using sig_memcpy = void* (__fastcall)(void*, void*, size_t);
 using sig_ffxiv_cbload = int64_t(__fastcall)(ResourceData*, param_2_struct*, param_3_struct, HostBufferData*);
 using sig_nier_replicant_cbload = void(__fastcall)(intptr_t p1, intptr_t* p2, uintptr_t p3);
 using sig_ffxiv_texture_create = void(__fastcall)(uintptr_t*, uintptr_t*);
-using sig_ffxiv_textures_recreate = uintptr_t(__fastcall)(uintptr_t);
-using sig_ffxiv_textures_create = uintptr_t(__fastcall)(uintptr_t);
+using sig_ffxiv_textures_recreate = uintptr_t __fastcall(uintptr_t);
+using sig_ffxiv_textures_create = uintptr_t __fastcall(uintptr_t);
 
 namespace Shim
 {
     class GameHook {
+    public:
+        // Resolves a signature in the executable's code sections, through the signature cache when possible
+        static const uint8_t* FindSignature(const Signature& sig);
+        // Resolves several signatures at once, cache misses share a single pass over the code sections
+        static std::vector<const uint8_t*> FindSignatures(const std::vector<const Signature*>& sigs);
+
     protected:
         static bool _hooked;
+
+    private:
+        static void InitModuleIdentity(const uint8_t* imageBase);
+        static bool _identityInitialized;
     };
 
     template<typename T>
     class GameHookT : public GameHook {
     public:
-        static bool Hook(T** original, T* detour, const sigmatch::signature& sig);
+        static bool Hook(T** original, T* detour, const Signature& sig);
         static bool Unhook();
         static std::string GetExecutableName();
         static T* InstallHook(void* target, T* callback);
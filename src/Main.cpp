@@ -31,6 +31,7 @@
 /////////////////////////////////////////////////////////////////////////
 #include <imgui.h>
 #include <reshade.hpp>
+#include <d3d11.h>
 #include <vector>
 #include <format>
 #include <unordered_map>
@@ -51,6 +52,15 @@
 #include "PipelinePrivateData.h"
 #include "ResourceManager.h"
 #include "RenderingManager.h"
+#include "EventSubscription.h"
+#include "RecordingGate.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
+#include "CommandCapture.h"
+#include "ConfigWriter.h"
+#include "ConfigWatcher.h"
+#include "Startup.h"
+#include "ShaderUsage.h"
 
 using namespace reshade::api;
 using namespace ShaderToggler;
@@ -92,6 +102,20 @@ static size_t g_charBufferSize = CHAR_BUFFER_SIZE;
 // TODO: actually implement ability to turn off srgb-view generation
 static vector<effect_runtime*> runtimes;
 
+// Per-draw and per-bind events, only registered while a group, hunt or collection needs them
+static EventSubscription g_drawEvents;
+// Handlers which stay registered but are still specialized per device API
+static EventSubscription g_deviceEvents;
+static device_api g_eventsDeviceApi = ANY_DEVICE_API;
+static device_api g_pendingEventsDeviceApi = ANY_DEVICE_API;
+static bool g_eventsSelected = false;
+static bool g_eventsSelectionPending = false;
+// ReShade dispatches events without synchronizing with their registration, so event lists are only changed while this is
+// locked. Immediate contexts don't enter it, they record on the thread presenting
+static RecordingGate g_recording;
+
+static void ApplyDeviceEvents(device_api api);
+
 /// <summary>
 /// Calculates a crc32 hash from the passed in shader bytecode. The hash is used to identity the shader in future runs.
 /// </summary>
@@ -105,17 +129,54 @@ static uint32_t calculateShaderHash(void* shaderData)
     }
 
     const auto shaderDesc = *static_cast<shader_desc*>(shaderData);
+
+    PROFILE_SCOPE_ITEMS(Profiling::PROFILE_SHADER_HASH, shaderDesc.code_size);
     return compute_crc32(static_cast<const uint8_t*>(shaderDesc.code), shaderDesc.code_size);
 }
 
-static void onInitDevice(device* device)
+/// <summary>
+/// Returns the command list's data, with its queues dropped first if it was last touched before the draw events were
+/// resubscribed. Subscriptions only change while no command list records, so lists which record afterwards start from a reset
+/// anyway. Only the immediate contexts carry state over the gap, their state tracker is kept since the effects rendered on
+/// them rebind it themselves.
+/// </summary>
+static CommandListDataContainer& GetCommandListData(command_list* cmd_list)
 {
-    device->create_private_data<DeviceDataContainer>();
+    CommandListDataContainer& data = cmd_list->get_private_data<CommandListDataContainer>();
+
+    const uint32_t epoch = g_drawEvents.GetEpoch();
+    if (data.subscriptionEpoch != epoch)
+    {
+        data.ResetQueues();
+        data.subscriptionEpoch = epoch;
+    }
+
+    return data;
 }
 
+static bool IsDrawPathNeeded()
+{
+    if (!g_addonUIData.GetDynamicEventSubscription() || g_activeCollectorFrameCounter > 0 || g_addonUIData.GetToggleGroupIdShaderEditing() >= 0 ||
+        g_pixelShaderManager.isInHuntingMode() || g_vertexShaderManager.isInHuntingMode() || Profiling::CommandCapture::IsActive())
+    {
+        return true;
+    }
+
+    for (const auto& group : g_addonUIData.GetHotToggleGroups())
+    {
+        if (group.flags & HOT_GROUP_ACTIVE)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
 
 static void onDestroyDevice(device* device)
 {
+    ShaderToggler::Startup::Wait();
+
     resourceManager.OnDestroyDevice(device);
 
     device->destroy_private_data<DeviceDataContainer>();
@@ -133,36 +194,87 @@ static void onInitCommandList(command_list* commandList)
 
 static void onDestroyCommandList(command_list* commandList)
 {
+    if (commandList->get_private_data<CommandListDataContainer>().recording)
+    {
+        g_recording.Leave();
+    }
+
     commandList->destroy_private_data<CommandListDataContainer>();
 }
 
+/// <summary>
+/// True for command lists which may record on other threads than the one presenting. Immediate contexts are left out, they
+/// get reset events (e.g. on ClearState) but never a close event.
+/// </summary>
+static bool IsDeferredCommandList(command_list* commandList)
+{
+    switch (commandList->get_device()->get_api())
+    {
+    case device_api::d3d12:
+    case device_api::vulkan:
+        return true;
+    case device_api::d3d11:
+        return reinterpret_cast<ID3D11DeviceContext*>(commandList->get_native())->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED;
+    default:
+        return false;
+    }
+}
+
 static void onResetCommandList(command_list* commandList)
 {
     CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+
+    // Waits out a present changing what the list is about to read
+    if (!commandListData.recording && IsDeferredCommandList(commandList))
+    {
+        g_recording.Enter();
+        commandListData.recording = true;
+    }
+
     commandListData.Reset();
+    commandListData.ReserveTechniques(commandList->get_device()->get_private_data<DeviceDataContainer>().allEnabledTechniques.size());
+}
+
+static void onCloseCommandList(command_list* commandList)
+{
+    CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+
+    if (commandListData.recording)
+    {
+        commandListData.recording = false;
+        g_recording.Leave();
+    }
 }
 
 
 static void onInitSwapchain(reshade::api::swapchain* swapchain)
 {
+    ShaderToggler::Startup::Wait();
+
     resourceManager.OnInitSwapchain(swapchain);
 }
 
 
 static void onDestroySwapchain(reshade::api::swapchain* swapchain)
 {
+    ShaderToggler::Startup::Wait();
+
     resourceManager.OnDestroySwapchain(swapchain);
 }
 
 
 static bool onCreateResource(device* device, resource_desc& desc, subresource_data* initial_data, resource_usage initial_state)
 {
+    ShaderToggler::Startup::Wait();
+
     return resourceManager.OnCreateResource(device, desc, initial_data, initial_state);
 }
 
 
 static void onInitResource(device* device, const resource_desc& desc, const subresource_data* initData, resource_usage usage, reshade::api::resource handle)
 {
+    ShaderToggler::Startup::Wait();
+
     resourceManager.OnInitResource(device, desc, initData, usage, handle);
     
     if (constantCopy != nullptr)
@@ -172,6 +284,8 @@ static void onInitResource(device* device, const resource_desc& desc, const subr
 
 static void onDestroyResource(device* device, resource res)
 {
+    ShaderToggler::Startup::Wait();
+
     resourceManager.OnDestroyResource(device, res);
     
     if (constantCopy != nullptr)
@@ -181,24 +295,32 @@ static void onDestroyResource(device* device, resource res)
 
 static bool onCreateResourceView(device* device, resource resource, resource_usage usage_type, resource_view_desc& desc)
 {
+    ShaderToggler::Startup::Wait();
+
     return resourceManager.OnCreateResourceView(device, resource, usage_type, desc);
 }
 
 
 static void onInitResourceView(device* device, resource resource, resource_usage usage_type, const resource_view_desc& desc, resource_view view)
 {
+    ShaderToggler::Startup::Wait();
+
     resourceManager.OnInitResourceView(device, resource, usage_type, desc, view);
 }
 
 
 static void onDestroyResourceView(device* device, resource_view view)
 {
+    ShaderToggler::Startup::Wait();
+
     resourceManager.OnDestroyResourceView(device, view);
 }
 
 
 static void onReshadeReloadedEffects(effect_runtime* runtime)
 {
+    ShaderToggler::Startup::Wait();
+
     DeviceDataContainer& data = runtime->get_device()->get_private_data<DeviceDataContainer>();
     data.allEnabledTechniques.clear();
     allTechniques.clear();
@@ -222,6 +344,8 @@ static void onReshadeReloadedEffects(effect_runtime* runtime)
 
 static bool onReshadeSetTechniqueState(effect_runtime* runtime, effect_technique technique, bool enabled)
 {
+    ShaderToggler::Startup::Wait();
+
     DeviceDataContainer& data = runtime->get_device()->get_private_data<DeviceDataContainer>();
     g_charBufferSize = CHAR_BUFFER_SIZE;
     runtime->get_technique_name(technique, g_charBuffer, &g_charBufferSize);
@@ -253,6 +377,9 @@ static bool onReshadeSetTechniqueState(effect_runtime* runtime, effect_technique
 
 static void onInitEffectRuntime(effect_runtime* runtime)
 {
+    // Resources are tracked from here on and the runtime's constants are read, both need the config and hooks in place
+    ShaderToggler::Startup::Wait();
+
     DeviceDataContainer& data = runtime->get_device()->get_private_data<DeviceDataContainer>();
 
     // Dispose of texture bindings created from the runtime below
@@ -271,11 +398,20 @@ static void onInitEffectRuntime(effect_runtime* runtime)
     {
         constantHandler->ReloadConstantVariables(runtime);
     }
+
+    ShaderToggler::ConfigWatcher::Start(g_addonUIData.GetBasePath() / HASH_FILE_NAME);
 }
 
 
 static void onDestroyEffectRuntime(effect_runtime* runtime)
 {
+    ShaderToggler::Startup::Wait();
+
+    // Finish a pending trace dump while it's still safe to wait on threads, DllMain runs under the loader lock
+    Profiling::TraceRecorder::Join();
+    Profiling::CommandCapture::Stop();
+    ShaderToggler::ConfigWriter::Join();
+
     DeviceDataContainer& data = runtime->get_device()->get_private_data<DeviceDataContainer>();
 
     // Remove runtime from stack
@@ -290,6 +426,11 @@ static void onDestroyEffectRuntime(effect_runtime* runtime)
         it++;
     }
 
+    if (runtimes.size() == 0)
+    {
+        ShaderToggler::ConfigWatcher::Stop();
+    }
+
     // Pick the runtime on top of our stack if there are any
     if (runtime == data.current_runtime)
     {
@@ -348,8 +489,11 @@ static void onDestroyPipeline(device* device, pipeline pipelineHandle)
 }
 
 
+template<device_api api>
 static void onBindPipeline(command_list* commandList, pipeline_stage stages, pipeline pipelineHandle)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_BIND_PIPELINE);
+
     if (nullptr == commandList || pipelineHandle.handle == 0 || !((uint32_t)(stages & pipeline_stage::pixel_shader) || (uint32_t)(stages & pipeline_stage::vertex_shader)))
     {
         return;
@@ -358,12 +502,14 @@ static void onBindPipeline(command_list* commandList, pipeline_stage stages, pip
     const uint32_t handleHasPixelShaderAttached = (uint32_t)(stages & pipeline_stage::pixel_shader) ? g_pixelShaderManager.safeGetShaderHash(pipelineHandle.handle) : 0;
     const uint32_t handleHasVertexShaderAttached = (uint32_t)(stages & pipeline_stage::vertex_shader) ? g_vertexShaderManager.safeGetShaderHash(pipelineHandle.handle) : 0;
 
+    Profiling::CommandCapture::OnBindPipeline(commandList, stages, pipelineHandle, handleHasPixelShaderAttached, handleHasVertexShaderAttached);
+
     if (!handleHasPixelShaderAttached && !handleHasVertexShaderAttached)
     {
         // draw call with unknown handle, don't collect it
         return;
     }
-    CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+    CommandListDataContainer& commandListData = GetCommandListData(commandList);
     DeviceDataContainer& deviceData = commandList->get_device()->get_private_data<DeviceDataContainer>();
 
     if (deviceData.current_runtime == nullptr || !deviceData.current_runtime->get_effects_state())
@@ -371,7 +517,7 @@ static void onBindPipeline(command_list* commandList, pipeline_stage stages, pip
         return;
     }
     
-    if (commandList->get_device()->get_api() == device_api::vulkan || commandList->get_device()->get_api() == device_api::d3d12)
+    if (IsDeviceApi<api, device_api::d3d12, device_api::vulkan>(commandList->get_device()))
     {
         commandListData.stateTracker.OnBindPipeline(commandList, stages, pipelineHandle);
     }
@@ -440,13 +586,17 @@ static void onBindPipeline(command_list* commandList, pipeline_stage stages, pip
 
 static void onBindRenderTargetsAndDepthStencil(command_list* cmd_list, uint32_t count, const resource_view* rtvs, resource_view dsv)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_BIND_RENDER_TARGETS);
+
     if (cmd_list == nullptr || cmd_list->get_device() == nullptr)
     {
         return;
     }
     
+    Profiling::CommandCapture::OnBindRenderTargets(cmd_list, count, rtvs, dsv);
+
     device* device = cmd_list->get_device();
-    CommandListDataContainer& commandListData = cmd_list->get_private_data<CommandListDataContainer>();
+    CommandListDataContainer& commandListData = GetCommandListData(cmd_list);
     DeviceDataContainer& deviceData = device->get_private_data<DeviceDataContainer>();
 
     commandListData.stateTracker.OnBindRenderTargetsAndDepthStencil(cmd_list, count, rtvs, dsv);
@@ -473,13 +623,17 @@ static void onBindRenderTargetsAndDepthStencil(command_list* cmd_list, uint32_t
 
 static void onBeginRenderPass(command_list* cmd_list, uint32_t count, const render_pass_render_target_desc* rts, const render_pass_depth_stencil_desc* ds)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_BEGIN_RENDER_PASS);
+
     if (cmd_list == nullptr || cmd_list->get_device() == nullptr)
     {
         return;
     }
     
+    Profiling::CommandCapture::OnBeginRenderPass(cmd_list, count, rts, ds);
+
     device* device = cmd_list->get_device();
-    CommandListDataContainer& commandListData = cmd_list->get_private_data<CommandListDataContainer>();
+    CommandListDataContainer& commandListData = GetCommandListData(cmd_list);
     DeviceDataContainer& deviceData = device->get_private_data<DeviceDataContainer>();
     
     commandListData.stateTracker.OnBeginRenderPass(cmd_list, count, rts, ds);
@@ -503,42 +657,82 @@ static void onBeginRenderPass(command_list* cmd_list, uint32_t count, const rend
 
 static void onPushDescriptors(command_list* cmd_list, shader_stage stages, pipeline_layout layout, uint32_t layout_param, const reshade::api::descriptor_table_update& tables)
 {
-    auto& data = cmd_list->get_private_data<CommandListDataContainer>();
+    PROFILE_SCOPE(Profiling::PROFILE_PUSH_DESCRIPTORS);
+
+    Profiling::CommandCapture::OnPushDescriptors(cmd_list, stages, layout, layout_param, tables);
+
+    auto& data = GetCommandListData(cmd_list);
     data.stateTracker.OnPushDescriptors(cmd_list, stages, layout, layout_param, tables);
 }
 
 
 static void onPushConstants(command_list* cmd_list, shader_stage stages, pipeline_layout layout, uint32_t layout_param, uint32_t first, uint32_t count, const void* values)
 {
-    auto& data = cmd_list->get_private_data<CommandListDataContainer>();
+    PROFILE_SCOPE(Profiling::PROFILE_PUSH_CONSTANTS);
+
+    Profiling::CommandCapture::OnPushConstants(cmd_list, stages, layout, layout_param, first, count, values);
+
+    auto& data = GetCommandListData(cmd_list);
     data.stateTracker.OnPushConstants(cmd_list, stages, layout, layout_param, first, count, values);
 }
 
 
+template<device_api api>
 static void onBindDescriptorSets(command_list* cmd_list, shader_stage stages, pipeline_layout layout, uint32_t first, uint32_t count, const reshade::api::descriptor_table* tables)
 {
-    auto& data = cmd_list->get_private_data<CommandListDataContainer>();
+    PROFILE_SCOPE(Profiling::PROFILE_BIND_DESCRIPTOR_TABLES);
+
+    if (!IsDeviceApi<api, device_api::d3d12>(cmd_list->get_device()))
+    {
+        return;
+    }
+
+    auto& data = GetCommandListData(cmd_list);
     data.stateTracker.OnBindDescriptorSets(cmd_list, stages, layout, first, count, tables);
 }
 
 
+template<device_api api>
 static void onBindViewports(command_list* cmd_list, uint32_t first, uint32_t count, const viewport* viewports)
 {
-    auto& data = cmd_list->get_private_data<CommandListDataContainer>();
+    PROFILE_SCOPE(Profiling::PROFILE_BIND_VIEWPORTS);
+
+    if (!IsDeviceApi<api, device_api::d3d12, device_api::vulkan>(cmd_list->get_device()))
+    {
+        return;
+    }
+
+    auto& data = GetCommandListData(cmd_list);
     data.stateTracker.OnBindViewports(cmd_list, first, count, viewports);
 }
 
 
+template<device_api api>
 static void onBindScissorRects(command_list* cmd_list, uint32_t first, uint32_t count, const rect* rects)
 {
-    auto& data = cmd_list->get_private_data<CommandListDataContainer>();
+    PROFILE_SCOPE(Profiling::PROFILE_BIND_SCISSOR_RECTS);
+
+    if (!IsDeviceApi<api, device_api::d3d12, device_api::vulkan>(cmd_list->get_device()))
+    {
+        return;
+    }
+
+    auto& data = GetCommandListData(cmd_list);
     data.stateTracker.OnBindScissorRects(cmd_list, first, count, rects);
 }
 
 
+template<device_api api>
 static void onBindPipelineStates(command_list* cmd_list, uint32_t count, const dynamic_state* states, const uint32_t* values)
 {
-    auto& data = cmd_list->get_private_data<CommandListDataContainer>();
+    PROFILE_SCOPE(Profiling::PROFILE_BIND_PIPELINE_STATES);
+
+    if (!IsDeviceApi<api, device_api::d3d12>(cmd_list->get_device()))
+    {
+        return;
+    }
+
+    auto& data = GetCommandListData(cmd_list);
     data.stateTracker.OnBindPipelineStates(cmd_list, count, states, values);
 }
 
@@ -571,11 +765,27 @@ static void onDestroyPipelineLayout(device* device, pipeline_layout layout)
 
 static void onReshadeOverlay(effect_runtime* runtime)
 {
+    if (!ShaderToggler::Startup::IsReady())
+    {
+        return;
+    }
+
     DisplayOverlay(g_addonUIData, resourceManager, runtime);
 }
 
+template<device_api api>
 static void onPresent(command_queue* queue, swapchain* swapchain, const rect* source_rect, const rect* dest_rect, uint32_t dirty_rect_count, const rect* dirty_rects)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_PRESENT);
+
+    // Frames presented while starting up are passed through untouched
+    if (!ShaderToggler::Startup::IsReady())
+    {
+        return;
+    }
+
+    Profiling::CommandCapture::OnPresent(queue, swapchain);
+
     device* dev = queue->get_device();
     DeviceDataContainer& deviceData = dev->get_private_data<DeviceDataContainer>();
 
@@ -595,12 +805,19 @@ static void onPresent(command_queue* queue, swapchain* swapchain, const rect* so
         }
     }
 
-    if (dev->get_api() != device_api::d3d12 && dev->get_api() != device_api::vulkan)
-        onResetCommandList(runtime->get_command_queue()->get_immediate_command_list());
+    if (!IsDeviceApi<api, device_api::d3d12, device_api::vulkan>(dev))
+        runtime->get_command_queue()->get_immediate_command_list()->get_private_data<CommandListDataContainer>().Reset();
 }
 
 static void onReshadePresent(effect_runtime* runtime)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_RESHADE_PRESENT);
+
+    if (!ShaderToggler::Startup::IsReady())
+    {
+        return;
+    }
+
     device* dev = runtime->get_device();
     DeviceDataContainer& deviceData = dev->get_private_data<DeviceDataContainer>();
     command_queue* queue = runtime->get_command_queue();
@@ -614,6 +831,44 @@ static void onReshadePresent(effect_runtime* runtime)
     deviceData.constantsUpdated.clear();
     deviceData.huntPreview.Reset();
 
+#ifdef SHADERTOGGLER_PROFILER
+    if (Profiling::Profiler::IsEnabled())
+    {
+        Profiling::Profiler::EndFrame();
+    }
+#endif
+
+    Profiling::TraceRecorder::SetEnabled(g_addonUIData.GetTraceRecording());
+    Profiling::TraceRecorder::EndFrame();
+    Profiling::CommandCapture::EndFrame();
+
+    uint32_t width, height;
+    runtime->get_screenshot_width_and_height(&width, &height);
+    ShaderToggler::ShaderUsage::EndFrame(g_activeCollectorFrameCounter > 0, width, height);
+
+    // While quiet no deferred command list records, and lists resetting meanwhile wait until the gate is unlocked below, so
+    // what they read may change
+    const bool quiet = g_recording.TryLock();
+
+    // Pick up outside edits of the config, then group edits made in the overlay during the last frame. A reload patches the
+    // hash lookups command lists iterate, it waits for a quiet present.
+    if (quiet && g_addonUIData.ApplyConfigReload(runtime->get_device()))
+    {
+        deviceData.reload_bindings = true;
+    }
+    g_addonUIData.RefreshToggleGroups();
+
+    if (quiet && g_eventsSelectionPending)
+    {
+        ApplyDeviceEvents(g_pendingEventsDeviceApi);
+    }
+    g_drawEvents.Update(IsDrawPathNeeded(), quiet);
+
+    if (quiet)
+    {
+        g_recording.Unlock();
+    }
+
     if (deviceData.reload_bindings)
     {
         renderingManager.DisposeTextureBindings(runtime);
@@ -628,21 +883,27 @@ static void onReshadePresent(effect_runtime* runtime)
 
 static void onMapBufferRegion(device* device, resource resource, uint64_t offset, uint64_t size, map_access access, void** data)
 {
-    if (constantCopy != nullptr)
+    PROFILE_SCOPE(Profiling::PROFILE_BUFFER_REGION);
+
+    if (ShaderToggler::Startup::IsReady() && constantCopy != nullptr)
         constantCopy->OnMapBufferRegion(device, resource, offset, size, access, data);
 }
 
 
 static void onUnmapBufferRegion(device* device, resource resource)
 {
-    if (constantCopy != nullptr)
+    PROFILE_SCOPE(Profiling::PROFILE_BUFFER_REGION);
+
+    if (ShaderToggler::Startup::IsReady() && constantCopy != nullptr)
         constantCopy->OnUnmapBufferRegion(device, resource);
 }
 
 
 static bool onUpdateBufferRegion(device* device, const void* data, resource resource, uint64_t offset, uint64_t size)
 {
-    if (constantCopy != nullptr)
+    PROFILE_SCOPE(Profiling::PROFILE_BUFFER_REGION);
+
+    if (ShaderToggler::Startup::IsReady() && constantCopy != nullptr)
         constantCopy->OnUpdateBufferRegion(device, data, resource, offset, size);
 
     return false;
@@ -651,16 +912,41 @@ static bool onUpdateBufferRegion(device* device, const void* data, resource reso
 
 static void displaySettings(effect_runtime* runtime)
 {
+    if (!ShaderToggler::Startup::IsReady())
+    {
+        ImGui::TextUnformatted("Starting up...");
+        return;
+    }
+
     DisplaySettings(g_addonUIData, runtime);
 }
 
 
-static bool Init()
+/// <summary>
+/// Runs on the startup worker, or inline on the first hook which can't do without it. Everything reading files or scanning
+/// the game's memory goes here rather than into DllMain.
+/// </summary>
+static void Init()
 {
-    resourceManager.SetResourceShim(g_addonUIData.GetResourceShim());
-    resourceManager.Init();
+    using ShaderToggler::Startup;
 
-    return constantManager.Init(g_addonUIData, &constantCopy, &constantHandler);
+    Startup::Stage("config", [] {
+        g_addonUIData.LoadShaderTogglerIniFile();
+        });
+
+    Startup::Stage("resource shim", [] {
+        resourceManager.SetResourceShim(g_addonUIData.GetResourceShim());
+        resourceManager.Init();
+        });
+
+    Startup::Stage("constant hooks", [] {
+        constantManager.Init(g_addonUIData, &constantCopy, &constantHandler);
+        });
+
+    // Persist signature locations resolved by the hooks above
+    Startup::Stage("signature cache", [] {
+        ShaderToggler::ConfigWriter::FlushSignatureCache(g_addonUIData.GetBasePath() / HASH_FILE_NAME);
+        });
 }
 
 
@@ -671,7 +957,21 @@ static bool UnInit()
 
 static void CheckDrawCall(command_list* cmd_list)
 {
-    CommandListDataContainer& commandListData = cmd_list->get_private_data<CommandListDataContainer>();
+    PROFILE_SCOPE(Profiling::PROFILE_CHECK_DRAW_CALL);
+
+    CommandListDataContainer& commandListData = GetCommandListData(cmd_list);
+
+    if (ShaderToggler::ShaderUsage::IsCollecting())
+    {
+        resource_view rtvs[ShaderToggler::ShaderUsage::MAX_RENDER_TARGETS];
+        resource_view dsv = { 0 };
+        const uint32_t rtvCount = commandListData.stateTracker.GetBoundTargets(rtvs, ShaderToggler::ShaderUsage::MAX_RENDER_TARGETS, dsv);
+
+        // activeShaderHash is -1 until a known shader was bound
+        const uint32_t pixelShaderHash = commandListData.ps.activeShaderHash != static_cast<uint32_t>(-1) ? commandListData.ps.activeShaderHash : 0;
+        const uint32_t vertexShaderHash = commandListData.vs.activeShaderHash != static_cast<uint32_t>(-1) ? commandListData.vs.activeShaderHash : 0;
+        ShaderToggler::ShaderUsage::OnDraw(cmd_list, pixelShaderHash, vertexShaderHash, rtvs, rtvCount, dsv);
+    }
 
     if (commandListData.commandQueue & Rendering::CHECK_MATCH_DRAW)
     {
@@ -700,6 +1000,7 @@ static void CheckDrawCall(command_list* cmd_list)
 
 static bool onDraw(command_list* cmd_list, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
 {
+    Profiling::CommandCapture::OnDraw(cmd_list, Profiling::CAPTURE_DRAW, vertex_count, instance_count, first_vertex, first_instance);
     CheckDrawCall(cmd_list);
 
     return false;
@@ -707,6 +1008,7 @@ static bool onDraw(command_list* cmd_list, uint32_t vertex_count, uint32_t insta
 
 static bool onDrawIndexed(command_list* cmd_list, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance)
 {
+    Profiling::CommandCapture::OnDraw(cmd_list, Profiling::CAPTURE_DRAW_INDEXED, index_count, instance_count, first_index, Profiling::CommandCapture::ZigZag(vertex_offset), first_instance);
     CheckDrawCall(cmd_list);
 
     return false;
@@ -718,6 +1020,7 @@ static bool onDrawOrDispatchIndirect(command_list* cmd_list, indirect_command ty
     {
     case indirect_command::draw:
     case indirect_command::draw_indexed:
+        Profiling::CommandCapture::OnDraw(cmd_list, Profiling::CAPTURE_DRAW_INDIRECT, static_cast<uint32_t>(type), buffer.handle, offset, draw_count, stride);
         CheckDrawCall(cmd_list);
         break;
     default:
@@ -727,6 +1030,116 @@ static bool onDrawOrDispatchIndirect(command_list* cmd_list, indirect_command ty
     return false;
 }
 
+template<device_api api>
+static void AddDeviceEvents()
+{
+    g_drawEvents.Add<reshade::addon_event::bind_pipeline>(onBindPipeline<api>);
+    g_drawEvents.Add<reshade::addon_event::bind_render_targets_and_depth_stencil>(onBindRenderTargetsAndDepthStencil);
+    g_drawEvents.Add<reshade::addon_event::begin_render_pass>(onBeginRenderPass);
+    g_drawEvents.Add<reshade::addon_event::push_descriptors>(onPushDescriptors);
+    g_drawEvents.Add<reshade::addon_event::push_constants>(onPushConstants);
+    g_drawEvents.Add<reshade::addon_event::draw>(onDraw);
+    g_drawEvents.Add<reshade::addon_event::draw_indexed>(onDrawIndexed);
+    g_drawEvents.Add<reshade::addon_event::draw_or_dispatch_indirect>(onDrawOrDispatchIndirect);
+
+    // Immediate-context APIs keep this state across effect rendering themselves, so there's nothing to track
+    if constexpr (MayBeDeviceApi<api, device_api::d3d12, device_api::vulkan>)
+    {
+        g_drawEvents.Add<reshade::addon_event::bind_viewports>(onBindViewports<api>);
+        g_drawEvents.Add<reshade::addon_event::bind_scissor_rects>(onBindScissorRects<api>);
+    }
+
+    if constexpr (MayBeDeviceApi<api, device_api::d3d12>)
+    {
+        g_drawEvents.Add<reshade::addon_event::bind_descriptor_tables>(onBindDescriptorSets<api>);
+        g_drawEvents.Add<reshade::addon_event::bind_pipeline_states>(onBindPipelineStates<api>);
+    }
+
+    g_deviceEvents.Add<reshade::addon_event::present>(onPresent<api>);
+}
+
+/// <summary>
+/// Replaces the registered handlers with the set specialized for the given API. Only called while no command list records.
+/// </summary>
+static void ApplyDeviceEvents(device_api api)
+{
+    const bool subscribed = g_drawEvents.IsSubscribed();
+    g_drawEvents.Clear();
+    g_deviceEvents.Clear();
+
+    switch (api)
+    {
+    case device_api::d3d9:
+        AddDeviceEvents<device_api::d3d9>();
+        break;
+    case device_api::d3d10:
+        AddDeviceEvents<device_api::d3d10>();
+        break;
+    case device_api::d3d11:
+        AddDeviceEvents<device_api::d3d11>();
+        break;
+    case device_api::d3d12:
+        AddDeviceEvents<device_api::d3d12>();
+        break;
+    case device_api::opengl:
+        AddDeviceEvents<device_api::opengl>();
+        break;
+    case device_api::vulkan:
+        AddDeviceEvents<device_api::vulkan>();
+        break;
+    default:
+        api = ANY_DEVICE_API;
+        AddDeviceEvents<ANY_DEVICE_API>();
+        break;
+    }
+
+    g_deviceEvents.Subscribe();
+    if (subscribed)
+    {
+        g_drawEvents.Subscribe();
+    }
+
+    g_eventsDeviceApi = api;
+    g_eventsSelected = true;
+    g_eventsSelectionPending = false;
+}
+
+/// <summary>
+/// Registers the handler set specialized for the device's API. Falls back to handlers which check the API per call once
+/// devices of different APIs are alive at the same time. If command lists of the other device are recording, the switch
+/// waits for the first present without any.
+/// </summary>
+static void SelectDeviceEvents(device_api api)
+{
+    if (g_eventsSelected && (g_eventsDeviceApi == api || g_eventsDeviceApi == ANY_DEVICE_API))
+    {
+        return;
+    }
+
+    if (g_eventsSelected)
+    {
+        reshade::log_message(reshade::log_level::info, "Devices of different graphics APIs found, falling back to generic event handlers");
+        api = ANY_DEVICE_API;
+    }
+
+    if (!g_recording.TryLock())
+    {
+        g_pendingEventsDeviceApi = api;
+        g_eventsSelectionPending = true;
+        return;
+    }
+
+    ApplyDeviceEvents(api);
+    g_recording.Unlock();
+}
+
+static void onInitDevice(device* device)
+{
+    device->create_private_data<DeviceDataContainer>();
+
+    SelectDeviceEvents(device->get_api());
+}
+
 /// <summary>
 /// copied from Reshade
 /// Returns the path to the module file identified by the specified <paramref name="module"/> handle.
@@ -750,8 +1163,6 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
         g_dllPath = getModulePath(hModule);
 
         g_addonUIData.SetBasePath(g_dllPath.parent_path());
-        g_addonUIData.LoadShaderTogglerIniFile();
-        Init();
         reshade::register_event<reshade::addon_event::init_swapchain>(onInitSwapchain);
         reshade::register_event<reshade::addon_event::destroy_swapchain>(onDestroySwapchain);
         reshade::register_event<reshade::addon_event::init_resource>(onInitResource);
@@ -764,39 +1175,36 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
         reshade::register_event<reshade::addon_event::destroy_resource_view>(onDestroyResourceView);
         reshade::register_event<reshade::addon_event::init_resource_view>(onInitResourceView);
         reshade::register_event<reshade::addon_event::init_pipeline>(onInitPipeline);
-        reshade::register_event<reshade::addon_event::bind_viewports>(onBindViewports);
-        reshade::register_event<reshade::addon_event::bind_scissor_rects>(onBindScissorRects);
-        reshade::register_event<reshade::addon_event::bind_descriptor_tables>(onBindDescriptorSets);
         reshade::register_event<reshade::addon_event::init_pipeline_layout>(onInitPipelineLayout);
         reshade::register_event<reshade::addon_event::destroy_pipeline_layout>(onDestroyPipelineLayout);
-        reshade::register_event<reshade::addon_event::bind_pipeline_states>(onBindPipelineStates);
         reshade::register_event<reshade::addon_event::init_command_list>(onInitCommandList);
         reshade::register_event<reshade::addon_event::destroy_command_list>(onDestroyCommandList);
         reshade::register_event<reshade::addon_event::reset_command_list>(onResetCommandList);
+        reshade::register_event<reshade::addon_event::close_command_list>(onCloseCommandList);
         reshade::register_event<reshade::addon_event::destroy_pipeline>(onDestroyPipeline);
         reshade::register_event<reshade::addon_event::reshade_overlay>(onReshadeOverlay);
         reshade::register_event<reshade::addon_event::reshade_present>(onReshadePresent);
         reshade::register_event<reshade::addon_event::reshade_reloaded_effects>(onReshadeReloadedEffects);
         reshade::register_event<reshade::addon_event::reshade_set_technique_state>(onReshadeSetTechniqueState);
-        reshade::register_event<reshade::addon_event::bind_pipeline>(onBindPipeline);
         reshade::register_event<reshade::addon_event::init_device>(onInitDevice);
         reshade::register_event<reshade::addon_event::destroy_device>(onDestroyDevice);
-        reshade::register_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(onBindRenderTargetsAndDepthStencil);
-        reshade::register_event<reshade::addon_event::begin_render_pass>(onBeginRenderPass);
         reshade::register_event<reshade::addon_event::init_effect_runtime>(onInitEffectRuntime);
         reshade::register_event<reshade::addon_event::destroy_effect_runtime>(onDestroyEffectRuntime);
-        reshade::register_event<reshade::addon_event::push_descriptors>(onPushDescriptors);
-        reshade::register_event<reshade::addon_event::push_constants>(onPushConstants);
-        reshade::register_event<reshade::addon_event::present>(onPresent);
-
-        reshade::register_event<reshade::addon_event::draw>(onDraw);
-        reshade::register_event<reshade::addon_event::draw_indexed>(onDrawIndexed);
-        reshade::register_event<reshade::addon_event::draw_or_dispatch_indirect>(onDrawOrDispatchIndirect);
 
+        // The draw and device event sets are filled in once the first device reveals its API, the draw events are
+        // subscribed by the first present after startup finished
         reshade::register_overlay(nullptr, &displaySettings);
+
+        // Loading the config and hooking the game don't belong under the loader lock
+        ShaderToggler::Startup::Begin(Init);
         break;
     case DLL_PROCESS_DETACH:
-        UnInit();
+        // The worker holds a reference to the module while it runs, so it has finished by now unless the process is exiting
+        // and terminated it. Stopping it keeps a worker stopped in between from leaving hooks behind.
+        if (ShaderToggler::Startup::Stop())
+        {
+            UnInit();
+        }
         reshade::unregister_event<reshade::addon_event::init_swapchain>(onInitSwapchain);
         reshade::unregister_event<reshade::addon_event::destroy_swapchain>(onDestroySwapchain);
         reshade::unregister_event<reshade::addon_event::reshade_present>(onReshadePresent);
@@ -808,35 +1216,25 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
         reshade::unregister_event<reshade::addon_event::reshade_overlay>(onReshadeOverlay);
         reshade::unregister_event<reshade::addon_event::reshade_reloaded_effects>(onReshadeReloadedEffects);
         reshade::unregister_event<reshade::addon_event::reshade_set_technique_state>(onReshadeSetTechniqueState);
-        reshade::unregister_event<reshade::addon_event::bind_pipeline>(onBindPipeline);
-        reshade::unregister_event<reshade::addon_event::bind_viewports>(onBindViewports);
-        reshade::unregister_event<reshade::addon_event::bind_scissor_rects>(onBindScissorRects);
-        reshade::unregister_event<reshade::addon_event::bind_descriptor_tables>(onBindDescriptorSets);
         reshade::unregister_event<reshade::addon_event::init_pipeline_layout>(onInitPipelineLayout);
         reshade::unregister_event<reshade::addon_event::destroy_pipeline_layout>(onDestroyPipelineLayout);
-        reshade::unregister_event<reshade::addon_event::bind_pipeline_states>(onBindPipelineStates);
         reshade::unregister_event<reshade::addon_event::init_command_list>(onInitCommandList);
         reshade::unregister_event<reshade::addon_event::destroy_command_list>(onDestroyCommandList);
         reshade::unregister_event<reshade::addon_event::reset_command_list>(onResetCommandList);
+        reshade::unregister_event<reshade::addon_event::close_command_list>(onCloseCommandList);
         reshade::unregister_event<reshade::addon_event::init_device>(onInitDevice);
         reshade::unregister_event<reshade::addon_event::destroy_device>(onDestroyDevice);
-        reshade::unregister_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(onBindRenderTargetsAndDepthStencil);
-        reshade::unregister_event<reshade::addon_event::begin_render_pass>(onBeginRenderPass);
         reshade::unregister_event<reshade::addon_event::init_effect_runtime>(onInitEffectRuntime);
         reshade::unregister_event<reshade::addon_event::destroy_effect_runtime>(onDestroyEffectRuntime);
-        reshade::unregister_event<reshade::addon_event::push_descriptors>(onPushDescriptors);
-        reshade::unregister_event<reshade::addon_event::push_constants>(onPushConstants);
         reshade::unregister_event<reshade::addon_event::create_resource>(onCreateResource);
         reshade::unregister_event<reshade::addon_event::init_resource>(onInitResource);
         reshade::unregister_event<reshade::addon_event::destroy_resource>(onDestroyResource);
         reshade::unregister_event<reshade::addon_event::create_resource_view>(onCreateResourceView);
         reshade::unregister_event<reshade::addon_event::init_resource_view>(onInitResourceView);
         reshade::unregister_event<reshade::addon_event::destroy_resource_view>(onDestroyResourceView);
-        reshade::unregister_event<reshade::addon_event::present>(onPresent);
 
-        reshade::unregister_event<reshade::addon_event::draw>(onDraw);
-        reshade::unregister_event<reshade::addon_event::draw_indexed>(onDrawIndexed);
-        reshade::unregister_event<reshade::addon_event::draw_or_dispatch_indirect>(onDrawOrDispatchIndirect);
+        g_drawEvents.Unsubscribe();
+        g_deviceEvents.Unsubscribe();
 
         reshade::unregister_overlay(nullptr, &displaySettings);
         reshade::unregister_addon(hModule);
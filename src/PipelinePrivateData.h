@@ -2,20 +2,52 @@
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <memory_resource>
+#include <string_view>
 #include <tuple>
 #include "CDataFile.h"
 #include "ToggleGroup.h"
 #include "PipelineStateTracker.h"
 
+// Transparent hashing so technique names can be looked up without materializing a key
+struct TransparentStringHash
+{
+    using is_transparent = void;
+    size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+};
+
+struct TransparentStringEqual
+{
+    using is_transparent = void;
+    bool operator()(std::string_view lhs, std::string_view rhs) const { return lhs == rhs; }
+};
+
+using GroupQueueEntry = std::tuple<ShaderToggler::ToggleGroup*, uint32_t, reshade::api::resource_view>;
+using TechniqueQueue = std::pmr::unordered_map<std::pmr::string, GroupQueueEntry, TransparentStringHash, TransparentStringEqual>;
+using BindingQueue = std::pmr::unordered_map<uint32_t, GroupQueueEntry>;	// keyed by texture binding id
+using GroupQueue = std::pmr::unordered_set<ShaderToggler::ToggleGroup*>;
+
 struct __declspec(novtable) ShaderData final {
+    explicit ShaderData(std::pmr::memory_resource* resource) :
+        bindingsToUpdate(resource), constantBuffersToUpdate(resource), techniquesToRender(resource), srvToUpdate(resource)
+    {
+    }
+
     uint32_t activeShaderHash = -1;
-    std::unordered_map<std::string, std::tuple<ShaderToggler::ToggleGroup*, uint32_t, reshade::api::resource_view>> bindingsToUpdate;
-    std::unordered_set<ShaderToggler::ToggleGroup*> constantBuffersToUpdate;
-    std::unordered_map<std::string, std::tuple<ShaderToggler::ToggleGroup*, uint32_t, reshade::api::resource_view>> techniquesToRender;
-    std::unordered_set<ShaderToggler::ToggleGroup*> srvToUpdate;
-    const std::vector<ShaderToggler::ToggleGroup*>* blockedShaderGroups = nullptr;
+    BindingQueue bindingsToUpdate;
+    GroupQueue constantBuffersToUpdate;
+    TechniqueQueue techniquesToRender;
+    GroupQueue srvToUpdate;
+    const std::vector<uint32_t>* blockedShaderGroups = nullptr;	// indices into AddonUIData::GetHotToggleGroups()
     uint32_t id = 0;
 
+    // Scratch lists reused by every call, they only ever grow so the draw path stops allocating once warmed up
+    std::vector<TechniqueQueue::iterator> techniquesToRenderNow;
+    std::vector<TechniqueQueue::iterator> techniquesRendered;
+    std::vector<BindingQueue::iterator> bindingsToUpdateNow;
+    std::vector<BindingQueue::iterator> bindingsUpdatedNow;
+
     void Reset()
     {
         activeShaderHash = -1;
@@ -25,18 +57,42 @@ struct __declspec(novtable) ShaderData final {
         srvToUpdate.clear();
         blockedShaderGroups = nullptr;
     }
+
+    // Sizes the technique queue and its scratch lists for every technique. How many a list has queued at once depends on
+    // what other threads rendered first, so growing them on demand would keep finding new peaks frames after warming up.
+    void ReserveTechniques(size_t count)
+    {
+        techniquesToRender.reserve(count);
+        techniquesToRenderNow.reserve(count);
+        techniquesRendered.reserve(count);
+    }
 };
 
 struct __declspec(uuid("222F7169-3C09-40DB-9BC9-EC53842CE537")) CommandListDataContainer {
     uint32_t commandQueue = 0;
+    uint32_t subscriptionEpoch = 0;	// EventSubscription epoch the queued work belongs to
+    bool recording = false;			// between reset_command_list and close_command_list
     StateTracker::PipelineStateTracker stateTracker;
-    ShaderData ps;
-    ShaderData vs;
+    // Backs the per-draw queues, nodes released by the queues are recycled instead of going back to the heap
+    std::pmr::unsynchronized_pool_resource queuePool;
+    ShaderData ps{ &queuePool };
+    ShaderData vs{ &queuePool };
 
-    void Reset()
+    void ResetQueues()
     {
         ps.Reset();
         vs.Reset();
+    }
+
+    void ReserveTechniques(size_t count)
+    {
+        ps.ReserveTechniques(count);
+        vs.ReserveTechniques(count);
+    }
+
+    void Reset()
+    {
+        ResetQueues();
         stateTracker.Reset();
 
         commandQueue = 0;
@@ -83,10 +139,26 @@ struct __declspec(uuid("C63E95B1-4E2F-46D6-A276-E8B4612C069A")) DeviceDataContai
     std::atomic_bool rendered_effects = false;
     std::unordered_map<std::string, bool> allEnabledTechniques;
     std::unordered_map<std::string, TextureBindingData> bindingMap;
-    std::unordered_set<std::string> bindingsUpdated;
-    std::unordered_set<const ShaderToggler::ToggleGroup*> constantsUpdated;
-    std::unordered_set<const ShaderToggler::ToggleGroup*> srvUpdated;
+    std::vector<bool> bindingsUpdated;	// indexed by texture binding id
+    // Per-frame sets cleared at present, their nodes are recycled through the pool
+    std::pmr::synchronized_pool_resource updatePool;
+    std::pmr::unordered_set<const ShaderToggler::ToggleGroup*> constantsUpdated{ &updatePool };
+    std::pmr::unordered_set<const ShaderToggler::ToggleGroup*> srvUpdated{ &updatePool };
     std::unordered_map<uint64_t, std::vector<bool>> transient_mask;
     bool reload_bindings = false;
     HuntPreview huntPreview;
+
+    bool IsBindingUpdated(uint32_t bindingId) const
+    {
+        return bindingId < bindingsUpdated.size() && bindingsUpdated[bindingId];
+    }
+
+    void SetBindingUpdated(uint32_t bindingId)
+    {
+        if (bindingId >= bindingsUpdated.size())
+        {
+            bindingsUpdated.resize(bindingId + 1, false);
+        }
+        bindingsUpdated[bindingId] = true;
+    }
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <array>
 #include "PipelineStateTracker.h"
+#include "Profiler.h"
 
 using namespace StateTracker;
 using namespace std;
@@ -37,7 +39,9 @@ void PipelineStateTracker::ApplyBoundDescriptorSets(command_list* cmd_list, shad
 
 void PipelineStateTracker::ReApplyState(command_list* cmd_list, const unordered_map<uint64_t, vector<bool>>& transient_mask)
 {
-    vector<PipelineBindingBase*> states = {
+    PROFILE_SCOPE(Profiling::PROFILE_REAPPLY_STATE);
+
+    array<PipelineBindingBase*, 7> states = {
         &_descriptorSetsState,
         &_renderTargetState,
         &_scissorRectsState,
@@ -63,18 +67,20 @@ void PipelineStateTracker::ReApplyState(command_list* cmd_list, const unordered_
             {
                 if (_descriptorSetsState.cmd_list != nullptr)
                 {
-                    vector<bool> emptyMask;
+                    static const vector<bool> emptyMask;
                     const vector<bool>* mask_graphics = &emptyMask;
                     const vector<bool>* mask_compute = &emptyMask;
 
-                    if (transient_mask.contains(_descriptorSetsState.current_layout[0].handle))
+                    const auto graphics = transient_mask.find(_descriptorSetsState.current_layout[0].handle);
+                    if (graphics != transient_mask.end())
                     {
-                        mask_graphics = &transient_mask.at(_descriptorSetsState.current_layout[0].handle);
+                        mask_graphics = &graphics->second;
                     }
 
-                    if (transient_mask.contains(_descriptorSetsState.current_layout[1].handle))
+                    const auto compute = transient_mask.find(_descriptorSetsState.current_layout[1].handle);
+                    if (compute != transient_mask.end())
                     {
-                        mask_compute = &transient_mask.at(_descriptorSetsState.current_layout[1].handle);
+                        mask_compute = &compute->second;
                     }
 
                     ApplyBoundDescriptorSets(cmd_list, shader_stage::all_graphics, _descriptorSetsState.current_layout[0],
@@ -160,9 +166,6 @@ void PipelineStateTracker::OnBeginRenderPass(command_list* cmd_list, uint32_t co
 
 void PipelineStateTracker::OnBindDescriptorSets(command_list* cmd_list, shader_stage stages, pipeline_layout layout, uint32_t first, uint32_t count, const descriptor_table* sets)
 {
-    if (cmd_list->get_device()->get_api() != device_api::d3d12)
-        return;
-
     const int type_index = (stages == shader_stage::all_compute) ? 1 : 0;
 
     _descriptorSetsState.callIndex = _callIndex;
@@ -270,9 +273,6 @@ void PipelineStateTracker::OnPushDescriptors(command_list* cmd_list, shader_stag
 
 void PipelineStateTracker::OnBindViewports(command_list* cmd_list, uint32_t first, uint32_t count, const viewport* viewports)
 {
-    if (cmd_list->get_device()->get_api() != device_api::d3d12 && cmd_list->get_device()->get_api() != device_api::vulkan)
-        return;
-
     _viewportsState.callIndex = _callIndex;
     _callIndex++;
 
@@ -291,9 +291,6 @@ void PipelineStateTracker::OnBindViewports(command_list* cmd_list, uint32_t firs
 
 void PipelineStateTracker::OnBindScissorRects(command_list* cmd_list, uint32_t first, uint32_t count, const rect* rects)
 {
-    if (cmd_list->get_device()->get_api() != device_api::d3d12 && cmd_list->get_device()->get_api() != device_api::vulkan)
-        return;
-
     _scissorRectsState.callIndex = _callIndex;
     _callIndex++;
 
@@ -312,9 +309,6 @@ void PipelineStateTracker::OnBindScissorRects(command_list* cmd_list, uint32_t f
 
 void PipelineStateTracker::OnBindPipelineStates(command_list* cmd_list, uint32_t count, const dynamic_state* states, const uint32_t* values)
 {
-    if (cmd_list->get_device()->get_api() != device_api::d3d12)
-        return;
-
     for (uint32_t i = 0; i < count; i++)
     {
         if (states[i] == dynamic_state::primitive_topology)
@@ -338,9 +332,6 @@ void PipelineStateTracker::OnBindPipelineStates(command_list* cmd_list, uint32_t
 
 void PipelineStateTracker::OnBindPipeline(command_list* cmd_list, pipeline_stage stages, pipeline pipelineHandle)
 {
-    if (cmd_list->get_device()->get_api() != device_api::d3d12 && cmd_list->get_device()->get_api() != device_api::vulkan)
-        return;
-
     _pipelineState.callIndex = _callIndex;
     _callIndex++;
     _pipelineState.pipeline = pipelineHandle;
@@ -371,6 +362,30 @@ const vector<resource_view>& PipelineStateTracker::GetBoundRenderTargetViews() c
     return _renderTargetState.rtvs;
 }
 
+uint32_t PipelineStateTracker::GetBoundTargets(resource_view* rtvs, uint32_t capacity, resource_view& dsv) const
+{
+    uint32_t count = 0;
+
+    if (IsInRenderPass())
+    {
+        dsv = _renderPassState.dsv.view;
+        for (; count < capacity && count < _renderPassState.rtvs.size(); count++)
+        {
+            rtvs[count] = _renderPassState.rtvs[count].view;
+        }
+    }
+    else
+    {
+        dsv = _renderTargetState.dsv;
+        for (; count < capacity && count < _renderTargetState.rtvs.size(); count++)
+        {
+            rtvs[count] = _renderTargetState.rtvs[count];
+        }
+    }
+
+    return count;
+}
+
 void PipelineStateTracker::Reset()
 {
     _callIndex = 0;
@@ -9,6 +9,32 @@ using namespace reshade::api;
 
 namespace StateTracker
 {
+    // Stand-in for handler sets which can't be specialized because devices of different APIs are alive at the same time
+    constexpr device_api ANY_DEVICE_API = static_cast<device_api>(0);
+
+    /// <summary>
+    /// Compile-time check whether handlers specialized for api can see a device of one of the given APIs
+    /// </summary>
+    template<device_api api, device_api... apis>
+    constexpr bool MayBeDeviceApi = api == ANY_DEVICE_API || ((api == apis) || ...);
+
+    /// <summary>
+    /// Whether the device is of one of the given APIs. Resolved at compile time unless api is ANY_DEVICE_API.
+    /// </summary>
+    template<device_api api, device_api... apis>
+    inline bool IsDeviceApi(device* dev)
+    {
+        if constexpr (api == ANY_DEVICE_API)
+        {
+            const device_api runtimeApi = dev->get_api();
+            return ((runtimeApi == apis) || ...);
+        }
+        else
+        {
+            return ((api == apis) || ...);
+        }
+    }
+
     enum PipelineBindingTypes : uint32_t
     {
         unknown = 0,
@@ -184,7 +210,7 @@ namespace StateTracker
 
     struct __declspec(novtable) BindPipelineState final : PipelineBinding<PipelineBindingTypes::bind_pipeline> {
         pipeline_stage stages;
-        pipeline pipeline;
+        reshade::api::pipeline pipeline;
 
         void Reset()
         {
@@ -195,6 +221,11 @@ namespace StateTracker
         }
     };
 
+    /// <summary>
+    /// Tracks bound state so it can be restored after rendering effects mid-frame. Callers only forward the binds the
+    /// device's API needs replayed: viewports, scissor rects and pipelines on D3D12 and Vulkan, descriptor tables and
+    /// pipeline states on D3D12 only.
+    /// </summary>
     class __declspec(novtable) PipelineStateTracker final
     {
     public:
@@ -217,6 +248,11 @@ namespace StateTracker
         const PushDescriptorsState* GetPushDescriptorState() { return &_pushDescriptorsState; }
         const PushConstantsState* GetPushConstantsState() { return &_pushConstantsState; }
         const std::vector<resource_view>& GetBoundRenderTargetViews() const;
+        /// <summary>
+        /// Copies the render targets of the last render target bind or render pass, whichever came last, into rtvs. Returns
+        /// the number of views copied.
+        /// </summary>
+        uint32_t GetBoundTargets(resource_view* rtvs, uint32_t capacity, resource_view& dsv) const;
 
         void ClearPushDescriptorState(pipeline_stage);
 
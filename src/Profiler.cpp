@@ -0,0 +1,259 @@
+#include <windows.h>
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <format>
+#include "Profiler.h"
+
+using namespace Profiling;
+using namespace std;
+
+atomic_bool Profiler::_enabled = false;
+mutex Profiler::_slotMutex;
+vector<unique_ptr<Profiler::ThreadSlot>> Profiler::_slots;
+ScopeStats Profiler::_frame[PROFILE_SCOPE_COUNT];
+ScopeStats Profiler::_total[PROFILE_SCOPE_COUNT];
+uint64_t Profiler::_frameCount = 0;
+
+// Each slot has a single writer, so a plain load/store pair is enough and avoids a locked add
+static inline void Add(atomic_uint64_t& value, uint64_t amount)
+{
+    value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+uint64_t ScopeStats::Percentile(double p) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    const uint64_t target = static_cast<uint64_t>(p * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram[i];
+        if (seen > target)
+        {
+            return 1ull << (i + 1);
+        }
+    }
+
+    return 1ull << HISTOGRAM_BUCKETS;
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+    if (enabled && !IsEnabled())
+    {
+        Reset();
+    }
+
+    _enabled.store(enabled, memory_order_relaxed);
+}
+
+Profiler::ThreadSlot& Profiler::GetThreadSlot()
+{
+    thread_local ThreadSlot* slot = nullptr;
+
+    if (slot == nullptr)
+    {
+        // Slots outlive their threads so EndFrame never reads freed memory
+        unique_lock<mutex> lock(_slotMutex);
+        _slots.push_back(make_unique<ThreadSlot>());
+        slot = _slots.back().get();
+        slot->threadId = GetCurrentThreadId();
+    }
+
+    return *slot;
+}
+
+void Profiler::Record(ProfileScope scope, uint64_t ns, uint64_t items)
+{
+    ThreadSlot& slot = GetThreadSlot();
+
+    const uint32_t bucket = ns == 0 ? 0 : std::min(static_cast<uint32_t>(bit_width(ns)) - 1, HISTOGRAM_BUCKETS - 1);
+
+    Add(slot.count[scope], 1);
+    Add(slot.items[scope], items);
+    Add(slot.totalNs[scope], ns);
+    Add(slot.histogram[scope][bucket], 1);
+
+    if (ns > slot.maxNs[scope].load(memory_order_relaxed))
+    {
+        slot.maxNs[scope].store(ns, memory_order_relaxed);
+    }
+}
+
+void Profiler::EndFrame()
+{
+    unique_lock<mutex> lock(_slotMutex);
+
+    for (uint32_t scope = 0; scope < PROFILE_SCOPE_COUNT; scope++)
+    {
+        _frame[scope] = ScopeStats();
+    }
+
+    // Counters are never reset by the reader, the frame's values are the difference to the previous merge
+    for (auto& slot : _slots)
+    {
+        slot->frameCount = 0;
+
+        for (uint32_t scope = 0; scope < PROFILE_SCOPE_COUNT; scope++)
+        {
+            ScopeStats& merged = slot->merged[scope];
+            ScopeStats& threadTotal = slot->total[scope];
+            ScopeStats& frame = _frame[scope];
+
+            const uint64_t count = slot->count[scope].load(memory_order_relaxed) - merged.count;
+            const uint64_t items = slot->items[scope].load(memory_order_relaxed) - merged.items;
+            const uint64_t totalNs = slot->totalNs[scope].load(memory_order_relaxed) - merged.totalNs;
+            const uint64_t maxNs = slot->maxNs[scope].exchange(0, memory_order_relaxed);
+
+            frame.count += count;
+            frame.items += items;
+            frame.totalNs += totalNs;
+            frame.maxNs = std::max(frame.maxNs, maxNs);
+            merged.count += count;
+            merged.items += items;
+            merged.totalNs += totalNs;
+            threadTotal.count += count;
+            threadTotal.items += items;
+            threadTotal.totalNs += totalNs;
+            threadTotal.maxNs = std::max(threadTotal.maxNs, maxNs);
+            slot->frameCount += count;
+
+            for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+            {
+                const uint64_t value = slot->histogram[scope][i].load(memory_order_relaxed) - merged.histogram[i];
+                frame.histogram[i] += value;
+                merged.histogram[i] += value;
+                threadTotal.histogram[i] += value;
+            }
+        }
+    }
+
+    for (uint32_t scope = 0; scope < PROFILE_SCOPE_COUNT; scope++)
+    {
+        const ScopeStats& frame = _frame[scope];
+        ScopeStats& total = _total[scope];
+
+        total.count += frame.count;
+        total.items += frame.items;
+        total.totalNs += frame.totalNs;
+        total.maxNs = std::max(total.maxNs, frame.maxNs);
+
+        for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            total.histogram[i] += frame.histogram[i];
+        }
+    }
+
+    _frameCount++;
+}
+
+void Profiler::Reset()
+{
+    unique_lock<mutex> lock(_slotMutex);
+
+    for (uint32_t scope = 0; scope < PROFILE_SCOPE_COUNT; scope++)
+    {
+        _frame[scope] = ScopeStats();
+        _total[scope] = ScopeStats();
+    }
+
+    for (auto& slot : _slots)
+    {
+        for (uint32_t scope = 0; scope < PROFILE_SCOPE_COUNT; scope++)
+        {
+            slot->total[scope] = ScopeStats();
+        }
+        slot->frameCount = 0;
+    }
+
+    _frameCount = 0;
+}
+
+vector<ThreadStats> Profiler::GetThreadStats()
+{
+    unique_lock<mutex> lock(_slotMutex);
+
+    vector<ThreadStats> threads;
+    for (const auto& slot : _slots)
+    {
+        ThreadStats& stats = threads.emplace_back();
+        stats.threadId = slot->threadId;
+        stats.frameCount = slot->frameCount;
+        std::copy(std::begin(slot->total), std::end(slot->total), stats.total);
+    }
+
+    return threads;
+}
+
+bool Profiler::ExportCsv(const filesystem::path& path)
+{
+    ofstream file(path, ios::out | ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+
+    const uint64_t frames = std::max<uint64_t>(_frameCount, 1);
+
+    file << "scope,calls,calls_per_frame,items,ns_per_item,total_ms,ms_per_frame,avg_ns,max_ns,p50_ns,p90_ns,p99_ns,p999_ns";
+    for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        file << ",lt_" << (1ull << (i + 1)) << "ns";
+    }
+    file << "\n";
+
+    for (uint32_t scope = 0; scope < PROFILE_SCOPE_COUNT; scope++)
+    {
+        const ScopeStats& stats = _total[scope];
+
+        file << std::format("{},{},{:.2f},{},{:.2f},{:.3f},{:.4f},{},{},{},{},{},{}", ProfileScopeNames[scope], stats.count,
+            static_cast<double>(stats.count) / frames, stats.items, stats.items > 0 ? static_cast<double>(stats.totalNs) / stats.items : 0.0,
+            stats.totalNs / 1e6, stats.totalNs / 1e6 / frames,
+            stats.count > 0 ? stats.totalNs / stats.count : 0, stats.maxNs, stats.Percentile(0.5), stats.Percentile(0.9),
+            stats.Percentile(0.99), stats.Percentile(0.999));
+
+        for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            file << "," << stats.histogram[i];
+        }
+        file << "\n";
+    }
+
+    return file.good();
+}
+
+bool Profiler::ExportThreadCsv(const filesystem::path& path)
+{
+    ofstream file(path, ios::out | ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+
+    const uint64_t frames = std::max<uint64_t>(_frameCount, 1);
+
+    file << "thread_id,scope,calls,calls_per_frame,ms_per_frame,avg_ns,max_ns,p50_ns,p90_ns,p99_ns,p999_ns\n";
+
+    for (const auto& thread : GetThreadStats())
+    {
+        for (uint32_t scope = 0; scope < PROFILE_SCOPE_COUNT; scope++)
+        {
+            const ScopeStats& stats = thread.total[scope];
+            if (stats.count == 0)
+            {
+                continue;
+            }
+
+            file << std::format("{},{},{},{:.2f},{:.4f},{},{},{},{},{},{}\n", thread.threadId, ProfileScopeNames[scope], stats.count,
+                static_cast<double>(stats.count) / frames, stats.totalNs / 1e6 / frames, stats.totalNs / stats.count, stats.maxNs,
+                stats.Percentile(0.5), stats.Percentile(0.9), stats.Percentile(0.99), stats.Percentile(0.999));
+        }
+    }
+
+    return file.good();
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// The hot-path timers are only compiled in when SHADERTOGGLER_PROFILER is defined, in Debug and in Release builds with
+// /p:ShaderTogglerProfiler=true, the latter being the one to measure with. Without it
+// PROFILE_SCOPE expands to nothing and no hook pays for the profiler. PROFILE_SCOPE_ITEMS additionally records how many
+// items (bytes, keys, ...) the scope processed, PROFILE_SET_ITEMS changes that count once it's known.
+#ifdef SHADERTOGGLER_PROFILER
+#define PROFILE_SCOPE(scope) Profiling::ScopedTimer _profileScopeTimer(scope)
+#define PROFILE_SCOPE_ITEMS(scope, items) Profiling::ScopedTimer _profileScopeTimer(scope, items)
+#define PROFILE_SET_ITEMS(items) _profileScopeTimer.SetItems(items)
+#else
+#define PROFILE_SCOPE(scope)
+#define PROFILE_SCOPE_ITEMS(scope, items)
+#define PROFILE_SET_ITEMS(items)
+#endif
+
+namespace Profiling
+{
+    enum ProfileScope : uint32_t
+    {
+        PROFILE_BIND_PIPELINE = 0,
+        PROFILE_BIND_RENDER_TARGETS,
+        PROFILE_BEGIN_RENDER_PASS,
+        PROFILE_PUSH_DESCRIPTORS,
+        PROFILE_PUSH_CONSTANTS,
+        PROFILE_BIND_DESCRIPTOR_TABLES,
+        PROFILE_BIND_VIEWPORTS,
+        PROFILE_BIND_SCISSOR_RECTS,
+        PROFILE_BIND_PIPELINE_STATES,
+        PROFILE_CHECK_DRAW_CALL,
+        PROFILE_CHECK_CALL_FOR_COMMAND_LIST,
+        PROFILE_RENDER_EFFECTS,
+        PROFILE_UPDATE_TEXTURE_BINDINGS,
+        PROFILE_UPDATE_PREVIEW,
+        PROFILE_UPDATE_CONSTANTS,
+        PROFILE_BUFFER_REGION,
+        PROFILE_PRESENT,
+        PROFILE_RESHADE_PRESENT,
+        PROFILE_SHADER_HASH,
+        PROFILE_SHADER_HASH_LOOKUP,
+        PROFILE_GROUP_LOOKUP,
+        PROFILE_REAPPLY_STATE,
+        PROFILE_APPLY_CONSTANT_VALUES,
+        PROFILE_MEMCPY_FILTER,
+        PROFILE_CONFIG_LOAD,
+        PROFILE_CONFIG_SAVE,
+        PROFILE_SHADER_USAGE,
+        PROFILE_SCOPE_COUNT
+    };
+
+    static const char* ProfileScopeNames[] = {
+        "onBindPipeline",
+        "onBindRenderTargetsAndDepthStencil",
+        "onBeginRenderPass",
+        "onPushDescriptors",
+        "onPushConstants",
+        "onBindDescriptorSets",
+        "onBindViewports",
+        "onBindScissorRects",
+        "onBindPipelineStates",
+        "CheckDrawCall",
+        "CheckCallForCommandList",
+        "RenderEffects",
+        "UpdateTextureBindings",
+        "UpdatePreview",
+        "UpdateConstants",
+        "Map/Update/UnmapBufferRegion",
+        "onPresent",
+        "onReshadePresent",
+        "compute_crc32 (bytes)",
+        "safeGetShaderHash",
+        "GetToggleGroupsFor*ShaderHash",
+        "ReApplyState",
+        "ApplyConstantValues (constants)",
+        "memcpy detour filter",
+        "Config load (keys)",
+        "Config save (keys)",
+        "ShaderUsage::OnDraw"
+    };
+
+    // Bucket i holds durations in [2^i, 2^(i+1)) ns, the last one everything from ~8ms up
+    constexpr uint32_t HISTOGRAM_BUCKETS = 24;
+
+    struct ScopeStats
+    {
+        uint64_t count = 0;
+        uint64_t items = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        uint64_t histogram[HISTOGRAM_BUCKETS] = {};
+
+        /// <summary>
+        /// Upper bound in ns of the histogram bucket containing the given percentile (0..1)
+        /// </summary>
+        uint64_t Percentile(double p) const;
+    };
+
+    struct ThreadStats
+    {
+        uint32_t threadId = 0;
+        uint64_t frameCount = 0;    // calls recorded by the thread in the last frame, all scopes
+        ScopeStats total[PROFILE_SCOPE_COUNT];
+    };
+
+    /// <summary>
+    /// Collects per-hook timings. Every thread records into its own slot without locking; the slots are merged into
+    /// per-frame and accumulated statistics once per present.
+    /// </summary>
+    class __declspec(novtable) Profiler final
+    {
+    public:
+        static bool IsEnabled() { return _enabled.load(std::memory_order_relaxed); }
+        static void SetEnabled(bool enabled);
+
+        static void Record(ProfileScope scope, uint64_t ns, uint64_t items = 1);
+
+        /// <summary>
+        /// Merges what the threads recorded since the last call. Called from the present thread only.
+        /// </summary>
+        static void EndFrame();
+        static void Reset();
+
+        static const ScopeStats* GetFrameStats() { return _frame; }
+        static const ScopeStats* GetTotalStats() { return _total; }
+        static uint64_t GetFrameCount() { return _frameCount; }
+
+        /// <summary>
+        /// Accumulated statistics per recording thread, to see how the hooks' work is spread over the threads
+        /// </summary>
+        static std::vector<ThreadStats> GetThreadStats();
+
+        static bool ExportCsv(const std::filesystem::path& path);
+        static bool ExportThreadCsv(const std::filesystem::path& path);
+
+    private:
+        struct ThreadSlot
+        {
+            std::atomic_uint64_t count[PROFILE_SCOPE_COUNT] = {};
+            std::atomic_uint64_t items[PROFILE_SCOPE_COUNT] = {};
+            std::atomic_uint64_t totalNs[PROFILE_SCOPE_COUNT] = {};
+            std::atomic_uint64_t maxNs[PROFILE_SCOPE_COUNT] = {};
+            std::atomic_uint64_t histogram[PROFILE_SCOPE_COUNT][HISTOGRAM_BUCKETS] = {};
+
+            // Values seen by the previous merge and this thread's share since the last reset, only touched by EndFrame and Reset
+            ScopeStats merged[PROFILE_SCOPE_COUNT];
+            ScopeStats total[PROFILE_SCOPE_COUNT];
+            uint64_t frameCount = 0;
+            uint32_t threadId = 0;
+        };
+
+        static ThreadSlot& GetThreadSlot();
+
+        static std::atomic_bool _enabled;
+        static std::mutex _slotMutex;
+        static std::vector<std::unique_ptr<ThreadSlot>> _slots;
+        static ScopeStats _frame[PROFILE_SCOPE_COUNT];
+        static ScopeStats _total[PROFILE_SCOPE_COUNT];
+        static uint64_t _frameCount;
+    };
+
+    class ScopedTimer final
+    {
+    public:
+        explicit ScopedTimer(ProfileScope scope, uint64_t items = 1) : _scope(scope), _items(items), _active(Profiler::IsEnabled())
+        {
+            if (_active)
+            {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~ScopedTimer()
+        {
+            if (_active)
+            {
+                Profiler::Record(_scope, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count()), _items);
+            }
+        }
+
+        void SetItems(uint64_t items) { _items = items; }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        ProfileScope _scope;
+        uint64_t _items;
+        bool _active;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
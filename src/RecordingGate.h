@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace ShaderToggler
+{
+    /// <summary>
+    /// Keeps command lists from recording while the present changes what they read: event lists, hash lookups. Lists enter
+    /// it when reset and leave it when closed, possibly on another thread, so it's a count instead of a lock owned by a
+    /// thread. The present only takes it while no list records and never waits for it, lists resetting while it's held
+    /// wait instead.
+    /// </summary>
+    class __declspec(novtable) RecordingGate final
+    {
+    public:
+        /// <summary>
+        /// Called when a command list starts recording. Waits while the gate is locked.
+        /// </summary>
+        void Enter()
+        {
+            uint32_t state = _state.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                if (state & LOCKED)
+                {
+                    _state.wait(state, std::memory_order_relaxed);
+                    state = _state.load(std::memory_order_relaxed);
+                }
+                else if (_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Called when a command list stops recording, after it was closed or destroyed
+        /// </summary>
+        void Leave()
+        {
+            _state.fetch_sub(1, std::memory_order_release);
+        }
+
+        /// <summary>
+        /// Locks the gate if no command list is recording. Returns false without waiting otherwise.
+        /// </summary>
+        bool TryLock()
+        {
+            uint32_t expected = 0;
+            return _state.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Unlocks the gate and lets the command lists waiting for it record
+        /// </summary>
+        void Unlock()
+        {
+            _state.store(0, std::memory_order_release);
+            _state.notify_all();
+        }
+
+    private:
+        static constexpr uint32_t LOCKED = 0x80000000u;
+
+        std::atomic_uint32_t _state = 0;
+    };
+}
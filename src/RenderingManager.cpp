@@ -1,14 +1,13 @@
 #include "RenderingManager.h"
 #include "PipelinePrivateData.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
 
 using namespace Rendering;
 using namespace ShaderToggler;
 using namespace reshade::api;
 using namespace std;
 
-size_t RenderingManager::g_charBufferSize = CHAR_BUFFER_SIZE;
-char RenderingManager::g_charBuffer[CHAR_BUFFER_SIZE];
-
 RenderingManager::RenderingManager(AddonImGui::AddonUIData& data, ResourceManager& rManager) : uiData(data), resourceManager(rManager)
 {
 }
@@ -18,14 +17,10 @@ RenderingManager::~RenderingManager()
 
 }
 
-void RenderingManager::EnumerateTechniques(effect_runtime* runtime, function<void(effect_runtime*, effect_technique, string&)> func)
+// Builds the key in place from the queue's allocator instead of converting through a temporary string
+static inline void EnqueueTechnique(TechniqueQueue& queue, const string& techName, ToggleGroup* group, uint32_t location)
 {
-    runtime->enumerate_techniques(nullptr, [func](effect_runtime* rt, effect_technique technique) {
-        g_charBufferSize = CHAR_BUFFER_SIZE;
-        rt->get_technique_name(technique, g_charBuffer, &g_charBufferSize);
-        string name(g_charBuffer);
-        func(rt, technique, name);
-        });
+    queue.emplace(piecewise_construct, forward_as_tuple(techName.data(), techName.size()), forward_as_tuple(group, location, resource_view{ 0 }));
 }
 
 void RenderingManager::_CheckCallForCommandList(ShaderData& sData, CommandListDataContainer& commandListData, DeviceDataContainer& deviceData) const
@@ -42,74 +37,88 @@ void RenderingManager::_CheckCallForCommandList(ShaderData& sData, CommandListDa
 
     if (sData.blockedShaderGroups != nullptr)
     {
-        for (auto group : *sData.blockedShaderGroups)
+        TRACE_SCOPE(Profiling::TRACE_PIPELINE_MATCH, sData.activeShaderHash);
+
+        const vector<ToggleGroupHotData>& hotGroups = uiData.GetHotToggleGroups();
+
+        for (const uint32_t index : *sData.blockedShaderGroups)
         {
-            if (group->isActive())
+            const ToggleGroupHotData& hot = hotGroups[index];
+
+            if (!(hot.flags & HOT_GROUP_ACTIVE))
             {
-                if (group->getExtractConstants() && !deviceData.constantsUpdated.contains(group))
+                continue;
+            }
+
+            ToggleGroup* group = hot.group;
+            group->getStatistics().Add(STAT_MATCHES);
+
+            if (hot.flags & HOT_GROUP_EXTRACT_CONSTANTS && !deviceData.constantsUpdated.contains(group))
+            {
+                if (!sData.constantBuffersToUpdate.contains(group))
                 {
-                    if (!sData.constantBuffersToUpdate.contains(group))
-                    {
-                        sData.constantBuffersToUpdate.emplace(group);
-                        queue_mask |= match_const;
-                    }
+                    sData.constantBuffersToUpdate.emplace(group);
+                    queue_mask |= match_const;
                 }
+            }
 
-                if (group->getId() == uiData.GetToggleGroupIdShaderEditing() && !deviceData.huntPreview.matched)
+            if (hot.id == uiData.GetToggleGroupIdShaderEditing() && !deviceData.huntPreview.matched)
+            {
+                if(uiData.GetCurrentTabType() == AddonImGui::TAB_RENDER_TARGET)
                 {
-                    if(uiData.GetCurrentTabType() == AddonImGui::TAB_RENDER_TARGET)
-                    {
-                        queue_mask |= (match_preview << (group->getInvocationLocation() * MATCH_DELIMITER)) | (match_preview << CALL_DRAW * MATCH_DELIMITER);
-                        deviceData.huntPreview.target_invocation_location = group->getInvocationLocation();
-                    }
+                    queue_mask |= (match_preview << (hot.invocationLocation * MATCH_DELIMITER)) | (match_preview << CALL_DRAW * MATCH_DELIMITER);
+                    deviceData.huntPreview.target_invocation_location = hot.invocationLocation;
                 }
+            }
 
-                if (group->isProvidingTextureBinding() && !deviceData.bindingsUpdated.contains(group->getTextureBindingName()))
+            if (hot.flags & HOT_GROUP_PROVIDES_BINDING && !deviceData.IsBindingUpdated(hot.bindingId))
+            {
+                if (!sData.bindingsToUpdate.contains(hot.bindingId))
                 {
-                    if (!sData.bindingsToUpdate.contains(group->getTextureBindingName()))
+                    if (!(hot.flags & HOT_GROUP_COPY_BINDING) || hot.flags & HOT_GROUP_EXTRACT_RESOURCE_VIEWS)
                     {
-                        if (!group->getCopyTextureBinding() || group->getExtractResourceViews())
-                        {
-                            sData.bindingsToUpdate.emplace(group->getTextureBindingName(), std::make_tuple(group, CALL_DRAW, resource_view{ 0 }));
-                            queue_mask |= (match_binding << CALL_DRAW * MATCH_DELIMITER);
-                        }
-                        else
-                        {
-                            sData.bindingsToUpdate.emplace(group->getTextureBindingName(), std::make_tuple(group, group->getBindingInvocationLocation(), resource_view{ 0 }));
-                            queue_mask |= (match_binding << (group->getBindingInvocationLocation() * MATCH_DELIMITER)) | (match_binding << CALL_DRAW * MATCH_DELIMITER);
-                        }
+                        sData.bindingsToUpdate.emplace(hot.bindingId, std::make_tuple(group, CALL_DRAW, resource_view{ 0 }));
+                        queue_mask |= (match_binding << CALL_DRAW * MATCH_DELIMITER);
+                    }
+                    else
+                    {
+                        sData.bindingsToUpdate.emplace(hot.bindingId, std::make_tuple(group, hot.bindingInvocationLocation, resource_view{ 0 }));
+                        queue_mask |= (match_binding << (hot.bindingInvocationLocation * MATCH_DELIMITER)) | (match_binding << CALL_DRAW * MATCH_DELIMITER);
                     }
                 }
+            }
 
-                if (group->getAllowAllTechniques())
+            if (hot.flags & HOT_GROUP_ALLOW_ALL_TECHNIQUES)
+            {
+                for (const auto& [techName, techEnabled] : deviceData.allEnabledTechniques)
                 {
-                    for (const auto& [techName, techEnabled] : deviceData.allEnabledTechniques)
+                    if (techEnabled)
                     {
-                        if (group->getHasTechniqueExceptions() && group->preferredTechniques().contains(techName))
-                        {
-                            continue;
-                        }
+                        continue;
+                    }
 
-                        if (!techEnabled)
-                        {
-                            if (!sData.techniquesToRender.contains(techName))
-                            {
-                                sData.techniquesToRender.emplace(techName, std::make_tuple(group, group->getInvocationLocation(), resource_view{ 0 }));
-                                queue_mask |= (match_effect << (group->getInvocationLocation() * MATCH_DELIMITER)) | (match_effect << CALL_DRAW * MATCH_DELIMITER);
-                            }
-                        }
+                    if (hot.flags & HOT_GROUP_TECHNIQUE_EXCEPTIONS && group->preferredTechniques().contains(techName))
+                    {
+                        continue;
+                    }
+
+                    if (!sData.techniquesToRender.contains(techName))
+                    {
+                        EnqueueTechnique(sData.techniquesToRender, techName, group, hot.invocationLocation);
+                        queue_mask |= (match_effect << (hot.invocationLocation * MATCH_DELIMITER)) | (match_effect << CALL_DRAW * MATCH_DELIMITER);
                     }
                 }
-                else if (group->preferredTechniques().size() > 0) {
-                    for (auto& techName : group->preferredTechniques())
+            }
+            else if (hot.flags & HOT_GROUP_PREFERRED_TECHNIQUES) {
+                for (auto& techName : group->preferredTechniques())
+                {
+                    const auto& it = deviceData.allEnabledTechniques.find(techName);
+                    if (it != deviceData.allEnabledTechniques.end() && !it->second)
                     {
-                        if (deviceData.allEnabledTechniques.contains(techName) && !deviceData.allEnabledTechniques.at(techName))
+                        if (!sData.techniquesToRender.contains(techName))
                         {
-                            if (!sData.techniquesToRender.contains(techName))
-                            {
-                                sData.techniquesToRender.emplace(techName, std::make_tuple(group, group->getInvocationLocation(), resource_view{ 0 }));
-                                queue_mask |= (match_effect << (group->getInvocationLocation() * MATCH_DELIMITER)) | (match_effect << CALL_DRAW * MATCH_DELIMITER);
-                            }
+                            EnqueueTechnique(sData.techniquesToRender, techName, group, hot.invocationLocation);
+                            queue_mask |= (match_effect << (hot.invocationLocation * MATCH_DELIMITER)) | (match_effect << CALL_DRAW * MATCH_DELIMITER);
                         }
                     }
                 }
@@ -122,6 +131,8 @@ void RenderingManager::_CheckCallForCommandList(ShaderData& sData, CommandListDa
 
 void RenderingManager::CheckCallForCommandList(reshade::api::command_list* commandList)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_CHECK_CALL_FOR_COMMAND_LIST);
+
     if (nullptr == commandList)
     {
         return;
@@ -193,6 +204,40 @@ static bool check_aspect_ratio(float width_to_check, float height_to_check, uint
     return std::fabs(aspect_ratio) <= 0.1f && ((w_ratio <= 1.85f && w_ratio >= 0.5f && h_ratio <= 1.85f && h_ratio >= 0.5f) || (matchingMode == ShaderToggler::SWAPCHAIN_MATCH_MODE_EXTENDED_ASPECT_RATIO && std::modf(w_ratio, &w_ratio) <= 0.02f && std::modf(h_ratio, &h_ratio) <= 0.02f));
 }
 
+// Size of the top level of a texture, used for the binding copy statistics
+static inline uint64_t GetResourceSize(const resource_desc& desc)
+{
+    const uint32_t rowPitch = format_row_pitch(desc.texture.format, desc.texture.width);
+    return static_cast<uint64_t>(format_slice_pitch(desc.texture.format, rowPitch, desc.texture.height)) * desc.texture.depth_or_layers;
+}
+
+// Checks the swapchain matching mode of a group, counting why a render target was rejected
+static bool MatchesSwapchain(DeviceDataContainer& deviceData, ToggleGroup* group, const resource_desc& desc, uint32_t matchingMode)
+{
+    if (matchingMode >= ShaderToggler::SWAPCHAIN_MATCH_MODE_NONE)
+    {
+        return true;
+    }
+
+    uint32_t width, height;
+    deviceData.current_runtime->get_screenshot_width_and_height(&width, &height);
+
+    if (matchingMode >= ShaderToggler::SWAPCHAIN_MATCH_MODE_ASPECT_RATIO &&
+        !check_aspect_ratio(static_cast<float>(desc.texture.width), static_cast<float>(desc.texture.height), width, height, matchingMode))
+    {
+        group->getStatistics().Add(STAT_REJECT_ASPECT_RATIO);
+        return false;
+    }
+
+    if (matchingMode == ShaderToggler::SWAPCHAIN_MATCH_MODE_RESOLUTION && (width != desc.texture.width || height != desc.texture.height))
+    {
+        group->getStatistics().Add(STAT_REJECT_RESOLUTION);
+        return false;
+    }
+
+    return true;
+}
+
 const resource_view RenderingManager::GetCurrentResourceView(command_list* cmd_list, DeviceDataContainer& deviceData, ToggleGroup* group, CommandListDataContainer& commandListData, uint32_t descIndex, uint32_t action)
 {
     resource_view active_rtv = { 0 };
@@ -219,13 +264,19 @@ const resource_view RenderingManager::GetCurrentResourceView(command_list* cmd_l
         uint32_t slot = std::min(group->getBindingSRVSlotIndex(), slot_size - 1);
 
         if (slot_size == 0)
+        {
+            group->getStatistics().Add(STAT_REJECT_NULL_RESOURCE);
             return active_rtv;
+        }
 
         uint32_t desc_size = static_cast<uint32_t>(commandListData.stateTracker.GetPushDescriptorState()->current_srv[descIndex][slot].size());
         uint32_t desc = std::min(group->getBindingSRVDescriptorIndex(), desc_size - 1);
 
         if (desc_size == 0)
+        {
+            group->getStatistics().Add(STAT_REJECT_NULL_RESOURCE);
             return active_rtv;
+        }
 
         resource_view buf = commandListData.stateTracker.GetPushDescriptorState()->current_srv[descIndex][slot][desc];
 
@@ -259,6 +310,11 @@ const resource_view RenderingManager::GetCurrentResourceView(command_list* cmd_l
             }
         }
 
+        if (buf == 0)
+        {
+            group->getStatistics().Add(STAT_REJECT_NULL_RESOURCE);
+        }
+
         active_rtv = buf;
     }
     else if(action & MATCH_BINDING && !group->getExtractResourceViews() && rtvs.size() > 0 && rtvs[bindingRTindex] != 0)
@@ -268,23 +324,15 @@ const resource_view RenderingManager::GetCurrentResourceView(command_list* cmd_l
         if (rs == 0)
         {
             // Render targets may not have a resource bound in D3D12, in which case writes to them are discarded
+            group->getStatistics().Add(STAT_REJECT_NULL_RESOURCE);
             return active_rtv;
         }
 
         resource_desc desc = device->get_resource_desc(rs);
 
-        if (group->getBindingMatchSwapchainResolution() < ShaderToggler::SWAPCHAIN_MATCH_MODE_NONE)
+        if (!MatchesSwapchain(deviceData, group, desc, group->getBindingMatchSwapchainResolution()))
         {
-            uint32_t width, height;
-            deviceData.current_runtime->get_screenshot_width_and_height(&width, &height);
-
-            if ((group->getBindingMatchSwapchainResolution() >= ShaderToggler::SWAPCHAIN_MATCH_MODE_ASPECT_RATIO &&
-                !check_aspect_ratio(static_cast<float>(desc.texture.width), static_cast<float>(desc.texture.height), width, height, group->getBindingMatchSwapchainResolution())) ||
-                (group->getBindingMatchSwapchainResolution() == ShaderToggler::SWAPCHAIN_MATCH_MODE_RESOLUTION &&
-                    (width != desc.texture.width || height != desc.texture.height)))
-            {
-                return active_rtv;
-            }
+            return active_rtv;
         }
 
         active_rtv = rtvs[bindingRTindex];
@@ -296,6 +344,7 @@ const resource_view RenderingManager::GetCurrentResourceView(command_list* cmd_l
         if (rs == 0)
         {
             // Render targets may not have a resource bound in D3D12, in which case writes to them are discarded
+            group->getStatistics().Add(STAT_REJECT_NULL_RESOURCE);
             return active_rtv;
         }
 
@@ -303,26 +352,22 @@ const resource_view RenderingManager::GetCurrentResourceView(command_list* cmd_l
         resource_desc desc = device->get_resource_desc(rs);
         if (!IsColorBuffer(desc.texture.format))
         {
+            group->getStatistics().Add(STAT_REJECT_FORMAT);
             return active_rtv;
         }
 
         // Make sure our target matches swap buffer dimensions when applying effects or it's explicitly requested
-        if (group->getMatchSwapchainResolution() < ShaderToggler::SWAPCHAIN_MATCH_MODE_NONE)
+        if (!MatchesSwapchain(deviceData, group, desc, group->getMatchSwapchainResolution()))
         {
-            uint32_t width, height;
-            deviceData.current_runtime->get_screenshot_width_and_height(&width, &height);
-
-            if ((group->getMatchSwapchainResolution() >= ShaderToggler::SWAPCHAIN_MATCH_MODE_ASPECT_RATIO &&
-                !check_aspect_ratio(static_cast<float>(desc.texture.width), static_cast<float>(desc.texture.height), width, height, group->getMatchSwapchainResolution())) ||
-                (group->getMatchSwapchainResolution() == ShaderToggler::SWAPCHAIN_MATCH_MODE_RESOLUTION &&
-                    (width != desc.texture.width || height != desc.texture.height)))
-            {
-                return active_rtv;
-            }
+            return active_rtv;
         }
 
         active_rtv = rtvs[index];
     }
+    else if (action & (MATCH_BINDING | MATCH_EFFECT))
+    {
+        group->getStatistics().Add(STAT_REJECT_NULL_RESOURCE);
+    }
 
     return active_rtv;
 }
@@ -402,12 +447,13 @@ bool RenderingManager::RenderRemainingEffects(effect_runtime* runtime)
         return false;
     }
     
-    EnumerateTechniques(deviceData.current_runtime, [&deviceData, &commandListData, &cmd_list, &device, &active_rtv, &active_rtv_srgb, &rendered, &res](effect_runtime* runtime, effect_technique technique, string& name) {
-        if (deviceData.allEnabledTechniques.contains(name) && !deviceData.allEnabledTechniques[name])
+    EnumerateTechniques(deviceData.current_runtime, [&deviceData, &commandListData, &cmd_list, &device, &active_rtv, &active_rtv_srgb, &rendered, &res](effect_runtime* runtime, effect_technique technique, const string& name) {
+        const auto enabled = deviceData.allEnabledTechniques.find(name);
+        if (enabled != deviceData.allEnabledTechniques.end() && !enabled->second)
         {
             runtime->render_technique(technique, cmd_list, active_rtv, active_rtv_srgb);
     
-            deviceData.allEnabledTechniques[name] = true;
+            enabled->second = true;
             rendered = true;
         }
         });
@@ -418,64 +464,68 @@ bool RenderingManager::RenderRemainingEffects(effect_runtime* runtime)
 bool RenderingManager::_RenderEffects(
     command_list* cmd_list,
     DeviceDataContainer& deviceData,
-    const unordered_map<string, tuple<ToggleGroup*, uint32_t, resource_view>>& techniquesToRender,
-    vector<string>& removalList,
-    const unordered_set<string>& toRenderNames)
+    const vector<TechniqueQueue::iterator>& toRender,
+    vector<TechniqueQueue::iterator>& rendered)
 {
-    bool rendered = false;
-    CommandListDataContainer& cmdData = cmd_list->get_private_data<CommandListDataContainer>();
+    TRACE_SCOPE(Profiling::TRACE_EFFECT_BATCH, static_cast<uint32_t>(toRender.size()));
+
+    bool renderedAny = false;
+
+    EnumerateTechniques(deviceData.current_runtime, [&deviceData, &cmd_list, &renderedAny, &toRender, &rendered, this](effect_runtime* runtime, effect_technique technique, const string& name) {
+        const auto tech = std::find_if(toRender.begin(), toRender.end(), [&name](const auto& it) { return string_view(it->first) == name; });
 
-    EnumerateTechniques(deviceData.current_runtime, [&cmdData, &deviceData, &techniquesToRender, &cmd_list, &rendered, &removalList, &toRenderNames, this](effect_runtime* runtime, effect_technique technique, string& name) {
+        if (tech == toRender.end())
+        {
+            return;
+        }
+
+        const auto enabled = deviceData.allEnabledTechniques.find(name);
 
-        if (toRenderNames.find(name) != toRenderNames.end())
+        if (enabled != deviceData.allEnabledTechniques.end() && !enabled->second)
         {
-            auto tech = techniquesToRender.find(name);
+            const auto& [group, _, active_rtv] = (*tech)->second;
 
-            if (tech != techniquesToRender.end() && !deviceData.allEnabledTechniques.at(name))
+            if (active_rtv == 0)
             {
-                auto& [techName, techData] = *tech;
-                const auto& [group, _, active_rtv] = techData;
-
-                if (active_rtv == 0)
-                {
-                    return;
-                }
+                return;
+            }
 
-                resource res = runtime->get_device()->get_resource_from_view(active_rtv);
+            resource res = runtime->get_device()->get_resource_from_view(active_rtv);
 
-                resource_view view_non_srgb = active_rtv;
-                resource_view view_srgb = active_rtv;
+            resource_view view_non_srgb = active_rtv;
+            resource_view view_srgb = active_rtv;
 
-                resourceManager.SetResourceViewHandles(res.handle, &view_non_srgb, &view_srgb);
+            resourceManager.SetResourceViewHandles(res.handle, &view_non_srgb, &view_srgb);
 
-                if (view_non_srgb == 0)
-                {
-                    return;
-                }
+            if (view_non_srgb == 0)
+            {
+                return;
+            }
 
-                deviceData.rendered_effects = true;
+            deviceData.rendered_effects = true;
 
-                runtime->render_technique(technique, cmd_list, view_non_srgb, view_srgb);
+            runtime->render_technique(technique, cmd_list, view_non_srgb, view_srgb);
+            group->getStatistics().Add(STAT_TECHNIQUES_RENDERED);
 
-                resource_desc resDesc = runtime->get_device()->get_resource_desc(res);
-                uiData.cFormat = resDesc.texture.format;
-                removalList.push_back(name);
+            resource_desc resDesc = runtime->get_device()->get_resource_desc(res);
+            uiData.cFormat = resDesc.texture.format;
+            rendered.push_back(*tech);
 
-                deviceData.allEnabledTechniques[name] = true;
-                rendered = true;
-            }
+            enabled->second = true;
+            renderedAny = true;
         }
         });
 
-    return rendered;
+    return renderedAny;
 }
 
+template<typename Q>
 void RenderingManager::_QueueOrDequeue(
     command_list* cmd_list,
     DeviceDataContainer& deviceData,
     CommandListDataContainer& commandListData,
-    unordered_map<string, tuple<ShaderToggler::ToggleGroup*, uint32_t, reshade::api::resource_view>>& queue,
-    unordered_set<string>& immediateQueue,
+    Q& queue,
+    vector<typename Q::iterator>& immediateQueue,
     uint32_t callLocation,
     uint32_t layoutIndex,
     uint32_t action)
@@ -495,6 +545,8 @@ void RenderingManager::_QueueOrDequeue(
             }
             else if(group->getRequeueAfterRTMatchingFailure())
             {
+                group->getStatistics().Add(STAT_REQUEUES);
+
                 // Re-issue draw call queue command
                 commandListData.commandQueue |= (action << (callLocation * MATCH_DELIMITER));
                 it++;
@@ -510,7 +562,7 @@ void RenderingManager::_QueueOrDequeue(
         // Queue updates depending on the place their supposed to be called at
         if (view != 0 && (!callLocation && !loc || callLocation & loc))
         {
-            immediateQueue.insert(name);
+            immediateQueue.push_back(it);
         }
 
         it++;
@@ -519,6 +571,8 @@ void RenderingManager::_QueueOrDequeue(
 
 void RenderingManager::RenderEffects(command_list* cmd_list, uint32_t callLocation, uint32_t invocation)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_RENDER_EFFECTS);
+
     if (cmd_list == nullptr || cmd_list->get_device() == nullptr)
     {
         return;
@@ -535,50 +589,52 @@ void RenderingManager::RenderEffects(command_list* cmd_list, uint32_t callLocati
         return;
     }
 
-    bool toRender = false;
-    unordered_set<string> psToRenderNames;
-    unordered_set<string> vsToRenderNames;
+    ShaderData& ps = commandListData.ps;
+    ShaderData& vs = commandListData.vs;
+
+    ps.techniquesToRenderNow.clear();
+    vs.techniquesToRenderNow.clear();
 
     if (invocation & MATCH_EFFECT_PS)
     {
-        _QueueOrDequeue(cmd_list, deviceData, commandListData, commandListData.ps.techniquesToRender, psToRenderNames, callLocation, 0, MATCH_EFFECT_PS);
+        _QueueOrDequeue(cmd_list, deviceData, commandListData, ps.techniquesToRender, ps.techniquesToRenderNow, callLocation, 0, MATCH_EFFECT_PS);
     }
 
     if (invocation & MATCH_EFFECT_VS)
     {
-        _QueueOrDequeue(cmd_list, deviceData, commandListData, commandListData.vs.techniquesToRender, vsToRenderNames, callLocation, 1, MATCH_EFFECT_VS);
+        _QueueOrDequeue(cmd_list, deviceData, commandListData, vs.techniquesToRender, vs.techniquesToRenderNow, callLocation, 1, MATCH_EFFECT_VS);
     }
 
-    bool rendered = false;
-    vector<string> psRemovalList;
-    vector<string> vsRemovalList;
-
-    if (psToRenderNames.size() == 0 && vsToRenderNames.size() == 0)
+    if (ps.techniquesToRenderNow.size() == 0 && vs.techniquesToRenderNow.size() == 0)
     {
         return;
     }
 
     deviceData.current_runtime->render_effects(cmd_list, resource_view{ 0 }, resource_view{ 0 });
 
+    ps.techniquesRendered.clear();
+    vs.techniquesRendered.clear();
+
     unique_lock<shared_mutex> dev_mutex(render_mutex);
-    rendered = (psToRenderNames.size() > 0) && _RenderEffects(cmd_list, deviceData, commandListData.ps.techniquesToRender, psRemovalList, psToRenderNames) ||
-        (vsToRenderNames.size() > 0) && _RenderEffects(cmd_list, deviceData, commandListData.vs.techniquesToRender, vsRemovalList, vsToRenderNames);
+    const bool rendered = (ps.techniquesToRenderNow.size() > 0) && _RenderEffects(cmd_list, deviceData, ps.techniquesToRenderNow, ps.techniquesRendered) ||
+        (vs.techniquesToRenderNow.size() > 0) && _RenderEffects(cmd_list, deviceData, vs.techniquesToRenderNow, vs.techniquesRendered);
     dev_mutex.unlock();
 
-    for (auto& g : psRemovalList)
+    for (const auto& it : ps.techniquesRendered)
     {
-        commandListData.ps.techniquesToRender.erase(g);
+        ps.techniquesToRender.erase(it);
     }
 
-    for (auto& g : vsRemovalList)
+    for (const auto& it : vs.techniquesRendered)
     {
-        commandListData.vs.techniquesToRender.erase(g);
+        vs.techniquesToRender.erase(it);
     }
 
     if (rendered)
     {
         // TODO: ???
         //shared_lock<shared_mutex> dev_mutex(pipeline_layout_mutex);
+        TRACE_SCOPE(Profiling::TRACE_STATE_RESTORE, 0);
         commandListData.stateTracker.ReApplyState(cmd_list, deviceData.transient_mask);
     }
 }
@@ -586,6 +642,8 @@ void RenderingManager::RenderEffects(command_list* cmd_list, uint32_t callLocati
 
 void RenderingManager::UpdatePreview(command_list* cmd_list, uint32_t callLocation, uint32_t invocation)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_UPDATE_PREVIEW);
+
     if (cmd_list == nullptr || cmd_list->get_device() == nullptr)
     {
         return;
@@ -882,14 +940,16 @@ uint32_t RenderingManager::UpdateTextureBinding(effect_runtime* runtime, const s
 
 void RenderingManager::_UpdateTextureBindings(command_list* cmd_list,
     DeviceDataContainer& deviceData,
-    const unordered_map<string, tuple<ToggleGroup*, uint32_t, resource_view>>& bindingsToUpdate,
-    vector<string>& removalList,
-    const unordered_set<string>& toUpdateBindings)
+    const vector<BindingQueue::iterator>& toUpdate,
+    vector<BindingQueue::iterator>& updated)
 {
-    for (const auto& [bindingName,bindingData] : bindingsToUpdate)
+    for (const auto& entry : toUpdate)
     {
-        if (toUpdateBindings.contains(bindingName) && !deviceData.bindingsUpdated.contains(bindingName))
+        const auto& [bindingId, bindingData] = *entry;
+
+        if (!deviceData.IsBindingUpdated(bindingId))
         {
+            const string& bindingName = uiData.GetTextureBindingName(bindingId);
             effect_runtime* runtime = deviceData.current_runtime;
 
             resource_view active_rtv = std::get<2>(bindingData);
@@ -951,13 +1011,20 @@ void RenderingManager::_UpdateTextureBindings(command_list* cmd_list,
 
                     if (retUpdate && target_res != 0)
                     {
-                        cmd_list->copy_resource(res, target_res);
+                        {
+                            TRACE_SCOPE(Profiling::TRACE_BINDING_COPY, bindingId);
+                            cmd_list->copy_resource(res, target_res);
+                        }
+
+                        ToggleGroupStatistics& statistics = std::get<0>(entry->second)->getStatistics();
+                        statistics.Add(STAT_BINDING_COPIES);
+                        statistics.Add(STAT_BINDING_BYTES, GetResourceSize(resDesc));
                         bindingData.reset = false;
                     }
                 }
 
-                deviceData.bindingsUpdated.emplace(bindingName);
-                removalList.push_back(bindingName);
+                deviceData.SetBindingUpdated(bindingId);
+                updated.push_back(entry);
             }
         }
     }
@@ -965,6 +1032,8 @@ void RenderingManager::_UpdateTextureBindings(command_list* cmd_list,
 
 void RenderingManager::UpdateTextureBindings(command_list* cmd_list, uint32_t callLocation, uint32_t invocation)
 {
+    PROFILE_SCOPE(Profiling::PROFILE_UPDATE_TEXTURE_BINDINGS);
+
     if (cmd_list == nullptr || cmd_list->get_device() == nullptr)
     {
         return;
@@ -981,46 +1050,49 @@ void RenderingManager::UpdateTextureBindings(command_list* cmd_list, uint32_t ca
         return;
     }
 
-    unordered_set<string> psToUpdateBindings;
-    unordered_set<string> vsToUpdateBindings;
+    ShaderData& ps = commandListData.ps;
+    ShaderData& vs = commandListData.vs;
+
+    ps.bindingsToUpdateNow.clear();
+    vs.bindingsToUpdateNow.clear();
 
     if (invocation & MATCH_BINDING_PS)
     {
-        _QueueOrDequeue(cmd_list, deviceData, commandListData, commandListData.ps.bindingsToUpdate, psToUpdateBindings, callLocation, 0, MATCH_BINDING_PS);
+        _QueueOrDequeue(cmd_list, deviceData, commandListData, ps.bindingsToUpdate, ps.bindingsToUpdateNow, callLocation, 0, MATCH_BINDING_PS);
     }
 
     if (invocation & MATCH_BINDING_VS)
     {
-        _QueueOrDequeue(cmd_list, deviceData, commandListData, commandListData.vs.bindingsToUpdate, vsToUpdateBindings, callLocation, 1, MATCH_BINDING_VS);
+        _QueueOrDequeue(cmd_list, deviceData, commandListData, vs.bindingsToUpdate, vs.bindingsToUpdateNow, callLocation, 1, MATCH_BINDING_VS);
     }
 
-    if (psToUpdateBindings.size() == 0 && vsToUpdateBindings.size() == 0)
+    if (ps.bindingsToUpdateNow.size() == 0 && vs.bindingsToUpdateNow.size() == 0)
     {
         return;
     }
 
-    vector<string> psRemovalList;
-    vector<string> vsRemovalList;
+    ps.bindingsUpdatedNow.clear();
+    vs.bindingsUpdatedNow.clear();
 
     unique_lock<shared_mutex> mtx(binding_mutex);
-    if (psToUpdateBindings.size() > 0)
+    if (ps.bindingsToUpdateNow.size() > 0)
     {
-        _UpdateTextureBindings(cmd_list, deviceData, commandListData.ps.bindingsToUpdate, psRemovalList, psToUpdateBindings);
+        _UpdateTextureBindings(cmd_list, deviceData, ps.bindingsToUpdateNow, ps.bindingsUpdatedNow);
     }
-    if (vsToUpdateBindings.size() > 0)
+    if (vs.bindingsToUpdateNow.size() > 0)
     {
-        _UpdateTextureBindings(cmd_list, deviceData, commandListData.vs.bindingsToUpdate, vsRemovalList, vsToUpdateBindings);
+        _UpdateTextureBindings(cmd_list, deviceData, vs.bindingsToUpdateNow, vs.bindingsUpdatedNow);
     }
     mtx.unlock();
 
-    for (auto& g : psRemovalList)
+    for (const auto& it : ps.bindingsUpdatedNow)
     {
-        commandListData.ps.bindingsToUpdate.erase(g);
+        ps.bindingsToUpdate.erase(it);
     }
 
-    for (auto& g : vsRemovalList)
+    for (const auto& it : vs.bindingsUpdatedNow)
     {
-        commandListData.vs.bindingsToUpdate.erase(g);
+        vs.bindingsToUpdate.erase(it);
     }
 }
 
@@ -1038,7 +1110,7 @@ void RenderingManager::ClearUnmatchedTextureBindings(reshade::api::command_list*
 
     for (auto& [bindingName,bindingData] : data.bindingMap)
     {
-        if (data.bindingsUpdated.contains(bindingName) || !bindingData.enabled_reset_on_miss || bindingData.reset)
+        if (data.IsBindingUpdated(uiData.FindTextureBindingId(bindingName)) || !bindingData.enabled_reset_on_miss || bindingData.reset)
         {
             continue;
         }
@@ -76,19 +76,31 @@ namespace Rendering
 
         void ClearQueue2(CommandListDataContainer& commandListData, const uint32_t location0, const uint32_t location1) const;
 
-        static void EnumerateTechniques(reshade::api::effect_runtime* runtime, std::function<void(reshade::api::effect_runtime*, reshade::api::effect_technique, std::string&)> func);
+        // Invokes func(runtime, technique, name) for every technique. The name buffer is reused across calls, copy it if it has to outlive func
+        template<typename F>
+        static void EnumerateTechniques(reshade::api::effect_runtime* runtime, F&& func)
+        {
+            runtime->enumerate_techniques(nullptr, [&func](reshade::api::effect_runtime* rt, reshade::api::effect_technique technique) {
+                // Command lists render effects on their own threads
+                static thread_local char buffer[CHAR_BUFFER_SIZE];
+                static thread_local std::string name;
+
+                size_t bufferSize = CHAR_BUFFER_SIZE;
+                rt->get_technique_name(technique, buffer, &bufferSize);
+                name.assign(buffer);
+                func(rt, technique, name);
+                });
+        }
     private:
         bool _RenderEffects(
             reshade::api::command_list* cmd_list,
             DeviceDataContainer& deviceData,
-            const std::unordered_map<std::string, std::tuple<ShaderToggler::ToggleGroup*, uint32_t, reshade::api::resource_view>>& techniquesToRender,
-            std::vector<std::string>& removalList,
-            const std::unordered_set<std::string>& toRenderNames);
+            const std::vector<TechniqueQueue::iterator>& toRender,
+            std::vector<TechniqueQueue::iterator>& rendered);
         void _UpdateTextureBindings(reshade::api::command_list* cmd_list,
             DeviceDataContainer& deviceData,
-            const std::unordered_map<std::string, std::tuple<ShaderToggler::ToggleGroup*, uint32_t, reshade::api::resource_view>>& bindingsToUpdate,
-            std::vector<std::string>& removalList,
-            const std::unordered_set<std::string>& toUpdateBindings);
+            const std::vector<BindingQueue::iterator>& toUpdate,
+            std::vector<BindingQueue::iterator>& updated);
         bool _CreateTextureBinding(reshade::api::effect_runtime* runtime,
             reshade::api::resource* res,
             reshade::api::resource_view* srv,
@@ -96,12 +108,13 @@ namespace Rendering
             reshade::api::format format,
             uint32_t width,
             uint32_t height);
+        template<typename Q>
         void _QueueOrDequeue(
             command_list* cmd_list,
             DeviceDataContainer& deviceData,
             CommandListDataContainer& commandListData,
-            std::unordered_map<std::string, std::tuple<ShaderToggler::ToggleGroup*, uint32_t, reshade::api::resource_view>>& queue,
-            std::unordered_set<std::string>& immediateQueue,
+            Q& queue,
+            std::vector<typename Q::iterator>& immediateQueue,
             uint32_t callLocation,
             uint32_t layoutIndex,
             uint32_t action);
@@ -117,7 +130,5 @@ namespace Rendering
         reshade::api::resource_view empty_srv = { 0 };
 
         static constexpr size_t CHAR_BUFFER_SIZE = 256;
-        static size_t g_charBufferSize;
-        static char g_charBuffer[CHAR_BUFFER_SIZE];
     };
 }
\ No newline at end of file
@@ -19,6 +19,9 @@ unordered_set<uintptr_t> ResourceShimFFXIV::ffxiv_created_resources;
 
 bool ResourceShimFFXIV::Init()
 {
+    // Resolve all three in one pass, the individual hooks below are then served from the signature cache
+    GameHook::FindSignatures({ &ffxiv_textures_recreate, &ffxiv_texture_create, &ffxiv_textures_create });
+
     return
         GameHookT<sig_ffxiv_textures_recreate>::Hook(&org_ffxiv_textures_recreate, detour_ffxiv_textures_recreate, ffxiv_textures_recreate) &&
         GameHookT<sig_ffxiv_texture_create>::Hook(&org_ffxiv_texture_create, detour_ffxiv_texture_create, ffxiv_texture_create) &&
@@ -30,6 +30,8 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <bit>
 #include "ShaderManager.h"
 
 using namespace reshade::api;
@@ -67,7 +69,7 @@ namespace ShaderToggler
     }
 
 
-    void ShaderManager::startHuntingMode(const unordered_set<uint32_t> currentMarkedHashes)
+    void ShaderManager::startHuntingMode(const unordered_set<uint32_t>& currentMarkedHashes)
     {
         // copy the currently marked hashes (from the active group) to the set of marked hashes.
         {
@@ -79,6 +81,8 @@ namespace ShaderToggler
             }
         }
 
+        stopBisection();
+
         // switch on hunting mode
         _isInHuntingMode = true;
         _activeHuntedShaderIndex = -1;
@@ -92,6 +96,7 @@ namespace ShaderToggler
 
     void ShaderManager::stopHuntingMode()
     {
+        stopBisection();
         _isInHuntingMode = false;
         _activeHuntedShaderIndex = -1;
         _activeHuntedShaderHash = 0;
@@ -200,27 +205,24 @@ namespace ShaderToggler
                 return;
             }
             // we have marked shaders, find the next one in collected active shader hashes that's part of this set.
-            auto it = _collectedActiveShaderHashes.begin();
+            // unordered_set iterators are only guaranteed to go forward, so walk back over a copy.
+            const std::vector<uint32_t> collectedHashes(_collectedActiveShaderHashes.begin(), _collectedActiveShaderHashes.end());
             int index = _activeHuntedShaderIndex - 1;
-            std::advance(it, index);
             bool foundHash = false;
             uint32_t hash = 0;
             while (index != _activeHuntedShaderIndex)
             {
-                if (it == _collectedActiveShaderHashes.begin())
+                if (index <= 0)
                 {
-                    it = _collectedActiveShaderHashes.end();
-                    --it;
-                    index = _collectedActiveShaderHashes.size() - 1;
+                    index = collectedHashes.size() - 1;
                 }
-                hash = *it;
+                hash = collectedHashes[index];
                 if (_markedShaderHashes.contains(hash))
                 {
                     // found one
                     foundHash = true;
                     break;
                 }
-                --it;
                 index--;
             }
             if (foundHash)
@@ -318,6 +320,137 @@ namespace ShaderToggler
     }
 
 
+    bool ShaderManager::startBisection(const vector<uint32_t>& candidates)
+    {
+        stopBisection();
+        _bisectMisses = 0;
+
+        if (!_isInHuntingMode)
+        {
+            return false;
+        }
+
+        {
+            shared_lock lock(_markedShaderHashMutex);
+            _bisectCandidates.reserve(candidates.size());
+            for (const auto hash : candidates)
+            {
+                if (!_markedShaderHashes.contains(hash))
+                {
+                    _bisectCandidates.push_back(hash);
+                }
+            }
+        }
+
+        // sorted so the tested half can be searched when the collected shaders are listed
+        std::sort(_bisectCandidates.begin(), _bisectCandidates.end());
+        _bisectSplit = (_bisectCandidates.size() + 1) / 2;
+
+        return isBisecting();
+    }
+
+
+    void ShaderManager::stopBisection()
+    {
+        _bisectCandidates.clear();
+        _bisectPending.clear();
+        _bisectSplit = 0;
+    }
+
+
+    void ShaderManager::answerBisection(BisectAnswer answer)
+    {
+        if (!isBisecting())
+        {
+            return;
+        }
+
+        const auto split = _bisectCandidates.begin() + _bisectSplit;
+        const bool testedAlone = _bisectSplit == 1;
+
+        switch (answer)
+        {
+        case BISECT_GONE:
+            _bisectCandidates.erase(split, _bisectCandidates.end());
+            break;
+        case BISECT_VISIBLE:
+            _bisectCandidates.erase(_bisectCandidates.begin(), split);
+            if (_bisectCandidates.empty())
+            {
+                // the last candidate was tested alone and doesn't draw the element
+                _bisectMisses++;
+            }
+            break;
+        case BISECT_BOTH:
+            if (split != _bisectCandidates.end())
+            {
+                _bisectPending.emplace_back(split, _bisectCandidates.end());
+            }
+            _bisectCandidates.erase(split, _bisectCandidates.end());
+            break;
+        }
+
+        // only a shader which affected the element while it was tested on its own is known to draw it
+        if (testedAlone && answer != BISECT_VISIBLE)
+        {
+            markBisectedShader(_bisectCandidates.front());
+            _bisectCandidates.clear();
+        }
+
+        nextBisectionRange();
+    }
+
+
+    void ShaderManager::nextBisectionRange()
+    {
+        while (_bisectCandidates.empty())
+        {
+            if (_bisectPending.empty())
+            {
+                stopBisection();
+                return;
+            }
+
+            _bisectCandidates = std::move(_bisectPending.back());
+            _bisectPending.pop_back();
+        }
+
+        // a single candidate left is tested alone before it's marked
+        _bisectSplit = (_bisectCandidates.size() + 1) / 2;
+    }
+
+
+    void ShaderManager::markBisectedShader(uint32_t hash)
+    {
+        {
+            unique_lock lock(_markedShaderHashMutex);
+            _markedShaderHashes.emplace(hash);
+        }
+
+        // make it the hunted shader so it shows up as the current one in the list
+        const auto it = std::find(_collectedActiveShaderHashes.begin(), _collectedActiveShaderHashes.end(), hash);
+        if (it != _collectedActiveShaderHashes.end())
+        {
+            _activeHuntedShaderIndex = static_cast<int>(std::distance(_collectedActiveShaderHashes.begin(), it));
+            _activeHuntedShaderHash = hash;
+        }
+    }
+
+
+    bool ShaderManager::isBisectTestedHash(uint32_t hash) const
+    {
+        const auto tested = getBisectTestedHashes();
+        return std::binary_search(tested.begin(), tested.end(), hash);
+    }
+
+
+    uint32_t ShaderManager::getBisectStepsLeft() const
+    {
+        // halving down to one candidate, plus testing it alone if the last half answered wasn't it
+        return _bisectCandidates.size() <= 1 ? static_cast<uint32_t>(_bisectCandidates.size()) : static_cast<uint32_t>(std::bit_width(_bisectCandidates.size() - 1)) + 1;
+    }
+
+
     uint32_t ShaderManager::getShaderHash(uint64_t handle)
     {
         if (!_handleToShaderHash.contains(handle))
@@ -33,6 +33,8 @@
 #pragma once
 
 #include <map>
+#include <span>
+#include <vector>
 #include <reshade_api_device.hpp>
 #include <reshade_api_pipeline.hpp>
 #include <shared_mutex>
@@ -40,10 +42,22 @@
 #include <tsl/robin_map.h>
 #include "CDataFile.h"
 #include "ToggleGroup.h"
+#include "Profiler.h"
 
 
 namespace ShaderToggler
 {
+    /// <summary>
+    /// Answer to a bisection step, telling what happened to the element hunted for while the tested half of the candidates was
+    /// assigned to the edited group.
+    /// </summary>
+    enum BisectAnswer : uint32_t
+    {
+        BISECT_GONE = 0,        // the element is affected, it's drawn by the tested half
+        BISECT_VISIBLE,         // the element is unaffected, it's drawn by the other half
+        BISECT_BOTH             // the element is partly affected, both halves draw a part of it
+    };
+
     /// <summary>
     /// Class which manages a set of shaders for a given type (pixel, vertex...)
     /// </summary>
@@ -59,7 +73,7 @@ namespace ShaderToggler
         ///	where the user can step through collected active shaders to mark them for assignment to the current edited group.
         /// </summary>
         /// <param name="currentMarkedHashes"></param>
-        void startHuntingMode(const std::unordered_set<uint32_t> currentMarkedHashes);
+        void startHuntingMode(const std::unordered_set<uint32_t>& currentMarkedHashes);
         void stopHuntingMode();
         /// <summary>
         /// Moves to the next shader. If control is pressed as well, it'll step to the next marked shader (if any). If there aren't any shaders in that
@@ -89,6 +103,37 @@ namespace ShaderToggler
         uint32_t getShaderHash(uint64_t handle);
         void addActivePipelineHandle(uint64_t handle);
         void toggleMarkOnHuntedShader();
+        /// <summary>
+        /// Starts bisecting the given collected shaders, skipping the ones already marked. Each step tests one half of the
+        /// remaining candidates, so a shader among n candidates is found in about log2(n) steps instead of n. Returns false if
+        /// there's nothing to bisect.
+        /// </summary>
+        bool startBisection(const std::vector<uint32_t>& candidates);
+        void stopBisection();
+        /// <summary>
+        /// Narrows the candidates down to the half the answer points at. A shader is only marked once it was tested alone and
+        /// the answer wasn't BISECT_VISIBLE, a last candidate left over from the untested half gets a step of its own. A range
+        /// whose last candidate stays visible ends without a match, e.g. when the element isn't drawn by any candidate.
+        /// BISECT_BOTH queues the other half to be bisected once the tested half is done, which finds several shaders drawing
+        /// one element. Bisection stops by itself once no candidates are left.
+        /// </summary>
+        void answerBisection(BisectAnswer answer);
+        bool isBisecting() const { return !_bisectCandidates.empty(); }
+        /// <summary>
+        /// The half of the candidates currently tested, sorted.
+        /// </summary>
+        std::span<const uint32_t> getBisectTestedHashes() const { return std::span<const uint32_t>(_bisectCandidates.data(), _bisectSplit); }
+        bool isBisectTestedHash(uint32_t hash) const;
+        size_t getBisectCandidateCount() const { return _bisectCandidates.size(); }
+        size_t getBisectPendingCount() const { return _bisectPending.size(); }
+        /// <summary>
+        /// Ranges of the last bisection which ended without a match.
+        /// </summary>
+        size_t getBisectMissCount() const { return _bisectMisses; }
+        /// <summary>
+        /// Most answers needed to find the shader among the current candidates, including testing it alone.
+        /// </summary>
+        uint32_t getBisectStepsLeft() const;
 
         size_t getPipelineCount() { return _handleToShaderHash.size(); }
         size_t getShaderCount() { return _shaderHashes.size(); }
@@ -145,6 +190,8 @@ namespace ShaderToggler
 
         inline uint32_t safeGetShaderHash(uint64_t pipelineHandle)
         {
+            PROFILE_SCOPE(Profiling::PROFILE_SHADER_HASH_LOOKUP);
+
             std::shared_lock lock(_hashHandlesMutex);
             const auto& it = _handleToShaderHash.find(pipelineHandle);
 
@@ -153,6 +200,8 @@ namespace ShaderToggler
 
     private:
         void setActiveHuntedShaderHandle();
+        void nextBisectionRange();
+        void markBisectedShader(uint32_t hash);
 
         std::unordered_set<uint32_t> _shaderHashes;				// all shader hashes added through init pipeline
         //std::unordered_map<uint64_t, uint32_t> _handleToShaderHash;		// pipeline handle per shader hash. Handle is removed when a pipeline is destroyed.
@@ -167,6 +216,10 @@ namespace ShaderToggler
         std::shared_mutex _hashHandlesMutex;
         std::shared_mutex _markedShaderHashMutex;
         bool _hideMarkedShaders = false;
+        std::vector<uint32_t> _bisectCandidates;			// candidates of the current bisection range, sorted. The first _bisectSplit ones are tested
+        std::vector<std::vector<uint32_t>> _bisectPending;	// ranges left to bisect after the current one, from BISECT_BOTH answers
+        size_t _bisectSplit = 0;
+        size_t _bisectMisses = 0;
     };
 }
 
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include "ShaderUsage.h"
+#include "Profiler.h"
+
+using namespace ShaderToggler;
+using namespace reshade::api;
+using namespace std;
+
+atomic_bool ShaderUsage::_collecting = false;
+atomic_uint32_t ShaderUsage::_swapchainWidth = 0;
+atomic_uint32_t ShaderUsage::_swapchainHeight = 0;
+mutex ShaderUsage::_slotMutex;
+vector<unique_ptr<ShaderUsage::ThreadSlot>> ShaderUsage::_slots;
+unordered_map<uint32_t, ShaderUsageStatistics> ShaderUsage::_statistics[USAGE_STAGE_COUNT];
+unordered_map<uint32_t, ShaderUsage::FrameUsage> ShaderUsage::_frame[USAGE_STAGE_COUNT];
+
+void ShaderUsageStatistics::AddTarget(const RenderTargetUsage& target)
+{
+    if (targetCount < MAX_TARGETS && std::find(targets, targets + targetCount, target) == targets + targetCount)
+    {
+        targets[targetCount++] = target;
+    }
+}
+
+bool ShaderUsageStatistics::HasTargetFormat(format targetFormat) const
+{
+    return std::any_of(targets, targets + targetCount, [targetFormat](const RenderTargetUsage& target) { return target.format == targetFormat; });
+}
+
+static void Merge(ShaderUsageStatistics& into, const ShaderUsageStatistics& from)
+{
+    into.drawCount += from.drawCount;
+    into.firstDraw = std::min(into.firstDraw, from.firstDraw);
+    into.lastDraw = std::max(into.lastDraw, from.lastDraw);
+    into.swapchainSized |= from.swapchainSized;
+
+    for (uint32_t i = 0; i < from.targetCount; i++)
+    {
+        into.AddTarget(from.targets[i]);
+    }
+}
+
+ShaderUsage::ThreadSlot& ShaderUsage::GetThreadSlot()
+{
+    thread_local ThreadSlot* slot = nullptr;
+
+    if (slot == nullptr)
+    {
+        // Slots outlive their threads so EndFrame never reads freed memory
+        unique_lock<mutex> lock(_slotMutex);
+        _slots.push_back(make_unique<ThreadSlot>());
+        slot = _slots.back().get();
+    }
+
+    return *slot;
+}
+
+void ShaderUsage::Record(FrameUsage& usage, uint32_t ordinal, const RenderTargetUsage* targets, uint32_t targetCount, bool swapchainSized)
+{
+    ShaderUsageStatistics& statistics = usage.statistics;
+
+    statistics.drawCount++;
+    statistics.firstDraw = std::min(statistics.firstDraw, ordinal);
+    statistics.lastDraw = std::max(statistics.lastDraw, ordinal);
+    statistics.swapchainSized |= swapchainSized;
+
+    for (uint32_t i = 0; i < targetCount; i++)
+    {
+        statistics.AddTarget(targets[i]);
+    }
+}
+
+void ShaderUsage::OnDraw(command_list* cmd_list, uint32_t pixelShaderHash, uint32_t vertexShaderHash, const resource_view* rtvs, uint32_t rtvCount, resource_view dsv)
+{
+    PROFILE_SCOPE(Profiling::PROFILE_SHADER_USAGE);
+
+    ThreadSlot& slot = GetThreadSlot();
+
+    // Only contended by EndFrame
+    unique_lock<mutex> lock(slot.mutex);
+
+    const uint32_t ordinal = slot.ordinal++;
+    const uint32_t swapchainWidth = _swapchainWidth.load(memory_order_relaxed);
+    const uint32_t swapchainHeight = _swapchainHeight.load(memory_order_relaxed);
+
+    RenderTargetUsage targets[MAX_RENDER_TARGETS];
+    uint32_t targetCount = 0;
+    bool swapchainSized = false;
+
+    device* device = cmd_list->get_device();
+    for (uint32_t i = 0; i < rtvCount && i < MAX_RENDER_TARGETS; i++)
+    {
+        if (rtvs[i].handle == 0)
+        {
+            continue;
+        }
+
+        // Views are described once per frame, a handle reused within the frame for another view is taken as the old one
+        const auto& [it, inserted] = slot.views.try_emplace(rtvs[i].handle);
+        if (inserted)
+        {
+            const resource res = device->get_resource_from_view(rtvs[i]);
+            if (res.handle != 0)
+            {
+                const resource_desc desc = device->get_resource_desc(res);
+                it->second = RenderTargetUsage{ desc.texture.format, desc.texture.width, desc.texture.height };
+            }
+        }
+
+        const RenderTargetUsage& target = it->second;
+        targets[targetCount++] = target;
+        swapchainSized |= target.width == swapchainWidth && target.height == swapchainHeight;
+    }
+
+    if (targetCount == 0 && dsv.handle != 0)
+    {
+        slot.lastDepthDraw = ordinal;
+    }
+
+    if (pixelShaderHash != 0)
+    {
+        Record(slot.frame[USAGE_PIXEL][pixelShaderHash], ordinal, targets, targetCount, swapchainSized);
+    }
+
+    if (vertexShaderHash != 0)
+    {
+        Record(slot.frame[USAGE_VERTEX][vertexShaderHash], ordinal, targets, targetCount, swapchainSized);
+    }
+}
+
+void ShaderUsage::EndFrame(bool collecting, uint32_t swapchainWidth, uint32_t swapchainHeight)
+{
+    _swapchainWidth.store(swapchainWidth, memory_order_relaxed);
+    _swapchainHeight.store(swapchainHeight, memory_order_relaxed);
+
+    if (!IsCollecting())
+    {
+        _collecting.store(collecting, memory_order_relaxed);
+        return;
+    }
+
+    {
+        unique_lock<mutex> lock(_slotMutex);
+
+        // A shader drawing on several threads counts once per frame, after depth only if it was on all of them
+        for (auto& slot : _slots)
+        {
+            unique_lock<mutex> slotLock(slot->mutex);
+
+            for (uint32_t stage = 0; stage < USAGE_STAGE_COUNT; stage++)
+            {
+                for (const auto& [hash, usage] : slot->frame[stage])
+                {
+                    const bool afterDepth = slot->lastDepthDraw != UINT32_MAX && usage.statistics.firstDraw > slot->lastDepthDraw;
+
+                    const auto& [it, inserted] = _frame[stage].try_emplace(hash);
+                    it->second.afterDepth = inserted ? afterDepth : it->second.afterDepth && afterDepth;
+                    Merge(it->second.statistics, usage.statistics);
+                }
+
+                slot->frame[stage].clear();
+            }
+
+            slot->views.clear();
+            slot->ordinal = 0;
+            slot->lastDepthDraw = UINT32_MAX;
+        }
+    }
+
+    for (uint32_t stage = 0; stage < USAGE_STAGE_COUNT; stage++)
+    {
+        for (const auto& [hash, usage] : _frame[stage])
+        {
+            ShaderUsageStatistics& statistics = _statistics[stage][hash];
+            Merge(statistics, usage.statistics);
+            statistics.frameCount++;
+            statistics.framesAfterDepth += usage.afterDepth ? 1 : 0;
+        }
+
+        _frame[stage].clear();
+    }
+
+    _collecting.store(collecting, memory_order_relaxed);
+}
+
+void ShaderUsage::Reset()
+{
+    {
+        unique_lock<mutex> lock(_slotMutex);
+
+        for (auto& slot : _slots)
+        {
+            unique_lock<mutex> slotLock(slot->mutex);
+
+            for (auto& frame : slot->frame)
+            {
+                frame.clear();
+            }
+
+            slot->views.clear();
+            slot->ordinal = 0;
+            slot->lastDepthDraw = UINT32_MAX;
+        }
+    }
+
+    for (uint32_t stage = 0; stage < USAGE_STAGE_COUNT; stage++)
+    {
+        _statistics[stage].clear();
+        _frame[stage].clear();
+    }
+}
+
+const ShaderUsageStatistics* ShaderUsage::Get(ShaderUsageStage stage, uint32_t hash)
+{
+    const auto it = _statistics[stage].find(hash);
+    return it == _statistics[stage].end() ? nullptr : &it->second;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <reshade.hpp>
+
+namespace ShaderToggler
+{
+    enum ShaderUsageStage : uint32_t
+    {
+        USAGE_PIXEL = 0,
+        USAGE_VERTEX,
+        USAGE_STAGE_COUNT
+    };
+
+    struct RenderTargetUsage
+    {
+        reshade::api::format format = reshade::api::format::unknown;
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        bool operator==(const RenderTargetUsage& rhs) const { return format == rhs.format && width == rhs.width && height == rhs.height; }
+    };
+
+    /// <summary>
+    /// What a shader did during the collection phase. Draw ordinals count the draws of the recording thread within a frame,
+    /// which is the frame's draw order on immediate-context APIs.
+    /// </summary>
+    struct ShaderUsageStatistics
+    {
+        static constexpr uint32_t MAX_TARGETS = 4;
+
+        uint64_t drawCount = 0;
+        uint32_t frameCount = 0;				// frames the shader drew in
+        uint32_t framesAfterDepth = 0;			// frames in which all of its draws came after the frame's last depth-only draw
+        uint32_t firstDraw = UINT32_MAX;		// lowest ordinal of its first draw in a frame
+        uint32_t lastDraw = 0;					// highest ordinal of its last draw in a frame
+        bool swapchainSized = false;			// drew to a color target the size of the back buffer
+        uint32_t targetCount = 0;
+        RenderTargetUsage targets[MAX_TARGETS];	// distinct color targets drawn to, the first MAX_TARGETS seen
+
+        void AddTarget(const RenderTargetUsage& target);
+        bool HasTargetFormat(reshade::api::format format) const;
+    };
+
+    /// <summary>
+    /// Gathers per-shader statistics of the draws made while shaders are collected for hunting. Every thread records into its
+    /// own slot, the slots are merged into the statistics once per present. The statistics are only read from the present
+    /// thread.
+    /// </summary>
+    class __declspec(novtable) ShaderUsage final
+    {
+    public:
+        // D3D and Vulkan don't bind more color targets than this
+        static constexpr uint32_t MAX_RENDER_TARGETS = 8;
+
+        static bool IsCollecting() { return _collecting.load(std::memory_order_relaxed); }
+
+        /// <summary>
+        /// Records a draw with the given shaders bound, 0 for a stage without a known shader.
+        /// </summary>
+        static void OnDraw(reshade::api::command_list* cmd_list, uint32_t pixelShaderHash, uint32_t vertexShaderHash, const reshade::api::resource_view* rtvs, uint32_t rtvCount, reshade::api::resource_view dsv);
+
+        /// <summary>
+        /// Merges the frame the threads recorded and sets whether the next frame is collected. Called from the present thread.
+        /// </summary>
+        static void EndFrame(bool collecting, uint32_t swapchainWidth, uint32_t swapchainHeight);
+
+        /// <summary>
+        /// Drops all statistics, called when a new collection phase starts.
+        /// </summary>
+        static void Reset();
+
+        static const ShaderUsageStatistics* Get(ShaderUsageStage stage, uint32_t hash);
+
+    private:
+        struct FrameUsage
+        {
+            ShaderUsageStatistics statistics;
+            bool afterDepth = false;
+        };
+
+        struct ThreadSlot
+        {
+            std::mutex mutex;
+            uint32_t ordinal = 0;
+            uint32_t lastDepthDraw = UINT32_MAX;
+            std::unordered_map<uint32_t, FrameUsage> frame[USAGE_STAGE_COUNT];
+            std::unordered_map<uint64_t, RenderTargetUsage> views;	// descriptions of the views seen this frame
+        };
+
+        static ThreadSlot& GetThreadSlot();
+        static void Record(FrameUsage& usage, uint32_t ordinal, const RenderTargetUsage* targets, uint32_t targetCount, bool swapchainSized);
+
+        static std::atomic_bool _collecting;
+        static std::atomic_uint32_t _swapchainWidth;
+        static std::atomic_uint32_t _swapchainHeight;
+        static std::mutex _slotMutex;
+        static std::vector<std::unique_ptr<ThreadSlot>> _slots;
+        static std::unordered_map<uint32_t, ShaderUsageStatistics> _statistics[USAGE_STAGE_COUNT];
+        static std::unordered_map<uint32_t, FrameUsage> _frame[USAGE_STAGE_COUNT];
+    };
+}
@@ -0,0 +1,109 @@
+#include <cstring>
+#include <cctype>
+#include "Signature.h"
+#include "crc32_hash.hpp"
+
+using namespace Shim;
+using namespace std;
+
+static inline uint8_t HexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return static_cast<uint8_t>(c - '0');
+    if (c >= 'a' && c <= 'f')
+        return static_cast<uint8_t>(c - 'a' + 10);
+    if (c >= 'A' && c <= 'F')
+        return static_cast<uint8_t>(c - 'A' + 10);
+
+    return 0;
+}
+
+Signature::Signature(string_view pattern)
+{
+    for (size_t i = 0; i < pattern.size();)
+    {
+        if (isspace(static_cast<unsigned char>(pattern[i])))
+        {
+            i++;
+            continue;
+        }
+
+        if (pattern[i] == '?')
+        {
+            _bytes.push_back(0);
+            _mask.push_back(0);
+            i += (i + 1 < pattern.size() && pattern[i + 1] == '?') ? 2 : 1;
+        }
+        else if (i + 1 < pattern.size())
+        {
+            _bytes.push_back(static_cast<uint8_t>(HexValue(pattern[i]) << 4 | HexValue(pattern[i + 1])));
+            _mask.push_back(0xFF);
+            i += 2;
+        }
+        else
+        {
+            break;
+        }
+
+        if (!_pattern.empty())
+        {
+            _pattern += ' ';
+        }
+        _pattern += _mask.back() ? string{ static_cast<char>(toupper(pattern[i - 2])), static_cast<char>(toupper(pattern[i - 1])) } : string("??");
+    }
+
+    while (_anchor < _mask.size() && _mask[_anchor] == 0)
+    {
+        _anchor++;
+    }
+
+    _id = compute_crc32(reinterpret_cast<const uint8_t*>(_pattern.data()), _pattern.size());
+}
+
+bool Signature::Matches(const uint8_t* data) const
+{
+    for (size_t i = 0; i < _bytes.size(); i++)
+    {
+        if ((data[i] & _mask[i]) != _bytes[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const uint8_t* Signature::Find(const uint8_t* begin, size_t size) const
+{
+    if (_bytes.empty() || size < _bytes.size())
+    {
+        return nullptr;
+    }
+
+    const uint8_t* last = begin + size - _bytes.size();
+
+    if (_anchor >= _bytes.size())
+    {
+        return begin;
+    }
+
+    // Let memchr skip ahead to candidates for the first fixed byte
+    for (const uint8_t* it = begin + _anchor; it <= last + _anchor;)
+    {
+        it = static_cast<const uint8_t*>(memchr(it, _bytes[_anchor], static_cast<size_t>(last + _anchor - it) + 1));
+        if (it == nullptr)
+        {
+            break;
+        }
+
+        const uint8_t* candidate = it - _anchor;
+        if (Matches(candidate))
+        {
+            return candidate;
+        }
+
+        it++;
+    }
+
+    return nullptr;
+}
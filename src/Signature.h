@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Shim
+{
+    // Byte pattern in the usual "48 8B ?? C1" notation, ?? being a wildcard
+    class Signature final
+    {
+    public:
+        explicit Signature(std::string_view pattern);
+
+        bool Matches(const uint8_t* data) const;
+        const uint8_t* Find(const uint8_t* begin, size_t size) const;
+
+        size_t Size() const { return _bytes.size(); }
+        const std::vector<uint8_t>& Bytes() const { return _bytes; }
+        const std::vector<uint8_t>& Mask() const { return _mask; }
+        const std::string& Pattern() const { return _pattern; }
+        uint32_t Id() const { return _id; }
+
+    private:
+        std::string _pattern;
+        std::vector<uint8_t> _bytes;
+        std::vector<uint8_t> _mask;
+        size_t _anchor = 0;	// first non-wildcard byte
+        uint32_t _id = 0;
+    };
+}
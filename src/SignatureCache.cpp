@@ -0,0 +1,107 @@
+#include <climits>
+#include "SignatureCache.h"
+
+using namespace Shim;
+using namespace std;
+
+static constexpr auto SIGNATURE_CACHE_SECTION = "SignatureCache";
+
+ModuleIdentity SignatureCache::_identity;
+unordered_map<uint32_t, uint32_t> SignatureCache::_rvas;
+bool SignatureCache::_dirty = false;
+mutex SignatureCache::_mutex;
+
+void SignatureCache::Load(CDataFile& iniFile)
+{
+    unique_lock<mutex> lock(_mutex);
+
+    _rvas.clear();
+
+    const string fileSize = iniFile.GetValue("ExecutableSize", SIGNATURE_CACHE_SECTION);
+    _identity.fileSize = fileSize.size() > 0 ? strtoull(fileSize.c_str(), nullptr, 10) : 0;
+    _identity.timestamp = iniFile.GetUInt("ExecutableTimestamp", SIGNATURE_CACHE_SECTION);
+    _identity.checksum = iniFile.GetUInt("ExecutableChecksum", SIGNATURE_CACHE_SECTION);
+
+    const int amountSignatures = iniFile.GetInt("AmountSignatures", SIGNATURE_CACHE_SECTION);
+    for (int i = 0; i < amountSignatures; i++)
+    {
+        const uint32_t id = iniFile.GetUInt("Signature" + std::to_string(i), SIGNATURE_CACHE_SECTION);
+        const uint32_t rva = iniFile.GetUInt("RVA" + std::to_string(i), SIGNATURE_CACHE_SECTION);
+        if (id != UINT_MAX && rva != UINT_MAX)
+        {
+            _rvas[id] = rva;
+        }
+    }
+}
+
+void SignatureCache::Save(CDataFile& iniFile)
+{
+    unique_lock<mutex> lock(_mutex);
+
+    iniFile.DeleteSection(SIGNATURE_CACHE_SECTION);
+
+    if (_rvas.size() == 0)
+    {
+        return;
+    }
+
+    iniFile.SetValue("ExecutableSize", std::to_string(_identity.fileSize), "", SIGNATURE_CACHE_SECTION);
+    iniFile.SetUInt("ExecutableTimestamp", _identity.timestamp, "", SIGNATURE_CACHE_SECTION);
+    iniFile.SetUInt("ExecutableChecksum", _identity.checksum, "", SIGNATURE_CACHE_SECTION);
+
+    int counter = 0;
+    for (const auto& [id, rva] : _rvas)
+    {
+        iniFile.SetUInt("Signature" + std::to_string(counter), id, "", SIGNATURE_CACHE_SECTION);
+        iniFile.SetUInt("RVA" + std::to_string(counter), rva, "", SIGNATURE_CACHE_SECTION);
+        counter++;
+    }
+    iniFile.SetInt("AmountSignatures", counter, "", SIGNATURE_CACHE_SECTION);
+
+    _dirty = false;
+}
+
+bool SignatureCache::IsDirty()
+{
+    unique_lock<mutex> lock(_mutex);
+
+    return _dirty;
+}
+
+void SignatureCache::SetModuleIdentity(const ModuleIdentity& identity)
+{
+    unique_lock<mutex> lock(_mutex);
+
+    if (!(_identity == identity))
+    {
+        _identity = identity;
+        _rvas.clear();
+        _dirty = true;
+    }
+}
+
+bool SignatureCache::TryGet(const Signature& sig, uint32_t& rva)
+{
+    unique_lock<mutex> lock(_mutex);
+
+    const auto& it = _rvas.find(sig.Id());
+    if (it == _rvas.end())
+    {
+        return false;
+    }
+
+    rva = it->second;
+    return true;
+}
+
+void SignatureCache::Set(const Signature& sig, uint32_t rva)
+{
+    unique_lock<mutex> lock(_mutex);
+
+    const auto& it = _rvas.find(sig.Id());
+    if (it == _rvas.end() || it->second != rva)
+    {
+        _rvas[sig.Id()] = rva;
+        _dirty = true;
+    }
+}
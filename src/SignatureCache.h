@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include "CDataFile.h"
+#include "Signature.h"
+
+namespace Shim
+{
+    struct ModuleIdentity
+    {
+        uint64_t fileSize = 0;
+        uint32_t timestamp = 0;
+        uint32_t checksum = 0;
+
+        bool operator==(const ModuleIdentity& rhs) const
+        {
+            return fileSize == rhs.fileSize && timestamp == rhs.timestamp && checksum == rhs.checksum;
+        }
+    };
+
+    // Remembers the RVA signatures resolved to in the executable between launches. Entries are only valid for the exact
+    // executable they were found in, any change in file size, link timestamp or PE checksum drops the whole cache.
+    class SignatureCache final
+    {
+    public:
+        static void Load(CDataFile& iniFile);
+        static void Save(CDataFile& iniFile);
+        static bool IsDirty();
+
+        static void SetModuleIdentity(const ModuleIdentity& identity);
+        static bool TryGet(const Signature& sig, uint32_t& rva);
+        static void Set(const Signature& sig, uint32_t rva);
+
+    private:
+        static ModuleIdentity _identity;
+        static std::unordered_map<uint32_t, uint32_t> _rvas;
+        static bool _dirty;
+        static std::mutex _mutex;
+    };
+}
@@ -0,0 +1,248 @@
+#include <thread>
+#include <algorithm>
+#include <bit>
+#include "SignatureScanner.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SIGNATURE_SCANNER_SSE2
+#endif
+
+using namespace Shim;
+using namespace std;
+
+// Regions larger than this are split further so a single big code section doesn't end up on one thread
+static constexpr size_t MIN_CHUNK_SIZE = 4 * 1024 * 1024;
+
+void SignatureScanner::Add(const Signature* sig)
+{
+    Entry entry;
+    entry.sig = sig;
+
+    const vector<uint8_t>& mask = sig->Mask();
+    while (entry.anchor < mask.size() && mask[entry.anchor] == 0)
+    {
+        entry.anchor++;
+    }
+
+    // Prefer the next fixed byte right after the anchor, two adjacent bytes filter out far more candidates than one
+    entry.anchorNext = entry.anchor;
+    for (size_t i = entry.anchor + 1; i < mask.size(); i++)
+    {
+        if (mask[i] != 0)
+        {
+            entry.anchorNext = i;
+            break;
+        }
+    }
+
+    _maxSize = std::max(_maxSize, sig->Size());
+    _entries.push_back(entry);
+
+    if (entry.anchor >= sig->Size())
+    {
+        return;
+    }
+
+    // Signatures starting with the same fixed byte at the same offset share one compare per block
+    const uint8_t first = sig->Bytes()[entry.anchor];
+    auto filter = std::find_if(_filters.begin(), _filters.end(), [&](const Filter& f) { return f.anchor == entry.anchor && f.first == first; });
+    if (filter == _filters.end())
+    {
+        _filters.push_back(Filter{ entry.anchor, sig->Size(), first });
+        filter = _filters.end() - 1;
+    }
+
+    filter->minSize = std::min(filter->minSize, sig->Size());
+    filter->entries.push_back(static_cast<uint32_t>(_entries.size() - 1));
+}
+
+bool SignatureScanner::Verify(uint32_t index, const uint8_t* p, vector<const uint8_t*>& results) const
+{
+    const Entry& entry = _entries[index];
+    const Signature& sig = *entry.sig;
+
+    if (results[index] != nullptr || p[entry.anchorNext] != sig.Bytes()[entry.anchorNext] || !sig.Matches(p))
+    {
+        return false;
+    }
+
+    results[index] = p;
+    return true;
+}
+
+void SignatureScanner::ScanRange(const uint8_t* begin, const uint8_t* end, const uint8_t* regionEnd, vector<const uint8_t*>& results) const
+{
+    // begin/end bound the candidate start positions, regionEnd bounds the bytes that may be read. Positions are visited in
+    // ascending order, so the first match of a signature is its lowest address in the range
+    size_t pending = 0;
+    for (size_t e = 0; e < _entries.size(); e++)
+    {
+        const Signature& sig = *_entries[e].sig;
+
+        if (results[e] != nullptr || sig.Size() == 0 || static_cast<size_t>(regionEnd - begin) < sig.Size())
+        {
+            continue;
+        }
+
+        if (_entries[e].anchor >= sig.Size())
+        {
+            // Only wildcards, matches everywhere
+            if (begin < end)
+            {
+                results[e] = begin;
+            }
+            continue;
+        }
+
+        pending++;
+    }
+
+    const uint8_t* p = begin;
+
+#ifdef SIGNATURE_SCANNER_SSE2
+    // Every byte any signature may read from a start position in the block lies inside the region
+    const uint8_t* blockLast = static_cast<size_t>(regionEnd - begin) >= _maxSize + 31 ? std::min(end, regionEnd - _maxSize - 31) : begin;
+
+    for (; p < blockLast && pending > 0; p += 32)
+    {
+        for (const Filter& filter : _filters)
+        {
+            const __m128i first = _mm_set1_epi8(static_cast<char>(filter.first));
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + filter.anchor));
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + filter.anchor + 16));
+            uint32_t candidates = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, first))) |
+                static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, first))) << 16;
+
+            while (candidates != 0)
+            {
+                const uint8_t* candidate = p + std::countr_zero(candidates);
+                candidates &= candidates - 1;
+
+                if (candidate >= end)
+                {
+                    break;
+                }
+
+                for (uint32_t e : filter.entries)
+                {
+                    if (Verify(e, candidate, results))
+                    {
+                        pending--;
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+    // Whatever is left near the region's end, where each signature's own size bounds its start positions
+    for (; p < end && pending > 0; p++)
+    {
+        for (const Filter& filter : _filters)
+        {
+            // The anchor byte itself may lie past the region's end
+            if (static_cast<size_t>(regionEnd - p) < filter.minSize || p[filter.anchor] != filter.first)
+            {
+                continue;
+            }
+
+            for (uint32_t e : filter.entries)
+            {
+                if (static_cast<size_t>(regionEnd - p) >= _entries[e].sig->Size() && Verify(e, p, results))
+                {
+                    pending--;
+                }
+            }
+        }
+    }
+}
+
+vector<const uint8_t*> SignatureScanner::Scan(const uint8_t* data, size_t size, uint32_t maxThreads) const
+{
+    return Scan(vector<ScanRegion>{ ScanRegion{ data, size } }, maxThreads);
+}
+
+vector<const uint8_t*> SignatureScanner::Scan(const vector<ScanRegion>& regions, uint32_t maxThreads) const
+{
+    struct Chunk
+    {
+        const uint8_t* begin;
+        const uint8_t* end;
+        const uint8_t* regionEnd;
+    };
+
+    if (maxThreads == 0)
+    {
+        maxThreads = std::max(1u, thread::hardware_concurrency());
+    }
+
+    vector<Chunk> chunks;
+    for (const auto& region : regions)
+    {
+        if (region.data == nullptr || region.size == 0)
+        {
+            continue;
+        }
+
+        const uint8_t* regionEnd = region.data + region.size;
+        const size_t chunkSize = std::max(MIN_CHUNK_SIZE, region.size / maxThreads + 1);
+
+        // Chunks only split candidate start positions, matches may still read past the chunk up to the region end
+        for (const uint8_t* begin = region.data; begin < regionEnd; begin += std::min(chunkSize, static_cast<size_t>(regionEnd - begin)))
+        {
+            chunks.push_back(Chunk{ begin, begin + std::min(chunkSize, static_cast<size_t>(regionEnd - begin)), regionEnd });
+        }
+    }
+
+    vector<vector<const uint8_t*>> chunkResults(chunks.size(), vector<const uint8_t*>(_entries.size(), nullptr));
+
+    const uint32_t threadCount = static_cast<uint32_t>(std::min<size_t>(maxThreads, chunks.size()));
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            // Signatures already found in the region's previous chunk have their lowest address
+            if (i > 0 && chunks[i].regionEnd == chunks[i - 1].regionEnd)
+            {
+                chunkResults[i] = chunkResults[i - 1];
+            }
+
+            ScanRange(chunks[i].begin, chunks[i].end, chunks[i].regionEnd, chunkResults[i]);
+        }
+    }
+    else
+    {
+        vector<thread> workers;
+        workers.reserve(threadCount);
+
+        for (uint32_t t = 0; t < threadCount; t++)
+        {
+            workers.emplace_back([&, t]() {
+                for (size_t i = t; i < chunks.size(); i += threadCount)
+                {
+                    ScanRange(chunks[i].begin, chunks[i].end, chunks[i].regionEnd, chunkResults[i]);
+                }
+                });
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    vector<const uint8_t*> results(_entries.size(), nullptr);
+    for (const auto& chunkResult : chunkResults)
+    {
+        for (size_t e = 0; e < _entries.size(); e++)
+        {
+            if (chunkResult[e] != nullptr && (results[e] == nullptr || chunkResult[e] < results[e]))
+            {
+                results[e] = chunkResult[e];
+            }
+        }
+    }
+
+    return results;
+}
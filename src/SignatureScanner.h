@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Signature.h"
+
+namespace Shim
+{
+    struct ScanRegion
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    // Matches any number of signatures in a single pass over one or more memory regions. Candidates are filtered with SIMD
+    // compares on the first fixed byte, one compare for all signatures sharing it, then checked on a second fixed byte and
+    // verified with the full wildcard mask. Regions can be scanned in parallel, which must not be requested under the loader
+    // lock since the worker threads couldn't start. Works on arbitrary byte buffers, there's no dependency on the process or
+    // the PE image.
+    class SignatureScanner final
+    {
+    public:
+        void Add(const Signature* sig);
+        size_t Count() const { return _entries.size(); }
+
+        // Returns the lowest matching address per added signature, in the order they were added. nullptr if not found.
+        // maxThreads 0 uses all hardware threads, 1 scans on the calling thread only
+        std::vector<const uint8_t*> Scan(const uint8_t* data, size_t size, uint32_t maxThreads = 1) const;
+        std::vector<const uint8_t*> Scan(const std::vector<ScanRegion>& regions, uint32_t maxThreads = 1) const;
+
+    private:
+        struct Entry
+        {
+            const Signature* sig = nullptr;
+            size_t anchor = 0;		// offset of the first filter byte
+            size_t anchorNext = 0;	// offset of the second filter byte, equal to anchor if the signature has only one fixed byte
+        };
+
+        // Signatures sharing the fixed byte at their anchor offset
+        struct Filter
+        {
+            size_t anchor = 0;
+            size_t minSize = 0;		// smallest signature sharing it, a start position closer than that to the region's end has no candidates
+            uint8_t first = 0;
+            std::vector<uint32_t> entries;
+        };
+
+        bool Verify(uint32_t index, const uint8_t* p, std::vector<const uint8_t*>& results) const;
+        void ScanRange(const uint8_t* begin, const uint8_t* end, const uint8_t* regionEnd, std::vector<const uint8_t*>& results) const;
+
+        std::vector<Entry> _entries;
+        std::vector<Filter> _filters;
+        size_t _maxSize = 0;
+    };
+}
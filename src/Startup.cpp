@@ -0,0 +1,138 @@
+#include <windows.h>
+#include <format>
+#include <reshade.hpp>
+#include "Startup.h"
+
+using namespace ShaderToggler;
+using namespace std;
+
+function<void()> Startup::_init;
+chrono::steady_clock::time_point Startup::_begin;
+atomic_uint32_t Startup::_state = STATE_PENDING;
+atomic_bool Startup::_stopping = false;
+mutex Startup::_installMutex;
+mutex Startup::_mutex;
+condition_variable Startup::_ready;
+
+// Set on the thread running the initialization, hooks it triggers itself must not wait for it
+static thread_local bool t_initializing = false;
+// Set on the worker started by Begin
+static thread_local bool t_worker = false;
+
+void Startup::Begin(function<void()> init)
+{
+    _init = std::move(init);
+    _begin = chrono::steady_clock::now();
+
+    // The worker keeps the module loaded until it's done, so the addon can't be unloaded under a running stage. Taken here,
+    // before the worker exists, so there's no moment a detach could slip in between.
+    HMODULE module = nullptr;
+    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&Startup::Begin), &module);
+
+    // Doesn't start running before DllMain returns and releases the loader lock
+    const HANDLE worker = CreateThread(nullptr, 0, [](LPVOID reference) -> DWORD {
+        t_worker = true;
+        TryRun();
+
+        // Unloads the module if it was released meanwhile, which has to happen after this thread is out of its code
+        if (reference != nullptr)
+        {
+            FreeLibraryAndExitThread(static_cast<HMODULE>(reference), 0);
+        }
+        return 0;
+        }, module, 0, nullptr);
+
+    if (worker == nullptr)
+    {
+        // The reference stays, releasing it isn't allowed under the loader lock. Wait runs the initialization instead.
+        reshade::log_message(reshade::log_level::error, "Startup: could not start the initialization thread");
+        return;
+    }
+
+    CloseHandle(worker);
+}
+
+
+bool Startup::IsWorkerThread()
+{
+    return t_worker;
+}
+
+
+void Startup::Stage(const char* name, const function<void()>& stage)
+{
+    if (_stopping.load(memory_order_acquire))
+    {
+        reshade::log_message(reshade::log_level::warning, std::format("Startup: {} skipped, the addon is being unloaded", name).c_str());
+        return;
+    }
+
+    const auto start = chrono::steady_clock::now();
+    stage();
+    const auto end = chrono::steady_clock::now();
+
+    reshade::log_message(reshade::log_level::info, std::format("Startup: {} took {:.2f} ms", name, chrono::duration<double, milli>(end - start).count()).c_str());
+}
+
+
+bool Startup::Install(const function<bool()>& install)
+{
+    unique_lock<mutex> lock(_installMutex);
+
+    if (_stopping.load(memory_order_relaxed))
+    {
+        return false;
+    }
+
+    return install();
+}
+
+
+bool Startup::Stop()
+{
+    unique_lock<mutex> lock(_installMutex);
+
+    _stopping.store(true, memory_order_release);
+
+    return _state.load(memory_order_acquire) != STATE_PENDING;
+}
+
+
+bool Startup::TryRun()
+{
+    uint32_t expected = STATE_PENDING;
+    if (!_state.compare_exchange_strong(expected, STATE_RUNNING, memory_order_acq_rel))
+    {
+        return false;
+    }
+
+    const auto start = chrono::steady_clock::now();
+
+    t_initializing = true;
+    _init();
+    t_initializing = false;
+
+    const auto end = chrono::steady_clock::now();
+    reshade::log_message(reshade::log_level::info, std::format("Startup: ready after {:.2f} ms, {:.2f} ms of it queued", chrono::duration<double, milli>(end - _begin).count(),
+        chrono::duration<double, milli>(start - _begin).count()).c_str());
+
+    {
+        unique_lock<mutex> lock(_mutex);
+        _state.store(STATE_READY, memory_order_release);
+    }
+    _ready.notify_all();
+
+    return true;
+}
+
+
+void Startup::WaitSlow()
+{
+    if (t_initializing || TryRun())
+    {
+        return;
+    }
+
+    unique_lock<mutex> lock(_mutex);
+    _ready.wait(lock, [] { return _state.load(memory_order_acquire) == STATE_READY; });
+}
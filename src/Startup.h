@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace ShaderToggler
+{
+    /// <summary>
+    /// Readiness gate of the addon's initialization, which runs on a worker thread instead of under the loader lock in
+    /// DllMain. Per-frame hooks skip their work until IsReady. Hooks which mustn't miss anything call Wait, which runs the
+    /// initialization on the calling thread if the worker hasn't picked it up yet, so it can't deadlock on a worker held
+    /// back by the loader lock.
+    /// </summary>
+    class __declspec(novtable) Startup final
+    {
+    public:
+        /// <summary>
+        /// Starts running init on a worker thread. Called once from DllMain. The worker holds a reference to the module until
+        /// init returns, so the addon is only detached from while it runs when the process exits.
+        /// </summary>
+        static void Begin(std::function<void()> init);
+
+        static bool IsReady() { return _state.load(std::memory_order_acquire) == STATE_READY; }
+
+        /// <summary>
+        /// True on the worker started by Begin. It only runs once DllMain has returned, so unlike a thread running the
+        /// initialization from Wait it's known not to hold the loader lock and may start and join threads of its own.
+        /// </summary>
+        static bool IsWorkerThread();
+
+        /// <summary>
+        /// Returns once the initialization has finished. A single atomic load once it has.
+        /// </summary>
+        static void Wait()
+        {
+            if (!IsReady())
+            {
+                WaitSlow();
+            }
+        }
+
+        /// <summary>
+        /// Runs one stage of the initialization and logs how long it took. Skipped once Stop was called.
+        /// </summary>
+        static void Stage(const char* name, const std::function<void()>& stage);
+
+        /// <summary>
+        /// Runs install, which creates or enables hooks, unless Stop was called. Returns false if it was skipped or failed.
+        /// Stop waits for a running install under the loader lock, so install mustn't need it: resolve modules and exports
+        /// before calling this.
+        /// </summary>
+        static bool Install(const std::function<bool()>& install);
+
+        /// <summary>
+        /// Called from DllMain on detach, which only overlaps the worker when the process exits and terminated it. Stages
+        /// which haven't started are skipped and no hook is installed once this returns, an install in progress is waited for.
+        /// Returns true if the initialization had started, hooks it installed have to be removed.
+        /// </summary>
+        static bool Stop();
+
+    private:
+        enum State : uint32_t
+        {
+            STATE_PENDING = 0,
+            STATE_RUNNING,
+            STATE_READY
+        };
+
+        static bool TryRun();
+        static void WaitSlow();
+
+        static std::function<void()> _init;
+        static std::chrono::steady_clock::time_point _begin;
+        static std::atomic_uint32_t _state;
+        static std::atomic_bool _stopping;
+        static std::mutex _installMutex;
+        static std::mutex _mutex;
+        static std::condition_variable _ready;
+    };
+}
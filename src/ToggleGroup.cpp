@@ -30,7 +30,10 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <charconv>
 #include <sstream>
+#include <vector>
 #include "stdafx.h"
 #include "ToggleGroup.h"
 
@@ -38,6 +41,92 @@ using namespace std;
 
 namespace ShaderToggler
 {
+    // Shader hash lists are stored as one line: the hashes sorted ascending, the first one in hex and every next one as the hex
+    // difference to its predecessor. Sorted hashes are spread evenly so the deltas are a couple of digits shorter than the
+    // hashes, and there are no per-hash keys to parse.
+    static string encodeHashes(const unordered_set<uint32_t>& hashes)
+    {
+        vector<uint32_t> sorted(hashes.begin(), hashes.end());
+        std::sort(sorted.begin(), sorted.end());
+
+        string encoded;
+        encoded.reserve(sorted.size() * 8);
+
+        char buffer[8];
+        uint32_t previous = 0;
+        for (const auto hash : sorted)
+        {
+            if (!encoded.empty())
+            {
+                encoded += ',';
+            }
+
+            const auto result = std::to_chars(buffer, buffer + sizeof(buffer), hash - previous, 16);
+            encoded.append(buffer, result.ptr);
+            previous = hash;
+        }
+
+        return encoded;
+    }
+
+
+    static void decodeHashes(const string& encoded, unordered_set<uint32_t>& hashes)
+    {
+        const char* current = encoded.data();
+        const char* const end = current + encoded.size();
+
+        uint32_t hash = 0;
+        while (current < end)
+        {
+            uint32_t delta;
+            const auto result = std::from_chars(current, end, delta, 16);
+            if (result.ec != std::errc())
+            {
+                break;
+            }
+
+            hash += delta;
+            hashes.emplace(hash);
+
+            current = result.ptr;
+            if (current < end && *current == ',')
+            {
+                current++;
+            }
+        }
+    }
+
+
+    static void loadHashes(CDataFile& iniFile, const string& category, unordered_set<uint32_t>& hashes)
+    {
+        const int amount = iniFile.GetInt("AmountHashes", category);
+        if (amount > 0)
+        {
+            hashes.reserve(amount);
+        }
+
+        const string encoded = iniFile.GetString("Hashes", category);
+        if (encoded.size() > 0)
+        {
+            decodeHashes(encoded, hashes);
+            return;
+        }
+
+        // key per hash, as written by older versions
+        for (int i = 0; i < amount; i++)
+        {
+            uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), category);
+            if (hash != UINT_MAX)
+            {
+                hashes.emplace(hash);
+            }
+        }
+    }
+
+
+    atomic_uint32_t ToggleGroup::s_hotStateVersion = 0;
+    atomic_uint32_t ToggleGroup::s_hashVersion = 0;
+
     ToggleGroup::ToggleGroup(string name, int id)
     {
         _name = name.size() > 0 ? name : "Default";
@@ -52,6 +141,7 @@ namespace ShaderToggler
         _extractResourceViews = false;
         _matchSwapchainResolution = true;
         _copyTextureBinding = false;
+        _hashStamp = ++s_hashVersion;
     }
 
 
@@ -69,8 +159,10 @@ namespace ShaderToggler
     }
 
 
-    void ToggleGroup::storeCollectedHashes(const unordered_set<uint32_t> pixelShaderHashes, const unordered_set<uint32_t> vertexShaderHashes)
+    void ToggleGroup::storeCollectedHashes(const unordered_set<uint32_t>& pixelShaderHashes, const unordered_set<uint32_t>& vertexShaderHashes)
     {
+        _hashStamp = ++s_hashVersion;
+
         _vertexShaderHashes.clear();
         _pixelShaderHashes.clear();
 
@@ -99,6 +191,7 @@ namespace ShaderToggler
 
     void ToggleGroup::clearHashes()
     {
+        _hashStamp = ++s_hashVersion;
         _pixelShaderHashes.clear();
         _vertexShaderHashes.clear();
     }
@@ -114,9 +207,10 @@ namespace ShaderToggler
     }
 
 
-    bool ToggleGroup::SetVarMapping(uintptr_t offset, string& variable, bool prev)
+    bool ToggleGroup::SetVarMapping(uintptr_t offset, string& variable, bool prev, uint32_t elements)
     {
-        _varOffsetMapping.emplace(variable, make_tuple(offset, prev));
+        _varOffsetMapping.emplace(variable, make_tuple(offset, prev, elements));
+        _varMappingVersion++;
 
         return true; // do some sanity checking?
     }
@@ -125,41 +219,47 @@ namespace ShaderToggler
     bool ToggleGroup::RemoveVarMapping(string& variable)
     {
         _varOffsetMapping.erase(variable);
+        _varMappingVersion++;
 
         return true; // do some sanity checking?
     }
 
 
-    void ToggleGroup::saveState(CDataFile& iniFile, int groupCounter) const
+    void ToggleGroup::saveState(CDataFile& iniFile, int groupCounter, EncodedHashes* encoded) const
     {
         const string sectionRoot = "Group" + std::to_string(groupCounter);
         const string vertexHashesCategory = sectionRoot + "_VertexShaders";
         const string pixelHashesCategory = sectionRoot + "_PixelShaders";
         const string constantsCategory = sectionRoot + "_Constants";
 
-        int counter = 0;
-        for (const auto hash : _vertexShaderHashes)
+        EncodedHashes encodedHere;
+        if (encoded == nullptr)
         {
-            iniFile.SetUInt("ShaderHash" + std::to_string(counter), hash, "", vertexHashesCategory);
-            counter++;
+            encoded = &encodedHere;
         }
-        iniFile.SetUInt("AmountHashes", counter, "", vertexHashesCategory);
 
-        counter = 0;
-        for (const auto hash : _pixelShaderHashes)
+        // Encoding the hash lists is most of the work, skip it if they haven't changed since the last save
+        if (encoded->stamp != _hashStamp)
         {
-            iniFile.SetUInt("ShaderHash" + std::to_string(counter), hash, "", pixelHashesCategory);
-            counter++;
+            encoded->stamp = _hashStamp;
+            encoded->vertex = encodeHashes(_vertexShaderHashes);
+            encoded->pixel = encodeHashes(_pixelShaderHashes);
         }
-        iniFile.SetUInt("AmountHashes", counter, "", pixelHashesCategory);
 
-        counter = 0;
+        iniFile.SetUInt("AmountHashes", static_cast<uint32_t>(_vertexShaderHashes.size()), "", vertexHashesCategory);
+        iniFile.SetValue("Hashes", encoded->vertex, "", vertexHashesCategory);
+
+        iniFile.SetUInt("AmountHashes", static_cast<uint32_t>(_pixelShaderHashes.size()), "", pixelHashesCategory);
+        iniFile.SetValue("Hashes", encoded->pixel, "", pixelHashesCategory);
+
+        int counter = 0;
         for (const auto& [varName, varData] : _varOffsetMapping)
         {
-            const auto& [varOffset, varUsePref] = varData;
+            const auto& [varOffset, varUsePref, varElements] = varData;
             iniFile.SetUInt("Offset" + std::to_string(counter), varOffset, "", constantsCategory);
             iniFile.SetValue("Variable" + std::to_string(counter), varName, "", constantsCategory);
             iniFile.SetBool("UsePreviousValue" + std::to_string(counter), varUsePref, "", constantsCategory);
+            iniFile.SetUInt("Elements" + std::to_string(counter), varElements, "", constantsCategory);
             counter++;
         }
         iniFile.SetUInt("AmountConstants", counter, "", constantsCategory);
@@ -209,28 +309,76 @@ namespace ShaderToggler
     }
 
 
-    void ToggleGroup::loadState(CDataFile& iniFile, int groupCounter)
+    uint32_t ToggleGroup::applyState(const ToggleGroup& source)
     {
-        if (groupCounter < 0)
+        uint32_t changes = GROUP_CHANGE_NONE;
+        const auto assign = [&changes](auto& field, const auto& value, uint32_t change)
         {
-            int amount = iniFile.GetInt("AmountHashes", "PixelShaders");
-            for (int i = 0; i < amount; i++)
-            {
-                uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), "PixelShaders");
-                if (hash != UINT_MAX)
-                {
-                    _pixelShaderHashes.emplace(hash);
-                }
-            }
-            amount = iniFile.GetInt("AmountHashes", "VertexShaders");
-            for (int i = 0; i < amount; i++)
+            if (!(field == value))
             {
-                uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), "VertexShaders");
-                if (hash != UINT_MAX)
-                {
-                    _vertexShaderHashes.emplace(hash);
-                }
+                field = value;
+                changes |= change;
             }
+        };
+
+        assign(_vertexShaderHashes, source._vertexShaderHashes, GROUP_CHANGE_HASHES);
+        assign(_pixelShaderHashes, source._pixelShaderHashes, GROUP_CHANGE_HASHES);
+
+        assign(_isProvidingTextureBinding, source._isProvidingTextureBinding, GROUP_CHANGE_BINDING);
+        assign(_textureBindingName, source._textureBindingName, GROUP_CHANGE_BINDING);
+        assign(_copyTextureBinding, source._copyTextureBinding, GROUP_CHANGE_BINDING);
+        assign(_clearBindings, source._clearBindings, GROUP_CHANGE_BINDING);
+
+        assign(_varOffsetMapping, source._varOffsetMapping, GROUP_CHANGE_CONSTANTS);
+
+        assign(_name, source._name, GROUP_CHANGE_OTHER);
+        assign(_keybind, source._keybind, GROUP_CHANGE_OTHER);
+        assign(_isActive, source._isActive, GROUP_CHANGE_OTHER);
+        assign(_preferredTechniques, source._preferredTechniques, GROUP_CHANGE_OTHER);
+        assign(_allowAllTechniques, source._allowAllTechniques, GROUP_CHANGE_OTHER);
+        assign(_hasTechniqueExceptions, source._hasTechniqueExceptions, GROUP_CHANGE_OTHER);
+        assign(_invocationLocation, source._invocationLocation, GROUP_CHANGE_OTHER);
+        assign(_rtIndex, source._rtIndex, GROUP_CHANGE_OTHER);
+        assign(_matchSwapchainResolution, source._matchSwapchainResolution, GROUP_CHANGE_OTHER);
+        assign(_requeueAfterRTMatchingFailure, source._requeueAfterRTMatchingFailure, GROUP_CHANGE_OTHER);
+        assign(_extractConstants, source._extractConstants, GROUP_CHANGE_OTHER);
+        assign(_cbSlotIndex, source._cbSlotIndex, GROUP_CHANGE_OTHER);
+        assign(_cbDescIndex, source._cbDescIndex, GROUP_CHANGE_OTHER);
+        assign(_cbModePush, source._cbModePush, GROUP_CHANGE_OTHER);
+        assign(_extractResourceViews, source._extractResourceViews, GROUP_CHANGE_OTHER);
+        assign(_bindingSrvSlotIndex, source._bindingSrvSlotIndex, GROUP_CHANGE_OTHER);
+        assign(_bindingSrvDescIndex, source._bindingSrvDescIndex, GROUP_CHANGE_OTHER);
+        assign(_bindingRTIndex, source._bindingRTIndex, GROUP_CHANGE_OTHER);
+        assign(_bindingInvocationLocation, source._bindingInvocationLocation, GROUP_CHANGE_OTHER);
+        assign(_bindingMatchSwapchainResolution, source._bindingMatchSwapchainResolution, GROUP_CHANGE_OTHER);
+
+        if (changes & GROUP_CHANGE_HASHES)
+        {
+            _hashStamp = ++s_hashVersion;
+        }
+
+        if (changes & GROUP_CHANGE_CONSTANTS)
+        {
+            _varMappingVersion++;
+        }
+
+        if (changes != GROUP_CHANGE_NONE)
+        {
+            s_hotStateVersion++;
+        }
+
+        return changes;
+    }
+
+
+    void ToggleGroup::loadState(CDataFile& iniFile, int groupCounter)
+    {
+        _hashStamp = ++s_hashVersion;
+
+        if (groupCounter < 0)
+        {
+            loadHashes(iniFile, "PixelShaders", _pixelShaderHashes);
+            loadHashes(iniFile, "VertexShaders", _vertexShaderHashes);
 
             // done
             return;
@@ -241,25 +389,8 @@ namespace ShaderToggler
         const string pixelHashesCategory = sectionRoot + "_PixelShaders";
         const string constantsCategory = sectionRoot + "_Constants";
 
-        int amountShaders = iniFile.GetInt("AmountHashes", vertexHashesCategory);
-        for (int i = 0; i < amountShaders; i++)
-        {
-            uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), vertexHashesCategory);
-            if (hash != UINT_MAX)
-            {
-                _vertexShaderHashes.emplace(hash);
-            }
-        }
-
-        amountShaders = iniFile.GetInt("AmountHashes", pixelHashesCategory);
-        for (int i = 0; i < amountShaders; i++)
-        {
-            uint32_t hash = iniFile.GetUInt("ShaderHash" + std::to_string(i), pixelHashesCategory);
-            if (hash != UINT_MAX)
-            {
-                _pixelShaderHashes.emplace(hash);
-            }
-        }
+        loadHashes(iniFile, vertexHashesCategory, _vertexShaderHashes);
+        loadHashes(iniFile, pixelHashesCategory, _pixelShaderHashes);
 
         int amountConstants = iniFile.GetInt("AmountConstants", constantsCategory);
         for (int i = 0; i < amountConstants; i++)
@@ -267,11 +398,17 @@ namespace ShaderToggler
             uint32_t offset = iniFile.GetUInt("Offset" + std::to_string(i), constantsCategory);
             string varName = iniFile.GetString("Variable" + std::to_string(i), constantsCategory);
             bool prevValue = iniFile.GetBool("UsePreviousValue" + std::to_string(i), constantsCategory);
+            uint32_t elements = iniFile.GetUInt("Elements" + std::to_string(i), constantsCategory);
+            if (elements == UINT_MAX || elements == 0)
+            {
+                elements = 1;
+            }
             if (offset != UINT_MAX && varName.size() > 0)
             {
-                _varOffsetMapping.emplace(varName, make_tuple(offset, prevValue));
+                _varOffsetMapping.emplace(varName, make_tuple(offset, prevValue, elements));
             }
         }
+        _varMappingVersion++;
 
         _name = iniFile.GetValue("Name", sectionRoot);
         if (_name.size() <= 0)
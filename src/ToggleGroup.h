@@ -31,7 +31,9 @@
 /////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <atomic>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -54,6 +56,133 @@ namespace ShaderToggler
         SWAPCHAIN_MATCH_MODE_NONE = 3
     };
 
+    enum GroupStatistic : uint32_t
+    {
+        STAT_MATCHES = 0,
+        STAT_TECHNIQUES_RENDERED,
+        STAT_BINDING_COPIES,
+        STAT_BINDING_BYTES,
+        STAT_CONSTANT_REFRESHES,
+        STAT_REQUEUES,
+        STAT_REJECT_NULL_RESOURCE,
+        STAT_REJECT_FORMAT,
+        STAT_REJECT_RESOLUTION,
+        STAT_REJECT_ASPECT_RATIO,
+        STAT_COUNT
+    };
+
+    static const char* GroupStatisticNames[] = {
+        "Shader matches",
+        "Techniques rendered",
+        "Binding copies",
+        "Binding bytes copied",
+        "Constant refreshes",
+        "Requeues",
+        "RT rejected: no resource",
+        "RT rejected: format",
+        "RT rejected: resolution",
+        "RT rejected: aspect ratio"
+    };
+
+    /// <summary>
+    /// Runtime counters of a group. Every recording thread bumps its own slot with a plain load/store, so a match costs no
+    /// locked add and no cache line bouncing between threads; readers sum the slots. Threads beyond the first THREAD_SLOTS
+    /// share one last slot with atomic adds. Get and Reset are called from the present thread.
+    /// Copying a group copies a snapshot of its counters.
+    /// </summary>
+    struct ToggleGroupStatistics final
+    {
+        static constexpr uint32_t THREAD_SLOTS = 16;
+
+        ToggleGroupStatistics() = default;
+        ToggleGroupStatistics(const ToggleGroupStatistics& other) { *this = other; }
+
+        ToggleGroupStatistics& operator=(const ToggleGroupStatistics& other)
+        {
+            for (uint32_t i = 0; i < STAT_COUNT; i++)
+            {
+                const uint64_t value = other.Get(static_cast<GroupStatistic>(i));
+                for (auto& slot : _slots)
+                {
+                    slot.counters[i].store(0, std::memory_order_relaxed);
+                }
+                _slots[0].counters[i].store(value, std::memory_order_relaxed);
+                _reset[i] = 0;
+            }
+            return *this;
+        }
+
+        void Add(GroupStatistic stat, uint64_t amount = 1)
+        {
+            const uint32_t slot = GetThreadSlot();
+            std::atomic_uint64_t& counter = _slots[slot].counters[stat];
+
+            if (slot < THREAD_SLOTS)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+            else
+            {
+                counter.fetch_add(amount, std::memory_order_relaxed);
+            }
+        }
+
+        uint64_t Get(GroupStatistic stat) const
+        {
+            uint64_t value = 0;
+            for (const auto& slot : _slots)
+            {
+                value += slot.counters[stat].load(std::memory_order_relaxed);
+            }
+            return value - _reset[stat];
+        }
+
+        // Counters are only written by their threads, a reset remembers the current values and Get subtracts them
+        void Reset()
+        {
+            for (uint32_t i = 0; i < STAT_COUNT; i++)
+            {
+                _reset[i] += Get(static_cast<GroupStatistic>(i));
+            }
+        }
+
+    private:
+        struct alignas(64) Slot
+        {
+            std::atomic_uint64_t counters[STAT_COUNT] = {};
+        };
+
+        // Index of the calling thread's slot, assigned on its first count and never reused
+        static uint32_t GetThreadSlot()
+        {
+            static std::atomic_uint32_t nextSlot = 0;
+            thread_local const uint32_t slot = std::min(nextSlot.fetch_add(1, std::memory_order_relaxed), THREAD_SLOTS);
+            return slot;
+        }
+
+        Slot _slots[THREAD_SLOTS + 1];
+        uint64_t _reset[STAT_COUNT] = {};
+    };
+
+    enum GroupChange : uint32_t
+    {
+        GROUP_CHANGE_NONE = 0,
+        GROUP_CHANGE_HASHES = 1 << 0,
+        GROUP_CHANGE_BINDING = 1 << 1,		// texture binding definition: provided, name, copy or clear
+        GROUP_CHANGE_CONSTANTS = 1 << 2,	// variable mappings
+        GROUP_CHANGE_OTHER = 1 << 3
+    };
+
+    /// <summary>
+    /// A group's shader hash lists as written to the config, with the hash stamp of the group they were encoded from.
+    /// </summary>
+    struct EncodedHashes final
+    {
+        uint32_t stamp = 0;
+        std::string vertex;
+        std::string pixel;
+    };
+
     class ToggleGroup
     {
     public:
@@ -61,6 +190,12 @@ namespace ShaderToggler
         ToggleGroup();
 
         static int getNewGroupId();
+        // Bumped whenever a field mirrored into ToggleGroupHotData changes on any group
+        static uint32_t getHotStateVersion() { return s_hotStateVersion; }
+        // Bumped whenever a group is created or its shader hashes change
+        static uint32_t getHashVersion() { return s_hashVersion; }
+        // Value of the hash version when this group's shader hashes last changed
+        uint32_t getHashStamp() const { return _hashStamp; }
 
         void setToggleKey(uint32_t keybind) { _keybind = keybind; }
         void setName(std::string newName);
@@ -69,19 +204,28 @@ namespace ShaderToggler
         /// </summary>
         /// <param name="iniFile"></param>
         /// <param name="groupCounter"></param>
-        void saveState(CDataFile& iniFile, int groupCounter) const;
+        /// <param name="encoded">optional, hash lists encoded by an earlier save of this group, reused if the hashes haven't changed since</param>
+        void saveState(CDataFile& iniFile, int groupCounter, EncodedHashes* encoded = nullptr) const;
         /// <summary>
         /// Loads the shader hashes, name and toggle key from the ini file specified, using a Group + groupCounter section.
+        /// Hash lists are read in both the single line format and the key per hash format of older versions.
         /// </summary>
         /// <param name="iniFile"></param>
         /// <param name="groupCounter">if -1, the ini file is in the pre-1.0 format</param>
         void loadState(CDataFile& iniFile, int groupCounter);
-        void storeCollectedHashes(const std::unordered_set<uint32_t> pixelShaderHashes, const std::unordered_set<uint32_t> vertexShaderHashes);
+        /// <summary>
+        /// Takes over the persisted state of source, e.g. a group loaded from an edited config. Only fields which differ
+        /// are assigned. Runtime state like the id, editing state and statistics is kept.
+        /// </summary>
+        /// <param name="source"></param>
+        /// <returns>GroupChange flags of what changed</returns>
+        uint32_t applyState(const ToggleGroup& source);
+        void storeCollectedHashes(const std::unordered_set<uint32_t>& pixelShaderHashes, const std::unordered_set<uint32_t>& vertexShaderHashes);
         bool isBlockedVertexShader(uint32_t shaderHash) const;
         bool isBlockedPixelShader(uint32_t shaderHash) const;
         void clearHashes();
 
-        void toggleActive() { _isActive = !_isActive; }
+        void toggleActive() { _isActive = !_isActive; s_hotStateVersion++; }
         void setEditing(bool isEditing) { _isEditing = isEditing; }
 
         uint32_t getToggleKey() { return _keybind; }
@@ -91,12 +235,12 @@ namespace ShaderToggler
         bool isEmpty() const { return _vertexShaderHashes.size() <= 0 && _pixelShaderHashes.size() <= 0; }
         int getId() const { return _id; }
         const std::unordered_set<std::string>& preferredTechniques() const { return _preferredTechniques; }
-        void setPreferredTechniques(std::unordered_set<std::string> techniques) { _preferredTechniques = techniques; }
-        std::unordered_set<uint32_t> getPixelShaderHashes() const { return _pixelShaderHashes; }
-        std::unordered_set<uint32_t> getVertexShaderHashes() const { return _vertexShaderHashes; }
-        void setInvocationLocation(uint32_t location) { _invocationLocation = location; }
+        void setPreferredTechniques(const std::unordered_set<std::string>& techniques) { _preferredTechniques = techniques; s_hotStateVersion++; }
+        const std::unordered_set<uint32_t>& getPixelShaderHashes() const { return _pixelShaderHashes; }
+        const std::unordered_set<uint32_t>& getVertexShaderHashes() const { return _vertexShaderHashes; }
+        void setInvocationLocation(uint32_t location) { _invocationLocation = location; s_hotStateVersion++; }
         uint32_t getInvocationLocation() const { return _invocationLocation; }
-        void setBindingInvocationLocation(uint32_t location) { _bindingInvocationLocation = location; }
+        void setBindingInvocationLocation(uint32_t location) { _bindingInvocationLocation = location; s_hotStateVersion++; }
         uint32_t getBindingInvocationLocation() const { return _bindingInvocationLocation; }
         void setCBSlotIndex(uint32_t index) { _cbSlotIndex = index; }
         uint32_t getCBSlotIndex() const { return _cbSlotIndex; }
@@ -107,17 +251,17 @@ namespace ShaderToggler
         void setRenderTargetIndex(uint32_t index) { _rtIndex = index; }
         uint32_t getRenderTargetIndex() const { return _rtIndex; }
         bool isProvidingTextureBinding() const { return _isProvidingTextureBinding; }
-        void setProvidingTextureBinding(bool isProvidingTextureBinding) { _isProvidingTextureBinding = isProvidingTextureBinding; }
+        void setProvidingTextureBinding(bool isProvidingTextureBinding) { _isProvidingTextureBinding = isProvidingTextureBinding; s_hotStateVersion++; }
         const std::string& getTextureBindingName() const { return _textureBindingName; }
-        void setTextureBindingName(std::string textureBindingName) { _textureBindingName = textureBindingName; }
+        void setTextureBindingName(std::string textureBindingName) { _textureBindingName = textureBindingName; s_hotStateVersion++; }
         bool getClearBindings() { return _clearBindings; }
         void setClearBindings(bool clear) { _clearBindings = clear; }
         bool getAllowAllTechniques() const { return _allowAllTechniques; }
-        void setAllowAllTechniques(bool allowAllTechniques) { _allowAllTechniques = allowAllTechniques; }
+        void setAllowAllTechniques(bool allowAllTechniques) { _allowAllTechniques = allowAllTechniques; s_hotStateVersion++; }
         bool getExtractConstants() const { return _extractConstants; }
-        void setExtractConstant(bool extract) { _extractConstants = extract; }
+        void setExtractConstant(bool extract) { _extractConstants = extract; s_hotStateVersion++; }
         bool getExtractResourceViews() const { return _extractResourceViews; }
-        void setExtractResourceViews(bool extract) { _extractResourceViews = extract; }
+        void setExtractResourceViews(bool extract) { _extractResourceViews = extract; s_hotStateVersion++; }
         void setBindingSRVSlotIndex(uint32_t index) { _bindingSrvSlotIndex = index; }
         uint32_t getBindingSRVSlotIndex() const { return _bindingSrvSlotIndex; }
         void setBindingSRVDescriptorIndex(uint32_t index) { _bindingSrvDescIndex = index; }
@@ -125,7 +269,7 @@ namespace ShaderToggler
         void setBindingRenderTargetIndex(uint32_t index) { _bindingRTIndex = index; }
         uint32_t getBindingRenderTargetIndex() const { return _bindingRTIndex; }
         bool getHasTechniqueExceptions() const { return _hasTechniqueExceptions; }
-        void setHasTechniqueExceptions(bool exceptions) { _hasTechniqueExceptions = exceptions; }
+        void setHasTechniqueExceptions(bool exceptions) { _hasTechniqueExceptions = exceptions; s_hotStateVersion++; }
         uint32_t getMatchSwapchainResolution() const { return _matchSwapchainResolution; }
         void setMatchSwapchainResolution(uint32_t match) { _matchSwapchainResolution = match; }
         uint32_t getBindingMatchSwapchainResolution() const { return _bindingMatchSwapchainResolution; }
@@ -133,10 +277,11 @@ namespace ShaderToggler
         bool getRequeueAfterRTMatchingFailure() const { return _requeueAfterRTMatchingFailure; }
         void setRequeueAfterRTMatchingFailure(bool requeue) { _requeueAfterRTMatchingFailure = requeue; }
         bool getCopyTextureBinding() const { return _copyTextureBinding; }
-        void setCopyTextureBinding(bool copy) { _copyTextureBinding = copy; }
-        const std::unordered_map<std::string, std::tuple<uintptr_t, bool>>& GetVarOffsetMapping() const { return _varOffsetMapping; }
-        bool SetVarMapping(uintptr_t, std::string&, bool);
+        void setCopyTextureBinding(bool copy) { _copyTextureBinding = copy; s_hotStateVersion++; }
+        const std::unordered_map<std::string, std::tuple<uintptr_t, bool, uint32_t>>& GetVarOffsetMapping() const { return _varOffsetMapping; }
+        bool SetVarMapping(uintptr_t, std::string&, bool, uint32_t elements = 1);
         bool RemoveVarMapping(std::string&);
+        uint32_t getVarMappingVersion() const { return _varMappingVersion; }
         void dispatchCBCycle(DescriptorCycle cycle) { _cbCycle = cycle; }
         DescriptorCycle consumeCBCycle() 
         { 
@@ -158,6 +303,8 @@ namespace ShaderToggler
             _rtCycle = CYCLE_NONE;
             return ret;
         }
+        ToggleGroupStatistics& getStatistics() { return _statistics; }
+        const ToggleGroupStatistics& getStatistics() const { return _statistics; }
 
         bool operator==(const ToggleGroup& rhs)
         {
@@ -193,9 +340,40 @@ namespace ShaderToggler
         bool _cbModePush = false;
         std::string _textureBindingName;
         std::unordered_set<std::string> _preferredTechniques;
-        std::unordered_map<std::string, std::tuple<uintptr_t, bool>> _varOffsetMapping;
+        std::unordered_map<std::string, std::tuple<uintptr_t, bool, uint32_t>> _varOffsetMapping;	// variable -> offset, use previous value, array elements
+        uint32_t _varMappingVersion = 0;	// bumped on every change of _varOffsetMapping so consumers can cache derived data
+        uint32_t _hashStamp = 0;
+        ToggleGroupStatistics _statistics;
         DescriptorCycle _cbCycle;
         DescriptorCycle _srvCycle;
         DescriptorCycle _rtCycle;
+
+        static std::atomic_uint32_t s_hotStateVersion;
+        static std::atomic_uint32_t s_hashVersion;
+    };
+
+    static constexpr uint32_t HOT_GROUP_ACTIVE                   = 0b000000001;
+    static constexpr uint32_t HOT_GROUP_EXTRACT_CONSTANTS        = 0b000000010;
+    static constexpr uint32_t HOT_GROUP_PROVIDES_BINDING         = 0b000000100;
+    static constexpr uint32_t HOT_GROUP_COPY_BINDING             = 0b000001000;
+    static constexpr uint32_t HOT_GROUP_EXTRACT_RESOURCE_VIEWS   = 0b000010000;
+    static constexpr uint32_t HOT_GROUP_ALLOW_ALL_TECHNIQUES     = 0b000100000;
+    static constexpr uint32_t HOT_GROUP_TECHNIQUE_EXCEPTIONS     = 0b001000000;
+    static constexpr uint32_t HOT_GROUP_PREFERRED_TECHNIQUES     = 0b010000000;
+
+    static constexpr uint32_t INVALID_BINDING_ID = UINT32_MAX;
+
+    /// <summary>
+    /// The subset of a ToggleGroup consulted on every draw call, packed into a contiguous array indexed by a dense group index.
+    /// Regenerated by AddonUIData whenever a group is edited, cold data is only reached through group once work is queued.
+    /// </summary>
+    struct ToggleGroupHotData final
+    {
+        ToggleGroup* group;
+        int32_t id;
+        uint32_t bindingId;
+        uint16_t flags;
+        uint8_t invocationLocation;
+        uint8_t bindingInvocationLocation;
     };
 }
@@ -0,0 +1,167 @@
+#include <windows.h>
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <reshade.hpp>
+#include "TraceRecorder.h"
+
+using namespace Profiling;
+using namespace std;
+
+atomic_bool TraceRecorder::_enabled = false;
+atomic_uint64_t TraceRecorder::_writeIndex = 0;
+atomic_uint32_t TraceRecorder::_frame = 0;
+atomic_bool TraceRecorder::_dumping = false;
+mutex TraceRecorder::_dumpMutex;
+condition_variable TraceRecorder::_dumped;
+TraceRecorder::Event TraceRecorder::_events[TraceRecorder::CAPACITY];
+
+uint64_t TraceRecorder::Now()
+{
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void TraceRecorder::Record(TraceEventType type, uint64_t startNs, uint64_t endNs, uint32_t arg)
+{
+    thread_local const uint32_t threadId = GetCurrentThreadId();
+
+    const uint64_t index = _writeIndex.fetch_add(1, memory_order_relaxed);
+    Event& ev = _events[index & (CAPACITY - 1)];
+
+    ev.sequence.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    ev.startNs = startNs;
+    ev.durationNs = static_cast<uint32_t>(std::min<uint64_t>(endNs - startNs, UINT32_MAX));
+    ev.threadId = threadId;
+    ev.frame = _frame.load(memory_order_relaxed);
+    ev.type = type;
+    ev.arg = arg;
+
+    ev.sequence.store(index + 1, memory_order_release);
+}
+
+void TraceRecorder::EndFrame()
+{
+    if (IsEnabled())
+    {
+        const uint64_t now = Now();
+        Record(TRACE_FRAME, now, now, _frame.load(memory_order_relaxed));
+    }
+
+    _frame.fetch_add(1, memory_order_relaxed);
+}
+
+bool TraceRecorder::Dump(const filesystem::path& path)
+{
+    unique_lock<mutex> lock(_dumpMutex);
+
+    if (_dumping)
+    {
+        return false;
+    }
+
+    const uint32_t frame = _frame.load(memory_order_relaxed);
+    const uint32_t firstFrame = frame > DUMP_FRAMES ? frame - DUMP_FRAMES : 0;
+
+    // Detached so a process exiting without a shutdown event isn't terminated by a joinable static thread, _dumping keeps
+    // a second dump from starting until this one is written
+    _dumping = true;
+    thread(WriteTrace, path, _writeIndex.load(memory_order_acquire), firstFrame).detach();
+
+    return true;
+}
+
+void TraceRecorder::Join()
+{
+    unique_lock<mutex> lock(_dumpMutex);
+
+    _dumped.wait(lock, [] { return !_dumping; });
+}
+
+void TraceRecorder::WriteTrace(filesystem::path path, uint64_t endIndex, uint32_t firstFrame)
+{
+    struct Snapshot
+    {
+        uint64_t startNs;
+        uint32_t durationNs;
+        uint32_t threadId;
+        uint32_t type;
+        uint32_t arg;
+    };
+
+    // Copy out first so slots recycled by the recording threads are detected before anything is written
+    vector<Snapshot> events;
+    const uint64_t beginIndex = endIndex > CAPACITY ? endIndex - CAPACITY : 0;
+    events.reserve(static_cast<size_t>(endIndex - beginIndex));
+
+    for (uint64_t index = beginIndex; index < endIndex; index++)
+    {
+        const Event& ev = _events[index & (CAPACITY - 1)];
+
+        if (ev.sequence.load(memory_order_acquire) != index + 1)
+        {
+            continue;
+        }
+
+        const Snapshot snapshot = { ev.startNs, ev.durationNs, ev.threadId, ev.type, ev.arg };
+        const uint32_t frame = ev.frame;
+
+        atomic_thread_fence(memory_order_acquire);
+        if (ev.sequence.load(memory_order_relaxed) != index + 1 || frame < firstFrame || snapshot.type >= TRACE_EVENT_TYPE_COUNT)
+        {
+            continue;
+        }
+
+        events.push_back(snapshot);
+    }
+
+    std::sort(events.begin(), events.end(), [](const auto& lhs, const auto& rhs) { return lhs.startNs < rhs.startNs; });
+
+    ofstream file(path, ios::out | ios::trunc);
+    if (file)
+    {
+        const uint64_t baseNs = events.empty() ? 0 : events.front().startNs;
+        const uint32_t processId = GetCurrentProcessId();
+
+        file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            const Snapshot& ev = events[i];
+            const double ts = static_cast<double>(ev.startNs - baseNs) / 1000.0;
+            const string args = TraceEventArgNames[ev.type] != nullptr ? std::format("{{\"{}\":{}}}", TraceEventArgNames[ev.type], ev.arg) : "{}";
+
+            if (ev.type == TRACE_FRAME)
+            {
+                file << std::format("{{\"name\":\"{}\",\"ph\":\"i\",\"s\":\"g\",\"ts\":{:.3f},\"pid\":{},\"tid\":{},\"args\":{}}}",
+                    TraceEventNames[ev.type], ts, processId, ev.threadId, args);
+            }
+            else
+            {
+                file << std::format("{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{},\"args\":{}}}",
+                    TraceEventNames[ev.type], ts, ev.durationNs / 1000.0, processId, ev.threadId, args);
+            }
+
+            file << (i + 1 < events.size() ? ",\n" : "\n");
+        }
+        file << "]}\n";
+    }
+
+    if (file.good())
+    {
+        reshade::log_message(reshade::log_level::info, std::format("Wrote {} trace events to {}", events.size(), path.string()).c_str());
+    }
+    else
+    {
+        reshade::log_message(reshade::log_level::error, std::format("Failed to write trace to {}", path.string()).c_str());
+    }
+
+    {
+        unique_lock<mutex> lock(_dumpMutex);
+        _dumping = false;
+    }
+
+    _dumped.notify_all();
+}
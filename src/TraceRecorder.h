@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <condition_variable>
+
+#define TRACE_SCOPE(type, arg) const Profiling::TraceScope _traceScope(type, arg)
+
+namespace Profiling
+{
+    enum TraceEventType : uint32_t
+    {
+        TRACE_FRAME = 0,
+        TRACE_PIPELINE_MATCH,
+        TRACE_EFFECT_BATCH,
+        TRACE_BINDING_COPY,
+        TRACE_CONSTANT_READBACK,
+        TRACE_STATE_RESTORE,
+        TRACE_EVENT_TYPE_COUNT
+    };
+
+    static const char* TraceEventNames[] = {
+        "Present",
+        "Pipeline match",
+        "Effect batch",
+        "Binding copy",
+        "Constant readback",
+        "State restore"
+    };
+
+    // Names of the argument recorded with each event type, in the same order. nullptr if the type has none.
+    static const char* TraceEventArgNames[] = {
+        "frame",
+        "shader_hash",
+        "techniques",
+        "binding_id",
+        "size",
+        nullptr
+    };
+
+    /// <summary>
+    /// Ring buffer of the addon's own work, dumped as a Chrome trace (chrome://tracing, Perfetto) on request. Recording
+    /// is lock-free: every event claims a slot with a single atomic increment and publishes it with a sequence number,
+    /// so the dump thread can skip slots which were overwritten while it was reading them.
+    /// </summary>
+    class __declspec(novtable) TraceRecorder final
+    {
+    public:
+        static constexpr uint32_t CAPACITY = 1 << 17;
+        static constexpr uint32_t DUMP_FRAMES = 120;
+
+        static bool IsEnabled() { return _enabled.load(std::memory_order_relaxed); }
+        static void SetEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+        static uint64_t Now();
+        static void Record(TraceEventType type, uint64_t startNs, uint64_t endNs, uint32_t arg);
+
+        /// <summary>
+        /// Marks the end of a frame. Called from the present thread.
+        /// </summary>
+        static void EndFrame();
+
+        /// <summary>
+        /// Writes the last DUMP_FRAMES frames to the given file on a background thread. Returns false if a dump is still
+        /// being written.
+        /// </summary>
+        static bool Dump(const std::filesystem::path& path);
+
+        /// <summary>
+        /// Waits for a pending dump to finish. Called on shutdown.
+        /// </summary>
+        static void Join();
+
+    private:
+        struct Event
+        {
+            std::atomic_uint64_t sequence;	// index + 1 once the slot is written, 0 while it's being written
+            uint64_t startNs;
+            uint32_t durationNs;
+            uint32_t threadId;
+            uint32_t frame;
+            uint32_t type;
+            uint32_t arg;
+        };
+
+        static void WriteTrace(std::filesystem::path path, uint64_t endIndex, uint32_t firstFrame);
+
+        static std::atomic_bool _enabled;
+        static std::atomic_uint64_t _writeIndex;
+        static std::atomic_uint32_t _frame;
+        static std::atomic_bool _dumping;
+        static std::mutex _dumpMutex;
+        static std::condition_variable _dumped;
+        static Event _events[CAPACITY];
+    };
+
+    class TraceScope final
+    {
+    public:
+        TraceScope(TraceEventType type, uint32_t arg) : _type(type), _arg(arg), _startNs(TraceRecorder::IsEnabled() ? TraceRecorder::Now() : 0)
+        {
+        }
+
+        ~TraceScope()
+        {
+            if (_startNs != 0)
+            {
+                TraceRecorder::Record(_type, _startNs, TraceRecorder::Now(), _arg);
+            }
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        TraceEventType _type;
+        uint32_t _arg;
+        uint64_t _startNs;
+    };
+}